@@ -24,6 +24,13 @@ extern NVRHI::TextureHandle g_clipmap_opacity_texture = NULL;
 extern NVRHI::TextureHandle g_clipmap_illumination_texture = NULL;
 extern uint32_t g_MyWidth = 0U;
 extern uint32_t g_MyHeight = 0U;
+extern ID3D11ComputeShader *g_pMyConeTracingDownsampleCS = NULL;
+extern ID3D11ComputeShader *g_pMyConeTracingUpsampleCS = NULL;
+extern uint32_t g_MyTracingResolution = 1U;
+extern bool g_MyTracingHistory = false;
+extern NVRHI::TextureHandle g_my_cone_tracing_textures[MY_CONE_TRACING_TEXTURE_COUNT] = {};
+extern NVRHI::ConstantBufferHandle g_my_cone_tracing_constants = NULL;
+extern NVRHI::ConstantBufferHandle g_my_cone_tracing_gbuffer_parameters = NULL;
 
 namespace NVRHI
 {
@@ -570,7 +577,44 @@ namespace NVRHI
         t->resource.Get()->QueryInterface(IID_PPV_ARGS(&pTexture2D));
 
         if (pTexture2D == nullptr)
-            return false;
+        {
+            // 3D textures are read slice by slice, the depth pitch is "rowPitch * height"
+            ComPtr<ID3D11Texture3D> pTexture3D;
+            t->resource.Get()->QueryInterface(IID_PPV_ARGS(&pTexture3D));
+
+            if (pTexture3D == nullptr)
+                return false;
+
+            ComPtr<ID3D11Texture3D> pStagingTexture;
+            {
+                D3D11_TEXTURE3D_DESC desc;
+                pTexture3D->GetDesc(&desc);
+                desc.MipLevels = 1;
+                desc.BindFlags = 0;
+                desc.MiscFlags = 0;
+                desc.Usage = D3D11_USAGE_STAGING;
+                desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+
+                if (FAILED(device->CreateTexture3D(&desc, NULL, &pStagingTexture)))
+                    return false;
+            }
+
+            context->CopySubresourceRegion(pStagingTexture.Get(), 0, 0, 0, 0, pTexture3D.Get(), 0, NULL);
+
+            D3D11_MAPPED_SUBRESOURCE subresource;
+            if (FAILED(context->Map(pStagingTexture.Get(), 0, D3D11_MAP_READ, 0, &subresource)))
+                return false;
+
+            const FormatMapping &formatMapping = GetFormatMapping(t->desc.format);
+
+            for (uint32_t slice = 0; slice < t->desc.depthOrArraySize; slice++)
+                for (uint32_t row = 0; row < t->desc.height; row++)
+                    memcpy((char *)data + rowPitch * (t->desc.height * slice + row), (char *)subresource.pData + subresource.DepthPitch * slice + subresource.RowPitch * row, formatMapping.bytesPerPixel * t->desc.width);
+
+            context->Unmap(pStagingTexture.Get(), 0);
+
+            return true;
+        }
 
         ComPtr<ID3D11Texture2D> pStagingTexture;
         {
@@ -1108,8 +1152,15 @@ namespace NVRHI
             ID3D11ShaderResourceView *illumination_srv = getSRVForTexture(g_clipmap_illumination_texture, DXGI_FORMAT_R32_FLOAT, ~0U);
             context->CSSetShaderResources(15U, 1U, &illumination_srv);
 
-            context->CSSetShader(g_pMyConeTracingCS, NULL, 0U);
-            context->Dispatch(g_MyWidth, g_MyHeight, 1U);
+            if (((1U != g_MyTracingResolution) || g_MyTracingHistory) && (NULL != g_pMyConeTracingDownsampleCS) && (NULL != g_pMyConeTracingUpsampleCS))
+            {
+                dispatchMyConeTracingReduced();
+            }
+            else
+            {
+                context->CSSetShader(g_pMyConeTracingCS, NULL, 0U);
+                context->Dispatch(g_MyWidth, g_MyHeight, 1U);
+            }
         }
         else
         {
@@ -1119,6 +1170,94 @@ namespace NVRHI
         unapplyDispatchState(limits);
     }
 
+    // The G-buffer (t0 - t2), the "cBuiltinGBufferParameters" (b0) and the output (u0) bound by VXGI are replaced by the reduced resolution ones for the tracing, and restored afterwards.
+    void RendererInterfaceD3D11::dispatchMyConeTracingReduced()
+    {
+        uint32_t const tracingWidth = (g_MyWidth + g_MyTracingResolution - 1U) / g_MyTracingResolution;
+        uint32_t const tracingHeight = (g_MyHeight + g_MyTracingResolution - 1U) / g_MyTracingResolution;
+
+        ID3D11ShaderResourceView *boundSRVs[8] = {};
+        context->CSGetShaderResources(0U, 8U, boundSRVs);
+        ID3D11UnorderedAccessView *boundUAV = NULL;
+        context->CSGetUnorderedAccessViews(0U, 1U, &boundUAV);
+        ID3D11Buffer *boundCB = NULL;
+        context->CSGetConstantBuffers(0U, 1U, &boundCB);
+
+        ID3D11Buffer *coneTracingCB = static_cast<ConstantBuffer *>(g_my_cone_tracing_constants)->buffer.Get();
+        ID3D11Buffer *gbufferCB = static_cast<ConstantBuffer *>(g_my_cone_tracing_gbuffer_parameters)->buffer.Get();
+
+        ID3D11ShaderResourceView *const nullSRVs[8] = {};
+        ID3D11UnorderedAccessView *const nullUAVs[3] = {};
+
+        // the G-buffer at the sample positions
+        {
+            ID3D11UnorderedAccessView *uavs[3] = {
+                getUAVForTexture(g_my_cone_tracing_textures[MY_CONE_TRACING_TEXTURE_BASE_COLOR_AND_METALLIC]),
+                getUAVForTexture(g_my_cone_tracing_textures[MY_CONE_TRACING_TEXTURE_NORMAL_AND_ROUGHNESS]),
+                getUAVForTexture(g_my_cone_tracing_textures[MY_CONE_TRACING_TEXTURE_DEPTH])};
+
+            context->CSSetShader(g_pMyConeTracingDownsampleCS, NULL, 0U);
+            context->CSSetConstantBuffers(0U, 1U, &coneTracingCB);
+            context->CSSetUnorderedAccessViews(0U, 3U, uavs, NULL);
+            context->Dispatch((tracingWidth + 7U) / 8U, (tracingHeight + 7U) / 8U, 1U);
+            context->CSSetUnorderedAccessViews(0U, 3U, nullUAVs, NULL);
+        }
+
+        // the tracing at the sample positions
+        {
+            ID3D11ShaderResourceView *srvs[3] = {
+                getSRVForTexture(g_my_cone_tracing_textures[MY_CONE_TRACING_TEXTURE_BASE_COLOR_AND_METALLIC]),
+                getSRVForTexture(g_my_cone_tracing_textures[MY_CONE_TRACING_TEXTURE_NORMAL_AND_ROUGHNESS]),
+                getSRVForTexture(g_my_cone_tracing_textures[MY_CONE_TRACING_TEXTURE_DEPTH])};
+            ID3D11UnorderedAccessView *uav = getUAVForTexture(g_my_cone_tracing_textures[MY_CONE_TRACING_TEXTURE_RADIANCE_AND_AMBIENT]);
+
+            context->CSSetShader(g_pMyConeTracingCS, NULL, 0U);
+            context->CSSetConstantBuffers(0U, 1U, &gbufferCB);
+            context->CSSetShaderResources(0U, 3U, srvs);
+            context->CSSetUnorderedAccessViews(0U, 1U, &uav, NULL);
+            context->Dispatch(tracingWidth, tracingHeight, 1U);
+            context->CSSetUnorderedAccessViews(0U, 1U, nullUAVs, NULL);
+        }
+
+        // the upsampling to the output bound by VXGI
+        {
+            ID3D11ShaderResourceView *srvs[8] = {
+                getSRVForTexture(g_my_cone_tracing_textures[MY_CONE_TRACING_TEXTURE_RADIANCE_AND_AMBIENT]),
+                getSRVForTexture(g_my_cone_tracing_textures[MY_CONE_TRACING_TEXTURE_DEPTH]),
+                getSRVForTexture(g_my_cone_tracing_textures[MY_CONE_TRACING_TEXTURE_NORMAL_AND_ROUGHNESS]),
+                boundSRVs[2],
+                boundSRVs[1],
+                getSRVForTexture(g_my_cone_tracing_textures[MY_CONE_TRACING_TEXTURE_DEPTH_PREV]),
+                getSRVForTexture(g_my_cone_tracing_textures[MY_CONE_TRACING_TEXTURE_NORMAL_AND_ROUGHNESS_PREV]),
+                getSRVForTexture(g_my_cone_tracing_textures[MY_CONE_TRACING_TEXTURE_HISTORY_PREV])};
+            ID3D11UnorderedAccessView *uavs[2] = {
+                boundUAV,
+                getUAVForTexture(g_my_cone_tracing_textures[MY_CONE_TRACING_TEXTURE_HISTORY])};
+
+            context->CSSetShader(g_pMyConeTracingUpsampleCS, NULL, 0U);
+            context->CSSetConstantBuffers(0U, 1U, &coneTracingCB);
+            context->CSSetShaderResources(0U, 8U, srvs);
+            context->CSSetUnorderedAccessViews(0U, 2U, uavs, NULL);
+            context->Dispatch((g_MyWidth + 7U) / 8U, (g_MyHeight + 7U) / 8U, 1U);
+            context->CSSetUnorderedAccessViews(0U, 2U, nullUAVs, NULL);
+            context->CSSetShaderResources(0U, 8U, nullSRVs);
+        }
+
+        context->CSSetShaderResources(0U, 8U, boundSRVs);
+        context->CSSetUnorderedAccessViews(0U, 1U, &boundUAV, NULL);
+        context->CSSetConstantBuffers(0U, 1U, &boundCB);
+
+        for (uint32_t i = 0; i < 8U; i++)
+        {
+            if (boundSRVs[i])
+                boundSRVs[i]->Release();
+        }
+        if (boundUAV)
+            boundUAV->Release();
+        if (boundCB)
+            boundCB->Release();
+    }
+
     void RendererInterfaceD3D11::dispatchIndirect(const DispatchState &state, BufferHandle indirectParams, uint32_t offsetBytes)
     {
         ShaderResourceLimits limits;
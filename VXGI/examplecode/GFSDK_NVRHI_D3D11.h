@@ -23,6 +23,33 @@ extern NVRHI::TextureHandle g_clipmap_illumination_texture;
 extern uint32_t g_MyWidth;
 extern uint32_t g_MyHeight;
 
+// The reduced resolution mode of "g_pMyConeTracingCS": one sample per "g_MyTracingResolution" x "g_MyTracingResolution" block of pixels is traced, and the output is upsampled (with the history of the previous frames) to the full resolution.
+// The mode is used when the resolution is not 1 or the history is enabled, and the textures and the constant buffers are set by the application (see "ConeTracingConstants.h").
+enum MY_CONE_TRACING_TEXTURE
+{
+    // the G-buffer at the sample positions and the traced output, at least the size of the reduced resolution
+    MY_CONE_TRACING_TEXTURE_BASE_COLOR_AND_METALLIC = 0,
+    MY_CONE_TRACING_TEXTURE_NORMAL_AND_ROUGHNESS = 1,
+    MY_CONE_TRACING_TEXTURE_DEPTH = 2,
+    MY_CONE_TRACING_TEXTURE_RADIANCE_AND_AMBIENT = 3,
+    // the full resolution output of the current and the previous frame
+    MY_CONE_TRACING_TEXTURE_HISTORY = 4,
+    MY_CONE_TRACING_TEXTURE_HISTORY_PREV = 5,
+    // the full resolution G-buffer of the previous frame
+    MY_CONE_TRACING_TEXTURE_DEPTH_PREV = 6,
+    MY_CONE_TRACING_TEXTURE_NORMAL_AND_ROUGHNESS_PREV = 7,
+    MY_CONE_TRACING_TEXTURE_COUNT = 8
+};
+
+extern ID3D11ComputeShader *g_pMyConeTracingDownsampleCS;
+extern ID3D11ComputeShader *g_pMyConeTracingUpsampleCS;
+extern uint32_t g_MyTracingResolution;
+extern bool g_MyTracingHistory;
+extern NVRHI::TextureHandle g_my_cone_tracing_textures[MY_CONE_TRACING_TEXTURE_COUNT];
+// "ConeTracingConstants" and the "cBuiltinGBufferParameters" of the sample positions
+extern NVRHI::ConstantBufferHandle g_my_cone_tracing_constants;
+extern NVRHI::ConstantBufferHandle g_my_cone_tracing_gbuffer_parameters;
+
 namespace NVRHI
 {
   using namespace Microsoft::WRL;
@@ -119,6 +146,8 @@ namespace NVRHI
 
     void disableSLIResouceSync(ID3D11Resource *resource);
 
+    void dispatchMyConeTracingReduced();
+
   public:
     // These are the methods in the in the IRendererInteface inteface that are implemented by us
 
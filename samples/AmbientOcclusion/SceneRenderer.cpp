@@ -28,6 +28,7 @@
 #include "shaders\D3D\Debug\CompositingPS.inl"
 #include "shaders\D3D\Debug\MyVoxelizationVS.inl"
 #include "shaders\D3D\Debug\MyVoxelizationPS.inl"
+#include "shaders\D3D\Debug\MyVoxelizationOpaquePS.inl"
 #else
 #include "shaders\D3D\Release\DefaultVS.inl"
 #include "shaders\D3D\Release\AttributesPS.inl"
@@ -36,6 +37,7 @@
 #include "shaders\D3D\Release\CompositingPS.inl"
 #include "shaders\D3D\Release\MyVoxelizationVS.inl"
 #include "shaders\D3D\Release\MyVoxelizationPS.inl"
+#include "shaders\D3D\Release\MyVoxelizationOpaquePS.inl"
 #endif
 #include "shaders\VoxelizationPS.hlsli"
 
@@ -71,6 +73,7 @@ HRESULT SceneRenderer::AllocateResources(VXGI::IGlobalIllumination *pGI, VXGI::I
     CREATE_SHADER(PIXEL, g_BlitPS, &m_pBlitPS);
     CREATE_SHADER(PIXEL, g_CompositingPS, &m_pCompositingPS);
     CREATE_SHADER(PIXEL, g_MyVoxelizationPS, &m_pMyVoxelizationPS);
+    CREATE_SHADER(PIXEL, g_MyVoxelizationOpaquePS, &m_pMyVoxelizationOpaquePS);
 
     m_RendererInterface->createConstantBuffer(NVRHI::ConstantBufferDesc(sizeof(GlobalConstants), nullptr), nullptr, &m_pGlobalCBuffer);
 
@@ -354,7 +357,6 @@ void SceneRenderer::RenderSceneCommon(
 
                     state.VS.shader = m_pMyVoxelizationVS;
                     state.GS.shader = NULL;
-                    state.PS.shader = m_pMyVoxelizationPS;
 
                     state.renderState.viewportCount = 1;
                     state.renderState.viewports[0] = NVRHI::Viewport(float(BRX_VCT_CLIPMAP_MAP_SIZE), float(BRX_VCT_CLIPMAP_MAP_SIZE));
@@ -366,9 +368,16 @@ void SceneRenderer::RenderSceneCommon(
                     NVRHI::BindSampler(state.PS, 0, m_pDefaultSamplerState);
                 }
 
-                NVRHI::BindTexture(state.PS, SRV_SLOT_NORMAL_TEXTURE, materialInfo.normal_texture ? materialInfo.normal_texture : m_NullTexture, false, NVRHI::Format::UNKNOWN, ~0u);
-                NVRHI::BindTexture(state.PS, SRV_SLOT_BASE_COLOR_TEXTURE, materialInfo.base_color_texture ? materialInfo.base_color_texture : m_NullTexture, false, NVRHI::Format::UNKNOWN, ~0u);
-                NVRHI::BindTexture(state.PS, SRV_SLOT_ROUGHNESS_METALLIC_TEXTURE, materialInfo.roughness_metallic_texture ? materialInfo.roughness_metallic_texture : m_NullTexture, false, NVRHI::Format::UNKNOWN, ~0u);
+                // only the opacity is voxelized: the alpha tested materials only read the alpha of the base color, and the opaque materials read no texture
+                if (materialInfo.alphaTested)
+                {
+                    state.PS.shader = m_pMyVoxelizationPS;
+                    NVRHI::BindTexture(state.PS, SRV_SLOT_BASE_COLOR_TEXTURE, materialInfo.base_color_texture ? materialInfo.base_color_texture : m_WhiteDummy, false, NVRHI::Format::UNKNOWN, ~0u);
+                }
+                else
+                {
+                    state.PS.shader = m_pMyVoxelizationOpaquePS;
+                }
             }
 
             NVRHI::BindBuffer(state.VS, SRV_SLOT_VERTEX_POSITION_BUFFER, m_pScene->GetVertexPositionBuffer(i), false, NVRHI::Format::BC7);
@@ -413,6 +422,8 @@ void SceneRenderer::GetMaterialInfo(UINT meshID, OUT MeshMaterialInfo &materialI
 
     materialInfo.diffuseColor = m_pScene->GetColor(aiTextureType_DIFFUSE, meshID);
 
+    materialInfo.alphaTested = m_pScene->IsMeshAlphaTested(meshID);
+
     materialInfo.geometryShader = m_pVoxelizationGS;
     materialInfo.pixelShader = m_pVoxelizationPS;
 }
@@ -34,7 +34,10 @@ struct MeshMaterialInfo : public VXGI::MaterialInfo
 
     VXGI::float3 diffuseColor;
 
-    MeshMaterialInfo() : normal_texture(NULL), base_color_texture(NULL), roughness_metallic_texture(NULL), diffuseColor(0.f)
+    // the alpha of the base color is ignored by the opaque materials
+    bool alphaTested;
+
+    MeshMaterialInfo() : normal_texture(NULL), base_color_texture(NULL), roughness_metallic_texture(NULL), diffuseColor(0.f), alphaTested(false)
     {
     }
 };
@@ -54,6 +57,7 @@ private:
     NVRHI::ShaderRef m_pBlitPS;
     NVRHI::ShaderRef m_pCompositingPS;
     NVRHI::ShaderRef m_pMyVoxelizationPS;
+    NVRHI::ShaderRef m_pMyVoxelizationOpaquePS;
 
     NVRHI::ConstantBufferRef m_pGlobalCBuffer;
 
@@ -0,0 +1,4 @@
+// The voxelization of the opaque materials: the opacity is always 1 and no texture is sampled (see "MyVoxelizationPS").
+#define MY_VOXELIZATION_ALPHA_TEST 0
+
+#include "MyVoxelizationPS.hlsl"
@@ -315,11 +315,17 @@ void VxgiWriteVoxel(int3 coordinates, int clipLevel, bool writeOpacity, bool wri
 
 //////////////////APP CODE BOUNDARY/////////////
 
-Texture2D g_normal_texture : register(t3);
+// The ambient occlusion only needs the opacity (BRX_VCT_VOXELIZATION_ENABLE_ILLUMINATION is 0), thus the material is not evaluated.
+// The alpha tested materials only sample the alpha of the base color, and "MyVoxelizationOpaquePS" (MY_VOXELIZATION_ALPHA_TEST 0) samples no texture at all.
+#ifndef MY_VOXELIZATION_ALPHA_TEST
+#define MY_VOXELIZATION_ALPHA_TEST 1
+#endif
+
+#if MY_VOXELIZATION_ALPHA_TEST
 Texture2D g_base_color_texture : register(t4);
-Texture2D g_roughness_metallic_texture : register(t5);
 
 SamplerState g_sampler : register(s0);
+#endif
 
 void main(
     in uint in_sample_mask : SV_Coverage,
@@ -332,44 +338,8 @@ void main(
     in float4 in_interpolated_tangent : LOCATION4,
     in float2 in_interpolated_texcoord : LOCATION5)
 {
-    float3 shading_normal_world_space;
-    float3 diffuse_color;
-    float3 specular_color;
-    float opacity;
-    float roughness;
-    {
-        {
-            float3 geometry_normal_world_space = normalize(in_interpolated_normal);
-
-            float3 tangent_world_space = normalize(in_interpolated_tangent.xyz);
-
-            float3 bitangent_world_space = cross(geometry_normal_world_space, tangent_world_space) * ((in_interpolated_tangent.w >= 0.0) ? 1.0 : -1.0);
-
-            float3 shading_normal_tangent_space = normalize(g_normal_texture.Sample(g_sampler, in_interpolated_texcoord).xyz * 2.0 - float3(1.0, 1.0, 1.0));
-
-            shading_normal_world_space = normalize(tangent_world_space * shading_normal_tangent_space.x + bitangent_world_space * shading_normal_tangent_space.y + geometry_normal_world_space * shading_normal_tangent_space.z);
-        }
-
-        {
-            float4 base_color_and_opacity = g_base_color_texture.Sample(g_sampler, in_interpolated_texcoord);
-
-            float3 base_color = base_color_and_opacity.xyz;
-
-            opacity = base_color_and_opacity.w;
-
-            float2 roughness_metallic = g_roughness_metallic_texture.Sample(g_sampler, in_interpolated_texcoord).yz;
-
-            roughness = roughness_metallic.x;
-
-            float metallic = roughness_metallic.y;
-
-            // UE4: https://github.com/EpicGames/UnrealEngine/blob/4.21/Engine/Shaders/Private/MobileBasePassPixelShader.usf#L376
-            const float dielectric_specular = 0.04;
-
-            specular_color = clamp((dielectric_specular - dielectric_specular * metallic) + base_color * metallic, 0.0, 1.0);
-            diffuse_color = clamp(base_color - base_color * metallic, 0.0, 1.0);
-        }
-    }
+#if MY_VOXELIZATION_ALPHA_TEST
+    float opacity = g_base_color_texture.Sample(g_sampler, in_interpolated_texcoord).w;
 
     // [branch]
     if (opacity < 0.5)
@@ -377,6 +347,9 @@ void main(
         discard;
         return;
     }
+#else
+    float opacity = 1.0;
+#endif
 
     brx_voxel_cone_tracing_voxelization_store_data(
         in_viewport_depth_direction_index,
@@ -384,10 +357,10 @@ void main(
         brx_float3(in_position.x, BRX_VCT_CLIPMAP_MAP_SIZE - in_position.y, in_position.z * BRX_VCT_CLIPMAP_MAP_SIZE),
         in_sample_mask,
         opacity,
-        shading_normal_world_space,
-        diffuse_color,
-        specular_color,
-        roughness,
+        brx_normalize(in_interpolated_normal),
+        brx_float3(0.0, 0.0, 0.0),
+        brx_float3(0.0, 0.0, 0.0),
+        1.0,
         brx_normalize(brx_float3(-1.0, -1.0, -1.0)),
         brx_float3(0.0, 0.0, 0.0));
 
@@ -0,0 +1,260 @@
+#include "AreaLightManager.h"
+#include <cassert>
+#include <cmath>
+#include <cfloat>
+#include <algorithm>
+
+namespace
+{
+    struct Plane
+    {
+        float normal[3];
+        float distance;
+    };
+
+    inline float Dot3(const float a[3], const float b[3])
+    {
+        return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+    }
+
+    inline float Length3(const VXGI::float3 &v)
+    {
+        return std::sqrt(v.x * v.x + v.y * v.y + v.z * v.z);
+    }
+
+    // the row vector convention, "(x, y, z, 1) * matrix"
+    inline void TransformPoint(const VXGI::float4x4 &matrix, const float point[3], float result[4])
+    {
+        for (int column = 0; column < 4; ++column)
+        {
+            result[column] = point[0] * matrix[0][column] + point[1] * matrix[1][column] + point[2] * matrix[2][column] + matrix[3][column];
+        }
+    }
+
+    // the planes of the frustum in the view space, the points inside have "dot(normal, point) + distance >= 0"
+    void GetFrustumPlanes(const VXGI::float4x4 &projMatrix, Plane planes[6])
+    {
+        // left, right, bottom, top, near (the depth of 0), far
+        static const int s_column[6] = {0, 0, 1, 1, 2, 2};
+        static const float s_sign[6] = {1.0F, -1.0F, 1.0F, -1.0F, 1.0F, -1.0F};
+        static const float s_w_weight[6] = {1.0F, 1.0F, 1.0F, 1.0F, 0.0F, 1.0F};
+
+        for (int plane_index = 0; plane_index < 6; ++plane_index)
+        {
+            float coefficients[4];
+            for (int row = 0; row < 4; ++row)
+            {
+                coefficients[row] = s_w_weight[plane_index] * projMatrix[row][3] + s_sign[plane_index] * projMatrix[row][s_column[plane_index]];
+            }
+
+            float const length = std::sqrt(Dot3(coefficients, coefficients));
+            float const scale = (length > 0.0F) ? (1.0F / length) : 0.0F;
+
+            planes[plane_index].normal[0] = coefficients[0] * scale;
+            planes[plane_index].normal[1] = coefficients[1] * scale;
+            planes[plane_index].normal[2] = coefficients[2] * scale;
+            planes[plane_index].distance = coefficients[3] * scale;
+        }
+    }
+
+    // the inverse of the perspective projection of the view depth, "depth = P22 + P32 / z"
+    inline float GetViewDepth(const VXGI::float4x4 &projMatrix, float depth)
+    {
+        return projMatrix[3][2] / (depth - projMatrix[2][2]);
+    }
+
+    // Whether the sphere (in the view space) overlaps the depth range of any screen tile covered by the sphere.
+    // The screen rectangle of the sphere is the projection of the view space box around the sphere, which is conservative.
+    bool OverlapsTileDepthRanges(const VXGI::float4x4 &projMatrix, const AreaLightTileDepthRanges &tileDepthRanges, const float center[3], float radius)
+    {
+        float const near_depth = GetViewDepth(projMatrix, 0.0F);
+        float const min_depth = center[2] - radius;
+        float const max_depth = center[2] + radius;
+
+        int min_tile_x = 0;
+        int min_tile_y = 0;
+        int max_tile_x = static_cast<int>(tileDepthRanges.tile_count_x) - 1;
+        int max_tile_y = static_cast<int>(tileDepthRanges.tile_count_y) - 1;
+
+        // the sphere which crosses the near plane covers the whole screen
+        if (min_depth > near_depth)
+        {
+            float min_ndc[2] = {FLT_MAX, FLT_MAX};
+            float max_ndc[2] = {-FLT_MAX, -FLT_MAX};
+            for (int corner_index = 0; corner_index < 8; ++corner_index)
+            {
+                float const corner[3] = {
+                    center[0] + ((corner_index & 1) ? radius : -radius),
+                    center[1] + ((corner_index & 2) ? radius : -radius),
+                    center[2] + ((corner_index & 4) ? radius : -radius)};
+
+                float clip[4];
+                TransformPoint(projMatrix, corner, clip);
+
+                for (int axis = 0; axis < 2; ++axis)
+                {
+                    min_ndc[axis] = std::min(min_ndc[axis], clip[axis] / clip[3]);
+                    max_ndc[axis] = std::max(max_ndc[axis], clip[axis] / clip[3]);
+                }
+            }
+
+            float const tile_scale_x = static_cast<float>(tileDepthRanges.width) / static_cast<float>(tileDepthRanges.tile_size);
+            float const tile_scale_y = static_cast<float>(tileDepthRanges.height) / static_cast<float>(tileDepthRanges.tile_size);
+
+            // the Y axis of the NDC is up, and the Y axis of the screen is down
+            min_tile_x = std::max(min_tile_x, static_cast<int>(std::floor((0.5F * min_ndc[0] + 0.5F) * tile_scale_x)));
+            max_tile_x = std::min(max_tile_x, static_cast<int>(std::floor((0.5F * max_ndc[0] + 0.5F) * tile_scale_x)));
+            min_tile_y = std::max(min_tile_y, static_cast<int>(std::floor((0.5F - 0.5F * max_ndc[1]) * tile_scale_y)));
+            max_tile_y = std::min(max_tile_y, static_cast<int>(std::floor((0.5F - 0.5F * min_ndc[1]) * tile_scale_y)));
+        }
+
+        for (int tile_y = min_tile_y; tile_y <= max_tile_y; ++tile_y)
+        {
+            for (int tile_x = min_tile_x; tile_x <= max_tile_x; ++tile_x)
+            {
+                size_t const tile_index = static_cast<size_t>(tile_y) * tileDepthRanges.tile_count_x + tile_x;
+                float const tile_min_depth = tileDepthRanges.depth_ranges[2U * tile_index + 0U];
+                float const tile_max_depth = tileDepthRanges.depth_ranges[2U * tile_index + 1U];
+
+                if ((tile_min_depth <= tile_max_depth) && (GetViewDepth(projMatrix, tile_min_depth) <= max_depth) && (GetViewDepth(projMatrix, tile_max_depth) >= min_depth))
+                {
+                    return true;
+                }
+            }
+        }
+
+        return false;
+    }
+}
+
+AreaLightManager::AreaLightManager()
+    : m_BatchOffsets(1U, 0U), m_Statistics()
+{
+}
+
+uint32_t AreaLightManager::AddLight(const VXGI::AreaLight &light)
+{
+    uint32_t const light_index = static_cast<uint32_t>(m_Lights.size());
+
+    m_Lights.push_back(light);
+    if (nullptr == m_Lights.back().identifier)
+    {
+        m_Lights.back().identifier = reinterpret_cast<void *>(static_cast<uintptr_t>(light_index) + 1U);
+    }
+
+    return light_index;
+}
+
+void AreaLightManager::ClearLights()
+{
+    m_Lights.clear();
+}
+
+void AreaLightManager::Cull(const AreaLightCullingParameters &parameters, const VXGI::float4x4 &viewMatrix, const VXGI::float4x4 &projMatrix, const AreaLightTileDepthRanges *tileDepthRanges)
+{
+    m_VisibleLights.clear();
+    m_BatchOffsets.clear();
+    m_BatchGroups.clear();
+    m_Statistics = AreaLightCullingStatistics();
+    m_Statistics.light_count = static_cast<uint32_t>(m_Lights.size());
+
+    Plane frustum_planes[6];
+    GetFrustumPlanes(projMatrix, frustum_planes);
+
+    bool const enable_tile_culling = parameters.enable_tile_culling && (NULL != tileDepthRanges) && (tileDepthRanges->tile_count_x > 0U) && (tileDepthRanges->tile_count_y > 0U) &&
+                                     (tileDepthRanges->depth_ranges.size() == (2U * static_cast<size_t>(tileDepthRanges->tile_count_x) * tileDepthRanges->tile_count_y));
+
+    uint32_t const max_lights_per_batch = std::max(1U, parameters.max_lights_per_batch);
+
+    for (uint32_t light_index = 0U; light_index < static_cast<uint32_t>(m_Lights.size()); ++light_index)
+    {
+        VXGI::AreaLight light = m_Lights[light_index];
+
+        // the texture of the light is at most 1, thus the radiance is bounded by the color and the intensities
+        float const radiance = std::max(std::max(light.color.x, light.color.y), light.color.z) * std::max(light.diffuseIntensity, light.specularIntensity);
+        float const major_length = Length3(light.majorAxis);
+        float const minor_length = Length3(light.minorAxis);
+        float const area = 4.0F * major_length * minor_length;
+
+        // the irradiance of the light is at most "pi x radiance" anywhere
+        if ((radiance <= 0.0F) || (area <= 0.0F) || ((3.14159265F * radiance) < parameters.contribution_threshold))
+        {
+            ++m_Statistics.threshold_culled_count;
+            continue;
+        }
+
+        float range = (light.attenuationRadius > 0.0F) ? light.attenuationRadius : FLT_MAX;
+        if (parameters.contribution_threshold > 0.0F)
+        {
+            // at the distance "d" from the light, the irradiance is at most "radiance x area / d^2"
+            float const threshold_range = std::sqrt(radiance * area / parameters.contribution_threshold);
+            if (threshold_range < range)
+            {
+                range = threshold_range;
+                light.attenuationRadius = threshold_range;
+            }
+        }
+
+        if (range < FLT_MAX)
+        {
+            float const world_center[3] = {light.center.x, light.center.y, light.center.z};
+            float const radius = std::sqrt(major_length * major_length + minor_length * minor_length) + range;
+
+            float view_center[4];
+            TransformPoint(viewMatrix, world_center, view_center);
+
+            if (parameters.enable_frustum_culling)
+            {
+                bool outside = false;
+                for (int plane_index = 0; (plane_index < 6) && (!outside); ++plane_index)
+                {
+                    outside = ((Dot3(frustum_planes[plane_index].normal, view_center) + frustum_planes[plane_index].distance) < -radius);
+                }
+
+                if (outside)
+                {
+                    ++m_Statistics.frustum_culled_count;
+                    continue;
+                }
+            }
+
+            if (enable_tile_culling && (!OverlapsTileDepthRanges(projMatrix, *tileDepthRanges, view_center, radius)))
+            {
+                ++m_Statistics.tile_culled_count;
+                continue;
+            }
+        }
+
+        // the visible lights are in the order of the lights, thus the visible lights of the same group are adjacent
+        uint32_t const group_index = light_index / max_lights_per_batch;
+        if (m_BatchGroups.empty() || (m_BatchGroups.back() != group_index))
+        {
+            m_BatchOffsets.push_back(static_cast<uint32_t>(m_VisibleLights.size()));
+            m_BatchGroups.push_back(group_index);
+        }
+
+        m_VisibleLights.push_back(light);
+    }
+
+    uint32_t const visible_light_count = static_cast<uint32_t>(m_VisibleLights.size());
+    uint32_t const batch_count = static_cast<uint32_t>(m_BatchGroups.size());
+    m_BatchOffsets.push_back(visible_light_count);
+
+    m_Statistics.visible_light_count = visible_light_count;
+    m_Statistics.batch_count = batch_count;
+}
+
+const VXGI::AreaLight *AreaLightManager::GetBatch(uint32_t batchIndex, uint32_t &lightCount) const
+{
+    assert(batchIndex < GetBatchCount());
+
+    lightCount = m_BatchOffsets[batchIndex + 1U] - m_BatchOffsets[batchIndex];
+    return &m_VisibleLights[m_BatchOffsets[batchIndex]];
+}
+
+uint32_t AreaLightManager::GetBatchGroup(uint32_t batchIndex) const
+{
+    assert(batchIndex < GetBatchCount());
+
+    return m_BatchGroups[batchIndex];
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "GFSDK_VXGI.h"
+#include <vector>
+
+// The area lights of the scene are culled on the CPU before they are passed to "computeAreaLightChannels", so that the cost of the area light tracing scales with the lights which influence the visible surfaces rather than with the count of the lights.
+// 1. The influence of each light is bounded by a sphere: the attenuation radius of the light, shortened to the distance at which the irradiance of the light falls below the contribution threshold.
+//    The light is submitted with this attenuation radius, thus the tracer stops at the same distance as the culling.
+// 2. The spheres are culled against the planes of the view frustum.
+// 3. The spheres are culled against the screen tiles, each of which is bounded by the depth range of the G-buffer within the tile (see "SceneRenderer::ComputeTileDepthRanges").
+// 4. The lights are grouped by their index into groups of "max_lights_per_batch" lights, and the visible lights of each group form one batch.
+//    Thus a batch only changes when its own lights are culled, and each group can be traced by its own tracer, whose history is reprojected by the temporal filters.
+
+struct AreaLightCullingParameters
+{
+    // the irradiance below which the light does not contribute, 0 means the influence is only bounded by the attenuation radius of the light
+    float contribution_threshold;
+
+    // the limit of the lights passed to one "computeAreaLightChannels", and the size of the groups of the lights
+    uint32_t max_lights_per_batch;
+
+    bool enable_frustum_culling;
+
+    // ignored when the tile depth ranges are not provided
+    bool enable_tile_culling;
+
+    AreaLightCullingParameters()
+        : contribution_threshold(0.01F), max_lights_per_batch(16U), enable_frustum_culling(true), enable_tile_culling(true)
+    {
+    }
+};
+
+struct AreaLightTileDepthRanges
+{
+    // the extent of the G-buffer in pixels
+    uint32_t width;
+    uint32_t height;
+
+    uint32_t tile_size;
+    uint32_t tile_count_x;
+    uint32_t tile_count_y;
+
+    // the min and the max of the device depth of each tile, row by row
+    // the pixels without geometry are excluded, thus the min is greater than the max for the tiles without geometry
+    std::vector<float> depth_ranges;
+
+    AreaLightTileDepthRanges()
+        : width(0U), height(0U), tile_size(0U), tile_count_x(0U), tile_count_y(0U)
+    {
+    }
+};
+
+struct AreaLightCullingStatistics
+{
+    uint32_t light_count;
+    uint32_t threshold_culled_count;
+    uint32_t frustum_culled_count;
+    uint32_t tile_culled_count;
+    uint32_t visible_light_count;
+    uint32_t batch_count;
+};
+
+class AreaLightManager
+{
+private:
+    std::vector<VXGI::AreaLight> m_Lights;
+
+    // the visible lights, with the attenuation radius of the culling, in the order of "m_Lights"
+    std::vector<VXGI::AreaLight> m_VisibleLights;
+
+    // the first visible light of each batch, and the count of the visible lights at the end
+    std::vector<uint32_t> m_BatchOffsets;
+
+    // the group of the lights of each batch
+    std::vector<uint32_t> m_BatchGroups;
+
+    AreaLightCullingStatistics m_Statistics;
+
+public:
+    AreaLightManager();
+
+    // the identifier of the light is the index of the light (plus one) when it is NULL, thus the index should be stable over the frames for the temporal filters
+    uint32_t AddLight(const VXGI::AreaLight &light);
+    void ClearLights();
+    uint32_t GetLightCount() const { return static_cast<uint32_t>(m_Lights.size()); }
+
+    // the matrices are the row vector matrices of the camera, the projection is perspective with the depth of [0, 1]
+    void Cull(const AreaLightCullingParameters &parameters, const VXGI::float4x4 &viewMatrix, const VXGI::float4x4 &projMatrix, const AreaLightTileDepthRanges *tileDepthRanges);
+
+    const std::vector<VXGI::AreaLight> &GetVisibleLights() const { return m_VisibleLights; }
+    uint32_t GetBatchCount() const { return static_cast<uint32_t>(m_BatchOffsets.size()) - 1U; }
+    const VXGI::AreaLight *GetBatch(uint32_t batchIndex, uint32_t &lightCount) const;
+
+    // the index of the first light of the group divided by "max_lights_per_batch", the groups without visible lights have no batch
+    uint32_t GetBatchGroup(uint32_t batchIndex) const;
+
+    const AreaLightCullingStatistics &GetStatistics() const { return m_Statistics; }
+};
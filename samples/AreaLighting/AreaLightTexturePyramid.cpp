@@ -0,0 +1,358 @@
+#if defined(_MSC_VER)
+#define _CRT_SECURE_NO_WARNINGS 1
+#endif
+
+#include "AreaLightTexturePyramid.h"
+#include "../ContentHash.h"
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE__)
+#include <xmmintrin.h>
+#define AREA_LIGHT_TEXTURE_PYRAMID_SSE 1
+#else
+#define AREA_LIGHT_TEXTURE_PYRAMID_SSE 0
+#endif
+
+static uint32_t const AREA_LIGHT_TEXTURE_PYRAMID_MAGIC = 0x504C4142U; // "BALP"
+static uint32_t const AREA_LIGHT_TEXTURE_PYRAMID_VERSION = 1U;
+
+struct AreaLightTexturePyramidFileHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t source_hash;
+    uint32_t width;
+    uint32_t height;
+    float sigma;
+    uint32_t max_level_count;
+    uint32_t level_count;
+    uint32_t _padding;
+};
+
+static_assert(40U == sizeof(AreaLightTexturePyramidFileHeader), "the header is written as is");
+
+namespace
+{
+    // the RGBA channels of one texel
+    struct Float4
+    {
+#if AREA_LIGHT_TEXTURE_PYRAMID_SSE
+        __m128 v;
+
+        Float4() : v(_mm_setzero_ps()) {}
+        explicit Float4(float f) : v(_mm_set1_ps(f)) {}
+        explicit Float4(__m128 m) : v(m) {}
+        void Load(float const f[4]) { v = _mm_loadu_ps(f); }
+        void Store(float f[4]) const { _mm_storeu_ps(f, v); }
+
+        Float4 operator+(Float4 const &b) const { return Float4(_mm_add_ps(v, b.v)); }
+        Float4 operator*(Float4 const &b) const { return Float4(_mm_mul_ps(v, b.v)); }
+        static Float4 Min(Float4 const &a, Float4 const &b) { return Float4(_mm_min_ps(a.v, b.v)); }
+        static Float4 Max(Float4 const &a, Float4 const &b) { return Float4(_mm_max_ps(a.v, b.v)); }
+#else
+        float v[4];
+
+        Float4() { v[0] = v[1] = v[2] = v[3] = 0.0F; }
+        explicit Float4(float f) { v[0] = v[1] = v[2] = v[3] = f; }
+        void Load(float const f[4]) { std::copy(f, f + 4, v); }
+        void Store(float f[4]) const { std::copy(v, v + 4, f); }
+
+        Float4 operator+(Float4 const &b) const { Float4 r; for (int i = 0; i < 4; ++i) r.v[i] = v[i] + b.v[i]; return r; }
+        Float4 operator*(Float4 const &b) const { Float4 r; for (int i = 0; i < 4; ++i) r.v[i] = v[i] * b.v[i]; return r; }
+        static Float4 Min(Float4 const &a, Float4 const &b) { Float4 r; for (int i = 0; i < 4; ++i) r.v[i] = std::min(a.v[i], b.v[i]); return r; }
+        static Float4 Max(Float4 const &a, Float4 const &b) { Float4 r; for (int i = 0; i < 4; ++i) r.v[i] = std::max(a.v[i], b.v[i]); return r; }
+#endif
+    };
+
+    inline Float4 LoadTexel(std::vector<float> const &image, size_t texel_index)
+    {
+        Float4 texel;
+        texel.Load(&image[4U * texel_index]);
+        return texel;
+    }
+
+    // the rows are distributed over the threads, the function is called as "row_function(thread_index, row_index)"
+    template <typename RowFunction>
+    void ForEachRow(uint32_t row_count, uint32_t thread_count, RowFunction const &row_function)
+    {
+        std::atomic<uint32_t> next_row(0U);
+
+        auto worker = [&](uint32_t thread_index) {
+            uint32_t y;
+            while ((y = next_row.fetch_add(1U)) < row_count)
+            {
+                row_function(thread_index, y);
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (uint32_t thread_index = 1U; thread_index < thread_count; ++thread_index)
+        {
+            threads.emplace_back(worker, thread_index);
+        }
+        worker(0U);
+        for (std::thread &thread : threads)
+        {
+            thread.join();
+        }
+    }
+
+    // the normalized weights of the taps [-radius, radius]
+    std::vector<float> GetGaussianWeights(float sigma)
+    {
+        int const radius = (sigma > 0.0F) ? std::max(1, static_cast<int>(std::ceil(3.0F * sigma))) : 0;
+
+        std::vector<float> weights(2U * radius + 1U, 1.0F);
+        float sum = 0.0F;
+        for (int tap_index = -radius; tap_index <= radius; ++tap_index)
+        {
+            float const weight = (radius > 0) ? std::exp(-0.5F * static_cast<float>(tap_index * tap_index) / (sigma * sigma)) : 1.0F;
+            weights[tap_index + radius] = weight;
+            sum += weight;
+        }
+        for (float &weight : weights)
+        {
+            weight /= sum;
+        }
+        return weights;
+    }
+
+    void UnpackTexels(uint32_t const *texels, size_t texel_count, std::vector<float> &image)
+    {
+        image.resize(4U * texel_count);
+        for (size_t texel_index = 0U; texel_index < texel_count; ++texel_index)
+        {
+            for (uint32_t channel_index = 0U; channel_index < 4U; ++channel_index)
+            {
+                image[4U * texel_index + channel_index] = static_cast<float>((texels[texel_index] >> (8U * channel_index)) & 0xFFU) / 255.0F;
+            }
+        }
+    }
+
+    inline uint32_t PackTexel(Float4 const &texel)
+    {
+        float channels[4];
+        Float4::Min(Float4::Max(texel, Float4(0.0F)), Float4(1.0F)).Store(channels);
+
+        uint32_t packed_texel = 0U;
+        for (uint32_t channel_index = 0U; channel_index < 4U; ++channel_index)
+        {
+            packed_texel |= static_cast<uint32_t>(channels[channel_index] * 255.0F + 0.5F) << (8U * channel_index);
+        }
+        return packed_texel;
+    }
+}
+
+AreaLightTexturePyramidKey GetAreaLightTexturePyramidKey(uint32_t const *texels, uint32_t width, uint32_t height, AreaLightTexturePyramidParameters const &parameters)
+{
+    AreaLightTexturePyramidKey key = {};
+    key.source_hash = HashContentData(texels, sizeof(uint32_t) * width * height);
+    key.width = width;
+    key.height = height;
+    key.sigma = parameters.sigma;
+    key.max_level_count = parameters.max_level_count;
+    return key;
+}
+
+void BuildAreaLightTexturePyramid(uint32_t const *texels, uint32_t width, uint32_t height, AreaLightTexturePyramidParameters const &parameters, AreaLightTexturePyramid &pyramid)
+{
+    assert((width > 0U) && (height > 0U));
+
+    uint32_t thread_count = parameters.thread_count;
+    if (0U == thread_count)
+    {
+        thread_count = std::max(1U, static_cast<uint32_t>(std::thread::hardware_concurrency()));
+    }
+
+    uint32_t level_count = 1U;
+    while ((std::max(width, height) >> level_count) > 0U)
+    {
+        ++level_count;
+    }
+    if (0U != parameters.max_level_count)
+    {
+        level_count = std::min(level_count, parameters.max_level_count);
+    }
+
+    pyramid.key = GetAreaLightTexturePyramidKey(texels, width, height, parameters);
+    pyramid.levels.resize(level_count);
+
+    pyramid.levels[0].width = width;
+    pyramid.levels[0].height = height;
+    pyramid.levels[0].texels.assign(texels, texels + static_cast<size_t>(width) * height);
+
+    std::vector<float> const weights = GetGaussianWeights(parameters.sigma);
+    int const radius = static_cast<int>(weights.size() / 2U);
+
+    // the levels are filtered from the unquantized finer level, thus the rounding does not accumulate over the chain
+    std::vector<float> finer_image;
+    UnpackTexels(texels, static_cast<size_t>(width) * height, finer_image);
+
+    std::vector<float> horizontal_image;
+    std::vector<float> coarser_image;
+
+    // two rows of the vertical pass per thread
+    std::vector<std::vector<float>> row_scratch(thread_count);
+
+    for (uint32_t level_index = 1U; level_index < level_count; ++level_index)
+    {
+        uint32_t const finer_width = pyramid.levels[level_index - 1U].width;
+        uint32_t const finer_height = pyramid.levels[level_index - 1U].height;
+        uint32_t const coarser_width = std::max(1U, finer_width >> 1);
+        uint32_t const coarser_height = std::max(1U, finer_height >> 1);
+
+        // the horizontal gaussian, the taps are clamped to the edge
+        horizontal_image.resize(4U * static_cast<size_t>(finer_width) * finer_height);
+        ForEachRow(finer_height, thread_count, [&](uint32_t, uint32_t y) {
+            size_t const row_offset = static_cast<size_t>(y) * finer_width;
+            for (int x = 0; x < static_cast<int>(finer_width); ++x)
+            {
+                Float4 sum(0.0F);
+                for (int tap_index = -radius; tap_index <= radius; ++tap_index)
+                {
+                    int const tap_x = std::min(std::max(x + tap_index, 0), static_cast<int>(finer_width) - 1);
+                    sum = sum + Float4(weights[tap_index + radius]) * LoadTexel(finer_image, row_offset + tap_x);
+                }
+                sum.Store(&horizontal_image[4U * (row_offset + x)]);
+            }
+        });
+
+        // the vertical gaussian of the two finer rows, and the 2 x 2 box of the decimation
+        coarser_image.resize(4U * static_cast<size_t>(coarser_width) * coarser_height);
+        std::vector<uint32_t> &coarser_texels = pyramid.levels[level_index].texels;
+        coarser_texels.resize(static_cast<size_t>(coarser_width) * coarser_height);
+
+        ForEachRow(coarser_height, thread_count, [&](uint32_t thread_index, uint32_t y) {
+            std::vector<float> &scratch = row_scratch[thread_index];
+            scratch.resize(2U * 4U * finer_width);
+
+            for (uint32_t row_index = 0U; row_index < 2U; ++row_index)
+            {
+                int const finer_y = static_cast<int>(std::min(2U * y + row_index, finer_height - 1U));
+                for (uint32_t x = 0U; x < finer_width; ++x)
+                {
+                    Float4 sum(0.0F);
+                    for (int tap_index = -radius; tap_index <= radius; ++tap_index)
+                    {
+                        int const tap_y = std::min(std::max(finer_y + tap_index, 0), static_cast<int>(finer_height) - 1);
+                        sum = sum + Float4(weights[tap_index + radius]) * LoadTexel(horizontal_image, static_cast<size_t>(tap_y) * finer_width + x);
+                    }
+                    sum.Store(&scratch[4U * (row_index * finer_width + x)]);
+                }
+            }
+
+            for (uint32_t x = 0U; x < coarser_width; ++x)
+            {
+                uint32_t const x0 = std::min(2U * x, finer_width - 1U);
+                uint32_t const x1 = std::min(2U * x + 1U, finer_width - 1U);
+
+                Float4 const texel = Float4(0.25F) * (LoadTexel(scratch, x0) + LoadTexel(scratch, x1) + LoadTexel(scratch, finer_width + x0) + LoadTexel(scratch, finer_width + x1));
+
+                size_t const texel_index = static_cast<size_t>(y) * coarser_width + x;
+                texel.Store(&coarser_image[4U * texel_index]);
+                coarser_texels[texel_index] = PackTexel(texel);
+            }
+        });
+
+        pyramid.levels[level_index].width = coarser_width;
+        pyramid.levels[level_index].height = coarser_height;
+
+        finer_image.swap(coarser_image);
+    }
+}
+
+std::string GetAreaLightTexturePyramidFileName(AreaLightTexturePyramidKey const &key)
+{
+    // the fields are hashed one by one, since the padding of the struct is undefined
+    uint64_t hash = HashContentData(&key.source_hash, sizeof(key.source_hash));
+    hash = HashContentData(&key.width, sizeof(key.width), hash);
+    hash = HashContentData(&key.height, sizeof(key.height), hash);
+    hash = HashContentData(&key.sigma, sizeof(key.sigma), hash);
+    hash = HashContentData(&key.max_level_count, sizeof(key.max_level_count), hash);
+
+    char file_name[32];
+    snprintf(file_name, sizeof(file_name), "%016llx.alp", static_cast<unsigned long long>(hash));
+    return file_name;
+}
+
+bool SaveAreaLightTexturePyramid(char const *path, AreaLightTexturePyramid const &pyramid)
+{
+    assert(!pyramid.levels.empty());
+
+    FILE *file = fopen(path, "wb");
+    if (NULL == file)
+    {
+        return false;
+    }
+
+    AreaLightTexturePyramidFileHeader header = {};
+    header.magic = AREA_LIGHT_TEXTURE_PYRAMID_MAGIC;
+    header.version = AREA_LIGHT_TEXTURE_PYRAMID_VERSION;
+    header.source_hash = pyramid.key.source_hash;
+    header.width = pyramid.key.width;
+    header.height = pyramid.key.height;
+    header.sigma = pyramid.key.sigma;
+    header.max_level_count = pyramid.key.max_level_count;
+    header.level_count = static_cast<uint32_t>(pyramid.levels.size());
+
+    // the extent of each level is derived from the extent of the level 0, thus only the texels are written
+    bool result = (1U == fwrite(&header, sizeof(header), 1U, file));
+    for (AreaLightTexturePyramidLevel const &level : pyramid.levels)
+    {
+        assert(level.texels.size() == (static_cast<size_t>(level.width) * level.height));
+        result = result && (level.texels.size() == fwrite(level.texels.data(), sizeof(uint32_t), level.texels.size(), file));
+    }
+
+    fclose(file);
+
+    if (!result)
+    {
+        remove(path);
+    }
+
+    return result;
+}
+
+bool LoadAreaLightTexturePyramid(char const *path, AreaLightTexturePyramidKey const &key, AreaLightTexturePyramid &pyramid)
+{
+    FILE *file = fopen(path, "rb");
+    if (NULL == file)
+    {
+        return false;
+    }
+
+    AreaLightTexturePyramidFileHeader header;
+    bool result = (1U == fread(&header, sizeof(header), 1U, file)) && (AREA_LIGHT_TEXTURE_PYRAMID_MAGIC == header.magic) && (AREA_LIGHT_TEXTURE_PYRAMID_VERSION == header.version) &&
+                  (header.source_hash == key.source_hash) && (header.width == key.width) && (header.height == key.height) && (header.sigma == key.sigma) && (header.max_level_count == key.max_level_count) &&
+                  (header.level_count > 0U) && (header.level_count <= 32U);
+
+    if (result)
+    {
+        pyramid.key = key;
+        pyramid.levels.resize(header.level_count);
+
+        uint32_t level_width = header.width;
+        uint32_t level_height = header.height;
+        for (uint32_t level_index = 0U; result && (level_index < header.level_count); ++level_index)
+        {
+            AreaLightTexturePyramidLevel &level = pyramid.levels[level_index];
+            level.width = level_width;
+            level.height = level_height;
+            level.texels.resize(static_cast<size_t>(level_width) * level_height);
+            result = (level.texels.size() == fread(level.texels.data(), sizeof(uint32_t), level.texels.size(), file));
+
+            level_width = std::max(1U, level_width >> 1);
+            level_height = std::max(1U, level_height >> 1);
+        }
+    }
+
+    fclose(file);
+
+    return result;
+}
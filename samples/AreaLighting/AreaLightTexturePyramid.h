@@ -0,0 +1,70 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+// The texture of the area light is sampled over the footprint of a cone (by VXGI) or of the roughness lobe, which covers many texels of the source image.
+// The pyramid prefilters the image on load: each level is blurred by a gaussian and decimated by 2 x 2, thus the footprint of the gaussian grows with the level
+// and the shading fetches one trilinear sample of the matching level rather than averaging many texels.
+// The pyramid is built once and cached on disk, keyed by the hash of the source texels and the filter parameters.
+
+struct AreaLightTexturePyramidParameters
+{
+    // the standard deviation of the gaussian applied before each decimation, in the texels of the finer level
+    float sigma;
+
+    // 0 means the full chain down to 1 x 1
+    uint32_t max_level_count;
+
+    // 0 means one thread per hardware thread
+    uint32_t thread_count;
+
+    AreaLightTexturePyramidParameters()
+        : sigma(1.0F), max_level_count(0U), thread_count(0U)
+    {
+    }
+};
+
+struct AreaLightTexturePyramidKey
+{
+    // see "HashContentData", over the RGBA8 texels of the source image
+    uint64_t source_hash;
+
+    uint32_t width;
+    uint32_t height;
+
+    // see "AreaLightTexturePyramidParameters", the thread count does not change the result
+    float sigma;
+    uint32_t max_level_count;
+};
+
+struct AreaLightTexturePyramidLevel
+{
+    uint32_t width;
+    uint32_t height;
+
+    // RGBA8, row by row without padding
+    std::vector<uint32_t> texels;
+};
+
+struct AreaLightTexturePyramid
+{
+    AreaLightTexturePyramidKey key;
+
+    // the level 0 is the source image
+    std::vector<AreaLightTexturePyramidLevel> levels;
+};
+
+AreaLightTexturePyramidKey GetAreaLightTexturePyramidKey(uint32_t const *texels, uint32_t width, uint32_t height, AreaLightTexturePyramidParameters const &parameters);
+
+void BuildAreaLightTexturePyramid(uint32_t const *texels, uint32_t width, uint32_t height, AreaLightTexturePyramidParameters const &parameters, AreaLightTexturePyramid &pyramid);
+
+// "<hash of the key>.alp"
+std::string GetAreaLightTexturePyramidFileName(AreaLightTexturePyramidKey const &key);
+
+bool SaveAreaLightTexturePyramid(char const *path, AreaLightTexturePyramid const &pyramid);
+
+// false is returned when the file does not exist, is corrupted, or was built with a different key
+bool LoadAreaLightTexturePyramid(char const *path, AreaLightTexturePyramidKey const &key, AreaLightTexturePyramid &pyramid);
@@ -52,7 +52,21 @@ SceneRenderer *g_pSceneRenderer = NULL;
 VXGI::IGlobalIllumination *g_pGI = NULL;
 VXGI::IShaderCompiler *g_pGICompiler = NULL;
 VXGI::IUserDefinedShaderSet *g_GIGBufferLoader = NULL;
-VXGI::IViewTracer *g_pGITracer = NULL;
+
+// One tracer per group of the area lights (see "AreaLightManager::GetBatchGroup"), since each tracer keeps the history of its own channels for the temporal reprojection.
+// The tracer of the group 0 is created with the device, and the others when their group is visible for the first time.
+struct AreaLightGroupTracer
+{
+    VXGI::IViewTracer *pTracer;
+
+    // the frame of the history of the tracer, which is only reprojected when it is from the previous frame, 0 when the tracer has no history
+    uint32_t frameIndex;
+};
+static std::vector<AreaLightGroupTracer> g_AreaLightGroupTracers;
+static uint32_t g_nFrameIndex = 1;
+
+// the groups change with the count of the lights per batch, which invalidates the histories
+static uint32_t g_nGroupLightsPerBatch = 0;
 
 NVRHI::ConstantBufferRef g_pBuiltinGBufferParameters;
 
@@ -80,6 +94,15 @@ static bool g_bMoveLight = false;
 static bool g_bTemporalFiltering = true;
 static bool g_bUpdateVoxelization = false;
 
+static uint32_t g_nExtraLights = 64;
+static float g_fLightContributionThreshold = 0.01f;
+static uint32_t g_nLightsPerBatch = 16;
+static bool g_bFrustumCulling = true;
+static bool g_bTileCulling = true;
+
+static AreaLightManager g_AreaLightManager;
+static AreaLightTileDepthRanges g_TileDepthRanges;
+
 VXGI::IBasicViewTracer::InputBuffers g_InputBuffersPrev;
 bool g_InputBuffersPrevValid = false;
 
@@ -154,11 +177,13 @@ HRESULT CreateVXGIObject()
 
     g_pBuiltinGBufferParameters = g_pRendererInterface->createConstantBuffer(NVRHI::ConstantBufferDesc(sizeof(BuiltinGBufferParameters), nullptr), nullptr);
 
-    if (VXGI_FAILED(g_pGI->createCustomTracer(&g_pGITracer, g_GIGBufferLoader)))
+    AreaLightGroupTracer groupTracer = {};
+    if (VXGI_FAILED(g_pGI->createCustomTracer(&groupTracer.pTracer, g_GIGBufferLoader)))
     {
         MessageBoxA(g_DeviceManager->GetHWND(), "Failed to create a VXGI tracer.", "VXGI Sample", MB_ICONERROR);
         return E_FAIL;
     }
+    g_AreaLightGroupTracers.push_back(groupTracer);
 
     VXGI::VoxelizationParameters voxelizationParams;
     voxelizationParams.ambientOcclusionMode = true;
@@ -205,6 +230,10 @@ class AntTweakBarVisualController : public IVisualController
         TwAddTextLine(msg, color, 0);
         TwAddTextLine("Use the right mouse button to rotate the light.", color, 0);
 
+        const AreaLightCullingStatistics &statistics = g_AreaLightManager.GetStatistics();
+        sprintf_s(msg, "Area lights: %u of %u in %u batches (culled: %u threshold, %u frustum, %u tiles)", statistics.visible_light_count, statistics.light_count, statistics.batch_count, statistics.threshold_culled_count, statistics.frustum_culled_count, statistics.tile_culled_count);
+        TwAddTextLine(msg, color, 0);
+
         TwEndText();
     }
 
@@ -259,7 +288,7 @@ class AntTweakBarVisualController : public IVisualController
     void InitDialogs()
     {
         TwBar *bar = TwNewBar("barMain");
-        TwDefine("barMain label='Settings' position='10 35' size='250 300' valueswidth=100");
+        TwDefine("barMain label='Settings' position='10 35' size='250 400' valueswidth=100");
 
         TwAddVarRW(bar, "Diffuse Intensity", TW_TYPE_FLOAT, &g_DiffuseIntensity, "min=0 max=10 step=0.01");
         TwAddVarRW(bar, "Specular Intensity", TW_TYPE_FLOAT, &g_SpecularIntensity, "min=0 max=10 step=0.01");
@@ -274,6 +303,14 @@ class AntTweakBarVisualController : public IVisualController
 
         TwAddSeparator(bar, nullptr, nullptr);
 
+        TwAddVarRW(bar, "Extra Lights", TW_TYPE_UINT32, &g_nExtraLights, "min=0 max=256");
+        TwAddVarRW(bar, "Contribution Threshold", TW_TYPE_FLOAT, &g_fLightContributionThreshold, "min=0 max=1 step=0.001");
+        TwAddVarRW(bar, "Lights Per Batch", TW_TYPE_UINT32, &g_nLightsPerBatch, "min=1 max=64");
+        TwAddVarRW(bar, "Frustum Culling", TW_TYPE_BOOLCPP, &g_bFrustumCulling, "");
+        TwAddVarRW(bar, "Tile Culling", TW_TYPE_BOOLCPP, &g_bTileCulling, "");
+
+        TwAddSeparator(bar, nullptr, nullptr);
+
         TwAddVarRW(bar, "Shadows", TW_TYPE_BOOLCPP, &g_bEnableShadows, "key=o");
         TwAddVarRW(bar, "Textured Shadows", TW_TYPE_BOOLCPP, &g_bTexturedShadows, "");
         TwAddVarRW(bar, "Screen Space Shadows", TW_TYPE_BOOLCPP, &g_bEnableScreenSpaceShadows, "");
@@ -290,6 +327,37 @@ class AntTweakBarVisualController : public IVisualController
     }
 };
 
+static void ApplyAreaLightSettings(VXGI::AreaLight &light)
+{
+    light.enableOcclusion = g_bEnableShadows;
+    light.enableScreenSpaceOcclusion = g_bEnableScreenSpaceShadows;
+    light.texturedShadows = g_bTexturedShadows;
+    light.diffuseIntensity = g_DiffuseIntensity;
+    light.specularIntensity = g_SpecularIntensity;
+    light.quality = g_fShadowQuality;
+}
+
+// The extra lights are small untextured panels facing down, in rows over the atrium, 64 lights per floor.
+static VXGI::AreaLight GetExtraAreaLight(uint32_t index)
+{
+    static const float3 s_Colors[4] = {float3(1.f, 0.6f, 0.3f), float3(0.4f, 0.7f, 1.f), float3(0.5f, 1.f, 0.5f), float3(1.f, 0.4f, 0.8f)};
+
+    const uint32_t column = index % 16;
+    const uint32_t row = (index / 16) % 4;
+    const uint32_t level = index / 64;
+
+    VXGI::AreaLight light;
+    light.center = float3(-1200.f + 160.f * float(column), 120.f + 350.f * float(level), -450.f + 300.f * float(row));
+
+    // the same orientation as the main light looking down, the right vector is X and the up vector is Z
+    light.majorAxis = float3(-15.f, 0.f, 0.f);
+    light.minorAxis = float3(0.f, 0.f, 15.f);
+    light.color = s_Colors[index % 4];
+    ApplyAreaLightSettings(light);
+
+    return light;
+}
+
 class MainVisualController : public IVisualController
 {
     virtual LRESULT MsgProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lParam) override
@@ -468,40 +536,112 @@ class MainVisualController : public IVisualController
         }
         else
         {
-            VXGI::AreaLight light;
-            light.center = float3(g_AreaLightCamera.GetEyePt().m128_f32);
-            light.majorAxis = float3(g_AreaLightCamera.GetWorldRight().m128_f32) * (-g_LightWidth);
-            light.minorAxis = float3(g_AreaLightCamera.GetWorldUp().m128_f32) * g_LightHeight;
-            light.enableOcclusion = g_bEnableShadows;
-            light.enableScreenSpaceOcclusion = g_bEnableScreenSpaceShadows;
-            light.texturedShadows = g_bTexturedShadows;
-            light.diffuseIntensity = g_DiffuseIntensity;
-            light.specularIntensity = g_SpecularIntensity;
-            light.color = g_LightColor;
-            light.quality = g_fShadowQuality;
-            light.texture = g_LightTexture ? g_pSceneRenderer->GetAreaLightTexture() : nullptr;
-
-            g_pGITracer->beginFrame();
+            g_AreaLightManager.ClearLights();
+            {
+                VXGI::AreaLight light;
+                light.center = float3(g_AreaLightCamera.GetEyePt().m128_f32);
+                light.majorAxis = float3(g_AreaLightCamera.GetWorldRight().m128_f32) * (-g_LightWidth);
+                light.minorAxis = float3(g_AreaLightCamera.GetWorldUp().m128_f32) * g_LightHeight;
+                light.color = g_LightColor;
+                light.texture = g_LightTexture ? g_pSceneRenderer->GetAreaLightTexture() : nullptr;
+                ApplyAreaLightSettings(light);
+
+                g_AreaLightManager.AddLight(light);
+            }
+            for (uint32_t lightIndex = 0; lightIndex < g_nExtraLights; ++lightIndex)
+            {
+                g_AreaLightManager.AddLight(GetExtraAreaLight(lightIndex));
+            }
+
+            bool tileDepthRangesValid = false;
+            if (g_bTileCulling)
+            {
+                g_pRendererInterface->debugBeginEvent("Tile Depth Ranges");
+
+                tileDepthRangesValid = g_pSceneRenderer->ComputeTileDepthRanges(g_TileDepthRanges);
+
+                g_pRendererInterface->debugEndEvent();
+            }
+
+            AreaLightCullingParameters cullingParams;
+            cullingParams.contribution_threshold = g_fLightContributionThreshold;
+            cullingParams.max_lights_per_batch = g_nLightsPerBatch;
+            cullingParams.enable_frustum_culling = g_bFrustumCulling;
+            cullingParams.enable_tile_culling = g_bTileCulling;
+            g_AreaLightManager.Cull(cullingParams, (VXGI::float4x4 &)viewMatrix, (VXGI::float4x4 &)projMatrix, tileDepthRangesValid ? &g_TileDepthRanges : nullptr);
+
+            ++g_nFrameIndex;
+
+            if (g_nGroupLightsPerBatch != g_nLightsPerBatch)
+            {
+                for (AreaLightGroupTracer &groupTracer : g_AreaLightGroupTracers)
+                {
+                    groupTracer.frameIndex = 0;
+                }
+                g_nGroupLightsPerBatch = g_nLightsPerBatch;
+            }
 
             NVRHI::TextureHandle areaLightDiffuse = nullptr;
             NVRHI::TextureHandle areaLightSpecular = nullptr;
             {
                 g_pRendererInterface->debugBeginEvent("VXGI Area Light Cone Tracing");
 
+                const uint32_t batchCount = g_AreaLightManager.GetBatchCount();
+
                 VXGI::BasicAreaLightTracingParameters areaLightParams;
-                areaLightParams.enableTemporalReprojection = g_bTemporalFiltering;
                 areaLightParams.enableTemporalJitter = g_bTemporalFiltering;
                 areaLightParams.coplanarOffsetFactor = g_bOcclusionHack ? 0.f : 5.f;
 
-                g_pGITracer->computeAreaLightChannels(areaLightParams, gbufferBindings, gbufferSize, views, 1, &light, 1, areaLightDiffuse, areaLightSpecular);
+                // the tracer returns the same channels for each call, thus the channels of each batch are summed before the next batch is traced
+                for (uint32_t batchIndex = 0; batchIndex < batchCount; ++batchIndex)
+                {
+                    uint32_t batchLightCount = 0;
+                    const VXGI::AreaLight *batchLights = g_AreaLightManager.GetBatch(batchIndex, batchLightCount);
+
+                    const uint32_t groupIndex = g_AreaLightManager.GetBatchGroup(batchIndex);
+                    while (g_AreaLightGroupTracers.size() <= groupIndex)
+                    {
+                        AreaLightGroupTracer groupTracer = {};
+                        if (VXGI_FAILED(g_pGI->createCustomTracer(&groupTracer.pTracer, g_GIGBufferLoader)))
+                            break;
+
+                        g_AreaLightGroupTracers.push_back(groupTracer);
+                    }
+
+                    if (g_AreaLightGroupTracers.size() <= groupIndex)
+                        break;
+
+                    AreaLightGroupTracer &groupTracer = g_AreaLightGroupTracers[groupIndex];
+
+                    // the history of a group which was culled in the previous frame is older than the previous G-buffer
+                    areaLightParams.enableTemporalReprojection = g_bTemporalFiltering && (groupTracer.frameIndex + 1 == g_nFrameIndex);
+                    groupTracer.frameIndex = g_nFrameIndex;
+
+                    groupTracer.pTracer->beginFrame();
+                    groupTracer.pTracer->computeAreaLightChannels(areaLightParams, gbufferBindings, gbufferSize, views, 1, batchLights, batchLightCount, areaLightDiffuse, areaLightSpecular);
+
+                    if (batchCount > 1)
+                    {
+                        g_pSceneRenderer->AccumulateAreaLightChannels(areaLightDiffuse, areaLightSpecular, 0 == batchIndex, areaLightDiffuse, areaLightSpecular);
+                    }
+                }
 
                 g_pRendererInterface->debugEndEvent();
             }
 
-            // g_pSceneRenderer->Blit(areaLightSpecular, mainRenderTarget);
-            g_pSceneRenderer->CompositeLighting(areaLightDiffuse, areaLightSpecular, mainRenderTarget);
+            if (areaLightDiffuse && areaLightSpecular)
+            {
+                g_pSceneRenderer->CompositeLighting(areaLightDiffuse, areaLightSpecular, mainRenderTarget);
+            }
+            else
+            {
+                g_pRendererInterface->clearTextureFloat(mainRenderTarget, NVRHI::Color(0.f));
+            }
 
-            g_pSceneRenderer->RenderAreaLight(light, (VXGI::float4x4 &)viewProjMatrix, mainRenderTarget);
+            for (const VXGI::AreaLight &light : g_AreaLightManager.GetVisibleLights())
+            {
+                g_pSceneRenderer->RenderAreaLight(light, (VXGI::float4x4 &)viewProjMatrix, mainRenderTarget);
+            }
         }
 
         g_InputBuffersPrev = inputBuffers;
@@ -573,11 +713,11 @@ class MainVisualController : public IVisualController
 
         if (g_pGI)
         {
-            if (g_pGITracer)
+            for (AreaLightGroupTracer &groupTracer : g_AreaLightGroupTracers)
             {
-                g_pGI->destroyTracer(g_pGITracer);
-                g_pGITracer = NULL;
+                g_pGI->destroyTracer(groupTracer.pTracer);
             }
+            g_AreaLightGroupTracers.clear();
 
             if (g_GIGBufferLoader)
             {
@@ -13,6 +13,7 @@
 #include <string>
 #include "SceneRenderer.h"
 #include "BindingHelpers.h"
+#include "AreaLightTexturePyramid.h"
 
 #ifndef NDEBUG
 #include "shaders\D3D\Debug\DefaultVS.inl"
@@ -22,6 +23,7 @@
 #include "shaders\D3D\Debug\CompositingPS.inl"
 #include "shaders\D3D\Debug\AreaLightVS.inl"
 #include "shaders\D3D\Debug\AreaLightPS.inl"
+#include "shaders\D3D\Debug\TileDepthRangeCS.inl"
 #else
 #include "shaders\D3D\Release\DefaultVS.inl"
 #include "shaders\D3D\Release\AttributesPS.inl"
@@ -30,6 +32,7 @@
 #include "shaders\D3D\Release\CompositingPS.inl"
 #include "shaders\D3D\Release\AreaLightVS.inl"
 #include "shaders\D3D\Release\AreaLightPS.inl"
+#include "shaders\D3D\Release\TileDepthRangeCS.inl"
 #endif
 #include "shaders\VoxelizationPS.hlsli"
 
@@ -43,6 +46,9 @@ static const UINT SRV_SLOT_BASE_COLOR_TEXTURE = 4;
 static const UINT SRV_SLOT_ROUGHNESS_METALLIC_TEXTURE = 5;
 static const UINT SRV_SLOT_COUNT = 6;
 
+// see "TILE_SIZE" of "TileDepthRangeCS"
+static const UINT TILE_DEPTH_RANGE_TILE_SIZE = 16;
+
 using namespace DirectX;
 
 SceneRenderer::SceneRenderer(NVRHI::IRendererInterface *pRenderer)
@@ -85,12 +91,48 @@ HRESULT SceneRenderer::LoadMesh2(const char *strFileName)
     return result;
 }
 
+static char const *const g_AreaLightTexturePyramidDirectory = "AreaLightTexturePyramids";
+
+// The pyramid is loaded from the cache when the source image and the filter are unchanged, otherwise it is built on the CPU and written to the cache.
 HRESULT SceneRenderer::LoadAreaLightTexture(const char *fileName)
 {
-    NVRHI::TextureHandle texture = m_pScene->LoadTextureFromFileInternal(fileName, false);
+    std::vector<uint32_t> pixel_data;
+    uint32_t pixel_data_width;
+    uint32_t pixel_data_height;
+    if (!Scene::LoadImageFromFile(fileName, pixel_data, pixel_data_width, pixel_data_height))
+        return E_FAIL;
+
+    AreaLightTexturePyramidParameters parameters;
+    AreaLightTexturePyramidKey const key = GetAreaLightTexturePyramidKey(pixel_data.data(), pixel_data_width, pixel_data_height, parameters);
+
+    CreateDirectoryA(g_AreaLightTexturePyramidDirectory, NULL);
+    std::string const path = std::string(g_AreaLightTexturePyramidDirectory) + "\\" + GetAreaLightTexturePyramidFileName(key);
+
+    AreaLightTexturePyramid pyramid;
+    if (!LoadAreaLightTexturePyramid(path.c_str(), key, pyramid))
+    {
+        BuildAreaLightTexturePyramid(pixel_data.data(), pixel_data_width, pixel_data_height, parameters, pyramid);
+        SaveAreaLightTexturePyramid(path.c_str(), pyramid);
+    }
+
+    NVRHI::TextureDesc textureDesc;
+    textureDesc.width = pixel_data_width;
+    textureDesc.height = pixel_data_height;
+    textureDesc.mipLevels = static_cast<uint32_t>(pyramid.levels.size());
+    textureDesc.format = NVRHI::Format::RGBA8_UNORM;
+    textureDesc.debugName = "AreaLightTexture";
+
+    // the initial data of "createTexture" only covers the first mip level
+    NVRHI::TextureHandle texture = m_RendererInterface->createTexture(textureDesc, NULL);
     if (!texture)
         return E_FAIL;
 
+    for (uint32_t level_index = 0U; level_index < textureDesc.mipLevels; ++level_index)
+    {
+        AreaLightTexturePyramidLevel const &level = pyramid.levels[level_index];
+        m_RendererInterface->writeTexture(texture, level_index, level.texels.data(), sizeof(uint32_t) * level.width, 0);
+    }
+
     m_AreaLightTexture = texture;
 
     return S_OK;
@@ -105,6 +147,7 @@ HRESULT SceneRenderer::AllocateResources(VXGI::IGlobalIllumination *pGI, VXGI::I
     CREATE_SHADER(PIXEL, g_CompositingPS, &m_pCompositingPS);
     CREATE_SHADER(VERTEX, g_AreaLightVS, &m_AreaLightVS);
     CREATE_SHADER(PIXEL, g_AreaLightPS, &m_AreaLightPS);
+    CREATE_SHADER(COMPUTE, g_TileDepthRangeCS, &m_TileDepthRangeCS);
 
     m_RendererInterface->createConstantBuffer(NVRHI::ConstantBufferDesc(sizeof(GlobalConstants), nullptr), nullptr, &m_pGlobalCBuffer);
 
@@ -207,6 +250,21 @@ void SceneRenderer::AllocateViewDependentResources(UINT width, UINT height, UINT
     gbufferDesc.debugName = "GbufferDepth";
     m_RendererInterface->createTexture(gbufferDesc, NULL, &m_TargetDepth);
     m_RendererInterface->createTexture(gbufferDesc, NULL, &m_TargetDepthPrev);
+
+    gbufferDesc.format = NVRHI::Format::RGBA16_FLOAT;
+    gbufferDesc.clearValue = NVRHI::Color(0.f);
+    gbufferDesc.debugName = "AreaLightDiffuseSum";
+    m_RendererInterface->createTexture(gbufferDesc, NULL, &m_AreaLightDiffuseSum);
+    gbufferDesc.debugName = "AreaLightSpecularSum";
+    m_RendererInterface->createTexture(gbufferDesc, NULL, &m_AreaLightSpecularSum);
+
+    NVRHI::TextureDesc tileDesc;
+    tileDesc.width = (m_Width + TILE_DEPTH_RANGE_TILE_SIZE - 1) / TILE_DEPTH_RANGE_TILE_SIZE;
+    tileDesc.height = (m_Height + TILE_DEPTH_RANGE_TILE_SIZE - 1) / TILE_DEPTH_RANGE_TILE_SIZE;
+    tileDesc.isUAV = true;
+    tileDesc.format = NVRHI::Format::RG32_FLOAT;
+    tileDesc.debugName = "TileDepthRanges";
+    m_RendererInterface->createTexture(tileDesc, NULL, &m_TileDepthRanges);
 }
 
 void SceneRenderer::ReleaseResources(VXGI::IGlobalIllumination *pGI)
@@ -243,6 +301,9 @@ void SceneRenderer::ReleaseViewDependentResources()
     m_TargetNormalPrev = nullptr;
     m_TargetDepth = nullptr;
     m_TargetDepthPrev = nullptr;
+    m_AreaLightDiffuseSum = nullptr;
+    m_AreaLightSpecularSum = nullptr;
+    m_TileDepthRanges = nullptr;
 }
 
 void SceneRenderer::RenderToGBuffer(const VXGI::float4x4 &viewProjMatrix)
@@ -472,7 +533,7 @@ NVRHI::TextureHandle SceneRenderer::GetAlbedoBufferHandle()
     return m_TargetAlbedo;
 }
 
-void SceneRenderer::Blit(NVRHI::TextureHandle pSource, NVRHI::TextureHandle pDest)
+void SceneRenderer::Blit(NVRHI::TextureHandle pSource, NVRHI::TextureHandle pDest, bool additive)
 {
     NVRHI::DrawCallState state;
 
@@ -487,6 +548,13 @@ void SceneRenderer::Blit(NVRHI::TextureHandle pSource, NVRHI::TextureHandle pDes
     state.renderState.depthStencilState.depthEnable = false;
     state.renderState.rasterState.cullMode = NVRHI::RasterState::CULL_NONE;
 
+    if (additive)
+    {
+        state.renderState.blendState.blendEnable[0] = true;
+        state.renderState.blendState.srcBlend[0] = NVRHI::BlendState::BLEND_ONE;
+        state.renderState.blendState.destBlend[0] = NVRHI::BlendState::BLEND_ONE;
+    }
+
     NVRHI::BindTexture(state.PS, 0, pSource);
 
     NVRHI::DrawArguments args;
@@ -517,3 +585,40 @@ void SceneRenderer::CompositeLighting(NVRHI::TextureHandle diffuse, NVRHI::Textu
     args.vertexCount = 4;
     m_RendererInterface->draw(state, &args, 1);
 }
+
+void SceneRenderer::AccumulateAreaLightChannels(NVRHI::TextureHandle diffuse, NVRHI::TextureHandle specular, bool first, NVRHI::TextureHandle &outDiffuseSum, NVRHI::TextureHandle &outSpecularSum)
+{
+    Blit(diffuse, m_AreaLightDiffuseSum, !first);
+    Blit(specular, m_AreaLightSpecularSum, !first);
+
+    outDiffuseSum = m_AreaLightDiffuseSum;
+    outSpecularSum = m_AreaLightSpecularSum;
+}
+
+bool SceneRenderer::ComputeTileDepthRanges(AreaLightTileDepthRanges &tileDepthRanges)
+{
+    const NVRHI::TextureDesc &tileDesc = m_RendererInterface->describeTexture(m_TileDepthRanges);
+
+    NVRHI::DispatchState state;
+    state.shader = m_TileDepthRangeCS;
+    NVRHI::BindTexture(state, 0, m_TargetDepth);
+    NVRHI::BindTexture(state, 0, m_TileDepthRanges, true);
+
+    // [numthreads(16, 16, 1)]
+    m_RendererInterface->dispatch(state, tileDesc.width, tileDesc.height, 1);
+
+    tileDepthRanges.width = m_Width;
+    tileDepthRanges.height = m_Height;
+    tileDepthRanges.tile_size = TILE_DEPTH_RANGE_TILE_SIZE;
+    tileDepthRanges.tile_count_x = tileDesc.width;
+    tileDepthRanges.tile_count_y = tileDesc.height;
+    tileDepthRanges.depth_ranges.resize(2U * tileDesc.width * tileDesc.height);
+
+    if (!m_RendererInterface->readTexture(m_TileDepthRanges, tileDepthRanges.depth_ranges.data(), 2U * sizeof(float) * tileDesc.width))
+    {
+        tileDepthRanges.depth_ranges.clear();
+        return false;
+    }
+
+    return true;
+}
@@ -12,6 +12,7 @@
 
 #include "GFSDK_VXGI.h"
 #include "../Scene.h"
+#include "AreaLightManager.h"
 #include <functional>
 
 #pragma warning(disable : 4324)
@@ -60,6 +61,8 @@ private:
     NVRHI::ShaderRef m_AreaLightVS;
     NVRHI::ShaderRef m_AreaLightPS;
 
+    NVRHI::ShaderRef m_TileDepthRangeCS;
+
     NVRHI::ConstantBufferRef m_pGlobalCBuffer;
 
     NVRHI::SamplerRef m_pDefaultSamplerState;
@@ -78,6 +81,13 @@ private:
     NVRHI::TextureRef m_WhiteDummy;
     NVRHI::TextureRef m_AreaLightTexture;
 
+    // RGBA16_FLOAT, the sums of the area light channels over the batches
+    NVRHI::TextureRef m_AreaLightDiffuseSum;
+    NVRHI::TextureRef m_AreaLightSpecularSum;
+
+    // RG32_FLOAT, the min and the max of the depth of each screen tile (see "TileDepthRangeCS")
+    NVRHI::TextureRef m_TileDepthRanges;
+
     VXGI::IUserDefinedShaderSet *m_pVoxelizationGS;
     VXGI::IUserDefinedShaderSet *m_pVoxelizationPS;
 
@@ -101,9 +111,17 @@ public:
     void FillTracingInputBuffers(VXGI::IBasicViewTracer::InputBuffers &inputBuffers);
     NVRHI::TextureHandle GetAlbedoBufferHandle();
 
-    void Blit(NVRHI::TextureHandle pSource, NVRHI::TextureHandle pDest);
+    void Blit(NVRHI::TextureHandle pSource, NVRHI::TextureHandle pDest, bool additive = false);
     void CompositeLighting(NVRHI::TextureHandle diffuse, NVRHI::TextureHandle specular, NVRHI::TextureHandle pDest);
 
+    // Sums the channels of the batches of the area lights, since the compositing is not linear.
+    // The channels of the first batch replace the sums, and the sums are returned for the compositing.
+    void AccumulateAreaLightChannels(NVRHI::TextureHandle diffuse, NVRHI::TextureHandle specular, bool first, NVRHI::TextureHandle &outDiffuseSum, NVRHI::TextureHandle &outSpecularSum);
+
+    // Reduces the depth of the G-buffer of the current frame into the tiles and reads the tiles back by "readTexture", thus the culling never misses a surface which moved into a tile.
+    // The readback waits for the GPU to finish the voxelization and the G-buffer pass of the frame, and copies only one texel per tile.
+    bool ComputeTileDepthRanges(AreaLightTileDepthRanges &tileDepthRanges);
+
     void RenderSceneCommon(
         Scene *pScene,
         NVRHI::DrawCallState &state,
@@ -0,0 +1,46 @@
+// The min and the max of the G-buffer depth within each screen tile, which bound the tiles for the culling of "AreaLightManager".
+// The pixels without geometry (the cleared depth of 1) are excluded, thus the min is greater than the max for the tiles without geometry.
+
+#define TILE_SIZE 16
+
+Texture2D<float> g_Depth : register(t0);
+
+RWTexture2D<float2> u_TileDepthRanges : register(u0);
+
+groupshared uint s_MinDepth;
+groupshared uint s_MaxDepth;
+
+[numthreads(TILE_SIZE, TILE_SIZE, 1)]
+void TileDepthRangeCS(uint3 group_id : SV_GroupID, uint3 dispatch_thread_id : SV_DispatchThreadID, uint group_index : SV_GroupIndex)
+{
+    if (0 == group_index)
+    {
+        s_MinDepth = asuint(1.0);
+        s_MaxDepth = asuint(0.0);
+    }
+
+    GroupMemoryBarrierWithGroupSync();
+
+    uint width;
+    uint height;
+    g_Depth.GetDimensions(width, height);
+
+    [branch] if (all(dispatch_thread_id.xy < uint2(width, height)))
+    {
+        float depth = g_Depth[dispatch_thread_id.xy];
+
+        // the depth is not negative, thus the order of the bits is the order of the values
+        [branch] if (depth < 1.0)
+        {
+            InterlockedMin(s_MinDepth, asuint(depth));
+            InterlockedMax(s_MaxDepth, asuint(depth));
+        }
+    }
+
+    GroupMemoryBarrierWithGroupSync();
+
+    if (0 == group_index)
+    {
+        u_TileDepthRanges[group_id.xy] = float2(asfloat(s_MinDepth), asfloat(s_MaxDepth));
+    }
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// FNV-1a, the hash of the scene content and the key of the caches on disk (the clipmap snapshots and the area light texture pyramids)
+// the hash is chained by passing the result of the previous call
+inline uint64_t HashContentData(void const *data, size_t size, uint64_t hash = 14695981039346656037ULL)
+{
+    uint8_t const *const bytes = static_cast<uint8_t const *>(data);
+    for (size_t byte_index = 0U; byte_index < size; ++byte_index)
+    {
+        hash ^= bytes[byte_index];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
@@ -0,0 +1,144 @@
+#include "AnisotropicClipmap.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+void GetAnisotropicClipmapOpacityTexelDirections(uint32_t texel, uint32_t voxel_texel_count, uint32_t &direction_begin, uint32_t &direction_end)
+{
+    direction_begin = (ANISOTROPIC_CLIPMAP_DIRECTION_COUNT * texel + voxel_texel_count - 1U) / voxel_texel_count;
+    direction_end = (ANISOTROPIC_CLIPMAP_DIRECTION_COUNT * (texel + 1U) + voxel_texel_count - 1U) / voxel_texel_count;
+    if (direction_begin == direction_end)
+    {
+        direction_begin = (ANISOTROPIC_CLIPMAP_DIRECTION_COUNT * texel) / voxel_texel_count;
+        direction_end = direction_begin + 1U;
+    }
+}
+
+static void DeriveVoxel(CpuVoxelClipmap &clipmap, uint32_t stack_level, uint32_t x, uint32_t y, uint32_t z)
+{
+    static_assert(static_cast<uint32_t>(ANISOTROPIC_CLIPMAP_DIRECTION_COUNT) == CPU_VOXELIZER_DIRECTION_COUNT, "the directions of the voxelization are the directions of the anisotropic clipmap");
+
+    uint32_t const voxel_texel_count = clipmap.opacity_extent[0] / clipmap.extent[0];
+    uint32_t const voxel_illumination_texel_count = clipmap.illumination_extent[0] / clipmap.extent[0];
+
+    uint32_t const inner_begin = BRX_VCT_CLIPMAP_MAP_SIZE / 4U;
+
+    size_t child_rows[8];
+    uint32_t child_x[8];
+
+    // [direction][child]
+    float child_opacity[ANISOTROPIC_CLIPMAP_DIRECTION_COUNT][8];
+    for (uint32_t child = 0U; child < 8U; ++child)
+    {
+        child_x[child] = 2U * (x - inner_begin) + (child & 1U);
+        child_rows[child] = GetCpuVoxelIndex(stack_level - 1U, 0U, 2U * (y - inner_begin) + ((child >> 1U) & 1U), 2U * (z - inner_begin) + ((child >> 2U) & 1U)) / clipmap.extent[0];
+
+        uint32_t const *const voxel_opacity = &clipmap.opacity[child_rows[child] * clipmap.opacity_extent[0] + voxel_texel_count * child_x[child]];
+        for (uint32_t direction = 0U; direction < ANISOTROPIC_CLIPMAP_DIRECTION_COUNT; ++direction)
+        {
+            child_opacity[direction][child] = static_cast<float>(voxel_opacity[(direction * voxel_texel_count) / ANISOTROPIC_CLIPMAP_DIRECTION_COUNT] & 0x3FFU) / 1023.0F;
+        }
+    }
+
+    float opacity[ANISOTROPIC_CLIPMAP_DIRECTION_COUNT];
+    for (uint32_t direction = 0U; direction < ANISOTROPIC_CLIPMAP_DIRECTION_COUNT; ++direction)
+    {
+        uint32_t const axis_bit = 1U << (direction >> 1U);
+        bool const positive = (0U == (direction & 1U));
+
+        opacity[direction] = 0.0F;
+        for (uint32_t child = 0U; child < 8U; ++child)
+        {
+            // each column is visited from its front child
+            if ((0U != (child & axis_bit)) == positive)
+            {
+                continue;
+            }
+
+            float const front = child_opacity[direction][child];
+            float const back = child_opacity[direction][child ^ axis_bit];
+            opacity[direction] += 0.25F * (front + (1.0F - front) * back);
+        }
+    }
+
+    size_t const row = GetCpuVoxelIndex(stack_level, 0U, y, z) / clipmap.extent[0];
+
+    uint32_t *const voxel_opacity = &clipmap.opacity[row * clipmap.opacity_extent[0] + voxel_texel_count * x];
+    for (uint32_t texel = 0U; texel < voxel_texel_count; ++texel)
+    {
+        uint32_t direction_begin;
+        uint32_t direction_end;
+        GetAnisotropicClipmapOpacityTexelDirections(texel, voxel_texel_count, direction_begin, direction_end);
+
+        float texel_opacity = 0.0F;
+        for (uint32_t direction = direction_begin; direction < direction_end; ++direction)
+        {
+            texel_opacity += opacity[direction];
+        }
+
+        voxel_opacity[texel] = PackCpuVoxelOpacity(texel_opacity / static_cast<float>(direction_end - direction_begin));
+    }
+
+    // the illumination is fixed point (see "VxgiPackEmittanceForAtomic"), which is averaged as float the same as the shader
+    uint32_t *const voxel_illumination = &clipmap.emittance[row * clipmap.illumination_extent[0] + voxel_illumination_texel_count * x];
+    for (uint32_t texel = 0U; texel < voxel_illumination_texel_count; ++texel)
+    {
+        float illumination = 0.0F;
+        for (uint32_t child = 0U; child < 8U; ++child)
+        {
+            illumination += static_cast<float>(clipmap.emittance[child_rows[child] * clipmap.illumination_extent[0] + voxel_illumination_texel_count * child_x[child] + texel]);
+        }
+
+        voxel_illumination[texel] = static_cast<uint32_t>(0.125F * illumination);
+    }
+}
+
+void DeriveCoarseStackLevelsCpu(CpuVoxelClipmap &clipmap, uint32_t thread_count, CpuAnisotropicClipmapStatistics &statistics)
+{
+    std::chrono::steady_clock::time_point const begin = std::chrono::steady_clock::now();
+
+    if (0U == thread_count)
+    {
+        thread_count = std::max(1U, static_cast<uint32_t>(std::thread::hardware_concurrency()));
+    }
+
+    uint32_t const inner_begin = BRX_VCT_CLIPMAP_MAP_SIZE / 4U;
+    uint32_t const inner_end = inner_begin + BRX_VCT_CLIPMAP_MAP_SIZE / 2U;
+
+    // each stack level depends on the finer stack level, thus only the slices of the same stack level are processed in parallel
+    for (uint32_t stack_level = 1U; stack_level < BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT; ++stack_level)
+    {
+        std::atomic<uint32_t> next_z(inner_begin);
+
+        auto worker = [&]() {
+            uint32_t z;
+            while ((z = next_z.fetch_add(1U)) < inner_end)
+            {
+                for (uint32_t y = inner_begin; y < inner_end; ++y)
+                {
+                    for (uint32_t x = inner_begin; x < inner_end; ++x)
+                    {
+                        DeriveVoxel(clipmap, stack_level, x, y, z);
+                    }
+                }
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (uint32_t thread_index = 1U; thread_index < thread_count; ++thread_index)
+        {
+            threads.emplace_back(worker);
+        }
+        worker();
+        for (std::thread &thread : threads)
+        {
+            thread.join();
+        }
+    }
+
+    uint64_t const inner_size = BRX_VCT_CLIPMAP_MAP_SIZE / 2U;
+    statistics.derived_voxel_count = (BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT - 1U) * inner_size * inner_size * inner_size;
+    statistics.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+}
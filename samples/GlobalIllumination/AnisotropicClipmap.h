@@ -0,0 +1,36 @@
+#pragma once
+
+#include <stdint.h>
+#include "CpuVoxelizer.h"
+
+// Derives the inner half of each coarser stack level by filtering the finer stack level, instead of voxelizing the inner half again.
+// Since all stack levels share the clipmap center, the region of the stack level "i - 1" is exactly the inner half [BRX_VCT_CLIPMAP_MAP_SIZE / 4, 3 * BRX_VCT_CLIPMAP_MAP_SIZE / 4) of the stack level "i", and each voxel there covers 2 x 2 x 2 voxels of the finer stack level.
+// The opacity is anisotropic: each direction is the average over the 2 x 2 columns of the front-to-back composition of the 2 children along the direction.
+// The illumination is isotropic (the average of the children).
+// The clipmap is filtered in place in the layout of "CpuVoxelClipmap", which is the layout of the clipmap textures, thus this is the CPU reference of "MyClipmapDownsampleCS" (see "SceneRenderer::DeriveCoarseStackLevels").
+
+enum ANISOTROPIC_CLIPMAP_DIRECTION
+{
+    ANISOTROPIC_CLIPMAP_DIRECTION_POSITIVE_X = 0,
+    ANISOTROPIC_CLIPMAP_DIRECTION_NEGATIVE_X = 1,
+    ANISOTROPIC_CLIPMAP_DIRECTION_POSITIVE_Y = 2,
+    ANISOTROPIC_CLIPMAP_DIRECTION_NEGATIVE_Y = 3,
+    ANISOTROPIC_CLIPMAP_DIRECTION_POSITIVE_Z = 4,
+    ANISOTROPIC_CLIPMAP_DIRECTION_NEGATIVE_Z = 5,
+    ANISOTROPIC_CLIPMAP_DIRECTION_COUNT = 6
+};
+
+struct CpuAnisotropicClipmapStatistics
+{
+    // the voxels filtered from the finer stack level
+    uint64_t derived_voxel_count;
+
+    double seconds;
+};
+
+// the directions [direction_begin, direction_end) stored in the opacity texel "texel" of a voxel: the directions share the texels when there are less than 6 texels per voxel, and the texels share the direction otherwise
+void GetAnisotropicClipmapOpacityTexelDirections(uint32_t texel, uint32_t voxel_texel_count, uint32_t &direction_begin, uint32_t &direction_end);
+
+// the stack levels are derived in order, since each stack level is filtered from the derived finer stack level
+// 0 threads means one thread per hardware thread
+void DeriveCoarseStackLevelsCpu(CpuVoxelClipmap &clipmap, uint32_t thread_count, CpuAnisotropicClipmapStatistics &statistics);
@@ -0,0 +1,375 @@
+#include "Clipmap.h"
+#include <cassert>
+#include <algorithm>
+
+float GetClipmapStackLevelVoxelSize(uint32_t stack_level)
+{
+    assert(stack_level < BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT);
+
+    return static_cast<float>(BRX_VCT_CLIPMAP_FINEST_VOXEL_SIZE) * static_cast<float>(1U << stack_level);
+}
+
+VXGI::Box3f GetClipmapStackLevelBounds(VXGI::float3 const &clipmap_center, uint32_t stack_level)
+{
+    float const half_extent = 0.5F * static_cast<float>(BRX_VCT_CLIPMAP_MAP_SIZE) * GetClipmapStackLevelVoxelSize(stack_level);
+
+    return VXGI::Box3f(clipmap_center - VXGI::float3(half_extent), clipmap_center + VXGI::float3(half_extent));
+}
+
+bool GetClipmapStackLevelRange(VXGI::Box3f const &bounds, VXGI::float3 const &clipmap_center, uint32_t &first_stack_level, uint32_t &stack_level_count)
+{
+    uint32_t min_stack_level = BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT;
+    uint32_t max_stack_level = 0U;
+
+    for (uint32_t stack_level = 0U; stack_level < BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT; ++stack_level)
+    {
+        if (GetClipmapStackLevelBounds(clipmap_center, stack_level).intersectsWith(bounds))
+        {
+            min_stack_level = std::min(min_stack_level, stack_level);
+            max_stack_level = std::max(max_stack_level, stack_level);
+        }
+    }
+
+    if (min_stack_level > max_stack_level)
+    {
+        first_stack_level = 0U;
+        stack_level_count = 0U;
+        return false;
+    }
+
+    first_stack_level = min_stack_level;
+    stack_level_count = max_stack_level - min_stack_level + 1U;
+    return true;
+}
+
+uint32_t GetClipmapStackLevelScrolledSlabs(VXGI::float3 const &previous_clipmap_center, VXGI::float3 const &clipmap_center, uint32_t stack_level, VXGI::Box3f slabs[3])
+{
+    VXGI::Box3f const previous_bounds = GetClipmapStackLevelBounds(previous_clipmap_center, stack_level);
+    VXGI::Box3f const bounds = GetClipmapStackLevelBounds(clipmap_center, stack_level);
+
+    if (!previous_bounds.intersectsWith(bounds))
+    {
+        slabs[0] = bounds;
+        return 1U;
+    }
+
+    // the remaining box shrinks by each slab, so that the slabs do not overlap
+    VXGI::Box3f remaining = bounds;
+    uint32_t slab_count = 0U;
+
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        float const lower = (&remaining.lower.x)[axis];
+        float const upper = (&remaining.upper.x)[axis];
+        float const previous_lower = (&previous_bounds.lower.x)[axis];
+        float const previous_upper = (&previous_bounds.upper.x)[axis];
+
+        if (upper > previous_upper)
+        {
+            VXGI::Box3f slab = remaining;
+            (&slab.lower.x)[axis] = previous_upper;
+            slabs[slab_count++] = slab;
+            (&remaining.upper.x)[axis] = previous_upper;
+        }
+        else if (lower < previous_lower)
+        {
+            VXGI::Box3f slab = remaining;
+            (&slab.upper.x)[axis] = previous_lower;
+            slabs[slab_count++] = slab;
+            (&remaining.lower.x)[axis] = previous_lower;
+        }
+    }
+
+    return slab_count;
+}
+
+bool GetClipmapStackLevelOverlap(VXGI::float3 const &previous_clipmap_center, VXGI::float3 const &clipmap_center, uint32_t stack_level, int32_t lower[3], int32_t upper[3], int32_t offset[3])
+{
+    float const voxel_size = GetClipmapStackLevelVoxelSize(stack_level);
+    int32_t const map_size = static_cast<int32_t>(BRX_VCT_CLIPMAP_MAP_SIZE);
+
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        float const move = ((&clipmap_center.x)[axis] - (&previous_clipmap_center.x)[axis]) / voxel_size;
+        offset[axis] = static_cast<int32_t>(std::lround(move));
+        lower[axis] = std::max(0, -offset[axis]);
+        upper[axis] = std::min(map_size, map_size - offset[axis]);
+
+        // the voxels of the two regions are only the same voxels when the move is a whole number of voxels of the stack level
+        if ((lower[axis] >= upper[axis]) || (std::fabs(move - static_cast<float>(offset[axis])) > (1.0F / 64.0F)))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void GetClipmapRegionVoxelBoxes(VXGI::float3 const &clipmap_center, VXGI::Box3f const *regions, uint32_t region_count, std::vector<ClipmapVoxelBox> &voxel_boxes)
+{
+    voxel_boxes.clear();
+
+    int32_t const map_size = static_cast<int32_t>(BRX_VCT_CLIPMAP_MAP_SIZE);
+
+    for (uint32_t stack_level = 0U; stack_level < BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT; ++stack_level)
+    {
+        VXGI::Box3f const bounds = GetClipmapStackLevelBounds(clipmap_center, stack_level);
+        float const voxel_size = GetClipmapStackLevelVoxelSize(stack_level);
+
+        size_t const first_box_index = voxel_boxes.size();
+
+        for (uint32_t region_index = 0U; region_index < region_count; ++region_index)
+        {
+            VXGI::Box3f const &region = regions[region_index];
+
+            ClipmapVoxelBox voxel_box;
+            voxel_box.stack_level = stack_level;
+
+            bool empty = false;
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                float const lower = ((&region.lower.x)[axis] - (&bounds.lower.x)[axis]) / voxel_size;
+                float const upper = ((&region.upper.x)[axis] - (&bounds.lower.x)[axis]) / voxel_size;
+
+                voxel_box.lower[axis] = std::max(0, static_cast<int32_t>(std::max(-1.0F, std::floor(lower))));
+                voxel_box.upper[axis] = std::min(map_size, static_cast<int32_t>(std::min(static_cast<float>(map_size) + 1.0F, std::ceil(upper))));
+
+                empty = empty || (voxel_box.lower[axis] >= voxel_box.upper[axis]);
+            }
+
+            if (!empty)
+            {
+                voxel_boxes.push_back(voxel_box);
+            }
+        }
+
+        // the merged box may overlap the boxes checked before, thus the check restarts after each merge
+        bool merged = true;
+        while (merged)
+        {
+            merged = false;
+            for (size_t box_index = first_box_index; (box_index < voxel_boxes.size()) && (!merged); ++box_index)
+            {
+                for (size_t other_box_index = box_index + 1U; (other_box_index < voxel_boxes.size()) && (!merged); ++other_box_index)
+                {
+                    ClipmapVoxelBox &voxel_box = voxel_boxes[box_index];
+                    ClipmapVoxelBox const &other_voxel_box = voxel_boxes[other_box_index];
+
+                    bool const overlap =
+                        (voxel_box.lower[0] < other_voxel_box.upper[0]) && (other_voxel_box.lower[0] < voxel_box.upper[0]) &&
+                        (voxel_box.lower[1] < other_voxel_box.upper[1]) && (other_voxel_box.lower[1] < voxel_box.upper[1]) &&
+                        (voxel_box.lower[2] < other_voxel_box.upper[2]) && (other_voxel_box.lower[2] < voxel_box.upper[2]);
+
+                    if (overlap)
+                    {
+                        for (int axis = 0; axis < 3; ++axis)
+                        {
+                            voxel_box.lower[axis] = std::min(voxel_box.lower[axis], other_voxel_box.lower[axis]);
+                            voxel_box.upper[axis] = std::max(voxel_box.upper[axis], other_voxel_box.upper[axis]);
+                        }
+
+                        voxel_boxes.erase(voxel_boxes.begin() + other_box_index);
+                        merged = true;
+                    }
+                }
+            }
+        }
+    }
+}
+
+uint64_t GetClipmapStackLevelSlabVoxelCount(VXGI::Box3f const &slab, uint32_t stack_level)
+{
+    float const voxel_size = GetClipmapStackLevelVoxelSize(stack_level);
+
+    VXGI::float3 const extent = slab.upper - slab.lower;
+
+    return static_cast<uint64_t>(std::lround(extent.x / voxel_size)) * static_cast<uint64_t>(std::lround(extent.y / voxel_size)) * static_cast<uint64_t>(std::lround(extent.z / voxel_size));
+}
+
+bool GetClipmapVoxelSurfaceCoordinates(VXGI::float3 const &position, VXGI::float3 const &clipmap_center, uint32_t stack_level, uint32_t coordinates[3])
+{
+    float const voxel_size = GetClipmapStackLevelVoxelSize(stack_level);
+
+    VXGI::float3 const offset = position - clipmap_center;
+
+    int32_t const voxel[3] = {
+        static_cast<int32_t>(std::floor(offset.x / voxel_size + 0.5F * static_cast<float>(BRX_VCT_CLIPMAP_MAP_SIZE))),
+        static_cast<int32_t>(std::floor(offset.y / voxel_size + 0.5F * static_cast<float>(BRX_VCT_CLIPMAP_MAP_SIZE))),
+        static_cast<int32_t>(std::floor(offset.z / voxel_size + 0.5F * static_cast<float>(BRX_VCT_CLIPMAP_MAP_SIZE)))};
+
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        if ((voxel[axis] < 0) || (voxel[axis] >= static_cast<int32_t>(BRX_VCT_CLIPMAP_MAP_SIZE)))
+        {
+            return false;
+        }
+    }
+
+    coordinates[0] = static_cast<uint32_t>(voxel[0]);
+    coordinates[1] = static_cast<uint32_t>(voxel[1]);
+    coordinates[2] = static_cast<uint32_t>(voxel[2]) + stack_level * BRX_VCT_CLIPMAP_MAP_SIZE;
+    return true;
+}
+
+ClipmapAnchorController::ClipmapAnchorController() : m_LookAheadTime(0.25F), m_Valid(false), m_Anchor(0.0F)
+{
+    for (uint32_t stack_level = 0U; stack_level < BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT; ++stack_level)
+    {
+        m_DeadZoneVoxels[stack_level] = 2.0F;
+    }
+}
+
+void ClipmapAnchorController::SetDeadZone(uint32_t stack_level, float dead_zone_voxels)
+{
+    assert(stack_level < BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT);
+    m_DeadZoneVoxels[stack_level] = std::max(0.0F, dead_zone_voxels);
+}
+
+float *ClipmapAnchorController::GetDeadZonePointer(uint32_t stack_level)
+{
+    assert(stack_level < BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT);
+    return &m_DeadZoneVoxels[stack_level];
+}
+
+void ClipmapAnchorController::SetLookAheadTime(float look_ahead_time)
+{
+    m_LookAheadTime = std::max(0.0F, look_ahead_time);
+}
+
+float *ClipmapAnchorController::GetLookAheadTimePointer()
+{
+    return &m_LookAheadTime;
+}
+
+void ClipmapAnchorController::Reset()
+{
+    m_Valid = false;
+}
+
+VXGI::float3 ClipmapAnchorController::Update(VXGI::float3 const &desired_anchor, VXGI::float3 const &velocity)
+{
+    VXGI::float3 const predicted_anchor = desired_anchor + velocity * m_LookAheadTime;
+
+    // the first anchor is snapped to the finest stack level
+    uint32_t snap_stack_level = 0U;
+    bool move = !m_Valid;
+
+    if (m_Valid)
+    {
+        VXGI::float3 const offset = predicted_anchor - m_Anchor;
+        float const distance = std::max(std::max(std::abs(offset.x), std::abs(offset.y)), std::abs(offset.z));
+
+        for (uint32_t stack_level = 0U; stack_level < BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT; ++stack_level)
+        {
+            if (distance > (m_DeadZoneVoxels[stack_level] * GetClipmapStackLevelVoxelSize(stack_level)))
+            {
+                snap_stack_level = stack_level;
+                move = true;
+            }
+        }
+    }
+
+    if (move)
+    {
+        float const voxel_size = GetClipmapStackLevelVoxelSize(snap_stack_level);
+
+        m_Anchor = VXGI::float3(
+            std::round(predicted_anchor.x / voxel_size) * voxel_size,
+            std::round(predicted_anchor.y / voxel_size) * voxel_size,
+            std::round(predicted_anchor.z / voxel_size) * voxel_size);
+        m_Valid = true;
+    }
+
+    return m_Anchor;
+}
+
+ClipmapStackLevelScheduler::ClipmapStackLevelScheduler() : m_EveryFrameStackLevelCount(2U), m_CoarseStackLevelPeriod(4U), m_TriangleBudget(100000U)
+{
+    Reset();
+}
+
+uint32_t *ClipmapStackLevelScheduler::GetEveryFrameStackLevelCountPointer()
+{
+    return &m_EveryFrameStackLevelCount;
+}
+
+uint32_t *ClipmapStackLevelScheduler::GetCoarseStackLevelPeriodPointer()
+{
+    return &m_CoarseStackLevelPeriod;
+}
+
+uint32_t *ClipmapStackLevelScheduler::GetTriangleBudgetPointer()
+{
+    return &m_TriangleBudget;
+}
+
+void ClipmapStackLevelScheduler::Reset()
+{
+    for (uint32_t stack_level = 0U; stack_level < BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT; ++stack_level)
+    {
+        m_FramesSinceUpdate[stack_level] = UINT32_MAX;
+    }
+}
+
+uint32_t ClipmapStackLevelScheduler::Schedule(uint32_t pending_stack_level_mask, uint64_t const scrolled_voxel_counts[BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT], uint32_t const triangle_counts[BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT])
+{
+    for (uint32_t stack_level = 0U; stack_level < BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT; ++stack_level)
+    {
+        m_FramesSinceUpdate[stack_level] = std::min(m_FramesSinceUpdate[stack_level], UINT32_MAX - 1U) + 1U;
+    }
+
+    uint32_t scheduled_stack_level_mask = 0U;
+    uint64_t scheduled_triangle_count = 0U;
+
+    uint32_t candidate_stack_levels[BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT];
+    uint32_t candidate_stack_level_count = 0U;
+
+    for (uint32_t stack_level = 0U; stack_level < BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT; ++stack_level)
+    {
+        if (0U == (pending_stack_level_mask & (1U << stack_level)))
+        {
+            continue;
+        }
+
+        if (stack_level < m_EveryFrameStackLevelCount)
+        {
+            scheduled_stack_level_mask |= (1U << stack_level);
+            scheduled_triangle_count += triangle_counts[stack_level];
+        }
+        else if (m_FramesSinceUpdate[stack_level] >= std::max(1U, m_CoarseStackLevelPeriod))
+        {
+            candidate_stack_levels[candidate_stack_level_count++] = stack_level;
+        }
+    }
+
+    std::sort(candidate_stack_levels, candidate_stack_levels + candidate_stack_level_count, [this, scrolled_voxel_counts](uint32_t a, uint32_t b) {
+        if (scrolled_voxel_counts[a] != scrolled_voxel_counts[b])
+        {
+            return scrolled_voxel_counts[a] > scrolled_voxel_counts[b];
+        }
+        return m_FramesSinceUpdate[a] > m_FramesSinceUpdate[b];
+    });
+
+    for (uint32_t candidate_index = 0U; candidate_index < candidate_stack_level_count; ++candidate_index)
+    {
+        uint32_t const stack_level = candidate_stack_levels[candidate_index];
+
+        if ((0U != scheduled_stack_level_mask) && (0U != m_TriangleBudget) && ((scheduled_triangle_count + triangle_counts[stack_level]) > m_TriangleBudget))
+        {
+            continue;
+        }
+
+        scheduled_stack_level_mask |= (1U << stack_level);
+        scheduled_triangle_count += triangle_counts[stack_level];
+    }
+
+    for (uint32_t stack_level = 0U; stack_level < BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT; ++stack_level)
+    {
+        if (0U != (scheduled_stack_level_mask & (1U << stack_level)))
+        {
+            m_FramesSinceUpdate[stack_level] = 0U;
+        }
+    }
+
+    return scheduled_stack_level_mask;
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cmath>
+#include <stdint.h>
+#include <vector>
+#include "GFSDK_VXGI_MathTypes.h"
+#include "../../thirdparty/Voxel-Cone-Tracing/include/brx_voxel_cone_tracing.h"
+
+// Each stack level is "BRX_VCT_CLIPMAP_MAP_SIZE" voxels wide and the voxel size doubles from one stack level to the next.
+// All stack levels share the same (snapped) clipmap center, which means that the region of a finer stack level is always inside the region of the coarser stack levels.
+
+static uint32_t const CLIPMAP_ALL_STACK_LEVELS_MASK = (1U << BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT) - 1U;
+
+float GetClipmapStackLevelVoxelSize(uint32_t stack_level);
+
+VXGI::Box3f GetClipmapStackLevelBounds(VXGI::float3 const &clipmap_center, uint32_t stack_level);
+
+// [first_stack_level, first_stack_level + stack_level_count) is the contiguous range of the stack levels whose region overlaps the bounds
+// false is returned when the bounds do not overlap any stack level
+bool GetClipmapStackLevelRange(VXGI::Box3f const &bounds, VXGI::float3 const &clipmap_center, uint32_t &first_stack_level, uint32_t &stack_level_count);
+
+// The region of the stack level around the new clipmap center which is NOT inside the region around the previous clipmap center.
+// The region is split into at most 3 disjoint slabs (one per axis) and the number of the slabs is returned.
+// The whole region is returned as a single slab when the clipmap center moves by at least the size of the region.
+uint32_t GetClipmapStackLevelScrolledSlabs(VXGI::float3 const &previous_clipmap_center, VXGI::float3 const &clipmap_center, uint32_t stack_level, VXGI::Box3f slabs[3]);
+
+// The voxels of the stack level which stay inside the region when the clipmap center moves, as the box [lower, upper) of the voxel coordinates around the new clipmap center.
+// The voxel "v" around the new clipmap center is the voxel "v + offset" around the previous clipmap center.
+// false is returned when the regions do not overlap.
+bool GetClipmapStackLevelOverlap(VXGI::float3 const &previous_clipmap_center, VXGI::float3 const &clipmap_center, uint32_t stack_level, int32_t lower[3], int32_t upper[3], int32_t offset[3]);
+
+// The box [lower, upper) of the voxel coordinates of the stack level around the clipmap center
+struct ClipmapVoxelBox
+{
+    uint32_t stack_level;
+    int32_t lower[3];
+    int32_t upper[3];
+};
+
+// The voxels of each stack level which overlap any of the regions (including the voxels partially inside).
+// The boxes of the same stack level do not overlap: the boxes which overlap after the rounding to the voxels are merged into their bounds.
+void GetClipmapRegionVoxelBoxes(VXGI::float3 const &clipmap_center, VXGI::Box3f const *regions, uint32_t region_count, std::vector<ClipmapVoxelBox> &voxel_boxes);
+
+// The number of the voxels of the stack level inside the slab
+uint64_t GetClipmapStackLevelSlabVoxelCount(VXGI::Box3f const &slab, uint32_t stack_level);
+
+// The voxel of the stack level which contains the position, in the layout of the voxel surface texture (see "shaders/VoxelLighting.hlsli")
+// false is returned when the position is outside the region of the stack level
+bool GetClipmapVoxelSurfaceCoordinates(VXGI::float3 const &position, VXGI::float3 const &clipmap_center, uint32_t stack_level, uint32_t coordinates[3]);
+
+// Filters the clipmap anchor to avoid that small movements and rotations of the camera move the clipmap center back and forth.
+// The anchor is predicted ahead by the velocity of the camera, and only moves when the prediction leaves the dead zone of a stack level.
+// The moved anchor is snapped to the voxel grid of the coarsest stack level whose dead zone is left.
+class ClipmapAnchorController
+{
+    float m_DeadZoneVoxels[BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT];
+    float m_LookAheadTime;
+
+    bool m_Valid;
+    VXGI::float3 m_Anchor;
+
+public:
+    ClipmapAnchorController();
+
+    // the dead zone is in the voxels of the stack level
+    void SetDeadZone(uint32_t stack_level, float dead_zone_voxels);
+    float *GetDeadZonePointer(uint32_t stack_level);
+
+    // in seconds
+    void SetLookAheadTime(float look_ahead_time);
+    float *GetLookAheadTimePointer();
+
+    void Reset();
+
+    VXGI::float3 Update(VXGI::float3 const &desired_anchor, VXGI::float3 const &velocity);
+};
+
+// Selects the stack levels voxelized in the current frame, so that a rebuild of the clipmap is spread over several frames.
+// The finest stack levels are voxelized in the first frame they are pending, and each coarser stack level at most once every "period" frames.
+// The coarser stack levels are prioritized by the voxels scrolled in (the least recently voxelized first), and added as long as the triangles fit the budget.
+// At least one pending stack level is selected when any is allowed, so that a single stack level exceeding the budget can not stall the rebuild.
+class ClipmapStackLevelScheduler
+{
+    uint32_t m_EveryFrameStackLevelCount;
+    uint32_t m_CoarseStackLevelPeriod;
+    uint32_t m_TriangleBudget;
+
+    uint32_t m_FramesSinceUpdate[BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT];
+
+public:
+    ClipmapStackLevelScheduler();
+
+    uint32_t *GetEveryFrameStackLevelCountPointer();
+    uint32_t *GetCoarseStackLevelPeriodPointer();
+
+    // 0 means unlimited
+    uint32_t *GetTriangleBudgetPointer();
+
+    void Reset();
+
+    // the returned mask is a subset of the pending mask (bit "i" is the stack level "i")
+    uint32_t Schedule(uint32_t pending_stack_level_mask, uint64_t const scrolled_voxel_counts[BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT], uint32_t const triangle_counts[BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT]);
+};
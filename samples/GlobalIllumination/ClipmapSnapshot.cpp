@@ -0,0 +1,306 @@
+#if defined(_MSC_VER)
+#define _CRT_SECURE_NO_WARNINGS 1
+#endif
+
+#include "ClipmapSnapshot.h"
+#include "../ContentHash.h"
+#include <cassert>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#if defined(_WIN32)
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+#include "../../thirdparty/zlib/zlib.h"
+#include "../../thirdparty/Voxel-Cone-Tracing/include/brx_voxel_cone_tracing_resource.h"
+
+static uint32_t const CLIPMAP_SNAPSHOT_MAGIC = 0x53435642U; // "BVCS"
+// 2: the voxel surface
+static uint32_t const CLIPMAP_SNAPSHOT_VERSION = 2U;
+
+struct ClipmapSnapshotFileHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t scene_hash;
+    uint32_t map_size;
+    uint32_t stack_level_count;
+    uint32_t mip_level_count;
+    float finest_voxel_size;
+    float clipmap_center[3];
+    uint32_t has_illumination;
+    float light_direction[3];
+    uint32_t opacity_extent[3];
+    uint32_t illumination_extent[3];
+    uint32_t has_surface;
+    uint32_t surface_extent[3];
+    uint32_t _padding;
+    uint64_t opacity_compressed_size;
+    uint64_t illumination_compressed_size;
+    uint64_t surface_compressed_size;
+};
+
+static_assert(128U == sizeof(ClipmapSnapshotFileHeader), "the header is written as is");
+
+static bool MatchClipmapSnapshotKey(ClipmapSnapshotFileHeader const &header, ClipmapSnapshotKey const &key)
+{
+    return (header.scene_hash == key.scene_hash) &&
+           (header.map_size == key.map_size) &&
+           (header.stack_level_count == key.stack_level_count) &&
+           (header.mip_level_count == key.mip_level_count) &&
+           (header.finest_voxel_size == key.finest_voxel_size) &&
+           (header.clipmap_center[0] == key.clipmap_center[0]) &&
+           (header.clipmap_center[1] == key.clipmap_center[1]) &&
+           (header.clipmap_center[2] == key.clipmap_center[2]) &&
+           (0 == memcmp(header.opacity_extent, key.opacity_extent, sizeof(header.opacity_extent))) &&
+           (0 == memcmp(header.illumination_extent, key.illumination_extent, sizeof(header.illumination_extent)));
+}
+
+static bool WriteCompressedTexels(FILE *file, std::vector<uint32_t> const &texels, uint64_t &compressed_size)
+{
+    uLong const source_size = static_cast<uLong>(sizeof(uint32_t) * texels.size());
+
+    std::vector<Bytef> compressed(compressBound(source_size));
+    uLongf destination_size = static_cast<uLongf>(compressed.size());
+    if (Z_OK != compress2(compressed.data(), &destination_size, reinterpret_cast<Bytef const *>(texels.data()), source_size, Z_BEST_SPEED))
+    {
+        return false;
+    }
+
+    compressed_size = destination_size;
+    return (destination_size == fwrite(compressed.data(), 1U, destination_size, file));
+}
+
+// the extent is checked against the key and the compressed size against the size of the file by the caller, thus a corrupted header does not allocate more than the file and the textures
+static bool ReadCompressedTexels(FILE *file, uint32_t const extent[3], uint32_t component_count, uint64_t compressed_size, std::vector<uint32_t> &texels)
+{
+    std::vector<Bytef> compressed(static_cast<size_t>(compressed_size));
+    if (compressed.size() != fread(compressed.data(), 1U, compressed.size(), file))
+    {
+        return false;
+    }
+
+    texels.resize(static_cast<size_t>(component_count) * extent[0] * extent[1] * extent[2]);
+
+    uLongf destination_size = static_cast<uLongf>(sizeof(uint32_t) * texels.size());
+    if (Z_OK != uncompress(reinterpret_cast<Bytef *>(texels.data()), &destination_size, compressed.data(), static_cast<uLong>(compressed.size())))
+    {
+        return false;
+    }
+
+    return (destination_size == (sizeof(uint32_t) * texels.size()));
+}
+
+ClipmapSnapshotKey MakeClipmapSnapshotKey(uint64_t scene_hash, uint32_t map_size, float finest_voxel_size, float const clipmap_center[3])
+{
+    ClipmapSnapshotKey key = {};
+    key.scene_hash = scene_hash;
+    key.map_size = map_size;
+    key.stack_level_count = BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT;
+    key.mip_level_count = BRX_VCT_CLIPMAP_MIP_LEVEL_COUNT;
+    key.finest_voxel_size = finest_voxel_size;
+    memcpy(key.clipmap_center, clipmap_center, sizeof(key.clipmap_center));
+
+    DirectX::XMUINT3 const opacity_extent = brx_voxel_cone_tracing_resource_clipmap_opacity_texture_extent();
+    key.opacity_extent[0] = opacity_extent.x;
+    key.opacity_extent[1] = opacity_extent.y;
+    key.opacity_extent[2] = opacity_extent.z;
+
+    DirectX::XMUINT3 const illumination_extent = brx_voxel_cone_tracing_resource_clipmap_illumination_texture_extent();
+    key.illumination_extent[0] = illumination_extent.x;
+    key.illumination_extent[1] = illumination_extent.y;
+    key.illumination_extent[2] = illumination_extent.z;
+
+    return key;
+}
+
+std::string GetClipmapSnapshotFileName(ClipmapSnapshotKey const &key)
+{
+    // the fields are hashed one by one, since the padding of the struct is undefined
+    uint64_t hash = HashContentData(&key.scene_hash, sizeof(key.scene_hash));
+    hash = HashContentData(&key.map_size, sizeof(key.map_size), hash);
+    hash = HashContentData(&key.stack_level_count, sizeof(key.stack_level_count), hash);
+    hash = HashContentData(&key.mip_level_count, sizeof(key.mip_level_count), hash);
+    hash = HashContentData(&key.finest_voxel_size, sizeof(key.finest_voxel_size), hash);
+    hash = HashContentData(key.clipmap_center, sizeof(key.clipmap_center), hash);
+    hash = HashContentData(key.opacity_extent, sizeof(key.opacity_extent), hash);
+    hash = HashContentData(key.illumination_extent, sizeof(key.illumination_extent), hash);
+
+    char file_name[32];
+    snprintf(file_name, sizeof(file_name), "%016llx.vcs", static_cast<unsigned long long>(hash));
+    return file_name;
+}
+
+std::string GetClipmapSnapshotPath(char const *directory, ClipmapSnapshotKey const &key)
+{
+    std::string path = directory;
+    if ((!path.empty()) && ('/' != path.back()) && ('\\' != path.back()))
+    {
+        path += '/';
+    }
+    return path + GetClipmapSnapshotFileName(key);
+}
+
+bool CreateClipmapSnapshotDirectory(char const *directory)
+{
+#if defined(_WIN32)
+    int const result = _mkdir(directory);
+#else
+    int const result = mkdir(directory, 0755);
+#endif
+    return (0 == result) || (EEXIST == errno);
+}
+
+bool SaveClipmapSnapshot(char const *path, ClipmapSnapshot const &snapshot)
+{
+    assert(0 == memcmp(snapshot.opacity_extent, snapshot.key.opacity_extent, sizeof(snapshot.opacity_extent)));
+    assert((!snapshot.has_illumination) || (0 == memcmp(snapshot.illumination_extent, snapshot.key.illumination_extent, sizeof(snapshot.illumination_extent))));
+    assert(snapshot.opacity.size() == (static_cast<size_t>(snapshot.opacity_extent[0]) * snapshot.opacity_extent[1] * snapshot.opacity_extent[2]));
+    assert((!snapshot.has_illumination) || (snapshot.illumination.size() == (static_cast<size_t>(snapshot.illumination_extent[0]) * snapshot.illumination_extent[1] * snapshot.illumination_extent[2])));
+    assert((!snapshot.has_surface) || (snapshot.surface.size() == (2U * static_cast<size_t>(snapshot.surface_extent[0]) * snapshot.surface_extent[1] * snapshot.surface_extent[2])));
+
+    FILE *file = fopen(path, "wb");
+    if (NULL == file)
+    {
+        return false;
+    }
+
+    ClipmapSnapshotFileHeader header = {};
+    header.magic = CLIPMAP_SNAPSHOT_MAGIC;
+    header.version = CLIPMAP_SNAPSHOT_VERSION;
+    header.scene_hash = snapshot.key.scene_hash;
+    header.map_size = snapshot.key.map_size;
+    header.stack_level_count = snapshot.key.stack_level_count;
+    header.mip_level_count = snapshot.key.mip_level_count;
+    header.finest_voxel_size = snapshot.key.finest_voxel_size;
+    memcpy(header.clipmap_center, snapshot.key.clipmap_center, sizeof(header.clipmap_center));
+    header.has_illumination = snapshot.has_illumination ? 1U : 0U;
+    memcpy(header.light_direction, snapshot.light_direction, sizeof(header.light_direction));
+    memcpy(header.opacity_extent, snapshot.opacity_extent, sizeof(header.opacity_extent));
+    memcpy(header.illumination_extent, snapshot.illumination_extent, sizeof(header.illumination_extent));
+    header.has_surface = snapshot.has_surface ? 1U : 0U;
+    memcpy(header.surface_extent, snapshot.surface_extent, sizeof(header.surface_extent));
+
+    // the compressed sizes are patched after the payloads are written
+    bool result = (1U == fwrite(&header, sizeof(header), 1U, file));
+    result = result && WriteCompressedTexels(file, snapshot.opacity, header.opacity_compressed_size);
+    if (snapshot.has_illumination)
+    {
+        result = result && WriteCompressedTexels(file, snapshot.illumination, header.illumination_compressed_size);
+    }
+    if (snapshot.has_surface)
+    {
+        result = result && WriteCompressedTexels(file, snapshot.surface, header.surface_compressed_size);
+    }
+    result = result && (0 == fseek(file, 0, SEEK_SET)) && (1U == fwrite(&header, sizeof(header), 1U, file));
+
+    fclose(file);
+
+    if (!result)
+    {
+        remove(path);
+    }
+
+    return result;
+}
+
+bool LoadClipmapSnapshotAnchors(char const *path, std::vector<ClipmapSnapshotAnchor> &anchors)
+{
+    anchors.clear();
+
+    FILE *file = fopen(path, "r");
+    if (NULL == file)
+    {
+        return false;
+    }
+
+    ClipmapSnapshotAnchor anchor;
+    while (3 == fscanf(file, "%f %f %f", &anchor.position[0], &anchor.position[1], &anchor.position[2]))
+    {
+        anchors.push_back(anchor);
+    }
+
+    bool const result = (0 != feof(file));
+
+    fclose(file);
+
+    return result && (!anchors.empty());
+}
+
+bool LoadClipmapSnapshot(char const *path, ClipmapSnapshotKey const &key, float const *light_direction, ClipmapSnapshot &snapshot)
+{
+    FILE *file = fopen(path, "rb");
+    if (NULL == file)
+    {
+        return false;
+    }
+
+    // the payloads can not be larger than the rest of the file
+    uint64_t payload_size = 0U;
+    if (0 == fseek(file, 0, SEEK_END))
+    {
+        long const file_size = ftell(file);
+        if (file_size > static_cast<long>(sizeof(ClipmapSnapshotFileHeader)))
+        {
+            payload_size = static_cast<uint64_t>(file_size) - sizeof(ClipmapSnapshotFileHeader);
+        }
+    }
+
+    ClipmapSnapshotFileHeader header;
+    bool result = (0 == fseek(file, 0, SEEK_SET)) && (1U == fread(&header, sizeof(header), 1U, file)) && (CLIPMAP_SNAPSHOT_MAGIC == header.magic) && (CLIPMAP_SNAPSHOT_VERSION == header.version) && MatchClipmapSnapshotKey(header, key);
+
+    if (result)
+    {
+        uint64_t const illumination_compressed_size = (0U != header.has_illumination) ? header.illumination_compressed_size : 0U;
+        uint64_t const surface_compressed_size = (0U != header.has_surface) ? header.surface_compressed_size : 0U;
+        result = (header.opacity_compressed_size <= payload_size) && (illumination_compressed_size <= (payload_size - header.opacity_compressed_size)) && (surface_compressed_size <= (payload_size - header.opacity_compressed_size - illumination_compressed_size));
+        result = result && ((0U == header.has_surface) || ((header.surface_extent[0] == key.map_size) && (header.surface_extent[1] == key.map_size) && (header.surface_extent[2] == (key.map_size * key.stack_level_count))));
+    }
+
+    // the illumination baked for another light direction is skipped
+    bool read_illumination = result && (0U != header.has_illumination);
+    if (result && (NULL != light_direction))
+    {
+        read_illumination = read_illumination && (header.light_direction[0] == light_direction[0]) && (header.light_direction[1] == light_direction[1]) && (header.light_direction[2] == light_direction[2]);
+        result = read_illumination || (0U != header.has_surface);
+    }
+
+    if (result)
+    {
+        snapshot.key = key;
+        memcpy(snapshot.opacity_extent, header.opacity_extent, sizeof(snapshot.opacity_extent));
+        snapshot.has_illumination = read_illumination;
+        memcpy(snapshot.light_direction, header.light_direction, sizeof(snapshot.light_direction));
+        memcpy(snapshot.illumination_extent, header.illumination_extent, sizeof(snapshot.illumination_extent));
+        snapshot.has_surface = (0U != header.has_surface);
+        memcpy(snapshot.surface_extent, header.surface_extent, sizeof(snapshot.surface_extent));
+
+        result = ReadCompressedTexels(file, snapshot.opacity_extent, 1U, header.opacity_compressed_size, snapshot.opacity);
+        if (result && read_illumination)
+        {
+            result = ReadCompressedTexels(file, snapshot.illumination_extent, 1U, header.illumination_compressed_size, snapshot.illumination);
+        }
+        else
+        {
+            snapshot.illumination.clear();
+            if (result && (0U != header.has_illumination))
+            {
+                result = (0 == fseek(file, static_cast<long>(header.illumination_compressed_size), SEEK_CUR));
+            }
+        }
+        if (result && snapshot.has_surface)
+        {
+            result = ReadCompressedTexels(file, snapshot.surface_extent, 2U, header.surface_compressed_size, snapshot.surface);
+        }
+        else
+        {
+            snapshot.surface.clear();
+        }
+    }
+
+    fclose(file);
+
+    return result;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+// A snapshot is the content of the static layer (see "VoxelizationLayer::STATIC") of the clipmap around one snapped clipmap center.
+// It is uploaded instead of voxelizing the static meshes when the clipmap center snaps to a baked position.
+// The voxels are stored as the raw texels of the clipmap textures and compressed by zlib.
+// The illumination is only valid for the light direction of the bake. The voxel surface (see "SceneRenderer::GetVoxelSurfaceTextureDesc") is independent of the light, thus the illumination can be injected again from it for any other light direction.
+
+struct ClipmapSnapshotKey
+{
+    // see "Scene::GetContentHash"
+    uint64_t scene_hash;
+
+    // see "VXGI::VoxelizationParameters"
+    uint32_t map_size;
+    uint32_t stack_level_count;
+    uint32_t mip_level_count;
+    float finest_voxel_size;
+
+    // the snapped clipmap center
+    float clipmap_center[3];
+
+    // the extents of the clipmap textures, the payloads of a snapshot with other extents are not read
+    uint32_t opacity_extent[3];
+    uint32_t illumination_extent[3];
+};
+
+struct ClipmapSnapshotAnchor
+{
+    float position[3];
+};
+
+struct ClipmapSnapshot
+{
+    ClipmapSnapshotKey key;
+
+    uint32_t opacity_extent[3];
+    std::vector<uint32_t> opacity;
+
+    // the illumination is optional and only valid for the light direction used by the bake
+    bool has_illumination;
+    float light_direction[3];
+    uint32_t illumination_extent[3];
+    std::vector<uint32_t> illumination;
+
+    // the voxel surface is optional, 2 x "uint" per texel
+    bool has_surface;
+    uint32_t surface_extent[3];
+    std::vector<uint32_t> surface;
+};
+
+// the clipmap texture extents are the extents of "brx_voxel_cone_tracing_resource_clipmap_*_texture_extent"
+ClipmapSnapshotKey MakeClipmapSnapshotKey(uint64_t scene_hash, uint32_t map_size, float finest_voxel_size, float const clipmap_center[3]);
+
+// "<hash of the key>.vcs"
+std::string GetClipmapSnapshotFileName(ClipmapSnapshotKey const &key);
+
+// "<directory>/<hash of the key>.vcs", the separator "/" is accepted by both Windows and POSIX
+std::string GetClipmapSnapshotPath(char const *directory, ClipmapSnapshotKey const &key);
+
+// true when the directory exists or has been created
+bool CreateClipmapSnapshotDirectory(char const *directory);
+
+bool SaveClipmapSnapshot(char const *path, ClipmapSnapshot const &snapshot);
+
+// the clipmap anchors around which the snapshots are baked offline, one "x y z" per line
+bool LoadClipmapSnapshotAnchors(char const *path, std::vector<ClipmapSnapshotAnchor> &anchors);
+
+// false is returned when the file does not exist, is corrupted, or was baked with a different key
+// when the light direction is not NULL, the illumination is only read when it was baked for this light direction, and the snapshot is rejected (before decompression) unless either the illumination or the voxel surface can be used
+bool LoadClipmapSnapshot(char const *path, ClipmapSnapshotKey const &key, float const *light_direction, ClipmapSnapshot &snapshot);
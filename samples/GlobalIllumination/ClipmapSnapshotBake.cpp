@@ -0,0 +1,76 @@
+#include "ClipmapSnapshotBake.h"
+#include "ClipmapSnapshot.h"
+#include "CpuVoxelizer.h"
+#include "SceneRenderer.h"
+#include <stdio.h>
+#include <algorithm>
+#include "../../thirdparty/Voxel-Cone-Tracing/include/brx_voxel_cone_tracing_voxelization.h"
+
+bool BakeClipmapSnapshotsCpu(char const *scene_path, char const *anchors_path, char const *directory, uint32_t map_size, float finest_voxel_size)
+{
+    std::vector<ClipmapSnapshotAnchor> anchors;
+    if (!LoadClipmapSnapshotAnchors(anchors_path, anchors))
+    {
+        printf("Clipmap snapshot bake: can not load the anchors %s\n", anchors_path);
+        return false;
+    }
+
+    // no renderer, only the CPU geometry and the content hash are loaded
+    Scene scene;
+    if (FAILED(scene.Load(scene_path, Scene::LOAD_DOMINANT_AXIS_BINNING | Scene::LOAD_CPU_GEOMETRY)) || FAILED(scene.InitResources(NULL)))
+    {
+        printf("Clipmap snapshot bake: can not load the scene %s\n", scene_path);
+        return false;
+    }
+
+    std::vector<CpuVoxelizerMesh> meshes;
+    SceneRenderer::GetCpuVoxelizerMeshes(&scene, VoxelizationLayer::STATIC, meshes);
+
+    if (!CreateClipmapSnapshotDirectory(directory))
+    {
+        printf("Clipmap snapshot bake: can not create the directory %s\n", directory);
+        return false;
+    }
+
+    uint32_t baked_count = 0U;
+    for (ClipmapSnapshotAnchor const &anchor : anchors)
+    {
+        DirectX::XMFLOAT3 const clipmap_center = brx_voxel_cone_tracing_voxelization_compute_clipmap_center(DirectX::XMFLOAT3(anchor.position[0], anchor.position[1], anchor.position[2]));
+        float const clipmap_center_array[3] = {clipmap_center.x, clipmap_center.y, clipmap_center.z};
+
+        CpuVoxelClipmap clipmap;
+        CpuVoxelizerStatistics statistics;
+        bool result = VoxelizeClipmapCpu(meshes.data(), uint32_t(meshes.size()), VXGI::float3(clipmap_center.x, clipmap_center.y, clipmap_center.z), 0U, clipmap, statistics);
+
+        ClipmapSnapshotKey const key = MakeClipmapSnapshotKey(scene.GetContentHash(), map_size, finest_voxel_size, clipmap_center_array);
+        std::string const path = GetClipmapSnapshotPath(directory, key);
+
+        if (result)
+        {
+            ClipmapSnapshot snapshot;
+            snapshot.key = key;
+
+            std::copy(clipmap.opacity_extent, clipmap.opacity_extent + 3, snapshot.opacity_extent);
+            snapshot.opacity.swap(clipmap.opacity);
+
+            // the emittance of the CPU voxelizer is not the lit illumination of the voxelization
+            snapshot.has_illumination = false;
+            std::fill(snapshot.light_direction, snapshot.light_direction + 3, 0.0F);
+            std::copy(clipmap.illumination_extent, clipmap.illumination_extent + 3, snapshot.illumination_extent);
+
+            snapshot.has_surface = true;
+            std::copy(clipmap.extent, clipmap.extent + 3, snapshot.surface_extent);
+            snapshot.surface.swap(clipmap.surface);
+
+            result = SaveClipmapSnapshot(path.c_str(), snapshot);
+        }
+
+        printf("Clipmap snapshot bake: %s %s, %u triangles in %.1f ms, %u occupied voxels\n", path.c_str(), result ? "baked" : "FAILED", uint32_t(statistics.triangle_count), statistics.seconds * 1000.0, uint32_t(statistics.occupied_voxel_count));
+
+        baked_count += result ? 1U : 0U;
+    }
+
+    printf("Clipmap snapshot bake: %u of %u anchors baked\n", baked_count, uint32_t(anchors.size()));
+
+    return (baked_count == anchors.size());
+}
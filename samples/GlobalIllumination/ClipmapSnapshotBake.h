@@ -0,0 +1,12 @@
+#pragma once
+
+#include <stdint.h>
+
+// The offline bake of the snapshots (see "ClipmapSnapshot.h") around the clipmap anchors listed in the file (see "LoadClipmapSnapshotAnchors").
+// The static meshes are voxelized by the CPU voxelizer (see "VoxelizeClipmapCpu") around each anchor, thus neither a device nor a window is created.
+// The snapshots store the opacity and the voxel surface, and the illumination is injected from the voxel surface for the current light when a snapshot is uploaded (the CPU voxelizer does not light the voxels).
+// The scene is loaded with the flags of "SceneRenderer::LoadMesh", so that the content hash of the scene matches the interactive run.
+// Run by "-bake <file>", which prints the result of each anchor and exits before the device is created.
+
+// false is returned when the scene or the anchors can not be loaded, or when any anchor fails
+bool BakeClipmapSnapshotsCpu(char const *scene_path, char const *anchors_path, char const *directory, uint32_t map_size, float finest_voxel_size);
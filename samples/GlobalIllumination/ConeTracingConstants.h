@@ -0,0 +1,54 @@
+#ifndef _CONE_TRACING_CONSTANTS_H_
+#define _CONE_TRACING_CONSTANTS_H_ 1
+
+// The constants of the reduced resolution and temporally amortized mode of "MyConeTracingCS" (see "MyConeTracingDownsampleCS" and "MyConeTracingUpsampleCS").
+// One sample is traced per "tracingResolution" x "tracingResolution" block of pixels, at the pixel "sampleOffset" of the block, and the offset is rotated from frame to frame when the history is used.
+
+#if defined(__STDC__) || defined(__cplusplus)
+
+__declspec(align(16)) struct ConeTracingConstants
+{
+    VXGI::float4x4 viewProjMatrixInv;
+    VXGI::float4x4 previousViewProjMatrix;
+    VXGI::float4x4 previousViewProjMatrixInv;
+    VXGI::float4 cameraPos;
+    uint32_t fullWidth;
+    uint32_t fullHeight;
+    uint32_t tracingWidth;
+    uint32_t tracingHeight;
+    uint32_t tracingResolution;
+    uint32_t sampleOffsetX;
+    uint32_t sampleOffsetY;
+    uint32_t historyValid;
+    float tracedWeight;
+    float upsampledWeight;
+    float depthTolerance;
+    float normalExponent;
+};
+#elif defined(HLSL_VERSION) || defined(__HLSL_VERSION)
+
+cbuffer ConeTracingConstants : register(b0)
+{
+    float4x4 g_ViewProjMatrixInv;
+    float4x4 g_PreviousViewProjMatrix;
+    float4x4 g_PreviousViewProjMatrixInv;
+    float4 g_CameraPos;
+    uint g_FullWidth;
+    uint g_FullHeight;
+    uint g_TracingWidth;
+    uint g_TracingHeight;
+    uint g_TracingResolution;
+    uint g_SampleOffsetX;
+    uint g_SampleOffsetY;
+    uint g_HistoryValid;
+    float g_TracedWeight;
+    float g_UpsampledWeight;
+    float g_DepthTolerance;
+    float g_NormalExponent;
+}
+
+#else
+#error Unknown Compiler
+#endif
+
+#endif
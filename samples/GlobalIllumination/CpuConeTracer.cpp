@@ -0,0 +1,777 @@
+#include "CpuConeTracer.h"
+#include "Clipmap.h"
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE__)
+#include <xmmintrin.h>
+#define CPU_CONE_TRACER_SSE 1
+#else
+#define CPU_CONE_TRACER_SSE 0
+#endif
+
+namespace
+{
+    // 4 lanes of the packet
+    struct Float4
+    {
+#if CPU_CONE_TRACER_SSE
+        __m128 v;
+
+        Float4() : v(_mm_setzero_ps()) {}
+        explicit Float4(float f) : v(_mm_set1_ps(f)) {}
+        explicit Float4(__m128 m) : v(m) {}
+        void Load(float const f[4]) { v = _mm_loadu_ps(f); }
+        void Store(float f[4]) const { _mm_storeu_ps(f, v); }
+
+        Float4 operator+(Float4 const &b) const { return Float4(_mm_add_ps(v, b.v)); }
+        Float4 operator-(Float4 const &b) const { return Float4(_mm_sub_ps(v, b.v)); }
+        Float4 operator*(Float4 const &b) const { return Float4(_mm_mul_ps(v, b.v)); }
+        static Float4 Min(Float4 const &a, Float4 const &b) { return Float4(_mm_min_ps(a.v, b.v)); }
+        static Float4 Max(Float4 const &a, Float4 const &b) { return Float4(_mm_max_ps(a.v, b.v)); }
+
+        // the bit "i" is set when the lane "i" of "a" is less than the lane of "b"
+        static uint32_t LessMask(Float4 const &a, Float4 const &b) { return static_cast<uint32_t>(_mm_movemask_ps(_mm_cmplt_ps(a.v, b.v))); }
+#else
+        float v[4];
+
+        Float4() { v[0] = v[1] = v[2] = v[3] = 0.0F; }
+        explicit Float4(float f) { v[0] = v[1] = v[2] = v[3] = f; }
+        void Load(float const f[4]) { std::copy(f, f + 4, v); }
+        void Store(float f[4]) const { std::copy(v, v + 4, f); }
+
+        Float4 operator+(Float4 const &b) const { Float4 r; for (int i = 0; i < 4; ++i) r.v[i] = v[i] + b.v[i]; return r; }
+        Float4 operator-(Float4 const &b) const { Float4 r; for (int i = 0; i < 4; ++i) r.v[i] = v[i] - b.v[i]; return r; }
+        Float4 operator*(Float4 const &b) const { Float4 r; for (int i = 0; i < 4; ++i) r.v[i] = v[i] * b.v[i]; return r; }
+        static Float4 Min(Float4 const &a, Float4 const &b) { Float4 r; for (int i = 0; i < 4; ++i) r.v[i] = std::min(a.v[i], b.v[i]); return r; }
+        static Float4 Max(Float4 const &a, Float4 const &b) { Float4 r; for (int i = 0; i < 4; ++i) r.v[i] = std::max(a.v[i], b.v[i]); return r; }
+        static uint32_t LessMask(Float4 const &a, Float4 const &b) { uint32_t m = 0U; for (int i = 0; i < 4; ++i) m |= (a.v[i] < b.v[i]) ? (1U << i) : 0U; return m; }
+#endif
+    };
+
+    struct ConePacket
+    {
+        float origin[3][4];
+        float direction[3][4];
+        float aperture[4];
+        uint32_t active_mask;
+    };
+
+    struct ConePacketResult
+    {
+        float radiance[3][4];
+        float opacity[4];
+    };
+
+    // the opacity unpacked as "VxgiUnpackOpacity" and the emittance unpacked from the fixed point of "VxgiPackEmittanceForAtomic"
+    inline void UnpackAccumulatedVoxel(uint32_t packed_opacity, uint32_t const packed_emittance[3], float &opacity, float radiance[3])
+    {
+        float const emittance_scale = 1.0F / static_cast<float>(1U << 20);
+
+        opacity = static_cast<float>(packed_opacity & 0x3FFU) / 1023.0F;
+        radiance[0] = static_cast<float>(packed_emittance[0]) * emittance_scale;
+        radiance[1] = static_cast<float>(packed_emittance[1]) * emittance_scale;
+        radiance[2] = static_cast<float>(packed_emittance[2]) * emittance_scale;
+    }
+
+    struct DenseVoxelSource
+    {
+        CpuVoxelClipmap const &clipmap;
+
+        void Fetch(uint32_t stack_level, uint32_t x, uint32_t y, uint32_t z, float &opacity, float radiance[3]) const
+        {
+            size_t const voxel_index = GetCpuVoxelIndex(stack_level, x, y, z);
+
+            uint32_t packed_emittance[3];
+            GetCpuVoxelEmittance(clipmap, voxel_index, packed_emittance);
+            UnpackAccumulatedVoxel(GetCpuVoxelOpacity(clipmap, voxel_index), packed_emittance, opacity, radiance);
+        }
+    };
+
+    struct CompactVoxelSource
+    {
+        CompactVoxelClipmap const &clipmap;
+
+        void Fetch(uint32_t stack_level, uint32_t x, uint32_t y, uint32_t z, float &opacity, float radiance[3]) const
+        {
+            VXGI::float3 voxel_radiance;
+            clipmap.ReadVoxel(GetCpuVoxelIndex(stack_level, x, y, z), opacity, voxel_radiance);
+            radiance[0] = voxel_radiance.x;
+            radiance[1] = voxel_radiance.y;
+            radiance[2] = voxel_radiance.z;
+        }
+    };
+}
+
+static VXGI::float3 Normalize(VXGI::float3 const &v)
+{
+    float const length = std::sqrt(v.x * v.x + v.y * v.y + v.z * v.z);
+    return (length > 0.0F) ? (v / length) : VXGI::float3(0.0F, 0.0F, 1.0F);
+}
+
+static VXGI::float3 Cross(VXGI::float3 const &a, VXGI::float3 const &b)
+{
+    return VXGI::float3(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+}
+
+// trilinear
+template <typename VoxelSource>
+static void SampleStackLevel(VoxelSource const &voxels, VXGI::float3 const &clipmap_center, uint32_t stack_level, float const position[3], float &opacity, float radiance[3])
+{
+    float const voxel_size = GetClipmapStackLevelVoxelSize(stack_level);
+    VXGI::float3 const origin = GetClipmapStackLevelBounds(clipmap_center, stack_level).lower;
+    float const origin_array[3] = {origin.x, origin.y, origin.z};
+
+    int32_t lower[3];
+    float fraction[3];
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        float const f = (position[axis] - origin_array[axis]) / voxel_size - 0.5F;
+        float const f_floor = std::floor(f);
+        lower[axis] = static_cast<int32_t>(f_floor);
+        fraction[axis] = f - f_floor;
+    }
+
+    opacity = 0.0F;
+    radiance[0] = radiance[1] = radiance[2] = 0.0F;
+
+    int32_t const map_size = static_cast<int32_t>(BRX_VCT_CLIPMAP_MAP_SIZE);
+
+    for (uint32_t corner = 0U; corner < 8U; ++corner)
+    {
+        int32_t voxel[3];
+        float weight = 1.0F;
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            uint32_t const upper = (corner >> axis) & 1U;
+            voxel[axis] = std::min(std::max(lower[axis] + static_cast<int32_t>(upper), 0), map_size - 1);
+            weight *= (0U != upper) ? fraction[axis] : (1.0F - fraction[axis]);
+        }
+
+        float voxel_opacity;
+        float voxel_radiance[3];
+        voxels.Fetch(stack_level, static_cast<uint32_t>(voxel[0]), static_cast<uint32_t>(voxel[1]), static_cast<uint32_t>(voxel[2]), voxel_opacity, voxel_radiance);
+
+        opacity += weight * voxel_opacity;
+        radiance[0] += weight * voxel_radiance[0];
+        radiance[1] += weight * voxel_radiance[1];
+        radiance[2] += weight * voxel_radiance[2];
+    }
+}
+
+// the finest stack level whose region contains the position with a margin of one voxel (for the trilinear filter), or "BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT" when outside the clipmap
+static uint32_t GetFinestStackLevel(VXGI::float3 const &clipmap_center, float const position[3])
+{
+    float const distance = std::max(std::max(std::abs(position[0] - clipmap_center.x), std::abs(position[1] - clipmap_center.y)), std::abs(position[2] - clipmap_center.z));
+
+    for (uint32_t stack_level = 0U; stack_level < BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT; ++stack_level)
+    {
+        float const voxel_size = GetClipmapStackLevelVoxelSize(stack_level);
+        if (distance < ((0.5F * static_cast<float>(BRX_VCT_CLIPMAP_MAP_SIZE) - 1.0F) * voxel_size))
+        {
+            return stack_level;
+        }
+    }
+
+    return BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT;
+}
+
+template <typename VoxelSource>
+static void TraceConePacket(VoxelSource const &voxels, VXGI::float3 const &clipmap_center, CpuConeTracingParameters const &parameters, float max_distance, ConePacket const &packet, ConePacketResult &result, uint64_t &sample_count)
+{
+    float const finest_voxel_size = GetClipmapStackLevelVoxelSize(0U);
+
+    Float4 distance(parameters.start_offset * finest_voxel_size);
+    Float4 alpha(0.0F);
+    Float4 radiance[3] = {Float4(0.0F), Float4(0.0F), Float4(0.0F)};
+
+    Float4 aperture;
+    aperture.Load(packet.aperture);
+
+    Float4 origin[3];
+    Float4 direction[3];
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        origin[axis].Load(packet.origin[axis]);
+        direction[axis].Load(packet.direction[axis]);
+    }
+
+    uint32_t active_mask = packet.active_mask;
+
+    // the correction of the opacity for the step which is shorter than the voxel: 1 - (1 - a)^step_scale
+    float const step_scale = std::max(0.05F, parameters.step_scale);
+
+    for (uint32_t step = 0U; (0U != active_mask) && (step < parameters.max_step_count); ++step)
+    {
+        Float4 const diameter = Float4::Max(Float4(finest_voxel_size), Float4(2.0F) * aperture * distance);
+
+        float position[3][4];
+        float diameter_lanes[4];
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            (origin[axis] + direction[axis] * distance).Store(position[axis]);
+        }
+        diameter.Store(diameter_lanes);
+
+        float sample_opacity[4] = {0.0F, 0.0F, 0.0F, 0.0F};
+        float sample_radiance[3][4] = {{0.0F, 0.0F, 0.0F, 0.0F}, {0.0F, 0.0F, 0.0F, 0.0F}, {0.0F, 0.0F, 0.0F, 0.0F}};
+
+        for (uint32_t lane = 0U; lane < 4U; ++lane)
+        {
+            if (0U == (active_mask & (1U << lane)))
+            {
+                continue;
+            }
+
+            float const lane_position[3] = {position[0][lane], position[1][lane], position[2][lane]};
+
+            // the level of the diameter, but never finer than the stack levels containing the position
+            float const finest_stack_level = static_cast<float>(GetFinestStackLevel(clipmap_center, lane_position));
+            float const level = std::max(std::log2(diameter_lanes[lane] / finest_voxel_size), finest_stack_level);
+
+            if (level >= static_cast<float>(BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT - 1U))
+            {
+                if (finest_stack_level >= static_cast<float>(BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT))
+                {
+                    // outside the clipmap
+                    active_mask &= ~(1U << lane);
+                    continue;
+                }
+
+                float lane_radiance[3];
+                SampleStackLevel(voxels, clipmap_center, BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT - 1U, lane_position, sample_opacity[lane], lane_radiance);
+                sample_radiance[0][lane] = lane_radiance[0];
+                sample_radiance[1][lane] = lane_radiance[1];
+                sample_radiance[2][lane] = lane_radiance[2];
+                ++sample_count;
+            }
+            else
+            {
+                uint32_t const level_lower = static_cast<uint32_t>(level);
+                float const level_fraction = level - static_cast<float>(level_lower);
+
+                float opacity_lower;
+                float radiance_lower[3];
+                SampleStackLevel(voxels, clipmap_center, level_lower, lane_position, opacity_lower, radiance_lower);
+
+                float opacity_upper;
+                float radiance_upper[3];
+                SampleStackLevel(voxels, clipmap_center, level_lower + 1U, lane_position, opacity_upper, radiance_upper);
+
+                sample_opacity[lane] = opacity_lower + (opacity_upper - opacity_lower) * level_fraction;
+                for (int channel = 0; channel < 3; ++channel)
+                {
+                    sample_radiance[channel][lane] = radiance_lower[channel] + (radiance_upper[channel] - radiance_lower[channel]) * level_fraction;
+                }
+                sample_count += 2U;
+            }
+
+            sample_opacity[lane] = 1.0F - std::pow(std::max(0.0F, 1.0F - std::min(sample_opacity[lane], 1.0F)), step_scale);
+        }
+
+        // the front-to-back compositing of the active lanes
+        float active_lanes[4];
+        for (uint32_t lane = 0U; lane < 4U; ++lane)
+        {
+            active_lanes[lane] = (0U != (active_mask & (1U << lane))) ? 1.0F : 0.0F;
+        }
+
+        Float4 active;
+        active.Load(active_lanes);
+
+        Float4 opacity;
+        opacity.Load(sample_opacity);
+
+        Float4 const weight = active * (Float4(1.0F) - alpha) * opacity;
+        for (int channel = 0; channel < 3; ++channel)
+        {
+            Float4 channel_radiance;
+            channel_radiance.Load(sample_radiance[channel]);
+            radiance[channel] = radiance[channel] + weight * channel_radiance;
+        }
+        alpha = alpha + weight;
+
+        distance = distance + active * diameter * Float4(step_scale);
+
+        // the lanes which are saturated or beyond the max distance are retired
+        active_mask &= Float4::LessMask(alpha, Float4(0.99F)) & Float4::LessMask(distance, Float4(max_distance));
+    }
+
+    for (int channel = 0; channel < 3; ++channel)
+    {
+        radiance[channel].Store(result.radiance[channel]);
+    }
+    alpha.Store(result.opacity);
+}
+
+template <typename VoxelSource>
+static void TraceCones(VoxelSource const &voxels, VXGI::float3 const &clipmap_center, CpuConeTracingGBuffer const &gbuffer, CpuConeTracingParameters const &parameters, std::vector<float> &radiance_and_ambient, CpuConeTracingStatistics &statistics)
+{
+    std::chrono::steady_clock::time_point const begin = std::chrono::steady_clock::now();
+
+    radiance_and_ambient.assign(4U * static_cast<size_t>(gbuffer.width) * gbuffer.height, 0.0F);
+
+    float const max_distance = (parameters.max_distance > 0.0F) ? parameters.max_distance : (static_cast<float>(BRX_VCT_CLIPMAP_MAP_SIZE) * GetClipmapStackLevelVoxelSize(BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT - 1U));
+
+    // the diffuse cones in the tangent space (Z is the normal): a Fibonacci spiral over the hemisphere, weighted by the cosine
+    uint32_t const diffuse_cone_count = std::max(1U, parameters.diffuse_cone_count);
+    std::vector<VXGI::float3> diffuse_directions(diffuse_cone_count);
+    std::vector<float> diffuse_weights(diffuse_cone_count);
+    {
+        float weight_sum = 0.0F;
+        for (uint32_t cone = 0U; cone < diffuse_cone_count; ++cone)
+        {
+            float const cos_theta = 1.0F - (static_cast<float>(cone) + 0.5F) / static_cast<float>(diffuse_cone_count);
+            float const sin_theta = std::sqrt(std::max(0.0F, 1.0F - cos_theta * cos_theta));
+            float const phi = 2.39996323F * static_cast<float>(cone);
+
+            diffuse_directions[cone] = VXGI::float3(sin_theta * std::cos(phi), sin_theta * std::sin(phi), cos_theta);
+            diffuse_weights[cone] = cos_theta;
+            weight_sum += cos_theta;
+        }
+        for (float &weight : diffuse_weights)
+        {
+            weight /= weight_sum;
+        }
+    }
+
+    uint32_t thread_count = parameters.thread_count;
+    if (0U == thread_count)
+    {
+        thread_count = std::max(1U, static_cast<uint32_t>(std::thread::hardware_concurrency()));
+    }
+
+    std::atomic<uint32_t> next_row(0U);
+    std::vector<uint64_t> cone_counts(thread_count, 0U);
+    std::vector<uint64_t> sample_counts(thread_count, 0U);
+
+    VXGI::float4x4 const &m = gbuffer.view_proj_matrix_inv;
+
+    auto worker = [&](uint32_t thread_index) {
+        uint32_t y;
+        while ((y = next_row.fetch_add(1U)) < gbuffer.height)
+        {
+            for (uint32_t x_base = 0U; x_base < gbuffer.width; x_base += 4U)
+            {
+                // the surface of each lane
+                uint32_t surface_mask = 0U;
+                VXGI::float3 position[4];
+                VXGI::float3 normal[4];
+                VXGI::float3 tangent[4];
+                VXGI::float3 bitangent[4];
+                float roughness[4] = {0.0F, 0.0F, 0.0F, 0.0F};
+                VXGI::float3 diffuse_color[4];
+                VXGI::float3 specular_color[4];
+                VXGI::float3 reflection[4];
+
+                for (uint32_t lane = 0U; lane < 4U; ++lane)
+                {
+                    uint32_t const x = x_base + lane;
+                    if (x >= gbuffer.width)
+                    {
+                        continue;
+                    }
+
+                    size_t const pixel = static_cast<size_t>(y) * gbuffer.width + x;
+                    float const depth = gbuffer.depth[pixel];
+                    if (depth >= 1.0F)
+                    {
+                        continue;
+                    }
+
+                    float const window_x = (static_cast<float>(x) + 0.5F) * gbuffer.window_scale + gbuffer.window_offset[0];
+                    float const window_y = (static_cast<float>(y) + 0.5F) * gbuffer.window_scale + gbuffer.window_offset[1];
+                    float const ndc_x = window_x / static_cast<float>(gbuffer.window_width) * 2.0F - 1.0F;
+                    float const ndc_y = 1.0F - window_y / static_cast<float>(gbuffer.window_height) * 2.0F;
+
+                    // row vector
+                    float p[4];
+                    for (int column = 0; column < 4; ++column)
+                    {
+                        p[column] = ndc_x * m.m[column] + ndc_y * m.m[4 + column] + depth * m.m[8 + column] + m.m[12 + column];
+                    }
+                    position[lane] = VXGI::float3(p[0] / p[3], p[1] / p[3], p[2] / p[3]);
+
+                    float const *normal_and_roughness = gbuffer.normal_and_roughness + 4U * pixel;
+                    normal[lane] = Normalize(VXGI::float3(normal_and_roughness[0], normal_and_roughness[1], normal_and_roughness[2]));
+                    roughness[lane] = std::min(std::max(normal_and_roughness[3], 0.0F), 1.0F);
+
+                    VXGI::float3 const up = (std::abs(normal[lane].z) < 0.999F) ? VXGI::float3(0.0F, 0.0F, 1.0F) : VXGI::float3(1.0F, 0.0F, 0.0F);
+                    tangent[lane] = Normalize(Cross(up, normal[lane]));
+                    bitangent[lane] = Cross(normal[lane], tangent[lane]);
+
+                    // the same as "GetDiffuseAndSpecularColor"
+                    float const *base_color_and_metallic = gbuffer.base_color_and_metallic + 4U * pixel;
+                    VXGI::float3 const base_color(base_color_and_metallic[0], base_color_and_metallic[1], base_color_and_metallic[2]);
+                    float const metallic = base_color_and_metallic[3];
+                    diffuse_color[lane] = base_color - base_color * metallic;
+                    specular_color[lane] = VXGI::float3(0.04F - 0.04F * metallic) + base_color * metallic;
+
+                    VXGI::float3 const view = Normalize(position[lane] - gbuffer.camera_position);
+                    float const v_dot_n = view.x * normal[lane].x + view.y * normal[lane].y + view.z * normal[lane].z;
+                    reflection[lane] = Normalize(view - normal[lane] * (2.0F * v_dot_n));
+
+                    surface_mask |= (1U << lane);
+                }
+
+                if (0U == surface_mask)
+                {
+                    continue;
+                }
+
+                float irradiance[4][3] = {};
+                float ambient[4] = {0.0F, 0.0F, 0.0F, 0.0F};
+                float specular[4][3] = {};
+
+                ConePacket packet;
+                packet.active_mask = surface_mask;
+                for (uint32_t lane = 0U; lane < 4U; ++lane)
+                {
+                    packet.origin[0][lane] = position[lane].x;
+                    packet.origin[1][lane] = position[lane].y;
+                    packet.origin[2][lane] = position[lane].z;
+                }
+
+                for (uint32_t cone = 0U; cone < diffuse_cone_count; ++cone)
+                {
+                    for (uint32_t lane = 0U; lane < 4U; ++lane)
+                    {
+                        VXGI::float3 const &d = diffuse_directions[cone];
+                        VXGI::float3 const direction = tangent[lane] * d.x + bitangent[lane] * d.y + normal[lane] * d.z;
+                        packet.direction[0][lane] = direction.x;
+                        packet.direction[1][lane] = direction.y;
+                        packet.direction[2][lane] = direction.z;
+                        packet.aperture[lane] = parameters.diffuse_cone_aperture;
+                    }
+
+                    ConePacketResult result;
+                    TraceConePacket(voxels, clipmap_center, parameters, max_distance, packet, result, sample_counts[thread_index]);
+
+                    for (uint32_t lane = 0U; lane < 4U; ++lane)
+                    {
+                        irradiance[lane][0] += diffuse_weights[cone] * result.radiance[0][lane];
+                        irradiance[lane][1] += diffuse_weights[cone] * result.radiance[1][lane];
+                        irradiance[lane][2] += diffuse_weights[cone] * result.radiance[2][lane];
+                        ambient[lane] += diffuse_weights[cone] * (1.0F - result.opacity[lane]);
+                    }
+                }
+
+                if (parameters.enable_specular)
+                {
+                    for (uint32_t lane = 0U; lane < 4U; ++lane)
+                    {
+                        packet.direction[0][lane] = reflection[lane].x;
+                        packet.direction[1][lane] = reflection[lane].y;
+                        packet.direction[2][lane] = reflection[lane].z;
+
+                        // the aperture of the specular lobe, but never narrower than the finest voxel at the start of the cone
+                        packet.aperture[lane] = std::max(roughness[lane] * roughness[lane], 0.5F / std::max(parameters.start_offset, 1.0F));
+                    }
+
+                    ConePacketResult result;
+                    TraceConePacket(voxels, clipmap_center, parameters, max_distance, packet, result, sample_counts[thread_index]);
+
+                    for (uint32_t lane = 0U; lane < 4U; ++lane)
+                    {
+                        specular[lane][0] = result.radiance[0][lane];
+                        specular[lane][1] = result.radiance[1][lane];
+                        specular[lane][2] = result.radiance[2][lane];
+                    }
+                }
+
+                for (uint32_t lane = 0U; lane < 4U; ++lane)
+                {
+                    if (0U == (surface_mask & (1U << lane)))
+                    {
+                        continue;
+                    }
+
+                    float *output = &radiance_and_ambient[4U * (static_cast<size_t>(y) * gbuffer.width + x_base + lane)];
+                    output[0] = diffuse_color[lane].x * irradiance[lane][0] + specular_color[lane].x * specular[lane][0];
+                    output[1] = diffuse_color[lane].y * irradiance[lane][1] + specular_color[lane].y * specular[lane][1];
+                    output[2] = diffuse_color[lane].z * irradiance[lane][2] + specular_color[lane].z * specular[lane][2];
+                    output[3] = ambient[lane];
+
+                    cone_counts[thread_index] += diffuse_cone_count + (parameters.enable_specular ? 1U : 0U);
+                }
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (uint32_t thread_index = 1U; thread_index < thread_count; ++thread_index)
+    {
+        threads.emplace_back(worker, thread_index);
+    }
+    worker(0U);
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+
+    statistics.cone_count = 0U;
+    statistics.sample_count = 0U;
+    for (uint32_t thread_index = 0U; thread_index < thread_count; ++thread_index)
+    {
+        statistics.cone_count += cone_counts[thread_index];
+        statistics.sample_count += sample_counts[thread_index];
+    }
+
+    statistics.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+}
+
+void TraceConesCpu(CpuVoxelClipmap const &clipmap, VXGI::float3 const &clipmap_center, CpuConeTracingGBuffer const &gbuffer, CpuConeTracingParameters const &parameters, std::vector<float> &radiance_and_ambient, CpuConeTracingStatistics &statistics)
+{
+    DenseVoxelSource const voxels = {clipmap};
+    TraceCones(voxels, clipmap_center, gbuffer, parameters, radiance_and_ambient, statistics);
+}
+
+void TraceConesCpu(CompactVoxelClipmap const &clipmap, VXGI::float3 const &clipmap_center, CpuConeTracingGBuffer const &gbuffer, CpuConeTracingParameters const &parameters, std::vector<float> &radiance_and_ambient, CpuConeTracingStatistics &statistics)
+{
+    CompactVoxelSource const voxels = {clipmap};
+    TraceCones(voxels, clipmap_center, gbuffer, parameters, radiance_and_ambient, statistics);
+}
+
+void CompareConeTracingImages(float const *image, float const *golden_image, uint32_t width, uint32_t height, double &radiance_rmse, double &ambient_rmse, float &max_error)
+{
+    double radiance_error_sum = 0.0;
+    double ambient_error_sum = 0.0;
+    max_error = 0.0F;
+
+    size_t const pixel_count = static_cast<size_t>(width) * height;
+    for (size_t pixel = 0U; pixel < pixel_count; ++pixel)
+    {
+        for (uint32_t channel = 0U; channel < 4U; ++channel)
+        {
+            float const error = image[4U * pixel + channel] - golden_image[4U * pixel + channel];
+
+            if (channel < 3U)
+            {
+                radiance_error_sum += static_cast<double>(error) * error;
+            }
+            else
+            {
+                ambient_error_sum += static_cast<double>(error) * error;
+            }
+
+            max_error = std::max(max_error, std::abs(error));
+        }
+    }
+
+    radiance_rmse = (pixel_count > 0U) ? std::sqrt(radiance_error_sum / (3.0 * static_cast<double>(pixel_count))) : 0.0;
+    ambient_rmse = (pixel_count > 0U) ? std::sqrt(ambient_error_sum / static_cast<double>(pixel_count)) : 0.0;
+}
+
+void RenderCpuConeTracingGBuffer(CpuVoxelClipmap const &clipmap, VXGI::float3 const &clipmap_center, VXGI::float4x4 const &view_proj_matrix, VXGI::float3 const &camera_position, uint32_t width, uint32_t height, float roughness, CpuConeTracingGBufferImage &image, CpuConeTracingGBuffer &gbuffer)
+{
+    size_t const pixel_count = static_cast<size_t>(width) * height;
+    image.depth.assign(pixel_count, 1.0F);
+    image.normal_and_roughness.assign(4U * pixel_count, 0.0F);
+    image.base_color_and_metallic.assign(4U * pixel_count, 0.0F);
+
+    gbuffer.width = width;
+    gbuffer.height = height;
+    gbuffer.depth = image.depth.data();
+    gbuffer.normal_and_roughness = image.normal_and_roughness.data();
+    gbuffer.base_color_and_metallic = image.base_color_and_metallic.data();
+    gbuffer.view_proj_matrix_inv = view_proj_matrix.invert();
+    gbuffer.camera_position = camera_position;
+    gbuffer.window_scale = 1.0F;
+    gbuffer.window_offset[0] = 0.0F;
+    gbuffer.window_offset[1] = 0.0F;
+    gbuffer.window_width = width;
+    gbuffer.window_height = height;
+
+    VXGI::float4x4 const &m = gbuffer.view_proj_matrix_inv;
+
+    // the rays which leave the coarsest stack level do not enter it again
+    float const coarsest_voxel_size = GetClipmapStackLevelVoxelSize(BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT - 1U);
+    VXGI::float3 const camera_offset = camera_position - clipmap_center;
+    float const max_distance = std::sqrt(camera_offset.x * camera_offset.x + camera_offset.y * camera_offset.y + camera_offset.z * camera_offset.z) + static_cast<float>(BRX_VCT_CLIPMAP_MAP_SIZE) * coarsest_voxel_size;
+
+    for (uint32_t y = 0U; y < height; ++y)
+    {
+        for (uint32_t x = 0U; x < width; ++x)
+        {
+            size_t const pixel = static_cast<size_t>(y) * width + x;
+
+            float const ndc_x = (static_cast<float>(x) + 0.5F) / static_cast<float>(width) * 2.0F - 1.0F;
+            float const ndc_y = 1.0F - (static_cast<float>(y) + 0.5F) / static_cast<float>(height) * 2.0F;
+
+            // any depth between the near and the far planes is in front of the camera, whichever the direction of the depth
+            float p[4];
+            for (int column = 0; column < 4; ++column)
+            {
+                p[column] = ndc_x * m.m[column] + ndc_y * m.m[4 + column] + 0.5F * m.m[8 + column] + m.m[12 + column];
+            }
+            VXGI::float3 const direction = Normalize(VXGI::float3(p[0] / p[3], p[1] / p[3], p[2] / p[3]) - camera_position);
+            float const direction_array[3] = {direction.x, direction.y, direction.z};
+
+            int32_t previous_voxel[3] = {0, 0, 0};
+            uint32_t previous_stack_level = BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT;
+
+            for (float distance = 0.0F; distance < max_distance;)
+            {
+                float const position[3] = {camera_position.x + direction.x * distance, camera_position.y + direction.y * distance, camera_position.z + direction.z * distance};
+
+                uint32_t const stack_level = GetFinestStackLevel(clipmap_center, position);
+                if (stack_level >= BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT)
+                {
+                    previous_stack_level = BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT;
+                    distance += 0.5F * coarsest_voxel_size;
+                    continue;
+                }
+
+                float const voxel_size = GetClipmapStackLevelVoxelSize(stack_level);
+                VXGI::float3 const origin = GetClipmapStackLevelBounds(clipmap_center, stack_level).lower;
+                float const origin_array[3] = {origin.x, origin.y, origin.z};
+
+                int32_t voxel[3];
+                for (int axis = 0; axis < 3; ++axis)
+                {
+                    voxel[axis] = std::min(std::max(static_cast<int32_t>(std::floor((position[axis] - origin_array[axis]) / voxel_size)), 0), static_cast<int32_t>(BRX_VCT_CLIPMAP_MAP_SIZE) - 1);
+                }
+
+                size_t const voxel_index = GetCpuVoxelIndex(stack_level, static_cast<uint32_t>(voxel[0]), static_cast<uint32_t>(voxel[1]), static_cast<uint32_t>(voxel[2]));
+                if (static_cast<float>(GetCpuVoxelOpacity(clipmap, voxel_index) & 0x3FFU) >= (0.5F * 1023.0F))
+                {
+                    // the face which is entered, or the dominant axis of the direction when the previous step was in another stack level (or in the same voxel)
+                    int normal_axis = -1;
+                    if (previous_stack_level == stack_level)
+                    {
+                        for (int axis = 0; axis < 3; ++axis)
+                        {
+                            if ((previous_voxel[axis] != voxel[axis]) && ((normal_axis < 0) || (std::abs(direction_array[axis]) > std::abs(direction_array[normal_axis]))))
+                            {
+                                normal_axis = axis;
+                            }
+                        }
+                    }
+                    if (normal_axis < 0)
+                    {
+                        normal_axis = (std::abs(direction.x) >= std::abs(direction.y)) ? ((std::abs(direction.x) >= std::abs(direction.z)) ? 0 : 2) : ((std::abs(direction.y) >= std::abs(direction.z)) ? 1 : 2);
+                    }
+
+                    float *normal_and_roughness = &image.normal_and_roughness[4U * pixel];
+                    normal_and_roughness[normal_axis] = (direction_array[normal_axis] > 0.0F) ? -1.0F : 1.0F;
+                    normal_and_roughness[3] = roughness;
+
+                    float *base_color_and_metallic = &image.base_color_and_metallic[4U * pixel];
+                    base_color_and_metallic[0] = base_color_and_metallic[1] = base_color_and_metallic[2] = 0.5F;
+                    base_color_and_metallic[3] = 0.0F;
+
+                    // row vector
+                    float clip[4];
+                    for (int column = 0; column < 4; ++column)
+                    {
+                        clip[column] = position[0] * view_proj_matrix.m[column] + position[1] * view_proj_matrix.m[4 + column] + position[2] * view_proj_matrix.m[8 + column] + view_proj_matrix.m[12 + column];
+                    }
+                    image.depth[pixel] = std::min(std::max(clip[2] / clip[3], 0.0F), 0.999999F);
+                    break;
+                }
+
+                std::copy(voxel, voxel + 3, previous_voxel);
+                previous_stack_level = stack_level;
+                distance += 0.5F * voxel_size;
+            }
+        }
+    }
+}
+
+void CompareConeTracingConfigurations(CpuVoxelClipmap const &clipmap, VXGI::float3 const &clipmap_center, CpuConeTracingGBuffer const &gbuffer, CpuConeTracingParameters const &parameters, CpuConeTracingParameters const &golden_parameters, std::vector<CpuConeTracingComparison> &comparisons)
+{
+    comparisons.clear();
+
+    std::vector<float> golden_image;
+    CpuConeTracingStatistics golden_statistics;
+    TraceConesCpu(clipmap, clipmap_center, gbuffer, golden_parameters, golden_image, golden_statistics);
+
+    std::vector<float> image;
+    CpuConeTracingStatistics statistics;
+
+    auto compare = [&](char const *name) {
+        CpuConeTracingComparison comparison;
+        comparison.name = name;
+        comparison.parameters = parameters;
+        comparison.seconds = statistics.seconds;
+        comparison.sample_count = statistics.sample_count;
+        CompareConeTracingImages(image.data(), golden_image.data(), gbuffer.width, gbuffer.height, comparison.radiance_rmse, comparison.ambient_rmse, comparison.max_error);
+        comparisons.push_back(comparison);
+    };
+
+    TraceConesCpu(clipmap, clipmap_center, gbuffer, parameters, image, statistics);
+    compare("dense");
+
+    {
+        CompactVoxelClipmap compact_clipmap;
+        ResolveCompactVoxelClipmapCpu(clipmap, VoxelOpacityEncoding::UNORM8, VoxelRadianceEncoding::RGB9E5, parameters.thread_count, compact_clipmap);
+        TraceConesCpu(compact_clipmap, clipmap_center, gbuffer, parameters, image, statistics);
+        compare("compact UNORM8 RGB9E5");
+    }
+
+    {
+        CompactVoxelClipmap compact_clipmap;
+        ResolveCompactVoxelClipmapCpu(clipmap, VoxelOpacityEncoding::UNORM8, VoxelRadianceEncoding::R11G11B10, parameters.thread_count, compact_clipmap);
+        TraceConesCpu(compact_clipmap, clipmap_center, gbuffer, parameters, image, statistics);
+        compare("compact UNORM8 R11G11B10");
+    }
+}
+
+uint32_t CompareConeTracingWithShader(CpuVoxelClipmap const &clipmap, VXGI::float3 const &clipmap_center, CpuConeTracingGBuffer const &gbuffer, float const *shader_image, CpuConeTracingParameters const &parameters, std::vector<CpuConeTracingComparison> &comparisons)
+{
+    comparisons.clear();
+
+    // the shader may write the pixels without a surface, which the CPU tracer skips
+    size_t const pixel_count = static_cast<size_t>(gbuffer.width) * gbuffer.height;
+    std::vector<float> surface_shader_image(shader_image, shader_image + 4U * pixel_count);
+    for (size_t pixel = 0U; pixel < pixel_count; ++pixel)
+    {
+        if (gbuffer.depth[pixel] >= 1.0F)
+        {
+            std::fill(&surface_shader_image[4U * pixel], &surface_shader_image[4U * pixel] + 4U, 0.0F);
+        }
+    }
+
+    // the cone counts, the apertures (the half angles of 15, 22.5, 30 and 45 degrees) and the steps, which select the stack levels together
+    uint32_t const diffuse_cone_counts[] = {6U, 16U};
+    float const diffuse_cone_apertures[] = {0.268F, 0.414F, 0.577F, 1.0F};
+    float const step_scales[] = {0.25F, 0.5F, 1.0F};
+
+    uint32_t best_comparison = 0U;
+
+    std::vector<float> image;
+    for (uint32_t const diffuse_cone_count : diffuse_cone_counts)
+    {
+        for (float const diffuse_cone_aperture : diffuse_cone_apertures)
+        {
+            for (float const step_scale : step_scales)
+            {
+                CpuConeTracingComparison comparison;
+                comparison.name = "shader";
+                comparison.parameters = parameters;
+                comparison.parameters.diffuse_cone_count = diffuse_cone_count;
+                comparison.parameters.diffuse_cone_aperture = diffuse_cone_aperture;
+                comparison.parameters.step_scale = step_scale;
+
+                CpuConeTracingStatistics statistics;
+                TraceConesCpu(clipmap, clipmap_center, gbuffer, comparison.parameters, image, statistics);
+
+                comparison.seconds = statistics.seconds;
+                comparison.sample_count = statistics.sample_count;
+                CompareConeTracingImages(image.data(), surface_shader_image.data(), gbuffer.width, gbuffer.height, comparison.radiance_rmse, comparison.ambient_rmse, comparison.max_error);
+
+                if ((!comparisons.empty()) && (comparison.radiance_rmse < comparisons[best_comparison].radiance_rmse))
+                {
+                    best_comparison = static_cast<uint32_t>(comparisons.size());
+                }
+                comparisons.push_back(comparison);
+            }
+        }
+    }
+
+    return best_comparison;
+}
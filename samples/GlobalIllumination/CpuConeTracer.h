@@ -0,0 +1,115 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include "GFSDK_VXGI_MathTypes.h"
+#include "CpuVoxelizer.h"
+#include "VoxelEncoding.h"
+
+// The CPU cone tracer, which traces the clipmap of the CPU voxelizer (see "CpuVoxelizer.h") from a G-buffer, so that the quality and the cost of the tracing parameters and of the voxel storages can be measured without a GPU.
+// The diffuse cones are distributed over the hemisphere around the normal (weighted by the cosine), and the specular cone follows the reflection with the aperture of the roughness.
+// Each step advances by a fraction of the cone diameter, and the stack level is selected by the diameter (but never finer than the finest stack level containing the sample), blending the 2 nearest stack levels.
+// The body of MyConeTracingCS is in the brx library, which is not part of this sample, thus the tracer is matched to the shader by "CompareConeTracingWithShader" rather than by its source: the aperture, the step and the cone count which reproduce the output of the shader on the same G-buffer and the same clipmap are the ones the other comparisons use.
+// The cones of 4 neighbouring pixels are traced as a packet by SSE (a scalar fallback is used without SSE), and the rows are distributed over the worker threads.
+
+struct CpuConeTracingGBuffer
+{
+    uint32_t width;
+    uint32_t height;
+
+    // 1 x "float" per pixel: the depth in NDC (1 is the far plane and the pixel is skipped)
+    float const *depth;
+
+    // 4 x "float" per pixel: the normal in world space and the roughness
+    float const *normal_and_roughness;
+
+    // 4 x "float" per pixel: the base color and the metallic
+    float const *base_color_and_metallic;
+
+    VXGI::float4x4 view_proj_matrix_inv;
+    VXGI::float3 camera_position;
+
+    // the pixel (x, y) is at the window position "(x + 0.5) x window_scale + window_offset" of a window of "window_width" x "window_height", the same as the samples of the reduced resolution "MyConeTracingCS"
+    // 1 and 0 when the pixels are the window
+    float window_scale;
+    float window_offset[2];
+    uint32_t window_width;
+    uint32_t window_height;
+};
+
+struct CpuConeTracingParameters
+{
+    uint32_t diffuse_cone_count;
+
+    // tan of the half angle
+    float diffuse_cone_aperture;
+
+    // the step is "step_scale" x the diameter of the cone
+    float step_scale;
+
+    // in the finest voxels, to avoid the self intersection
+    float start_offset;
+
+    uint32_t max_step_count;
+
+    // in world units, 0 means the extent of the coarsest stack level
+    float max_distance;
+
+    bool enable_specular;
+
+    // 0 means one thread per hardware thread
+    uint32_t thread_count;
+
+    CpuConeTracingParameters()
+        : diffuse_cone_count(6U), diffuse_cone_aperture(0.577F), step_scale(0.5F), start_offset(1.5F), max_step_count(128U), max_distance(0.0F), enable_specular(true), thread_count(0U)
+    {
+    }
+};
+
+struct CpuConeTracingStatistics
+{
+    uint64_t cone_count;
+    uint64_t sample_count;
+    double seconds;
+};
+
+// 4 x "float" per pixel (the same as "g_radiance_and_ambient"): the indirect radiance (diffuse and specular) and the ambient visibility of the diffuse cones
+void TraceConesCpu(CpuVoxelClipmap const &clipmap, VXGI::float3 const &clipmap_center, CpuConeTracingGBuffer const &gbuffer, CpuConeTracingParameters const &parameters, std::vector<float> &radiance_and_ambient, CpuConeTracingStatistics &statistics);
+
+// the same, but each voxel is decoded from the compact encodings (to measure the error of the encodings on the final image)
+void TraceConesCpu(CompactVoxelClipmap const &clipmap, VXGI::float3 const &clipmap_center, CpuConeTracingGBuffer const &gbuffer, CpuConeTracingParameters const &parameters, std::vector<float> &radiance_and_ambient, CpuConeTracingStatistics &statistics);
+
+// the golden image comparison of 2 images of "TraceConesCpu"
+void CompareConeTracingImages(float const *image, float const *golden_image, uint32_t width, uint32_t height, double &radiance_rmse, double &ambient_rmse, float &max_error);
+
+// the storage of "CpuConeTracingGBuffer"
+struct CpuConeTracingGBufferImage
+{
+    std::vector<float> depth;
+    std::vector<float> normal_and_roughness;
+    std::vector<float> base_color_and_metallic;
+};
+
+// The G-buffer of the clipmap itself, so that the comparison does not depend on the rasterization of the GPU: the ray of each pixel is marched through the finest stack level containing the position, and stops at the first voxel whose opacity is at least 0.5.
+// The normal is the face of the voxel which is entered, the base color is gray and the metallic is 0.
+void RenderCpuConeTracingGBuffer(CpuVoxelClipmap const &clipmap, VXGI::float3 const &clipmap_center, VXGI::float4x4 const &view_proj_matrix, VXGI::float3 const &camera_position, uint32_t width, uint32_t height, float roughness, CpuConeTracingGBufferImage &image, CpuConeTracingGBuffer &gbuffer);
+
+struct CpuConeTracingComparison
+{
+    char const *name;
+    CpuConeTracingParameters parameters;
+    double seconds;
+    uint64_t sample_count;
+    double radiance_rmse;
+    double ambient_rmse;
+    float max_error;
+};
+
+// The comparison harness: the dense clipmap traced with "golden_parameters" is the golden image, and the dense and the compact (see "VoxelEncoding.h") storages are traced with "parameters" and compared with it.
+// The first result is the dense storage, thus the error of the parameters alone, and the others add the error of the storage.
+void CompareConeTracingConfigurations(CpuVoxelClipmap const &clipmap, VXGI::float3 const &clipmap_center, CpuConeTracingGBuffer const &gbuffer, CpuConeTracingParameters const &parameters, CpuConeTracingParameters const &golden_parameters, std::vector<CpuConeTracingComparison> &comparisons);
+
+// The test against the shader: "shader_image" is the "g_radiance_and_ambient" written by MyConeTracingCS from the G-buffer "gbuffer" and the clipmap "clipmap" (both read back from the GPU).
+// The G-buffer is traced on the CPU with the cone counts, the apertures and the steps around "parameters", and each image is compared with the output of the shader on the pixels of the surfaces.
+// Returns the index of the comparison with the least radiance error, whose parameters match the shader best.
+uint32_t CompareConeTracingWithShader(CpuVoxelClipmap const &clipmap, VXGI::float3 const &clipmap_center, CpuConeTracingGBuffer const &gbuffer, float const *shader_image, CpuConeTracingParameters const &parameters, std::vector<CpuConeTracingComparison> &comparisons);
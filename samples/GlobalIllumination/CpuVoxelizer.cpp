@@ -0,0 +1,625 @@
+#include "CpuVoxelizer.h"
+#include "Clipmap.h"
+#include "../../thirdparty/Voxel-Cone-Tracing/include/brx_voxel_cone_tracing_resource.h"
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE__)
+#include <xmmintrin.h>
+#define CPU_VOXELIZER_SSE 1
+#else
+#define CPU_VOXELIZER_SSE 0
+#endif
+
+namespace
+{
+    // in the voxels of the stack level (the voxel "i" is [i, i + 1])
+    struct Triangle
+    {
+        float p[3][3];
+        float normal[3];
+
+        // the projection plane is (u, v) and the depth is d
+        int d;
+        int u;
+        int v;
+
+        // the edge functions in the projection plane: e(u, v) = a * u + b * v + c >= 0 inside
+        float edge_a[3];
+        float edge_b[3];
+        float edge_c[3];
+
+        int32_t lower[3];
+        int32_t upper[3];
+
+        CpuVoxelizerMesh const *mesh;
+        float texcoords[3][2];
+
+        // the directions which the normal faces (one per axis with the non-zero component) and the packed emittance weighted for each of them
+        uint32_t direction_count;
+        uint32_t directions[3];
+        uint32_t emittance[3][3];
+    };
+
+    uint32_t const TILE_COUNT_PER_AXIS = (BRX_VCT_CLIPMAP_MAP_SIZE + CPU_VOXELIZER_TILE_SIZE - 1U) / CPU_VOXELIZER_TILE_SIZE;
+    uint32_t const TILE_COUNT_PER_STACK_LEVEL = TILE_COUNT_PER_AXIS * TILE_COUNT_PER_AXIS * TILE_COUNT_PER_AXIS;
+}
+
+static inline void Cross(float const a[3], float const b[3], float c[3])
+{
+    c[0] = a[1] * b[2] - a[2] * b[1];
+    c[1] = a[2] * b[0] - a[0] * b[2];
+    c[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+static inline float Dot(float const a[3], float const b[3])
+{
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+// the separating axis test of Akenine-Moller with the box of the voxel
+static bool TriangleOverlapsVoxel(Triangle const &triangle, int32_t const voxel[3])
+{
+    float const center[3] = {static_cast<float>(voxel[0]) + 0.5F, static_cast<float>(voxel[1]) + 0.5F, static_cast<float>(voxel[2]) + 0.5F};
+
+    float v[3][3];
+    for (int i = 0; i < 3; ++i)
+    {
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            v[i][axis] = triangle.p[i][axis] - center[axis];
+        }
+    }
+
+    float e[3][3];
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        e[0][axis] = v[1][axis] - v[0][axis];
+        e[1][axis] = v[2][axis] - v[1][axis];
+        e[2][axis] = v[0][axis] - v[2][axis];
+    }
+
+    // the 9 cross products of the edges and the box axes
+    for (int edge = 0; edge < 3; ++edge)
+    {
+        for (int box_axis = 0; box_axis < 3; ++box_axis)
+        {
+            float unit[3] = {0.0F, 0.0F, 0.0F};
+            unit[box_axis] = 1.0F;
+
+            float axis[3];
+            Cross(e[edge], unit, axis);
+
+            float const p0 = Dot(v[0], axis);
+            float const p1 = Dot(v[1], axis);
+            float const p2 = Dot(v[2], axis);
+            float const radius = 0.5F * (std::abs(axis[0]) + std::abs(axis[1]) + std::abs(axis[2]));
+
+            if ((std::min(std::min(p0, p1), p2) > radius) || (std::max(std::max(p0, p1), p2) < -radius))
+            {
+                return false;
+            }
+        }
+    }
+
+    // the box axes are tested by the bounds of the triangle and the normal of the triangle is tested by the depth range of the column
+    return true;
+}
+
+static bool SetupTriangle(float const world_positions[3][3], VXGI::float3 const &origin, float voxel_size, Triangle &triangle)
+{
+    float const origin_array[3] = {origin.x, origin.y, origin.z};
+
+    for (int i = 0; i < 3; ++i)
+    {
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            triangle.p[i][axis] = (world_positions[i][axis] - origin_array[axis]) / voxel_size;
+        }
+    }
+
+    float const e0[3] = {triangle.p[1][0] - triangle.p[0][0], triangle.p[1][1] - triangle.p[0][1], triangle.p[1][2] - triangle.p[0][2]};
+    float const e1[3] = {triangle.p[2][0] - triangle.p[0][0], triangle.p[2][1] - triangle.p[0][1], triangle.p[2][2] - triangle.p[0][2]};
+    Cross(e0, e1, triangle.normal);
+
+    float const abs_normal[3] = {std::abs(triangle.normal[0]), std::abs(triangle.normal[1]), std::abs(triangle.normal[2])};
+
+    // degenerate
+    if (!((abs_normal[0] + abs_normal[1] + abs_normal[2]) > 0.0F))
+    {
+        return false;
+    }
+
+    triangle.d = ((abs_normal[0] >= abs_normal[1]) && (abs_normal[0] >= abs_normal[2])) ? 0 : ((abs_normal[1] >= abs_normal[2]) ? 1 : 2);
+    triangle.u = (triangle.d + 1) % 3;
+    triangle.v = (triangle.d + 2) % 3;
+
+    // the orientation of the projected triangle is the sign of the dominant component of the normal
+    float const orientation = (triangle.normal[triangle.d] >= 0.0F) ? 1.0F : -1.0F;
+
+    for (int edge = 0; edge < 3; ++edge)
+    {
+        float const *a = triangle.p[edge];
+        float const *b = triangle.p[(edge + 1) % 3];
+
+        triangle.edge_a[edge] = -(b[triangle.v] - a[triangle.v]) * orientation;
+        triangle.edge_b[edge] = (b[triangle.u] - a[triangle.u]) * orientation;
+        triangle.edge_c[edge] = -(triangle.edge_a[edge] * a[triangle.u] + triangle.edge_b[edge] * a[triangle.v]);
+    }
+
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        float const lower = std::min(std::min(triangle.p[0][axis], triangle.p[1][axis]), triangle.p[2][axis]);
+        float const upper = std::max(std::max(triangle.p[0][axis], triangle.p[1][axis]), triangle.p[2][axis]);
+
+        // inclusive: the triangle touching the face of a voxel overlaps it
+        triangle.lower[axis] = std::max(0, static_cast<int32_t>(std::ceil(lower)) - 1);
+        triangle.upper[axis] = std::min(static_cast<int32_t>(BRX_VCT_CLIPMAP_MAP_SIZE) - 1, static_cast<int32_t>(std::floor(upper)));
+
+        if (triangle.lower[axis] > triangle.upper[axis])
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// the bit "i" is set when the column (u + i, v) may overlap the projected triangle (the max of each edge function over the square of the column is not negative)
+static inline uint32_t OverlapColumns4(Triangle const &triangle, int32_t u, int32_t v)
+{
+#if CPU_VOXELIZER_SSE
+    __m128 const center_u = _mm_add_ps(_mm_set1_ps(static_cast<float>(u) + 0.5F), _mm_set_ps(3.0F, 2.0F, 1.0F, 0.0F));
+    float const center_v = static_cast<float>(v) + 0.5F;
+
+    __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+    for (int edge = 0; edge < 3; ++edge)
+    {
+        float const offset = triangle.edge_b[edge] * center_v + triangle.edge_c[edge] + 0.5F * (std::abs(triangle.edge_a[edge]) + std::abs(triangle.edge_b[edge]));
+        __m128 const value = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(triangle.edge_a[edge]), center_u), _mm_set1_ps(offset));
+        inside = _mm_and_ps(inside, _mm_cmpge_ps(value, _mm_setzero_ps()));
+    }
+    return static_cast<uint32_t>(_mm_movemask_ps(inside));
+#else
+    uint32_t overlap = 0U;
+    for (uint32_t i = 0U; i < 4U; ++i)
+    {
+        float const center_u = static_cast<float>(u + static_cast<int32_t>(i)) + 0.5F;
+        float const center_v = static_cast<float>(v) + 0.5F;
+
+        bool inside = true;
+        for (int edge = 0; edge < 3; ++edge)
+        {
+            inside = inside && ((triangle.edge_a[edge] * center_u + triangle.edge_b[edge] * center_v + triangle.edge_c[edge] + 0.5F * (std::abs(triangle.edge_a[edge]) + std::abs(triangle.edge_b[edge]))) >= 0.0F);
+        }
+        overlap |= (inside ? (1U << i) : 0U);
+    }
+    return overlap;
+#endif
+}
+
+// the texel of the base color texture at the center of the column, interpolated by the barycentric coordinates of the projected triangle
+static uint32_t GetColumnBaseColor(Triangle const &triangle, int32_t column_u, int32_t column_v)
+{
+    CpuVoxelizerMesh const &mesh = *triangle.mesh;
+    if ((NULL == mesh.base_color_texels) || (0U == mesh.base_color_width) || (0U == mesh.base_color_height))
+    {
+        return 0U;
+    }
+
+    float const center_u = static_cast<float>(column_u) + 0.5F;
+    float const center_v = static_cast<float>(column_v) + 0.5F;
+
+    // the edge "i" (from the vertex "i" to "i + 1") is opposite to the vertex "i + 2", the center outside of the triangle is clamped to the nearest edge
+    float weights[3];
+    float weight_sum = 0.0F;
+    for (int edge = 0; edge < 3; ++edge)
+    {
+        weights[(edge + 2) % 3] = std::max(0.0F, triangle.edge_a[edge] * center_u + triangle.edge_b[edge] * center_v + triangle.edge_c[edge]);
+        weight_sum += weights[(edge + 2) % 3];
+    }
+
+    float texcoord[2] = {0.0F, 0.0F};
+    for (int i = 0; i < 3; ++i)
+    {
+        float const weight = (weight_sum > 0.0F) ? (weights[i] / weight_sum) : (1.0F / 3.0F);
+        texcoord[0] += weight * triangle.texcoords[i][0];
+        texcoord[1] += weight * triangle.texcoords[i][1];
+    }
+
+    int32_t const width = static_cast<int32_t>(mesh.base_color_width);
+    int32_t const height = static_cast<int32_t>(mesh.base_color_height);
+    int32_t const texel_x = ((static_cast<int32_t>(std::floor(texcoord[0] * static_cast<float>(width))) % width) + width) % width;
+    int32_t const texel_y = ((static_cast<int32_t>(std::floor(texcoord[1] * static_cast<float>(height))) % height) + height) % height;
+
+    return mesh.base_color_texels[static_cast<size_t>(texel_y) * mesh.base_color_width + texel_x];
+}
+
+static void VoxelizeTile(std::vector<Triangle> const &triangles, std::vector<uint32_t> const &tile_triangles, uint32_t stack_level, uint32_t tile, CpuVoxelClipmap &clipmap, uint64_t &voxel_write_count, uint64_t &discarded_fragment_count)
+{
+    int32_t const tile_coordinates[3] = {
+        static_cast<int32_t>(tile % TILE_COUNT_PER_AXIS),
+        static_cast<int32_t>((tile / TILE_COUNT_PER_AXIS) % TILE_COUNT_PER_AXIS),
+        static_cast<int32_t>(tile / (TILE_COUNT_PER_AXIS * TILE_COUNT_PER_AXIS))};
+
+    int32_t tile_lower[3];
+    int32_t tile_upper[3];
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        tile_lower[axis] = tile_coordinates[axis] * static_cast<int32_t>(CPU_VOXELIZER_TILE_SIZE);
+        tile_upper[axis] = std::min(tile_lower[axis] + static_cast<int32_t>(CPU_VOXELIZER_TILE_SIZE), static_cast<int32_t>(BRX_VCT_CLIPMAP_MAP_SIZE)) - 1;
+    }
+
+    for (uint32_t const triangle_index : tile_triangles)
+    {
+        Triangle const &triangle = triangles[triangle_index];
+
+        int32_t lower[3];
+        int32_t upper[3];
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            lower[axis] = std::max(triangle.lower[axis], tile_lower[axis]);
+            upper[axis] = std::min(triangle.upper[axis], tile_upper[axis]);
+        }
+
+        int const d = triangle.d;
+        int const u = triangle.u;
+        int const v = triangle.v;
+
+        // the depth of the plane of the triangle: depth(u, v) = depth_c + depth_u * u + depth_v * v
+        float const depth_u = -triangle.normal[u] / triangle.normal[d];
+        float const depth_v = -triangle.normal[v] / triangle.normal[d];
+        float const depth_c = triangle.p[0][d] - depth_u * triangle.p[0][u] - depth_v * triangle.p[0][v];
+        float const depth_radius = 0.5F * (std::abs(depth_u) + std::abs(depth_v));
+
+        uint32_t const opacity_voxel_texel_count = clipmap.opacity_extent[0] / BRX_VCT_CLIPMAP_MAP_SIZE;
+        uint32_t const illumination_voxel_group_count = clipmap.illumination_extent[0] / (3U * BRX_VCT_CLIPMAP_MAP_SIZE);
+
+        for (int32_t column_v = lower[v]; column_v <= upper[v]; ++column_v)
+        {
+            for (int32_t column_u_base = lower[u]; column_u_base <= upper[u]; column_u_base += 4)
+            {
+                uint32_t columns = OverlapColumns4(triangle, column_u_base, column_v);
+
+                while (0U != columns)
+                {
+                    uint32_t i = 0U;
+                    while (0U == (columns & (1U << i)))
+                    {
+                        ++i;
+                    }
+                    columns &= ~(1U << i);
+
+                    int32_t const column_u = column_u_base + static_cast<int32_t>(i);
+                    if (column_u > upper[u])
+                    {
+                        break;
+                    }
+
+                    // the range of the depth of the plane over the square of the column
+                    float const depth_center = depth_c + depth_u * (static_cast<float>(column_u) + 0.5F) + depth_v * (static_cast<float>(column_v) + 0.5F);
+                    int32_t const depth_lower = std::max(lower[d], static_cast<int32_t>(std::ceil(depth_center - depth_radius)) - 1);
+                    int32_t const depth_upper = std::min(upper[d], static_cast<int32_t>(std::floor(depth_center + depth_radius)));
+
+                    // the opacity is sampled once per column, the same as the pixel of the voxelization which covers the column
+                    uint32_t const base_color = (depth_lower <= depth_upper) ? GetColumnBaseColor(triangle, column_u, column_v) : 0U;
+                    float const opacity = static_cast<float>(base_color >> 24U) / 255.0F;
+                    uint32_t const packed_opacity = PackCpuVoxelOpacity(opacity);
+
+                    uint32_t packed_surface[2];
+                    if (opacity >= 0.5F)
+                    {
+                        VXGI::float3 const base_color_rgb(static_cast<float>(base_color & 0xFFU) / 255.0F, static_cast<float>((base_color >> 8U) & 0xFFU) / 255.0F, static_cast<float>((base_color >> 16U) & 0xFFU) / 255.0F);
+                        PackCpuVoxelSurface(base_color_rgb, triangle.mesh->metallic, VXGI::float3(triangle.normal[0], triangle.normal[1], triangle.normal[2]), triangle.mesh->roughness, packed_surface);
+                    }
+
+                    for (int32_t depth = depth_lower; depth <= depth_upper; ++depth)
+                    {
+                        int32_t voxel[3];
+                        voxel[d] = depth;
+                        voxel[u] = column_u;
+                        voxel[v] = column_v;
+
+                        if (!TriangleOverlapsVoxel(triangle, voxel))
+                        {
+                            continue;
+                        }
+
+                        if (opacity < 0.5F)
+                        {
+                            ++discarded_fragment_count;
+                            continue;
+                        }
+
+                        size_t const row = static_cast<size_t>(static_cast<uint32_t>(voxel[2]) + stack_level * BRX_VCT_CLIPMAP_MAP_SIZE) * BRX_VCT_CLIPMAP_MAP_SIZE + static_cast<uint32_t>(voxel[1]);
+                        uint32_t *const voxel_opacity = &clipmap.opacity[row * clipmap.opacity_extent[0] + opacity_voxel_texel_count * static_cast<uint32_t>(voxel[0])];
+                        uint32_t *const voxel_emittance = &clipmap.emittance[row * clipmap.illumination_extent[0] + 3U * illumination_voxel_group_count * static_cast<uint32_t>(voxel[0])];
+
+                        for (uint32_t i = 0U; i < triangle.direction_count; ++i)
+                        {
+                            uint32_t const opacity_texel = (triangle.directions[i] * opacity_voxel_texel_count) / CPU_VOXELIZER_DIRECTION_COUNT;
+                            voxel_opacity[opacity_texel] = std::max(voxel_opacity[opacity_texel], packed_opacity);
+
+                            uint32_t const illumination_group = (triangle.directions[i] * illumination_voxel_group_count) / CPU_VOXELIZER_DIRECTION_COUNT;
+                            voxel_emittance[3U * illumination_group + 0U] += triangle.emittance[i][0];
+                            voxel_emittance[3U * illumination_group + 1U] += triangle.emittance[i][1];
+                            voxel_emittance[3U * illumination_group + 2U] += triangle.emittance[i][2];
+                        }
+
+                        size_t const voxel_index = GetCpuVoxelIndex(stack_level, static_cast<uint32_t>(voxel[0]), static_cast<uint32_t>(voxel[1]), static_cast<uint32_t>(voxel[2]));
+                        clipmap.surface[2U * voxel_index + 0U] = packed_surface[0];
+                        clipmap.surface[2U * voxel_index + 1U] = packed_surface[1];
+
+                        ++voxel_write_count;
+                    }
+                }
+            }
+        }
+    }
+}
+
+double CpuVoxelizerStatistics::GetTrianglesPerSecond() const
+{
+    return (seconds > 0.0) ? (static_cast<double>(triangle_count) / seconds) : 0.0;
+}
+
+double CpuVoxelizerStatistics::GetVoxelsPerSecond() const
+{
+    return (seconds > 0.0) ? (static_cast<double>(voxel_write_count) / seconds) : 0.0;
+}
+
+bool GetCpuVoxelClipmapExtent(uint32_t extent[3], uint32_t opacity_extent[3], uint32_t illumination_extent[3])
+{
+    extent[0] = BRX_VCT_CLIPMAP_MAP_SIZE;
+    extent[1] = BRX_VCT_CLIPMAP_MAP_SIZE;
+    extent[2] = BRX_VCT_CLIPMAP_MAP_SIZE * BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT;
+
+    DirectX::XMUINT3 const brx_opacity_extent = brx_voxel_cone_tracing_resource_clipmap_opacity_texture_extent();
+    opacity_extent[0] = brx_opacity_extent.x;
+    opacity_extent[1] = brx_opacity_extent.y;
+    opacity_extent[2] = brx_opacity_extent.z;
+
+    DirectX::XMUINT3 const brx_illumination_extent = brx_voxel_cone_tracing_resource_clipmap_illumination_texture_extent();
+    illumination_extent[0] = brx_illumination_extent.x;
+    illumination_extent[1] = brx_illumination_extent.y;
+    illumination_extent[2] = brx_illumination_extent.z;
+
+    // at least one texel per voxel, and one RGB group per voxel
+    return (opacity_extent[1] == extent[1]) && (opacity_extent[2] == extent[2]) && (opacity_extent[0] >= extent[0]) && (0U == (opacity_extent[0] % extent[0])) &&
+           (illumination_extent[1] == extent[1]) && (illumination_extent[2] == extent[2]) && (illumination_extent[0] >= (3U * extent[0])) && (0U == (illumination_extent[0] % (3U * extent[0])));
+}
+
+size_t GetCpuVoxelIndex(uint32_t stack_level, uint32_t x, uint32_t y, uint32_t z)
+{
+    return (static_cast<size_t>(z + stack_level * BRX_VCT_CLIPMAP_MAP_SIZE) * BRX_VCT_CLIPMAP_MAP_SIZE + y) * BRX_VCT_CLIPMAP_MAP_SIZE + x;
+}
+
+size_t GetCpuVoxelCount(CpuVoxelClipmap const &clipmap)
+{
+    return static_cast<size_t>(clipmap.extent[0]) * clipmap.extent[1] * clipmap.extent[2];
+}
+
+uint32_t GetCpuVoxelOpacity(CpuVoxelClipmap const &clipmap, size_t voxel_index)
+{
+    uint32_t const voxel_texel_count = clipmap.opacity_extent[0] / clipmap.extent[0];
+    size_t const row = voxel_index / clipmap.extent[0];
+    uint32_t const x = static_cast<uint32_t>(voxel_index % clipmap.extent[0]);
+
+    uint32_t const *const voxel_opacity = &clipmap.opacity[row * clipmap.opacity_extent[0] + voxel_texel_count * x];
+    return *std::max_element(voxel_opacity, voxel_opacity + voxel_texel_count);
+}
+
+void GetCpuVoxelEmittance(CpuVoxelClipmap const &clipmap, size_t voxel_index, uint32_t packed_emittance[3])
+{
+    uint32_t const voxel_group_count = clipmap.illumination_extent[0] / (3U * clipmap.extent[0]);
+    size_t const row = voxel_index / clipmap.extent[0];
+    uint32_t const x = static_cast<uint32_t>(voxel_index % clipmap.extent[0]);
+
+    uint32_t const *const voxel_emittance = &clipmap.emittance[row * clipmap.illumination_extent[0] + 3U * voxel_group_count * x];
+
+    packed_emittance[0] = 0U;
+    packed_emittance[1] = 0U;
+    packed_emittance[2] = 0U;
+    for (uint32_t group = 0U; group < voxel_group_count; ++group)
+    {
+        packed_emittance[0] += voxel_emittance[3U * group + 0U];
+        packed_emittance[1] += voxel_emittance[3U * group + 1U];
+        packed_emittance[2] += voxel_emittance[3U * group + 2U];
+    }
+}
+
+uint32_t PackCpuVoxelOpacity(float opacity)
+{
+    return static_cast<uint32_t>(1023.0F * opacity);
+}
+
+void PackCpuVoxelEmittanceForAtomic(VXGI::float3 const &emittance, uint32_t packed_emittance[3])
+{
+    float const fixed_point_scale = static_cast<float>(1U << 20);
+
+    packed_emittance[0] = static_cast<uint32_t>(emittance.x * fixed_point_scale);
+    packed_emittance[1] = static_cast<uint32_t>(emittance.y * fixed_point_scale);
+    packed_emittance[2] = static_cast<uint32_t>(emittance.z * fixed_point_scale);
+}
+
+void PackCpuVoxelSurface(VXGI::float3 const &base_color, float metallic, VXGI::float3 const &normal, float roughness, uint32_t packed_surface[2])
+{
+    auto saturate = [](float value) { return std::min(std::max(value, 0.0F), 1.0F); };
+    auto pack = [](float value, float scale) { return static_cast<uint32_t>(std::floor(value * scale + 0.5F)); };
+
+    // "OctahedralEncode"
+    float const length = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+    float octahedral[2] = {(length > 0.0F) ? (normal.x / length) : 0.0F, (length > 0.0F) ? (normal.y / length) : 0.0F};
+    if ((length > 0.0F) && (normal.z < 0.0F))
+    {
+        float const x = octahedral[0];
+        float const y = octahedral[1];
+        octahedral[0] = (1.0F - std::abs(y)) * ((x >= 0.0F) ? 1.0F : -1.0F);
+        octahedral[1] = (1.0F - std::abs(x)) * ((y >= 0.0F) ? 1.0F : -1.0F);
+    }
+
+    packed_surface[0] = pack(saturate(base_color.x), 255.0F) | (pack(saturate(base_color.y), 255.0F) << 8U) | (pack(saturate(base_color.z), 255.0F) << 16U) | (pack(saturate(metallic), 127.0F) << 24U) | (1U << 31U);
+    packed_surface[1] = pack(octahedral[0] * 0.5F + 0.5F, 4095.0F) | (pack(octahedral[1] * 0.5F + 0.5F, 4095.0F) << 12U) | (pack(saturate(roughness), 255.0F) << 24U);
+}
+
+bool VoxelizeClipmapCpu(CpuVoxelizerMesh const *meshes, uint32_t mesh_count, VXGI::float3 const &clipmap_center, uint32_t thread_count, CpuVoxelClipmap &clipmap, CpuVoxelizerStatistics &statistics)
+{
+    std::chrono::steady_clock::time_point const begin = std::chrono::steady_clock::now();
+
+    if (!GetCpuVoxelClipmapExtent(clipmap.extent, clipmap.opacity_extent, clipmap.illumination_extent))
+    {
+        return false;
+    }
+
+    clipmap.opacity.assign(static_cast<size_t>(clipmap.opacity_extent[0]) * clipmap.opacity_extent[1] * clipmap.opacity_extent[2], 0U);
+    clipmap.emittance.assign(static_cast<size_t>(clipmap.illumination_extent[0]) * clipmap.illumination_extent[1] * clipmap.illumination_extent[2], 0U);
+    clipmap.surface.assign(2U * GetCpuVoxelCount(clipmap), 0U);
+
+    statistics.triangle_count = 0U;
+    statistics.voxel_write_count = 0U;
+    statistics.discarded_fragment_count = 0U;
+    statistics.occupied_voxel_count = 0U;
+
+    // the triangles of each stack level, and the triangles overlapping each tile
+    std::vector<Triangle> triangles[BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT];
+    std::vector<std::vector<uint32_t>> tile_triangles(BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT * TILE_COUNT_PER_STACK_LEVEL);
+
+    for (uint32_t stack_level = 0U; stack_level < BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT; ++stack_level)
+    {
+        float const voxel_size = GetClipmapStackLevelVoxelSize(stack_level);
+        VXGI::float3 const origin = GetClipmapStackLevelBounds(clipmap_center, stack_level).lower;
+
+        for (uint32_t mesh_index = 0U; mesh_index < mesh_count; ++mesh_index)
+        {
+            CpuVoxelizerMesh const &mesh = meshes[mesh_index];
+
+            for (uint32_t index = 0U; (index + 2U) < mesh.index_count; index += 3U)
+            {
+                if (0U == stack_level)
+                {
+                    ++statistics.triangle_count;
+                }
+
+                float world_positions[3][3];
+                float texcoords[3][2] = {};
+                bool valid = true;
+                for (int i = 0; i < 3; ++i)
+                {
+                    uint32_t const vertex = mesh.indices[index + i];
+                    valid = valid && (vertex < mesh.vertex_count);
+                    for (int axis = 0; valid && (axis < 3); ++axis)
+                    {
+                        world_positions[i][axis] = mesh.positions[3U * vertex + axis];
+                    }
+                    for (int axis = 0; valid && (NULL != mesh.texcoords) && (axis < 2); ++axis)
+                    {
+                        texcoords[i][axis] = mesh.texcoords[2U * vertex + axis];
+                    }
+                }
+
+                Triangle triangle;
+                if ((!valid) || (!SetupTriangle(world_positions, origin, voxel_size, triangle)))
+                {
+                    continue;
+                }
+
+                triangle.mesh = &mesh;
+                std::copy(&texcoords[0][0], &texcoords[0][0] + 6, &triangle.texcoords[0][0]);
+
+                float const normal_length_squared = Dot(triangle.normal, triangle.normal);
+                triangle.direction_count = 0U;
+                for (uint32_t axis = 0U; axis < 3U; ++axis)
+                {
+                    if (0.0F != triangle.normal[axis])
+                    {
+                        float const weight = triangle.normal[axis] * triangle.normal[axis] / normal_length_squared;
+
+                        triangle.directions[triangle.direction_count] = 2U * axis + ((triangle.normal[axis] < 0.0F) ? 1U : 0U);
+                        PackCpuVoxelEmittanceForAtomic(VXGI::float3(mesh.emittance.x * weight, mesh.emittance.y * weight, mesh.emittance.z * weight), triangle.emittance[triangle.direction_count]);
+                        ++triangle.direction_count;
+                    }
+                }
+
+                uint32_t const triangle_index = static_cast<uint32_t>(triangles[stack_level].size());
+                triangles[stack_level].push_back(triangle);
+
+                for (int32_t tile_z = triangle.lower[2] / static_cast<int32_t>(CPU_VOXELIZER_TILE_SIZE); tile_z <= triangle.upper[2] / static_cast<int32_t>(CPU_VOXELIZER_TILE_SIZE); ++tile_z)
+                {
+                    for (int32_t tile_y = triangle.lower[1] / static_cast<int32_t>(CPU_VOXELIZER_TILE_SIZE); tile_y <= triangle.upper[1] / static_cast<int32_t>(CPU_VOXELIZER_TILE_SIZE); ++tile_y)
+                    {
+                        for (int32_t tile_x = triangle.lower[0] / static_cast<int32_t>(CPU_VOXELIZER_TILE_SIZE); tile_x <= triangle.upper[0] / static_cast<int32_t>(CPU_VOXELIZER_TILE_SIZE); ++tile_x)
+                        {
+                            uint32_t const tile = (static_cast<uint32_t>(tile_z) * TILE_COUNT_PER_AXIS + static_cast<uint32_t>(tile_y)) * TILE_COUNT_PER_AXIS + static_cast<uint32_t>(tile_x);
+                            tile_triangles[stack_level * TILE_COUNT_PER_STACK_LEVEL + tile].push_back(triangle_index);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    if (0U == thread_count)
+    {
+        thread_count = std::max(1U, static_cast<uint32_t>(std::thread::hardware_concurrency()));
+    }
+
+    std::atomic<uint32_t> next_tile(0U);
+    // [thread][stack level]
+    std::vector<uint64_t> voxel_write_counts(thread_count * BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT, 0U);
+    std::vector<uint64_t> discarded_fragment_counts(thread_count * BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT, 0U);
+
+    auto worker = [&](uint32_t thread_index) {
+        uint32_t tile;
+        while ((tile = next_tile.fetch_add(1U)) < static_cast<uint32_t>(tile_triangles.size()))
+        {
+            if (!tile_triangles[tile].empty())
+            {
+                uint32_t const stack_level = tile / TILE_COUNT_PER_STACK_LEVEL;
+                size_t const count_index = thread_index * BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT + stack_level;
+                VoxelizeTile(triangles[stack_level], tile_triangles[tile], stack_level, tile % TILE_COUNT_PER_STACK_LEVEL, clipmap, voxel_write_counts[count_index], discarded_fragment_counts[count_index]);
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (uint32_t thread_index = 1U; thread_index < thread_count; ++thread_index)
+    {
+        threads.emplace_back(worker, thread_index);
+    }
+    worker(0U);
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+
+    size_t const stack_level_voxel_count = static_cast<size_t>(BRX_VCT_CLIPMAP_MAP_SIZE) * BRX_VCT_CLIPMAP_MAP_SIZE * BRX_VCT_CLIPMAP_MAP_SIZE;
+
+    for (uint32_t stack_level = 0U; stack_level < BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT; ++stack_level)
+    {
+        statistics.stack_level_voxel_write_counts[stack_level] = 0U;
+        statistics.stack_level_discarded_fragment_counts[stack_level] = 0U;
+        for (uint32_t thread_index = 0U; thread_index < thread_count; ++thread_index)
+        {
+            statistics.stack_level_voxel_write_counts[stack_level] += voxel_write_counts[thread_index * BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT + stack_level];
+            statistics.stack_level_discarded_fragment_counts[stack_level] += discarded_fragment_counts[thread_index * BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT + stack_level];
+        }
+
+        statistics.stack_level_occupied_voxel_counts[stack_level] = 0U;
+        for (size_t voxel_index = stack_level * stack_level_voxel_count; voxel_index < ((stack_level + 1U) * stack_level_voxel_count); ++voxel_index)
+        {
+            statistics.stack_level_occupied_voxel_counts[stack_level] += (0U != GetCpuVoxelOpacity(clipmap, voxel_index)) ? 1U : 0U;
+        }
+
+        statistics.voxel_write_count += statistics.stack_level_voxel_write_counts[stack_level];
+        statistics.discarded_fragment_count += statistics.stack_level_discarded_fragment_counts[stack_level];
+        statistics.occupied_voxel_count += statistics.stack_level_occupied_voxel_counts[stack_level];
+    }
+
+    statistics.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    return true;
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include "GFSDK_VXGI_MathTypes.h"
+#include "../../thirdparty/Voxel-Cone-Tracing/include/brx_voxel_cone_tracing.h"
+
+// The CPU reference of the voxelization (MyVoxelizationVS / MyVoxelizationPS), so that the voxels can be validated, profiled and baked without a GPU.
+// Each triangle is projected along the dominant axis of its normal (the same as "Scene::GetMeshDominantAxisDrawArguments") into each stack level, and the voxels are selected by the exact (inclusive) triangle/box overlap test.
+// The stack levels are split into tiles of "CPU_VOXELIZER_TILE_SIZE"^3 voxels which are voxelized by the worker threads, so that no voxel is written by two threads.
+// The opacity of each fragment is the alpha of the base color texture and the fragments below 0.5 are discarded, the same as the voxelization pixel shader.
+// The voxels are written in the layout of the opacity and the illumination textures of the clipmap ("brx_voxel_cone_tracing_resource_clipmap_*_texture_extent") and packed as "VxgiPackOpacity" and "VxgiPackEmittanceForAtomic".
+// The voxel "x" covers the texels [k * x, k * (x + 1)) along the X axis of each texture, which are split evenly between the 6 directions (the order of "ANISOTROPIC_CLIPMAP_DIRECTION"), and the illumination texels are RGB interleaved.
+// The fragment is written to the directions which its normal faces: the full opacity, and the emittance weighted by the square of the component of the normal.
+// The voxel surface (see "PackVoxelSurface") is the material of the last fragment of the voxel, with the face normal instead of the normal map and the material factors instead of the roughness metallic texture.
+
+static uint32_t const CPU_VOXELIZER_TILE_SIZE = 32U;
+
+static uint32_t const CPU_VOXELIZER_DIRECTION_COUNT = 6U;
+
+struct CpuVoxelizerMesh
+{
+    // world space, 3 x "float" per vertex
+    float const *positions;
+    uint32_t vertex_count;
+
+    // 2 x "float" per vertex, NULL without the base color texture
+    float const *texcoords;
+
+    uint32_t const *indices;
+    uint32_t index_count;
+
+    // RGBA8, row by row without padding, point sampled with the wrap mode
+    // NULL is the null texture of the renderer whose alpha is 0, thus all fragments are discarded
+    uint32_t const *base_color_texels;
+    uint32_t base_color_width;
+    uint32_t base_color_height;
+
+    VXGI::float3 emittance;
+
+    // the factors of the material, only written to the voxel surface
+    float metallic;
+    float roughness;
+};
+
+struct CpuVoxelClipmap
+{
+    // the voxels: "BRX_VCT_CLIPMAP_MAP_SIZE" x "BRX_VCT_CLIPMAP_MAP_SIZE" x ("BRX_VCT_CLIPMAP_MAP_SIZE" * "BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT")
+    uint32_t extent[3];
+
+    // "brx_voxel_cone_tracing_resource_clipmap_opacity_texture_extent": the max of the packed opacity of the fragments
+    uint32_t opacity_extent[3];
+    std::vector<uint32_t> opacity;
+
+    // "brx_voxel_cone_tracing_resource_clipmap_illumination_texture_extent": the sum of the packed emittance of the fragments
+    uint32_t illumination_extent[3];
+    std::vector<uint32_t> emittance;
+
+    // "SceneRenderer::GetVoxelSurfaceTextureDesc": 2 x "uint" per voxel in the order of "GetCpuVoxelIndex", 0 where no fragment is written
+    std::vector<uint32_t> surface;
+};
+
+struct CpuVoxelizerStatistics
+{
+    uint64_t triangle_count;
+
+    // the (triangle, voxel) pairs which overlap
+    uint64_t voxel_write_count;
+
+    // the (triangle, voxel) pairs which overlap but whose fragment is discarded by "opacity < 0.5"
+    uint64_t discarded_fragment_count;
+
+    uint64_t occupied_voxel_count;
+
+    uint64_t stack_level_voxel_write_counts[BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT];
+    uint64_t stack_level_discarded_fragment_counts[BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT];
+    uint64_t stack_level_occupied_voxel_counts[BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT];
+
+    double seconds;
+
+    double GetTrianglesPerSecond() const;
+    double GetVoxelsPerSecond() const;
+};
+
+// false when the extents of the textures are not in the layout above
+bool GetCpuVoxelClipmapExtent(uint32_t extent[3], uint32_t opacity_extent[3], uint32_t illumination_extent[3]);
+
+// "((z + stack_level * BRX_VCT_CLIPMAP_MAP_SIZE) * BRX_VCT_CLIPMAP_MAP_SIZE + y) * BRX_VCT_CLIPMAP_MAP_SIZE + x"
+size_t GetCpuVoxelIndex(uint32_t stack_level, uint32_t x, uint32_t y, uint32_t z);
+
+size_t GetCpuVoxelCount(CpuVoxelClipmap const &clipmap);
+
+// the max of the packed opacity over the directions
+uint32_t GetCpuVoxelOpacity(CpuVoxelClipmap const &clipmap, size_t voxel_index);
+
+// the sum of the packed emittance over the directions
+void GetCpuVoxelEmittance(CpuVoxelClipmap const &clipmap, size_t voxel_index, uint32_t packed_emittance[3]);
+
+// the same as "VxgiPackOpacity"
+uint32_t PackCpuVoxelOpacity(float opacity);
+
+// the same as "VxgiPackEmittanceForAtomic"
+void PackCpuVoxelEmittanceForAtomic(VXGI::float3 const &emittance, uint32_t packed_emittance[3]);
+
+// the same as "PackVoxelSurface", the normal is normalized
+void PackCpuVoxelSurface(VXGI::float3 const &base_color, float metallic, VXGI::float3 const &normal, float roughness, uint32_t packed_surface[2]);
+
+// the clipmap center should be snapped (see "brx_voxel_cone_tracing_voxelization_compute_clipmap_center")
+// 0 threads means one thread per hardware thread
+// false when the extents of the textures are not in the layout above
+bool VoxelizeClipmapCpu(CpuVoxelizerMesh const *meshes, uint32_t mesh_count, VXGI::float3 const &clipmap_center, uint32_t thread_count, CpuVoxelClipmap &clipmap, CpuVoxelizerStatistics &statistics);
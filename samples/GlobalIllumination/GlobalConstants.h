@@ -24,6 +24,23 @@ __declspec(align(16)) struct GlobalConstants
     uint32_t enableIndirectSpecular;
     float transparentRoughness;
     float transparentReflectance;
+    uint32_t writeVoxelSurface;
+    uint32_t voxelStatisticsEnable;
+    uint32_t indirectIrradiancePass;
+    uint32_t indirectIrradianceFrame;
+    uint32_t indirectIrradiancePeriod;
+    float indirectIrradianceBlend;
+    float indirectIrradianceScale;
+    uint32_t indirectIrradianceVoxelLowerX;
+    uint32_t indirectIrradianceVoxelLowerY;
+    uint32_t indirectIrradianceVoxelLowerZ;
+    uint32_t indirectIrradianceVoxelUpperX;
+    uint32_t indirectIrradianceVoxelUpperY;
+    uint32_t indirectIrradianceVoxelUpperZ;
+    uint32_t deriveCoarseStackLevels;
+    uint32_t deriveStackLevel;
+    uint32_t voxelRadianceEncoding;
+    uint32_t indirectIrradianceCompactVoxels;
 };
 #elif defined(HLSL_VERSION) || defined(__HLSL_VERSION)
 
@@ -46,6 +63,23 @@ cbuffer GlobalConstants : register(b0)
     uint g_EnableIndirectSpecular;
     float g_TransparentRoughness;
     float g_TransparentReflectance;
+    uint g_WriteVoxelSurface;
+    uint g_VoxelStatisticsEnable;
+    uint g_IndirectIrradiancePass;
+    uint g_IndirectIrradianceFrame;
+    uint g_IndirectIrradiancePeriod;
+    float g_IndirectIrradianceBlend;
+    float g_IndirectIrradianceScale;
+    uint g_IndirectIrradianceVoxelLowerX;
+    uint g_IndirectIrradianceVoxelLowerY;
+    uint g_IndirectIrradianceVoxelLowerZ;
+    uint g_IndirectIrradianceVoxelUpperX;
+    uint g_IndirectIrradianceVoxelUpperY;
+    uint g_IndirectIrradianceVoxelUpperZ;
+    uint g_DeriveCoarseStackLevels;
+    uint g_DeriveStackLevel;
+    uint g_VoxelRadianceEncoding;
+    uint g_IndirectIrradianceCompactVoxels;
 }
 
 #else
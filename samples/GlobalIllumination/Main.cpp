@@ -16,9 +16,20 @@
 #endif
 
 #include "SceneRenderer.h"
+#include "Clipmap.h"
+#include "ClipmapSnapshot.h"
+#include "ClipmapSnapshotBake.h"
+#include "ParameterTuner.h"
+#include "TracingGovernor.h"
+#include "TracingGovernorTraces.h"
+#include "CpuConeTracer.h"
+#include "AnisotropicClipmap.h"
 #include "Camera.h"
 #include "SDKmisc.h"
 #include <AntTweakBar.h>
+#include <DirectXPackedVector.h>
+#include <cstdarg>
+#include <deque>
 
 #if USE_D3D11
 
@@ -40,12 +51,17 @@ NVRHI::RendererInterfaceD3D12 *g_pRendererInterface = NULL;
 
 #ifndef NDEBUG
 #include "shaders\D3D\Debug\MyConeTracingCS.inl"
+#include "shaders\D3D\Debug\MyConeTracingDownsampleCS.inl"
+#include "shaders\D3D\Debug\MyConeTracingUpsampleCS.inl"
 #else
 #include "shaders\D3D\Release\MyConeTracingCS.inl"
+#include "shaders\D3D\Release\MyConeTracingDownsampleCS.inl"
+#include "shaders\D3D\Release\MyConeTracingUpsampleCS.inl"
 #endif
 
 #include "BindingHelpers.h"
 #include "shaders\GBufferLoader.hlsli"
+#include "ConeTracingConstants.h"
 #include <d3dcompiler.h>
 
 #include "..\..\thirdparty\Voxel-Cone-Tracing\include\brx_voxel_cone_tracing.h"
@@ -79,16 +95,889 @@ static bool g_bEnableGI = true;
 static bool g_bRenderHUD = true;
 static bool g_bInitialized = false;
 static float g_fSamplingRate = 1.0f;
+static VXGI::TracingResolution::Enum g_TracingResolution = VXGI::TracingResolution::QUARTER;
+static float g_fTracingStep = 1.0f;
 static float g_fQuality = 0.1f;
 static int g_nMapSize = BRX_VCT_CLIPMAP_MAP_SIZE;
 static bool g_bDrawTransparent = false;
 static float g_TransparentRoughness = 0.1f;
 static float g_TransparentReflectance = 0.1f;
 static bool g_bTemporalFiltering = true;
+static bool g_bUseClipmapSnapshots = true;
+static bool g_bBakeClipmapSnapshot = false;
+static char const *const g_ClipmapSnapshotDirectory = "ClipmapSnapshots";
+
+static bool g_bClipmapAnchorHysteresis = true;
+
+// "-validate-voxelization" keeps the geometry of the scene on the CPU, then "V" voxelizes the static layer by "VoxelizeClipmapCpu" around the clipmap center of the static layer and compares the occupied voxels with the opacity texture of the static layer
+static bool g_bCpuVoxelizationGeometry = false;
+static bool g_bValidateVoxelization = false;
+ClipmapAnchorController g_ClipmapAnchorController;
+
+// "C" reads back the G-buffer and the output of the reduced resolution "MyConeTracingCS" and the working clipmap which it sampled, and traces the same G-buffer on the CPU (see "CompareConeTracingWithShader")
+// The parameters which match the shader best are then used by the CPU cone tracing of "V"
+static bool g_bValidateConeTracing = false;
+CpuConeTracingParameters g_CpuConeTracingParameters;
+DirectX::XMFLOAT3 g_TracingClipmapCenter;
 
 VXGI::IBasicViewTracer::InputBuffers g_InputBuffersPrev;
 bool g_InputBuffersPrevValid = false;
 
+// The persistent layer of the static meshes, which is copied into "g_clipmap_opacity_texture" and "g_clipmap_illumination_texture" before the dynamic meshes are voxelized on top.
+NVRHI::TextureHandle g_clipmap_static_opacity_texture = NULL;
+NVRHI::TextureHandle g_clipmap_static_illumination_texture = NULL;
+bool g_StaticLayerValid = false;
+DirectX::XMFLOAT3 g_StaticLayerClipmapAnchor;
+DirectX::XMFLOAT3 g_StaticLayerClipmapCenter;
+VXGI::float3 g_StaticLayerLightDirection;
+bool g_DynamicLayerPrev = false;
+bool g_StaticLayerFromSnapshot = false;
+bool g_StaticLayerChanged = false;
+
+// The material of each voxel of the static layer, so that only the illumination is injected again (by a compute pass) when only the light changes.
+// The voxel surface is not available when the static layer is uploaded from a snapshot.
+static bool g_bLightOnlyInjection = true;
+
+// The inner half of each coarser stack level of the static layer is derived from the finer stack level (see "SceneRenderer::DeriveCoarseStackLevels") instead of voxelizing the same triangles again.
+// The multi-bounce is not gathered for the derived voxels, since the voxel surface is only written by the voxelization.
+static bool g_bDeriveCoarseStackLevels = false;
+static bool g_StaticLayerDerived = false;
+
+// The light-only injection either walks the voxels of the voxel surface or the texels of the shadow map (see "ShadowMapLightInjection.h")
+enum class LightInjectionMode
+{
+    VOXEL_SURFACE,
+    SHADOW_MAP
+};
+
+static LightInjectionMode g_LightInjectionMode = LightInjectionMode::VOXEL_SURFACE;
+NVRHI::TextureHandle g_clipmap_static_surface_texture = NULL;
+NVRHI::TextureHandle g_clipmap_build_surface_texture = NULL;
+bool g_StaticLayerSurfaceValid = false;
+bool g_StaticLayerBuildSurfaceValid = false;
+char const *g_LastLightChange = "none";
+
+// The multi-bounce of the custom cone tracing (see "SceneRenderer::UpdateIndirectIrradiance"), since the indirect irradiance map of VXGI is not traced by "MyConeTracingCS".
+// The indirect irradiance of the voxel surface of the static layer is gathered again for a fraction of the voxels per frame, and blended with the irradiance of the previous updates.
+static float g_fMultiBounceUpdateFraction = 0.125f;
+static float g_fMultiBounceBlend = 0.25f;
+NVRHI::TextureHandle g_clipmap_indirect_irradiance_texture = NULL;
+bool g_IndirectIrradianceValid = false;
+bool g_IndirectIrradianceApplied = false;
+DirectX::XMFLOAT3 g_IndirectIrradianceClipmapCenter;
+VXGI::float3 g_IndirectIrradianceLightDirection;
+float g_IndirectIrradianceScale = 0.0f;
+uint32_t g_IndirectIrradianceFrame = 0U;
+
+// The working clipmap is resolved into the compact encodings (see "SceneRenderer::ResolveCompactVoxels") before the multi-bounce update, whose cones then read 1 byte of opacity and 4 bytes of radiance per voxel instead of the accumulation.
+static bool g_bCompactVoxels = true;
+static VoxelRadianceEncoding g_CompactVoxelRadianceEncoding = VoxelRadianceEncoding::RGB9E5;
+NVRHI::TextureHandle g_clipmap_compact_opacity_texture = NULL;
+NVRHI::TextureHandle g_clipmap_compact_radiance_texture = NULL;
+
+// The static layer around a new clipmap center is voxelized into "g_clipmap_build_opacity_texture" and "g_clipmap_build_illumination_texture" over several frames (see "ClipmapStackLevelScheduler").
+// The previous static layer and clipmap anchor are used until the build completes, and the build is swapped in at the beginning of the next frame.
+static bool g_bTimeSlicedVoxelization = true;
+ClipmapStackLevelScheduler g_ClipmapStackLevelScheduler;
+NVRHI::TextureHandle g_clipmap_build_opacity_texture = NULL;
+NVRHI::TextureHandle g_clipmap_build_illumination_texture = NULL;
+bool g_StaticLayerBuildActive = false;
+uint32_t g_StaticLayerBuildPendingMask = 0U;
+DirectX::XMFLOAT3 g_StaticLayerBuildClipmapAnchor;
+DirectX::XMFLOAT3 g_StaticLayerBuildClipmapCenter;
+VXGI::float3 g_StaticLayerBuildLightDirection;
+bool g_StaticLayerBuildFromSnapshot = false;
+uint64_t g_StaticLayerBuildScrolledVoxels[BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT];
+uint64_t g_StaticLayerBuildRevoxelizedVoxels[BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT];
+
+// When the clipmap center moves, the voxels which stay inside each stack level are copied from the current static layer (see "CopyClipmapOverlap"), and only the scrolled slabs are cleared and voxelized
+static bool g_bClipmapOverlapCopy = true;
+uint32_t g_StaticLayerBuildOverlapMask = 0U;
+DirectX::XMFLOAT3 g_StaticLayerBuildPreviousClipmapCenter;
+uint32_t g_StackLevelsVoxelized = 0U;
+
+// The voxels which scrolled into the clipmap by the last move of the clipmap center, compared with the voxels which are re-voxelized
+uint64_t g_ClipmapScrolledVoxels = 0U;
+uint64_t g_ClipmapRevoxelizedVoxels = 0U;
+
+// The GPU time of the voxelization and of the overlap copy of the last move, which is what the copy is chosen on rather than toroidal addressing (see "CopyClipmapOverlap")
+// The queries are read back at the end of the frame which moved the clipmap, which stalls the GPU, thus they are only issued while measured
+enum CLIPMAP_MOVE_PASS
+{
+    CLIPMAP_MOVE_PASS_VOXELIZATION = 0,
+    CLIPMAP_MOVE_PASS_OVERLAP_COPY = 1,
+    CLIPMAP_MOVE_PASS_COUNT = 2
+};
+static bool g_bMeasureClipmapMove = false;
+NVRHI::PerformanceQueryHandle g_ClipmapMovePassQueries[CLIPMAP_MOVE_PASS_COUNT] = {};
+bool g_ClipmapMovePassQueriesIssued[CLIPMAP_MOVE_PASS_COUNT] = {};
+double g_ClipmapMovePassTimesMs[CLIPMAP_MOVE_PASS_COUNT] = {};
+uint64_t g_ClipmapOverlapCopyBytes = 0U;
+
+// The voxels invalidated (cleared and voxelized again) in the current frame, to compare the anchor policies
+uint64_t g_VoxelsInvalidated = 0U;
+double g_VoxelsInvalidatedAverage = 0.0;
+
+// The objects and the light are diffed between frames to fill "invalidatedRegions" and "invalidatedLightFrusta" of "VXGI::UpdateVoxelizationParameters"
+// The regions are rounded to the pages of the finest stack level, VXGI snaps them to its allocation map itself
+SceneChangeTracker g_SceneChangeTracker;
+static uint32_t g_InvalidationPageVoxels = 16U;
+
+// While the scene changes are tracked, the voxel data of VXGI persists between frames and the dynamic layer is only restored from the static layer and voxelized again inside the invalidated regions
+// Otherwise the whole dynamic layer is restored and voxelized every frame
+static bool g_bTrackSceneChanges = true;
+std::vector<ClipmapVoxelBox> g_DynamicLayerVoxelBoxes;
+uint64_t g_DynamicLayerRestoredVoxels = 0U;
+
+// The messages of the validations, the tuner and the exports are written to the debug output, and the last ones are shown under the statistics
+static uint32_t const MESSAGE_LOG_LINE_COUNT = 12U;
+std::deque<std::string> g_MessageLog;
+
+static void LogMessage(char const *message)
+{
+    OutputDebugStringA(message);
+    OutputDebugStringA("\n");
+
+    g_MessageLog.push_back(message);
+    if (g_MessageLog.size() > MESSAGE_LOG_LINE_COUNT)
+    {
+        g_MessageLog.pop_front();
+    }
+}
+
+static void LogFormat(char const *format, ...)
+{
+    char message[512];
+    va_list args;
+    va_start(args, format);
+    vsprintf_s(message, format, args);
+    va_end(args);
+
+    LogMessage(message);
+}
+
+// The occupancy and the update cost of each stack level are recorded per frame while enabled (see "VoxelStatisticsRecorder")
+// "J" exports the recorded frames to "VoxelStatistics.csv" and "VoxelStatistics.json"
+VoxelStatisticsRecorder g_VoxelStatisticsRecorder;
+
+// The tracing parameters are tuned offline by replaying a recorded camera path (see "TuningSession")
+// "R" starts and stops the recording of the camera path, "T" runs the tuner over the path, and the cheapest set which meets the target error within the budget is saved for the next startup
+TuningSession g_TuningSession("CameraPath.txt", "VxgiTuning.txt", "VxgiTuningResults.csv", LogMessage);
+NVRHI::PerformanceQueryHandle g_TuningPassQueries[TUNING_PASS_COUNT] = {};
+std::vector<uint8_t> g_TuningImage;
+
+// The tracing parameters follow the GPU time of the tracing passes while enabled (see "TracingGovernor"), and the governor pauses while the tuner runs
+static bool g_bDynamicResolution = false;
+TracingGovernor g_TracingGovernor;
+NVRHI::PerformanceQueryHandle g_GovernorPassQueries[TRACING_GOVERNOR_QUERY_LATENCY][TRACING_GOVERNOR_PASS_COUNT] = {};
+
+// the divisor of the width and the height of the "MyConeTracingCS" dispatch
+static uint32_t g_ConeTracingResolution = 1U;
+
+// The reduced resolution and temporally amortized mode of "MyConeTracingCS" (see "RendererInterfaceD3D11::dispatchMyConeTracingReduced")
+// The sample of each block of pixels is rotated from frame to frame while the history is enabled, thus every pixel is traced once every "resolution x resolution" frames and the history fills in the rest
+static bool g_bConeTracingHistory = true;
+NVRHI::TextureRef g_ConeTracingTextures[MY_CONE_TRACING_TEXTURE_RADIANCE_AND_AMBIENT + 1];
+NVRHI::TextureRef g_ConeTracingHistoryTextures[2];
+NVRHI::ConstantBufferRef g_pConeTracingConstants;
+ConeTracingConstants g_LastConeTracingConstants;
+NVRHI::ConstantBufferRef g_pConeTracingGBufferParameters;
+uint32_t g_ConeTracingHistoryIndex = 0U;
+uint64_t g_ConeTracingFrameIndex = 0U;
+uint64_t g_ConeTracingHistoryFrameIndex = 0U;
+bool g_ConeTracingHistoryWritten = false;
+
+static TuningParameters GetTuningParameters()
+{
+    TuningParameters parameters;
+    parameters.quality = g_fQuality;
+    parameters.directional_sampling_rate = g_fSamplingRate;
+    parameters.tracing_resolution = uint32_t(g_TracingResolution);
+    parameters.tracing_step = g_fTracingStep;
+    return parameters;
+}
+
+static void SetTuningParameters(TuningParameters const &parameters)
+{
+    g_fQuality = parameters.quality;
+    g_fSamplingRate = parameters.directional_sampling_rate;
+    g_TracingResolution = VXGI::TracingResolution::Enum(parameters.tracing_resolution);
+    g_fTracingStep = parameters.tracing_step;
+}
+
+// the quality, the sampling rate and the tracing resolution of VXGI are left to the user (and the tuner), since "MyConeTracingCS" does not read them
+// the level is only changed by the frames which measure "MyConeTracingCS" (see "TracingGovernor::IsMeasuring")
+static void SetGovernorLevel(TracingGovernorLevel const &level)
+{
+    g_ConeTracingResolution = level.cone_tracing_resolution;
+}
+
+static double ReadGovernorQuery(uint32_t slot, uint32_t pass)
+{
+    return g_pRendererInterface->getPerformanceQueryTimeMS(g_GovernorPassQueries[slot][pass]);
+}
+
+static void BeginGovernorPass(uint32_t pass)
+{
+    if (g_TracingGovernor.BeginPass(pass))
+    {
+        g_pRendererInterface->beginPerformanceQuery(g_GovernorPassQueries[g_TracingGovernor.GetQuerySlot()][pass]);
+    }
+}
+
+static void EndGovernorPass(uint32_t pass)
+{
+    if (g_TracingGovernor.IsMeasuring())
+    {
+        g_pRendererInterface->endPerformanceQuery(g_GovernorPassQueries[g_TracingGovernor.GetQuerySlot()][pass]);
+    }
+}
+
+static void BeginClipmapMovePass(uint32_t pass)
+{
+    if (g_bMeasureClipmapMove)
+    {
+        g_pRendererInterface->beginPerformanceQuery(g_ClipmapMovePassQueries[pass]);
+        g_ClipmapMovePassQueriesIssued[pass] = true;
+    }
+}
+
+static void EndClipmapMovePass(uint32_t pass)
+{
+    if (g_bMeasureClipmapMove)
+    {
+        g_pRendererInterface->endPerformanceQuery(g_ClipmapMovePassQueries[pass]);
+    }
+}
+
+// the passes which were not issued in the frame which moved the clipmap cost nothing, e.g. the overlap copy when "g_bClipmapOverlapCopy" is disabled
+static void ReadClipmapMoveQueries()
+{
+    if ((!g_ClipmapMovePassQueriesIssued[CLIPMAP_MOVE_PASS_VOXELIZATION]) && (!g_ClipmapMovePassQueriesIssued[CLIPMAP_MOVE_PASS_OVERLAP_COPY]))
+        return;
+
+    if (!g_ClipmapMovePassQueriesIssued[CLIPMAP_MOVE_PASS_OVERLAP_COPY])
+        g_ClipmapOverlapCopyBytes = 0U;
+
+    for (uint32_t pass = 0U; pass < CLIPMAP_MOVE_PASS_COUNT; ++pass)
+    {
+        g_ClipmapMovePassTimesMs[pass] = g_ClipmapMovePassQueriesIssued[pass] ? g_pRendererInterface->getPerformanceQueryTimeMS(g_ClipmapMovePassQueries[pass]) : 0.0;
+        g_ClipmapMovePassQueriesIssued[pass] = false;
+    }
+}
+
+// the position of the traced sample inside the block of pixels, in the order of the 4x4 Bayer matrix, so that the consecutive samples are far apart
+static void GetConeTracingSampleOffset(uint64_t frame_index, uint32_t tracing_resolution, uint32_t &offset_x, uint32_t &offset_y)
+{
+    static uint32_t const bayer_offsets[16][2] = {{0U, 0U}, {2U, 2U}, {2U, 0U}, {0U, 2U}, {1U, 1U}, {3U, 3U}, {3U, 1U}, {1U, 3U}, {1U, 0U}, {3U, 2U}, {3U, 0U}, {1U, 2U}, {0U, 1U}, {2U, 3U}, {2U, 1U}, {0U, 3U}};
+
+    uint32_t const index = uint32_t(frame_index % (uint64_t(tracing_resolution) * tracing_resolution));
+    offset_x = bayer_offsets[index][0] * tracing_resolution / 4U;
+    offset_y = bayer_offsets[index][1] * tracing_resolution / 4U;
+}
+
+static void SetConeTracingConstants(VXGI::float4x4 const &viewProjMatrix, VXGI::float3 const &cameraPos, BuiltinGBufferParameters const &builtinGBufferParameters, VXGI::int2 const &gbufferSize)
+{
+    uint32_t const tracing_resolution = g_ConeTracingResolution;
+
+    bool const history_valid = g_bConeTracingHistory && g_InputBuffersPrevValid && g_ConeTracingHistoryWritten && ((g_ConeTracingHistoryFrameIndex + 1U) == g_ConeTracingFrameIndex);
+
+    ConeTracingConstants constants = {};
+    constants.viewProjMatrixInv = viewProjMatrix.invert();
+    constants.previousViewProjMatrix = g_InputBuffersPrev.viewMatrix * g_InputBuffersPrev.projMatrix;
+    constants.previousViewProjMatrixInv = constants.previousViewProjMatrix.invert();
+    constants.cameraPos = VXGI::float4(cameraPos.x, cameraPos.y, cameraPos.z, 1.0f);
+    constants.fullWidth = uint32_t(gbufferSize.x);
+    constants.fullHeight = uint32_t(gbufferSize.y);
+    constants.tracingWidth = (constants.fullWidth + tracing_resolution - 1U) / tracing_resolution;
+    constants.tracingHeight = (constants.fullHeight + tracing_resolution - 1U) / tracing_resolution;
+    constants.tracingResolution = tracing_resolution;
+    constants.sampleOffsetX = 0U;
+    constants.sampleOffsetY = 0U;
+    if (g_bConeTracingHistory)
+    {
+        GetConeTracingSampleOffset(g_ConeTracingFrameIndex, tracing_resolution, constants.sampleOffsetX, constants.sampleOffsetY);
+    }
+    constants.historyValid = history_valid ? 1U : 0U;
+    constants.tracedWeight = 0.5f;
+    constants.upsampledWeight = 0.1f;
+    constants.depthTolerance = 0.02f;
+    constants.normalExponent = 8.0f;
+    g_pRendererInterface->writeConstantBuffer(g_pConeTracingConstants, &constants, sizeof(ConeTracingConstants));
+    g_LastConeTracingConstants = constants;
+
+    // the window position of the sample "x" is "x + 0.5", and maps to the pixel "x * resolution + offset" of the full resolution G-buffer
+    BuiltinGBufferParameters gbufferParameters = builtinGBufferParameters;
+    gbufferParameters.g_GBuffer.viewportOrigin = VXGI::float2(0.5f - (float(constants.sampleOffsetX) + 0.5f) / float(tracing_resolution), 0.5f - (float(constants.sampleOffsetY) + 0.5f) / float(tracing_resolution));
+    gbufferParameters.g_GBuffer.viewportSizeInv = VXGI::float2(float(tracing_resolution) / float(gbufferSize.x), float(tracing_resolution) / float(gbufferSize.y));
+    g_pRendererInterface->writeConstantBuffer(g_pConeTracingGBufferParameters, &gbufferParameters, sizeof(BuiltinGBufferParameters));
+
+    for (uint32_t texture = 0U; texture <= MY_CONE_TRACING_TEXTURE_RADIANCE_AND_AMBIENT; ++texture)
+    {
+        g_my_cone_tracing_textures[texture] = g_ConeTracingTextures[texture];
+    }
+    g_my_cone_tracing_textures[MY_CONE_TRACING_TEXTURE_HISTORY] = g_ConeTracingHistoryTextures[g_ConeTracingHistoryIndex];
+    g_my_cone_tracing_textures[MY_CONE_TRACING_TEXTURE_HISTORY_PREV] = g_ConeTracingHistoryTextures[1U - g_ConeTracingHistoryIndex];
+    g_my_cone_tracing_textures[MY_CONE_TRACING_TEXTURE_DEPTH_PREV] = g_InputBuffersPrevValid ? g_InputBuffersPrev.gbufferDepth : g_pSceneRenderer->GetDepthBufferHandle();
+    g_my_cone_tracing_textures[MY_CONE_TRACING_TEXTURE_NORMAL_AND_ROUGHNESS_PREV] = g_InputBuffersPrevValid ? g_InputBuffersPrev.gbufferNormal : g_pSceneRenderer->GetNormalBufferHandle();
+    g_my_cone_tracing_constants = g_pConeTracingConstants;
+    g_my_cone_tracing_gbuffer_parameters = g_pConeTracingGBufferParameters;
+}
+
+static void AllocateConeTracingTextures(uint32_t width, uint32_t height)
+{
+    NVRHI::TextureDesc d;
+    d.width = width;
+    d.height = height;
+    d.isUAV = true;
+    d.disableGPUsSync = true;
+
+    // the reduced resolution textures are allocated at the full resolution, so that the resolution can change without a reallocation
+    d.format = NVRHI::Format::RGBA16_FLOAT;
+    d.debugName = "ConeTracingBaseColor";
+    g_pRendererInterface->createTexture(d, NULL, &g_ConeTracingTextures[MY_CONE_TRACING_TEXTURE_BASE_COLOR_AND_METALLIC]);
+    d.debugName = "ConeTracingNormal";
+    g_pRendererInterface->createTexture(d, NULL, &g_ConeTracingTextures[MY_CONE_TRACING_TEXTURE_NORMAL_AND_ROUGHNESS]);
+    d.debugName = "ConeTracingRadiance";
+    g_pRendererInterface->createTexture(d, NULL, &g_ConeTracingTextures[MY_CONE_TRACING_TEXTURE_RADIANCE_AND_AMBIENT]);
+    d.debugName = "ConeTracingHistory";
+    g_pRendererInterface->createTexture(d, NULL, &g_ConeTracingHistoryTextures[0]);
+    g_pRendererInterface->createTexture(d, NULL, &g_ConeTracingHistoryTextures[1]);
+
+    d.format = NVRHI::Format::R32_FLOAT;
+    d.debugName = "ConeTracingDepth";
+    g_pRendererInterface->createTexture(d, NULL, &g_ConeTracingTextures[MY_CONE_TRACING_TEXTURE_DEPTH]);
+
+    g_ConeTracingHistoryWritten = false;
+}
+
+static void ReleaseConeTracingTextures()
+{
+    for (uint32_t texture = 0U; texture < MY_CONE_TRACING_TEXTURE_COUNT; ++texture)
+    {
+        g_my_cone_tracing_textures[texture] = NULL;
+    }
+    for (uint32_t texture = 0U; texture <= MY_CONE_TRACING_TEXTURE_RADIANCE_AND_AMBIENT; ++texture)
+    {
+        g_ConeTracingTextures[texture] = nullptr;
+    }
+    g_ConeTracingHistoryTextures[0] = nullptr;
+    g_ConeTracingHistoryTextures[1] = nullptr;
+
+    g_ConeTracingHistoryWritten = false;
+}
+
+static void CopyClipmapTexture(NVRHI::TextureHandle dst, NVRHI::TextureHandle src)
+{
+    g_pRendererInterface->GetDeviceContext()->CopyResource(g_pRendererInterface->getResourceForTexture(dst), g_pRendererInterface->getResourceForTexture(src));
+}
+
+static void ClearClipmapTextures(NVRHI::TextureHandle opacityTexture, NVRHI::TextureHandle illuminationTexture)
+{
+    float const zero_float = 0.0F;
+    uint32_t const zero_uint = (*reinterpret_cast<uint32_t const *>(&zero_float));
+    g_pRendererInterface->clearTextureUInt(opacityTexture, zero_uint);
+    g_pRendererInterface->clearTextureUInt(illuminationTexture, zero_uint);
+}
+
+// The clipmap textures are addressed relative to the clipmap center (see "GetClipmapVoxelSurfaceCoordinates"), thus the voxels which stay inside a stack level move to other texels when the clipmap center moves.
+// The voxel (x, y, z) of the stack level is the texels [k x, k (x + 1)) along the X axis (the k directions or channels of the voxel are interleaved), y along the Y axis and "z + stack level x BRX_VCT_CLIPMAP_MAP_SIZE" along the Z axis.
+static bool IsClipmapVoxelTextureLayout(NVRHI::TextureHandle texture)
+{
+    NVRHI::TextureDesc const &desc = g_pRendererInterface->describeTexture(texture);
+    return (0U != desc.width) && (0U == (desc.width % BRX_VCT_CLIPMAP_MAP_SIZE)) && (BRX_VCT_CLIPMAP_MAP_SIZE == desc.height) && ((BRX_VCT_CLIPMAP_MAP_SIZE * BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT) == desc.depthOrArraySize);
+}
+
+// the stack levels whose voxels inside the current static layer are copied rather than voxelized again, when the static layer is built around the clipmap center
+// the illumination of the current static layer is only valid for its light direction
+static uint32_t GetClipmapOverlapStackLevelMask(DirectX::XMFLOAT3 const &clipmap_center, VXGI::float3 const &light_direction)
+{
+    if ((!g_bClipmapOverlapCopy) || (!g_StaticLayerValid) ||
+        (light_direction.x != g_StaticLayerLightDirection.x) || (light_direction.y != g_StaticLayerLightDirection.y) || (light_direction.z != g_StaticLayerLightDirection.z) ||
+        (!IsClipmapVoxelTextureLayout(g_clipmap_static_opacity_texture)) || (!IsClipmapVoxelTextureLayout(g_clipmap_static_illumination_texture)) || (!IsClipmapVoxelTextureLayout(g_clipmap_static_surface_texture)))
+        return 0U;
+
+    uint32_t overlap_mask = 0U;
+    for (uint32_t stack_level = 0U; stack_level < BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT; ++stack_level)
+    {
+        int32_t lower[3];
+        int32_t upper[3];
+        int32_t offset[3];
+        if (GetClipmapStackLevelOverlap(VXGI::float3(g_StaticLayerClipmapCenter.x, g_StaticLayerClipmapCenter.y, g_StaticLayerClipmapCenter.z), VXGI::float3(clipmap_center.x, clipmap_center.y, clipmap_center.z), stack_level, lower, upper, offset))
+        {
+            overlap_mask |= (1U << stack_level);
+        }
+    }
+    return overlap_mask;
+}
+
+// Copies the voxels of the stack levels which stay inside the clipmap, from the texture around the previous clipmap center to the texture around the clipmap center.
+// The textures are different, since the source and the destination texels of the same texture may overlap.
+// The copy is after the voxelization of the scrolled slabs, thus the voxels which the clipped draw calls wrote outside of the slabs are replaced.
+// Toroidal addressing would not copy anything, but the texel of a voxel is computed by "brx_voxel_cone_tracing_voxelization_store_data" and by the cone tracing of the brx library, which are not part of this sample, and every reader of the clipmap here (the light injection, the multi-bounce, the downsample, the resolve, the statistics, the snapshots and the CPU validation) would have to wrap its addresses as well.
+// The copy is a bandwidth bound copy of the overlap (at most the whole stack level), while the voxelization which it replaces rasterizes every triangle of the stack level again: both are measured by "g_bMeasureClipmapMove".
+// Returns the bytes copied.
+static uint64_t CopyClipmapOverlap(NVRHI::TextureHandle dst, NVRHI::TextureHandle src, DirectX::XMFLOAT3 const &previous_clipmap_center, DirectX::XMFLOAT3 const &clipmap_center, uint32_t stack_level_mask)
+{
+    NVRHI::TextureDesc const &desc = g_pRendererInterface->describeTexture(dst);
+    uint32_t const texels_per_voxel = desc.width / BRX_VCT_CLIPMAP_MAP_SIZE;
+
+    uint64_t const bytes_per_texel = (NVRHI::Format::RG32_UINT == desc.format) ? 8U : 4U;
+
+    ID3D11Resource *const dstResource = g_pRendererInterface->getResourceForTexture(dst);
+    ID3D11Resource *const srcResource = g_pRendererInterface->getResourceForTexture(src);
+
+    uint64_t copied_bytes = 0U;
+    for (uint32_t stack_level = 0U; stack_level < BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT; ++stack_level)
+    {
+        int32_t lower[3];
+        int32_t upper[3];
+        int32_t offset[3];
+        if ((0U == (stack_level_mask & (1U << stack_level))) ||
+            (!GetClipmapStackLevelOverlap(VXGI::float3(previous_clipmap_center.x, previous_clipmap_center.y, previous_clipmap_center.z), VXGI::float3(clipmap_center.x, clipmap_center.y, clipmap_center.z), stack_level, lower, upper, offset)))
+            continue;
+
+        uint32_t const stack_level_z = stack_level * BRX_VCT_CLIPMAP_MAP_SIZE;
+
+        D3D11_BOX srcBox;
+        srcBox.left = texels_per_voxel * uint32_t(lower[0] + offset[0]);
+        srcBox.right = texels_per_voxel * uint32_t(upper[0] + offset[0]);
+        srcBox.top = uint32_t(lower[1] + offset[1]);
+        srcBox.bottom = uint32_t(upper[1] + offset[1]);
+        srcBox.front = stack_level_z + uint32_t(lower[2] + offset[2]);
+        srcBox.back = stack_level_z + uint32_t(upper[2] + offset[2]);
+
+        g_pRendererInterface->GetDeviceContext()->CopySubresourceRegion(dstResource, 0, texels_per_voxel * uint32_t(lower[0]), uint32_t(lower[1]), stack_level_z + uint32_t(lower[2]), srcResource, 0, &srcBox);
+
+        copied_bytes += bytes_per_texel * uint64_t(srcBox.right - srcBox.left) * uint64_t(srcBox.bottom - srcBox.top) * uint64_t(srcBox.back - srcBox.front);
+    }
+    return copied_bytes;
+}
+
+// the overlap of the opacity, the illumination and the voxel surface, from the current static layer to the build textures
+static void CopyClipmapOverlapTextures(DirectX::XMFLOAT3 const &previous_clipmap_center, DirectX::XMFLOAT3 const &clipmap_center, uint32_t stack_level_mask)
+{
+    BeginClipmapMovePass(CLIPMAP_MOVE_PASS_OVERLAP_COPY);
+
+    g_ClipmapOverlapCopyBytes = 0U;
+    g_ClipmapOverlapCopyBytes += CopyClipmapOverlap(g_clipmap_build_opacity_texture, g_clipmap_static_opacity_texture, previous_clipmap_center, clipmap_center, stack_level_mask);
+    g_ClipmapOverlapCopyBytes += CopyClipmapOverlap(g_clipmap_build_illumination_texture, g_clipmap_static_illumination_texture, previous_clipmap_center, clipmap_center, stack_level_mask);
+    g_ClipmapOverlapCopyBytes += CopyClipmapOverlap(g_clipmap_build_surface_texture, g_clipmap_static_surface_texture, previous_clipmap_center, clipmap_center, stack_level_mask);
+
+    EndClipmapMovePass(CLIPMAP_MOVE_PASS_OVERLAP_COPY);
+}
+
+// Restores the voxels of the boxes from the static layer, the voxels outside of the boxes are not modified.
+static void RestoreClipmapVoxelBoxes(NVRHI::TextureHandle dst, NVRHI::TextureHandle src, std::vector<ClipmapVoxelBox> const &voxel_boxes)
+{
+    NVRHI::TextureDesc const &desc = g_pRendererInterface->describeTexture(dst);
+    uint32_t const texels_per_voxel = desc.width / BRX_VCT_CLIPMAP_MAP_SIZE;
+
+    ID3D11Resource *const dstResource = g_pRendererInterface->getResourceForTexture(dst);
+    ID3D11Resource *const srcResource = g_pRendererInterface->getResourceForTexture(src);
+
+    for (ClipmapVoxelBox const &voxel_box : voxel_boxes)
+    {
+        uint32_t const stack_level_z = voxel_box.stack_level * BRX_VCT_CLIPMAP_MAP_SIZE;
+
+        D3D11_BOX srcBox;
+        srcBox.left = texels_per_voxel * uint32_t(voxel_box.lower[0]);
+        srcBox.right = texels_per_voxel * uint32_t(voxel_box.upper[0]);
+        srcBox.top = uint32_t(voxel_box.lower[1]);
+        srcBox.bottom = uint32_t(voxel_box.upper[1]);
+        srcBox.front = stack_level_z + uint32_t(voxel_box.lower[2]);
+        srcBox.back = stack_level_z + uint32_t(voxel_box.upper[2]);
+
+        g_pRendererInterface->GetDeviceContext()->CopySubresourceRegion(dstResource, 0, srcBox.left, srcBox.top, srcBox.front, srcResource, 0, &srcBox);
+    }
+}
+
+// the scrolled slabs of the stack levels in the overlap mask and the whole region of the other stack levels, which clip the voxelization of the stack levels in the stack level mask
+static uint32_t GetClipmapMoveClippingBoxes(DirectX::XMFLOAT3 const &previous_clipmap_center, DirectX::XMFLOAT3 const &clipmap_center, uint32_t overlap_mask, uint32_t stack_level_mask, VXGI::Box3f boxes[3U * BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT])
+{
+    uint32_t box_count = 0U;
+    for (uint32_t stack_level = 0U; stack_level < BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT; ++stack_level)
+    {
+        if (0U == (stack_level_mask & (1U << stack_level)))
+            continue;
+
+        if (0U != (overlap_mask & (1U << stack_level)))
+        {
+            box_count += GetClipmapStackLevelScrolledSlabs(VXGI::float3(previous_clipmap_center.x, previous_clipmap_center.y, previous_clipmap_center.z), VXGI::float3(clipmap_center.x, clipmap_center.y, clipmap_center.z), stack_level, &boxes[box_count]);
+        }
+        else
+        {
+            boxes[box_count++] = GetClipmapStackLevelBounds(VXGI::float3(clipmap_center.x, clipmap_center.y, clipmap_center.z), stack_level);
+        }
+    }
+    return box_count;
+}
+
+// updates "g_ClipmapScrolledVoxels" and "g_ClipmapRevoxelizedVoxels" for the move from the current static layer to the clipmap center
+// only the scrolled voxels of the stack levels in the overlap mask are voxelized again
+static void UpdateClipmapMoveStatistics(DirectX::XMFLOAT3 const &clipmap_center, uint32_t overlap_mask, uint64_t scrolled_voxel_counts[BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT], uint64_t revoxelized_voxel_counts[BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT])
+{
+    g_ClipmapScrolledVoxels = 0U;
+    g_ClipmapRevoxelizedVoxels = 0U;
+    for (uint32_t stack_level = 0U; stack_level < BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT; ++stack_level)
+    {
+        scrolled_voxel_counts[stack_level] = 0U;
+
+        VXGI::Box3f slabs[3];
+        uint32_t const slab_count = g_StaticLayerValid ? GetClipmapStackLevelScrolledSlabs(VXGI::float3(g_StaticLayerClipmapCenter.x, g_StaticLayerClipmapCenter.y, g_StaticLayerClipmapCenter.z), VXGI::float3(clipmap_center.x, clipmap_center.y, clipmap_center.z), stack_level, slabs) : 0U;
+        for (uint32_t slab_index = 0U; slab_index < slab_count; ++slab_index)
+        {
+            scrolled_voxel_counts[stack_level] += GetClipmapStackLevelSlabVoxelCount(slabs[slab_index], stack_level);
+        }
+
+        revoxelized_voxel_counts[stack_level] = (0U != (overlap_mask & (1U << stack_level))) ? scrolled_voxel_counts[stack_level] : (uint64_t(BRX_VCT_CLIPMAP_MAP_SIZE) * BRX_VCT_CLIPMAP_MAP_SIZE * BRX_VCT_CLIPMAP_MAP_SIZE);
+
+        g_ClipmapScrolledVoxels += scrolled_voxel_counts[stack_level];
+        g_ClipmapRevoxelizedVoxels += revoxelized_voxel_counts[stack_level];
+    }
+}
+
+static ClipmapSnapshotKey GetClipmapSnapshotKey(DirectX::XMFLOAT3 const &clipmap_center)
+{
+    float const clipmap_center_array[3] = {clipmap_center.x, clipmap_center.y, clipmap_center.z};
+    return MakeClipmapSnapshotKey(g_pSceneRenderer->GetSceneContentHash(), uint32_t(g_nMapSize), g_fVoxelSize, clipmap_center_array);
+}
+
+// The illumination of the snapshot is only valid for the light direction of the bake.
+// For any other light direction (and for the snapshots baked by "BakeClipmapSnapshotsCpu", which have no illumination) the illumination is injected again from the voxel surface of the snapshot, the same as when only the light changes.
+// The snapshot is rejected when it has neither, and the static layer is voxelized instead.
+static bool UploadClipmapSnapshot(ClipmapSnapshotKey const &key, DirectX::XMFLOAT3 const &clipmap_anchor, VXGI::float3 const &light_direction, NVRHI::TextureHandle opacityTexture, NVRHI::TextureHandle illuminationTexture, NVRHI::TextureHandle surfaceTexture, bool &surface_valid)
+{
+    ClipmapSnapshot snapshot;
+    if (!LoadClipmapSnapshot(GetClipmapSnapshotPath(g_ClipmapSnapshotDirectory, key).c_str(), key, &light_direction.x, snapshot))
+        return false;
+
+    NVRHI::TextureDesc const &opacityDesc = g_pRendererInterface->describeTexture(opacityTexture);
+    NVRHI::TextureDesc const &illuminationDesc = g_pRendererInterface->describeTexture(illuminationTexture);
+    NVRHI::TextureDesc const &surfaceDesc = g_pRendererInterface->describeTexture(surfaceTexture);
+
+    if (snapshot.opacity_extent[0] != opacityDesc.width || snapshot.opacity_extent[1] != opacityDesc.height || snapshot.opacity_extent[2] != opacityDesc.depthOrArraySize ||
+        snapshot.illumination_extent[0] != illuminationDesc.width || snapshot.illumination_extent[1] != illuminationDesc.height || snapshot.illumination_extent[2] != illuminationDesc.depthOrArraySize)
+        return false;
+
+    if (snapshot.has_surface && (snapshot.surface_extent[0] != surfaceDesc.width || snapshot.surface_extent[1] != surfaceDesc.height || snapshot.surface_extent[2] != surfaceDesc.depthOrArraySize))
+        return false;
+
+    g_pRendererInterface->writeTexture(opacityTexture, 0, snapshot.opacity.data(), sizeof(uint32_t) * opacityDesc.width, sizeof(uint32_t) * opacityDesc.width * opacityDesc.height);
+
+    if (snapshot.has_surface)
+    {
+        g_pRendererInterface->writeTexture(surfaceTexture, 0, snapshot.surface.data(), 2U * sizeof(uint32_t) * surfaceDesc.width, 2U * sizeof(uint32_t) * surfaceDesc.width * surfaceDesc.height);
+    }
+    else
+    {
+        g_pRendererInterface->clearTextureUInt(surfaceTexture, 0U);
+    }
+
+    if (snapshot.has_illumination)
+    {
+        g_pRendererInterface->writeTexture(illuminationTexture, 0, snapshot.illumination.data(), sizeof(uint32_t) * illuminationDesc.width, sizeof(uint32_t) * illuminationDesc.width * illuminationDesc.height);
+    }
+    else
+    {
+        float const zero_float = 0.0F;
+        g_pRendererInterface->clearTextureUInt(illuminationTexture, (*reinterpret_cast<uint32_t const *>(&zero_float)));
+
+        // the working opacity is used as the scratch, thus it is restored from the static layer in this frame
+        if (LightInjectionMode::SHADOW_MAP == g_LightInjectionMode)
+        {
+            g_pSceneRenderer->InjectShadowMapLight(clipmap_anchor, surfaceTexture, g_clipmap_opacity_texture, illuminationTexture);
+        }
+        else
+        {
+            g_pSceneRenderer->InjectVoxelLight(clipmap_anchor, surfaceTexture, g_clipmap_opacity_texture, illuminationTexture);
+        }
+        g_StaticLayerChanged = true;
+    }
+
+    surface_valid = snapshot.has_surface;
+
+    return true;
+}
+
+static bool BakeClipmapSnapshot(ClipmapSnapshotKey const &key, VXGI::float3 const &light_direction)
+{
+    NVRHI::TextureDesc const &opacityDesc = g_pRendererInterface->describeTexture(g_clipmap_static_opacity_texture);
+    NVRHI::TextureDesc const &illuminationDesc = g_pRendererInterface->describeTexture(g_clipmap_static_illumination_texture);
+
+    ClipmapSnapshot snapshot;
+    snapshot.key = key;
+
+    snapshot.opacity_extent[0] = opacityDesc.width;
+    snapshot.opacity_extent[1] = opacityDesc.height;
+    snapshot.opacity_extent[2] = opacityDesc.depthOrArraySize;
+    snapshot.opacity.resize(size_t(opacityDesc.width) * opacityDesc.height * opacityDesc.depthOrArraySize);
+
+    snapshot.has_illumination = true;
+    snapshot.light_direction[0] = light_direction.x;
+    snapshot.light_direction[1] = light_direction.y;
+    snapshot.light_direction[2] = light_direction.z;
+    snapshot.illumination_extent[0] = illuminationDesc.width;
+    snapshot.illumination_extent[1] = illuminationDesc.height;
+    snapshot.illumination_extent[2] = illuminationDesc.depthOrArraySize;
+    snapshot.illumination.resize(size_t(illuminationDesc.width) * illuminationDesc.height * illuminationDesc.depthOrArraySize);
+
+    // the voxel surface lets the snapshot be used for the other light directions
+    NVRHI::TextureDesc const &surfaceDesc = g_pRendererInterface->describeTexture(g_clipmap_static_surface_texture);
+    snapshot.has_surface = g_StaticLayerSurfaceValid;
+    snapshot.surface_extent[0] = surfaceDesc.width;
+    snapshot.surface_extent[1] = surfaceDesc.height;
+    snapshot.surface_extent[2] = surfaceDesc.depthOrArraySize;
+    if (snapshot.has_surface)
+    {
+        snapshot.surface.resize(2U * size_t(surfaceDesc.width) * surfaceDesc.height * surfaceDesc.depthOrArraySize);
+    }
+
+    if (!g_pRendererInterface->readTexture(g_clipmap_static_opacity_texture, snapshot.opacity.data(), sizeof(uint32_t) * opacityDesc.width) ||
+        !g_pRendererInterface->readTexture(g_clipmap_static_illumination_texture, snapshot.illumination.data(), sizeof(uint32_t) * illuminationDesc.width) ||
+        (snapshot.has_surface && !g_pRendererInterface->readTexture(g_clipmap_static_surface_texture, snapshot.surface.data(), 2U * sizeof(uint32_t) * surfaceDesc.width)))
+        return false;
+
+    if (!CreateClipmapSnapshotDirectory(g_ClipmapSnapshotDirectory))
+        return false;
+
+    std::string const path = GetClipmapSnapshotPath(g_ClipmapSnapshotDirectory, key);
+    bool const result = SaveClipmapSnapshot(path.c_str(), snapshot);
+
+    LogFormat("Clipmap snapshot %s: %s", result ? "baked" : "failed", path.c_str());
+
+    return result;
+}
+
+// the static layer is voxelized by the GPU, and the same meshes are voxelized by the CPU around the same clipmap center
+// then the CPU clipmap is traced by the CPU cone tracer from the current camera, to compare the tracing parameters and the voxel storages with a golden image
+static void ValidateVoxelizationCpu(DirectX::XMFLOAT3 const &clipmap_center, VXGI::float4x4 const &viewProjMatrix, VXGI::float3 const &cameraPos)
+{
+    std::vector<CpuVoxelizerMesh> meshes;
+    g_pSceneRenderer->GetCpuVoxelizerMeshes(VoxelizationLayer::STATIC, meshes);
+    if (meshes.empty())
+    {
+        LogMessage("CPU voxelization: the scene is not loaded with -validate-voxelization");
+        return;
+    }
+
+    CpuVoxelClipmap clipmap;
+    CpuVoxelizerStatistics statistics;
+    if (!VoxelizeClipmapCpu(meshes.data(), uint32_t(meshes.size()), VXGI::float3(clipmap_center.x, clipmap_center.y, clipmap_center.z), 0U, clipmap, statistics))
+    {
+        LogMessage("CPU voxelization: the clipmap textures are not in the layout of CpuVoxelClipmap");
+        return;
+    }
+
+    // the same derivation as the static layer of the GPU, thus the stack levels are still comparable
+    if (g_StaticLayerDerived)
+    {
+        CpuAnisotropicClipmapStatistics derive_statistics;
+        DeriveCoarseStackLevelsCpu(clipmap, 0U, derive_statistics);
+        LogFormat("CPU derivation: %llu voxels in %.1f ms", (unsigned long long)derive_statistics.derived_voxel_count, derive_statistics.seconds * 1000.0);
+    }
+
+    NVRHI::TextureDesc const &opacityDesc = g_pRendererInterface->describeTexture(g_clipmap_static_opacity_texture);
+    if (opacityDesc.width != clipmap.opacity_extent[0] || opacityDesc.height != clipmap.opacity_extent[1] || opacityDesc.depthOrArraySize != clipmap.opacity_extent[2])
+        return;
+
+    // only the opacity is compared, the illumination of the GPU is lit while the CPU only accumulates the emittance
+    CpuVoxelClipmap gpu_clipmap;
+    std::copy(clipmap.extent, clipmap.extent + 3, gpu_clipmap.extent);
+    std::copy(clipmap.opacity_extent, clipmap.opacity_extent + 3, gpu_clipmap.opacity_extent);
+    gpu_clipmap.opacity.resize(clipmap.opacity.size());
+    if (!g_pRendererInterface->readTexture(g_clipmap_static_opacity_texture, gpu_clipmap.opacity.data(), sizeof(uint32_t) * opacityDesc.width))
+        return;
+
+    LogFormat("CPU voxelization: %u triangles in %.1f ms, %.2f M triangles/s, %.2f M voxels/s", uint32_t(statistics.triangle_count), statistics.seconds * 1000.0, statistics.GetTrianglesPerSecond() * 1e-6, statistics.GetVoxelsPerSecond() * 1e-6);
+
+    size_t const stack_level_voxel_count = size_t(BRX_VCT_CLIPMAP_MAP_SIZE) * BRX_VCT_CLIPMAP_MAP_SIZE * BRX_VCT_CLIPMAP_MAP_SIZE;
+    for (uint32_t stack_level = 0; stack_level < BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT; ++stack_level)
+    {
+        uint32_t cpu_occupied_count = 0;
+        uint32_t gpu_occupied_count = 0;
+        uint32_t cpu_only_count = 0;
+        uint32_t gpu_only_count = 0;
+        for (size_t voxel_index = stack_level * stack_level_voxel_count; voxel_index < (stack_level + 1) * stack_level_voxel_count; ++voxel_index)
+        {
+            bool const cpu_occupied = (0 != (GetCpuVoxelOpacity(clipmap, voxel_index) & 0x3FF));
+            bool const gpu_occupied = (0 != (GetCpuVoxelOpacity(gpu_clipmap, voxel_index) & 0x3FF));
+
+            cpu_occupied_count += cpu_occupied ? 1 : 0;
+            gpu_occupied_count += gpu_occupied ? 1 : 0;
+            cpu_only_count += (cpu_occupied && !gpu_occupied) ? 1 : 0;
+            gpu_only_count += (gpu_occupied && !cpu_occupied) ? 1 : 0;
+        }
+
+        LogFormat("    stack level %u: occupied CPU %u GPU %u, CPU only %u, GPU only %u", stack_level, cpu_occupied_count, gpu_occupied_count, cpu_only_count, gpu_only_count);
+    }
+
+    // the error of the compact encodings against the accumulation, which is only measured on the CPU
+    VoxelRadianceEncoding const radiance_encodings[] = {VoxelRadianceEncoding::RGB9E5, VoxelRadianceEncoding::R11G11B10};
+    char const *const radiance_encoding_names[] = {"RGB9E5", "R11G11B10"};
+    for (uint32_t encoding_index = 0; encoding_index < 2; ++encoding_index)
+    {
+        CompactVoxelClipmap compact_clipmap;
+        ResolveCompactVoxelClipmapCpu(clipmap, VoxelOpacityEncoding::UNORM8, radiance_encodings[encoding_index], 0U, compact_clipmap);
+        VoxelEncodingErrorStatistics encoding_statistics;
+        MeasureVoxelEncodingError(clipmap, compact_clipmap, encoding_statistics);
+        LogFormat("Compact voxels UNORM8 %s: opacity RMSE %.5f max %.5f, radiance relative RMSE %.5f max %.5f, %.2f MB instead of %.2f MB", radiance_encoding_names[encoding_index], encoding_statistics.opacity_rmse, encoding_statistics.max_opacity_error, encoding_statistics.radiance_relative_rmse, encoding_statistics.max_radiance_relative_error, double(encoding_statistics.compact_bytes) / (1024.0 * 1024.0), double(encoding_statistics.accumulation_bytes) / (1024.0 * 1024.0));
+    }
+
+    // The GPU resolve (the compact voxels traced by the multi-bounce) of the static layer, against the CPU resolve of the same accumulation and against the accumulation itself.
+    // The compact textures are resolved again from the working clipmap before the next multi-bounce update.
+    {
+        NVRHI::TextureDesc const &illuminationDesc = g_pRendererInterface->describeTexture(g_clipmap_static_illumination_texture);
+        std::copy(clipmap.illumination_extent, clipmap.illumination_extent + 3, gpu_clipmap.illumination_extent);
+        gpu_clipmap.emittance.resize(clipmap.emittance.size());
+
+        g_pSceneRenderer->ResolveCompactVoxels(g_clipmap_static_opacity_texture, g_clipmap_static_illumination_texture, g_CompactVoxelRadianceEncoding, g_clipmap_compact_opacity_texture, g_clipmap_compact_radiance_texture);
+
+        CompactVoxelClipmap gpu_compact_clipmap;
+        gpu_compact_clipmap.opacity_encoding = VoxelOpacityEncoding::UNORM8;
+        gpu_compact_clipmap.radiance_encoding = g_CompactVoxelRadianceEncoding;
+        std::copy(clipmap.extent, clipmap.extent + 3, gpu_compact_clipmap.extent);
+        gpu_compact_clipmap.opacity.resize(GetCpuVoxelCount(clipmap));
+        gpu_compact_clipmap.radiance.resize(GetCpuVoxelCount(clipmap));
+
+        if ((illuminationDesc.width == clipmap.illumination_extent[0]) &&
+            g_pRendererInterface->readTexture(g_clipmap_static_illumination_texture, gpu_clipmap.emittance.data(), sizeof(uint32_t) * illuminationDesc.width) &&
+            g_pRendererInterface->readTexture(g_clipmap_compact_opacity_texture, gpu_compact_clipmap.opacity.data(), sizeof(uint8_t) * BRX_VCT_CLIPMAP_MAP_SIZE) &&
+            g_pRendererInterface->readTexture(g_clipmap_compact_radiance_texture, gpu_compact_clipmap.radiance.data(), sizeof(uint32_t) * BRX_VCT_CLIPMAP_MAP_SIZE))
+        {
+            CompactVoxelClipmap cpu_compact_clipmap;
+            ResolveCompactVoxelClipmapCpu(gpu_clipmap, VoxelOpacityEncoding::UNORM8, g_CompactVoxelRadianceEncoding, 0U, cpu_compact_clipmap);
+
+            uint64_t mismatch_count = 0;
+            for (size_t voxel_index = 0; voxel_index < GetCpuVoxelCount(clipmap); ++voxel_index)
+            {
+                mismatch_count += ((gpu_compact_clipmap.opacity[voxel_index] != cpu_compact_clipmap.opacity[voxel_index]) || (gpu_compact_clipmap.radiance[voxel_index] != cpu_compact_clipmap.radiance[voxel_index])) ? 1 : 0;
+            }
+
+            VoxelEncodingErrorStatistics encoding_statistics;
+            MeasureVoxelEncodingError(gpu_clipmap, gpu_compact_clipmap, encoding_statistics);
+            LogFormat("GPU compact voxels UNORM8 %s: %llu voxels differ from the CPU resolve, opacity RMSE %.5f max %.5f, radiance relative RMSE %.5f max %.5f", (VoxelRadianceEncoding::R11G11B10 == g_CompactVoxelRadianceEncoding) ? "R11G11B10" : "RGB9E5", (unsigned long long)mismatch_count, encoding_statistics.opacity_rmse, encoding_statistics.max_opacity_error, encoding_statistics.radiance_relative_rmse, encoding_statistics.max_radiance_relative_error);
+        }
+    }
+
+    // the G-buffer is marched through the CPU clipmap at a small resolution, thus the comparison does not depend on the rasterization of the GPU
+    CpuConeTracingGBufferImage gbuffer_image;
+    CpuConeTracingGBuffer gbuffer;
+    RenderCpuConeTracingGBuffer(clipmap, VXGI::float3(clipmap_center.x, clipmap_center.y, clipmap_center.z), viewProjMatrix, cameraPos, 160, 90, 0.5f, gbuffer_image, gbuffer);
+
+    CpuConeTracingParameters parameters = g_CpuConeTracingParameters;
+    CpuConeTracingParameters golden_parameters = g_CpuConeTracingParameters;
+    golden_parameters.diffuse_cone_count = 32;
+    golden_parameters.step_scale = 0.25f;
+
+    std::vector<CpuConeTracingComparison> comparisons;
+    CompareConeTracingConfigurations(clipmap, VXGI::float3(clipmap_center.x, clipmap_center.y, clipmap_center.z), gbuffer, parameters, golden_parameters, comparisons);
+
+    LogFormat("CPU cone tracing: %u x %u, golden %u cones step %.2f, traced %u cones step %.2f", gbuffer.width, gbuffer.height, golden_parameters.diffuse_cone_count, golden_parameters.step_scale, parameters.diffuse_cone_count, parameters.step_scale);
+    for (CpuConeTracingComparison const &comparison : comparisons)
+    {
+        LogFormat("    %s: %.1f ms, %llu samples, radiance RMSE %.5f, ambient RMSE %.5f, max error %.5f", comparison.name, comparison.seconds * 1000.0, (unsigned long long)comparison.sample_count, comparison.radiance_rmse, comparison.ambient_rmse, comparison.max_error);
+    }
+}
+
+// the G-buffer and the "g_radiance_and_ambient" of the last dispatch of "MyConeTracingCS" by "dispatchMyConeTracingReduced", thus the reduced path is forced for the frame of the validation
+static void ValidateConeTracingGpu(VXGI::float4x4 const &viewProjMatrix, VXGI::float3 const &cameraPos)
+{
+    ConeTracingConstants const &constants = g_LastConeTracingConstants;
+
+    NVRHI::TextureDesc const &radianceDesc = g_pRendererInterface->describeTexture(g_ConeTracingTextures[MY_CONE_TRACING_TEXTURE_RADIANCE_AND_AMBIENT]);
+    size_t const texel_count = size_t(radianceDesc.width) * radianceDesc.height;
+
+    // RGBA16_FLOAT, except the depth which is R32_FLOAT
+    std::vector<uint16_t> base_color_and_metallic(4U * texel_count);
+    std::vector<uint16_t> normal_and_roughness(4U * texel_count);
+    std::vector<uint16_t> radiance_and_ambient(4U * texel_count);
+    std::vector<float> depth(texel_count);
+    if (!g_pRendererInterface->readTexture(g_ConeTracingTextures[MY_CONE_TRACING_TEXTURE_BASE_COLOR_AND_METALLIC], base_color_and_metallic.data(), 4U * sizeof(uint16_t) * radianceDesc.width) ||
+        !g_pRendererInterface->readTexture(g_ConeTracingTextures[MY_CONE_TRACING_TEXTURE_NORMAL_AND_ROUGHNESS], normal_and_roughness.data(), 4U * sizeof(uint16_t) * radianceDesc.width) ||
+        !g_pRendererInterface->readTexture(g_ConeTracingTextures[MY_CONE_TRACING_TEXTURE_RADIANCE_AND_AMBIENT], radiance_and_ambient.data(), 4U * sizeof(uint16_t) * radianceDesc.width) ||
+        !g_pRendererInterface->readTexture(g_ConeTracingTextures[MY_CONE_TRACING_TEXTURE_DEPTH], depth.data(), sizeof(float) * radianceDesc.width))
+    {
+        LogMessage("CPU cone tracing: the G-buffer of MyConeTracingCS can not be read back");
+        return;
+    }
+
+    NVRHI::TextureDesc const &opacityDesc = g_pRendererInterface->describeTexture(g_clipmap_opacity_texture);
+    NVRHI::TextureDesc const &illuminationDesc = g_pRendererInterface->describeTexture(g_clipmap_illumination_texture);
+
+    CpuVoxelClipmap clipmap;
+    clipmap.extent[0] = BRX_VCT_CLIPMAP_MAP_SIZE;
+    clipmap.extent[1] = BRX_VCT_CLIPMAP_MAP_SIZE;
+    clipmap.extent[2] = BRX_VCT_CLIPMAP_MAP_SIZE * BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT;
+    clipmap.opacity_extent[0] = opacityDesc.width;
+    clipmap.opacity_extent[1] = opacityDesc.height;
+    clipmap.opacity_extent[2] = opacityDesc.depthOrArraySize;
+    clipmap.illumination_extent[0] = illuminationDesc.width;
+    clipmap.illumination_extent[1] = illuminationDesc.height;
+    clipmap.illumination_extent[2] = illuminationDesc.depthOrArraySize;
+    clipmap.opacity.resize(size_t(opacityDesc.width) * opacityDesc.height * opacityDesc.depthOrArraySize);
+    clipmap.emittance.resize(size_t(illuminationDesc.width) * illuminationDesc.height * illuminationDesc.depthOrArraySize);
+    if (!g_pRendererInterface->readTexture(g_clipmap_opacity_texture, clipmap.opacity.data(), sizeof(uint32_t) * opacityDesc.width) ||
+        !g_pRendererInterface->readTexture(g_clipmap_illumination_texture, clipmap.emittance.data(), sizeof(uint32_t) * illuminationDesc.width))
+    {
+        LogMessage("CPU cone tracing: the working clipmap can not be read back");
+        return;
+    }
+
+    // every "step" sample along each axis, at most 160 samples per row as the CPU cone tracing of "ValidateVoxelizationCpu"
+    uint32_t const step = std::max(1U, (constants.tracingWidth + 159U) / 160U);
+    uint32_t const width = (constants.tracingWidth + step - 1U) / step;
+    uint32_t const height = (constants.tracingHeight + step - 1U) / step;
+
+    CpuConeTracingGBufferImage gbuffer_image;
+    gbuffer_image.depth.resize(size_t(width) * height);
+    gbuffer_image.normal_and_roughness.resize(4U * size_t(width) * height);
+    gbuffer_image.base_color_and_metallic.resize(4U * size_t(width) * height);
+    std::vector<float> shader_image(4U * size_t(width) * height);
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        for (uint32_t x = 0; x < width; ++x)
+        {
+            size_t const pixel = size_t(y) * width + x;
+            size_t const texel = size_t(y * step) * radianceDesc.width + x * step;
+
+            gbuffer_image.depth[pixel] = depth[texel];
+            for (uint32_t channel = 0; channel < 4; ++channel)
+            {
+                gbuffer_image.normal_and_roughness[4U * pixel + channel] = DirectX::PackedVector::XMConvertHalfToFloat(normal_and_roughness[4U * texel + channel]);
+                gbuffer_image.base_color_and_metallic[4U * pixel + channel] = DirectX::PackedVector::XMConvertHalfToFloat(base_color_and_metallic[4U * texel + channel]);
+                shader_image[4U * pixel + channel] = DirectX::PackedVector::XMConvertHalfToFloat(radiance_and_ambient[4U * texel + channel]);
+            }
+        }
+    }
+
+    // the sample (x, y) is the pixel "x * step * tracingResolution + sampleOffsetX" of the full resolution G-buffer (see "MyConeTracingDownsampleCS")
+    CpuConeTracingGBuffer gbuffer;
+    gbuffer.width = width;
+    gbuffer.height = height;
+    gbuffer.depth = gbuffer_image.depth.data();
+    gbuffer.normal_and_roughness = gbuffer_image.normal_and_roughness.data();
+    gbuffer.base_color_and_metallic = gbuffer_image.base_color_and_metallic.data();
+    gbuffer.view_proj_matrix_inv = viewProjMatrix.invert();
+    gbuffer.camera_position = cameraPos;
+    gbuffer.window_scale = float(step * constants.tracingResolution);
+    gbuffer.window_offset[0] = float(constants.sampleOffsetX) + 0.5f - 0.5f * gbuffer.window_scale;
+    gbuffer.window_offset[1] = float(constants.sampleOffsetY) + 0.5f - 0.5f * gbuffer.window_scale;
+    gbuffer.window_width = constants.fullWidth;
+    gbuffer.window_height = constants.fullHeight;
+
+    std::vector<CpuConeTracingComparison> comparisons;
+    uint32_t const best_comparison = CompareConeTracingWithShader(clipmap, VXGI::float3(g_TracingClipmapCenter.x, g_TracingClipmapCenter.y, g_TracingClipmapCenter.z), gbuffer, shader_image.data(), g_CpuConeTracingParameters, comparisons);
+    g_CpuConeTracingParameters = comparisons[best_comparison].parameters;
+
+    LogFormat("CPU cone tracing against MyConeTracingCS: %u x %u samples", width, height);
+    for (uint32_t comparison_index = 0; comparison_index < uint32_t(comparisons.size()); ++comparison_index)
+    {
+        CpuConeTracingComparison const &comparison = comparisons[comparison_index];
+        LogFormat("    %u cones, aperture %.3f, step %.2f: %.1f ms, radiance RMSE %.5f, ambient RMSE %.5f, max error %.5f%s", comparison.parameters.diffuse_cone_count, comparison.parameters.diffuse_cone_aperture, comparison.parameters.step_scale, comparison.seconds * 1000.0, comparison.radiance_rmse, comparison.ambient_rmse, comparison.max_error, (comparison_index == best_comparison) ? " (best)" : "");
+    }
+}
+
 enum class RenderingMode
 {
     NORMAL,
@@ -126,10 +1015,13 @@ VXGI::Status::Enum SetVoxelizationParameters()
     voxelizationParams.mapSize = VXGI::uint3(g_nMapSize);
     voxelizationParams.stackLevels = BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT;
     voxelizationParams.mipLevels = BRX_VCT_CLIPMAP_MIP_LEVEL_COUNT;
-    voxelizationParams.enableMultiBounce = g_bEnableMultiBounce;
+    // The multi-bounce of the sample is the amortized update of the clipmap (see "g_IndirectIrradianceValid"), since "MyConeTracingCS" does not trace the indirect irradiance map of VXGI, thus the map of VXGI would only cost the voxelization.
+    voxelizationParams.enableMultiBounce = false;
     // The **VXGI::VoxelizationParameters::persistentVoxelData** is always set to **false** in the **NVIDIA Unreal Engine 4 Fork**.
-    voxelizationParams.persistentVoxelData = false;
-    voxelizationParams.useEmittanceInterpolation = g_bEnableMultiBounce;
+    // Here the regions invalidated by "g_SceneChangeTracker" are the only regions voxelized again, thus the voxel data persists while the scene changes are tracked.
+    voxelizationParams.persistentVoxelData = g_bTrackSceneChanges;
+    // the emittance interpolation only serves the indirect irradiance map of VXGI, thus it follows the multi-bounce of VXGI and not the amortized update
+    voxelizationParams.useEmittanceInterpolation = voxelizationParams.enableMultiBounce;
     voxelizationParams.enabledHardwareFeatures = VXGI::HardwareFeatures::TYPED_UAV_LOAD;
 
     if (previousParams != voxelizationParams)
@@ -242,6 +1134,84 @@ class AntTweakBarVisualController : public IVisualController
         sprintf_s(msg, "%.1f FPS", fps);
         TwAddTextLine(msg, color, 0);
 
+        uint32_t voxelizationTrianglesSubmitted;
+        uint32_t voxelizationTrianglesSkipped;
+        g_pSceneRenderer->GetVoxelizationStatistics(voxelizationTrianglesSubmitted, voxelizationTrianglesSkipped);
+
+        sprintf_s(msg, "Voxelization: %u triangles submitted, %u triangles skipped", voxelizationTrianglesSubmitted, voxelizationTrianglesSkipped);
+        TwAddTextLine(msg, color, 0);
+
+        sprintf_s(msg, "Static layer: %s (press B to bake a snapshot)", g_StaticLayerFromSnapshot ? "snapshot" : "voxelized");
+        TwAddTextLine(msg, color, 0);
+
+        sprintf_s(msg, "Last light change: %s", g_LastLightChange);
+        TwAddTextLine(msg, color, 0);
+
+        sprintf_s(msg, "Last clipmap move: %llu voxels scrolled in, %llu voxels re-voxelized", g_ClipmapScrolledVoxels, g_ClipmapRevoxelizedVoxels);
+        TwAddTextLine(msg, color, 0);
+
+        if (g_bMeasureClipmapMove)
+        {
+            sprintf_s(msg, "Last clipmap move GPU time: %.3f ms voxelization, %.3f ms overlap copy (%.1f MB)", g_ClipmapMovePassTimesMs[CLIPMAP_MOVE_PASS_VOXELIZATION], g_ClipmapMovePassTimesMs[CLIPMAP_MOVE_PASS_OVERLAP_COPY], double(g_ClipmapOverlapCopyBytes) / (1024.0 * 1024.0));
+            TwAddTextLine(msg, color, 0);
+        }
+
+        sprintf_s(msg, "Voxels invalidated: %llu this frame, %.0f average", g_VoxelsInvalidated, g_VoxelsInvalidatedAverage);
+        TwAddTextLine(msg, color, 0);
+
+        sprintf_s(msg, "Scene changes: %u invalidated regions, %u invalidated light frusta", g_SceneChangeTracker.GetInvalidatedRegionCount(), g_SceneChangeTracker.GetInvalidatedLightFrustumCount());
+        TwAddTextLine(msg, color, 0);
+
+        {
+            uint64_t const clipmap_voxels = uint64_t(BRX_VCT_CLIPMAP_MAP_SIZE) * BRX_VCT_CLIPMAP_MAP_SIZE * BRX_VCT_CLIPMAP_MAP_SIZE * BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT;
+            sprintf_s(msg, "Dynamic layer: %llu voxels restored, %.1f%% of the clipmap skipped", g_DynamicLayerRestoredVoxels, 100.0 * double(clipmap_voxels - std::min(g_DynamicLayerRestoredVoxels, clipmap_voxels)) / double(clipmap_voxels));
+            TwAddTextLine(msg, color, 0);
+        }
+
+        uint32_t pending_stack_level_count = 0U;
+        for (uint32_t stack_level = 0U; stack_level < BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT; ++stack_level)
+        {
+            pending_stack_level_count += (g_StaticLayerBuildActive && (0U != (g_StaticLayerBuildPendingMask & (1U << stack_level)))) ? 1U : 0U;
+        }
+        sprintf_s(msg, "Stack levels: %u voxelized this frame, %u pending", g_StackLevelsVoxelized, pending_stack_level_count);
+        TwAddTextLine(msg, color, 0);
+
+        ParameterTuner &tuner = g_TuningSession.GetTuner();
+        if (tuner.IsRunning())
+        {
+            sprintf_s(msg, "Tuning: run %u of %u%s, path frame %u of %u", tuner.GetRunIndex() + 1U, tuner.GetRunCount(), tuner.IsReferenceRun() ? " (reference)" : "", tuner.GetPathFrame() + 1U, g_TuningSession.GetCameraPathFrameCount());
+            TwAddTextLine(msg, color, 0);
+        }
+        else if (g_TuningSession.IsRecording())
+        {
+            sprintf_s(msg, "Recording the camera path: %u frames (press R to stop)", g_TuningSession.GetCameraPathFrameCount());
+            TwAddTextLine(msg, color, 0);
+        }
+
+        if (g_bDynamicResolution)
+        {
+            sprintf_s(msg, "Governor: level %u of %u (cone tracing 1/%u), cone tracing %.2f ms, %u changes%s", g_TracingGovernor.GetLevelIndex() + 1U, g_TracingGovernor.GetLevelCount(), g_ConeTracingResolution, g_TracingGovernor.GetSmoothedTimeMs(), g_TracingGovernor.GetChangeCount(), g_TracingGovernor.IsMeasuring() ? "" : " (frozen)");
+            TwAddTextLine(msg, color, 0);
+        }
+
+        if (g_VoxelStatisticsRecorder.IsEnabled())
+        {
+            for (uint32_t stack_level = 0U; stack_level < BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT; ++stack_level)
+            {
+                VoxelStackLevelStatistics const &stack_level_statistics = g_VoxelStatisticsRecorder.GetCurrentFrame().stack_levels[stack_level];
+                sprintf_s(msg, "Stack level %u: %llu occupied, %llu written, %llu discarded, %llu invalidated, %.1f MB touched", stack_level, stack_level_statistics.occupied_voxel_count, stack_level_statistics.written_voxel_count, stack_level_statistics.discarded_fragment_count, stack_level_statistics.invalidated_voxel_count, double(stack_level_statistics.touched_bytes) / (1024.0 * 1024.0));
+                TwAddTextLine(msg, color, 0);
+            }
+
+            sprintf_s(msg, "Voxel statistics: %u frames recorded (press J to export)", g_VoxelStatisticsRecorder.GetFrameCount());
+            TwAddTextLine(msg, color, 0);
+        }
+
+        for (std::string const &message : g_MessageLog)
+        {
+            TwAddTextLine(message.c_str(), color, 0);
+        }
+
         TwEndText();
     }
 
@@ -302,11 +1272,84 @@ class AntTweakBarVisualController : public IVisualController
         TwAddVarRW(bar, "Ambient scale", TW_TYPE_FLOAT, &g_fAmbientScale, "min=0 max=10 step=0.01");
         TwAddVarRW(bar, "Diffuse scale", TW_TYPE_FLOAT, &g_fDiffuseScale, "min=0 max=10 step=0.01");
         TwAddVarRW(bar, "Specular scale", TW_TYPE_FLOAT, &g_fSpecularScale, "min=0 max=10 step=0.01");
-        TwAddVarRW(bar, "Multi-bounce", TW_TYPE_BOOLCPP, &g_bEnableMultiBounce, "");
-        TwAddVarRW(bar, "Multi-bounce scale", TW_TYPE_FLOAT, &g_fMultiBounceScale, "min=0 max=2 step=0.01");
+        TwAddVarRW(bar, "Voxel bounce (MyIndirectIrradianceCS)", TW_TYPE_BOOLCPP, &g_bEnableMultiBounce, "");
+        TwAddVarRW(bar, "Voxel bounce scale", TW_TYPE_FLOAT, &g_fMultiBounceScale, "min=0 max=2 step=0.01");
+        TwAddVarRW(bar, "Voxel bounce update fraction", TW_TYPE_FLOAT, &g_fMultiBounceUpdateFraction, "min=0.015625 max=1 step=0.005");
+        TwAddVarRW(bar, "Voxel bounce blend", TW_TYPE_FLOAT, &g_fMultiBounceBlend, "min=0 max=1 step=0.01");
+        TwAddVarRW(bar, "Voxel bounce compact voxels", TW_TYPE_BOOLCPP, &g_bCompactVoxels, nullptr);
+        { // Compact voxel radiance encoding
+            TwEnumVal compactVoxelRadianceEncodingEV[] = {
+                {int(VoxelRadianceEncoding::RGB9E5), "RGB9E5"},
+                {int(VoxelRadianceEncoding::R11G11B10), "R11G11B10"}};
+            TwType compactVoxelRadianceEncodingType = TwDefineEnum("Compact Voxel Radiance Encoding", compactVoxelRadianceEncodingEV, sizeof(compactVoxelRadianceEncodingEV) / sizeof(compactVoxelRadianceEncodingEV[0]));
+            TwAddVarRW(bar, "Voxel bounce radiance encoding", compactVoxelRadianceEncodingType, &g_CompactVoxelRadianceEncoding, nullptr);
+        }
         TwAddVarRW(bar, "Quality", TW_TYPE_FLOAT, &g_fQuality, "min=0 max=1 step=0.01");
         TwAddVarRW(bar, "Sampling rate", TW_TYPE_FLOAT, &g_fSamplingRate, "min=0.25 max=1 step=0.01");
+        { // Tracing resolution
+            TwEnumVal tracingResolutionEV[] = {
+                {int(VXGI::TracingResolution::FULL), "Full"},
+                {int(VXGI::TracingResolution::HALF), "Half"},
+                {int(VXGI::TracingResolution::THIRD), "Third"},
+                {int(VXGI::TracingResolution::QUARTER), "Quarter"}};
+            TwType tracingResolutionType = TwDefineEnum("Tracing Resolution", tracingResolutionEV, sizeof(tracingResolutionEV) / sizeof(tracingResolutionEV[0]));
+            TwAddVarRW(bar, "Tracing resolution", tracingResolutionType, &g_TracingResolution, nullptr);
+        }
+        TwAddVarRW(bar, "Tracing step", TW_TYPE_FLOAT, &g_fTracingStep, "min=0.5 max=1 step=0.01");
+        { // Cone tracing resolution
+            TwEnumVal coneTracingResolutionEV[] = {
+                {1, "Full"},
+                {2, "Half"},
+                {4, "Quarter"}};
+            TwType coneTracingResolutionType = TwDefineEnum("Cone Tracing Resolution", coneTracingResolutionEV, sizeof(coneTracingResolutionEV) / sizeof(coneTracingResolutionEV[0]));
+            TwAddVarRW(bar, "Cone tracing resolution", coneTracingResolutionType, &g_ConeTracingResolution, nullptr);
+        }
+        TwAddVarRW(bar, "Cone tracing history", TW_TYPE_BOOLCPP, &g_bConeTracingHistory, nullptr);
         TwAddVarRW(bar, "Temporal Filtering", TW_TYPE_BOOLCPP, &g_bTemporalFiltering, nullptr);
+        TwAddVarRW(bar, "Clipmap snapshots", TW_TYPE_BOOLCPP, &g_bUseClipmapSnapshots, nullptr);
+        TwAddVarRW(bar, "Light-only injection", TW_TYPE_BOOLCPP, &g_bLightOnlyInjection, nullptr);
+        TwAddVarRW(bar, "Derive coarse stack levels", TW_TYPE_BOOLCPP, &g_bDeriveCoarseStackLevels, nullptr);
+        { // Light injection mode
+            TwEnumVal lightInjectionModeEV[] = {
+                {int(LightInjectionMode::VOXEL_SURFACE), "Voxel surface"},
+                {int(LightInjectionMode::SHADOW_MAP), "Shadow map"}};
+            TwType lightInjectionModeType = TwDefineEnum("Light injection mode", lightInjectionModeEV, sizeof(lightInjectionModeEV) / sizeof(lightInjectionModeEV[0]));
+            TwAddVarRW(bar, "Light injection mode", lightInjectionModeType, &g_LightInjectionMode, nullptr);
+        }
+
+        TwAddVarRW(bar, "Anchor hysteresis", TW_TYPE_BOOLCPP, &g_bClipmapAnchorHysteresis, "group='Clipmap anchor'");
+        TwAddVarRW(bar, "Anchor look-ahead", TW_TYPE_FLOAT, g_ClipmapAnchorController.GetLookAheadTimePointer(), "min=0 max=2 step=0.05 group='Clipmap anchor'");
+        for (uint32_t stack_level = 0U; stack_level < BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT; ++stack_level)
+        {
+            char name[64];
+            sprintf_s(name, "Dead zone L%u", stack_level);
+            TwAddVarRW(bar, name, TW_TYPE_FLOAT, g_ClipmapAnchorController.GetDeadZonePointer(stack_level), "min=0 max=32 step=0.5 group='Clipmap anchor'");
+        }
+
+        TwAddVarRW(bar, "Time-sliced voxelization", TW_TYPE_BOOLCPP, &g_bTimeSlicedVoxelization, "group='Time slicing'");
+        TwAddVarRW(bar, "Copy clipmap overlap", TW_TYPE_BOOLCPP, &g_bClipmapOverlapCopy, "group='Time slicing'");
+        TwAddVarRW(bar, "Measure clipmap move", TW_TYPE_BOOLCPP, &g_bMeasureClipmapMove, "group='Time slicing'");
+        {
+            char def[64];
+            sprintf_s(def, "min=0 max=%u group='Time slicing'", uint32_t(BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT));
+            TwAddVarRW(bar, "Every-frame levels", TW_TYPE_UINT32, g_ClipmapStackLevelScheduler.GetEveryFrameStackLevelCountPointer(), def);
+        }
+        TwAddVarRW(bar, "Coarse level period", TW_TYPE_UINT32, g_ClipmapStackLevelScheduler.GetCoarseStackLevelPeriodPointer(), "min=1 max=16 group='Time slicing'");
+        TwAddVarRW(bar, "Triangle budget", TW_TYPE_UINT32, g_ClipmapStackLevelScheduler.GetTriangleBudgetPointer(), "min=0 step=10000 group='Time slicing'");
+
+        TwAddVarRW(bar, "Track scene changes", TW_TYPE_BOOLCPP, &g_bTrackSceneChanges, "group='Scene changes'");
+        TwAddVarRW(bar, "Page size (voxels)", TW_TYPE_UINT32, &g_InvalidationPageVoxels, "min=0 max=128 group='Scene changes'");
+
+        TwAddVarRW(bar, "Frame budget (ms)", TW_TYPE_FLOAT, g_TuningSession.GetTuner().GetFrameBudgetPointer(), "min=0 step=0.1 group='Tuner'");
+        TwAddVarRW(bar, "Target error", TW_TYPE_FLOAT, g_TuningSession.GetTuner().GetTargetErrorPointer(), "min=0 max=1 step=0.001 group='Tuner'");
+
+        TwAddVarRW(bar, "Dynamic resolution", TW_TYPE_BOOLCPP, &g_bDynamicResolution, "group='Governor'");
+        TwAddVarRW(bar, "Tracing budget (ms)", TW_TYPE_FLOAT, g_TracingGovernor.GetBudgetPointer(), "min=0 step=0.1 group='Governor'");
+        TwAddVarRW(bar, "Up threshold", TW_TYPE_FLOAT, g_TracingGovernor.GetUpThresholdPointer(), "min=0 max=1 step=0.01 group='Governor'");
+        TwAddVarRW(bar, "Up frames", TW_TYPE_UINT32, g_TracingGovernor.GetUpFrameCountPointer(), "min=1 max=300 group='Governor'");
+
+        TwAddVarRW(bar, "Record", TW_TYPE_BOOLCPP, g_VoxelStatisticsRecorder.GetEnabledPointer(), "group='Voxel statistics'");
+        TwAddVarRW(bar, "Max frames", TW_TYPE_UINT32, g_VoxelStatisticsRecorder.GetMaxFrameCountPointer(), "min=0 step=256 group='Voxel statistics'");
 
         { // Rendering mode
             TwEnumVal renderingModeEV[] = {
@@ -350,6 +1393,36 @@ class MainVisualController : public IVisualController
                 g_RenderingMode = RenderingMode::NORMAL;
                 return 0;
                 break;
+
+            case 'B':
+                g_bBakeClipmapSnapshot = true;
+                return 0;
+                break;
+
+            case 'V':
+                g_bValidateVoxelization = true;
+                return 0;
+                break;
+
+            case 'C':
+                g_bValidateConeTracing = true;
+                return 0;
+                break;
+
+            case 'J':
+                g_VoxelStatisticsRecorder.RequestExport();
+                return 0;
+                break;
+
+            case 'R':
+                g_TuningSession.ToggleRecording();
+                return 0;
+                break;
+
+            case 'T':
+                g_TuningSession.RequestStart();
+                return 0;
+                break;
             }
         }
 
@@ -361,6 +1434,22 @@ class MainVisualController : public IVisualController
         g_Camera.FrameMove((float)fElapsedTimeSeconds);
         g_LightCamera.FrameMove((float)fElapsedTimeSeconds);
 
+        // the recorded camera path replaces the input while tuning
+        CameraPathFrame const *const pathFrame = g_TuningSession.GetCameraPathFrame();
+        if (NULL != pathFrame)
+        {
+            g_Camera.SetViewParams(XMVectorSet(pathFrame->eye[0], pathFrame->eye[1], pathFrame->eye[2], 0.0f), XMVectorSet(pathFrame->look_at[0], pathFrame->look_at[1], pathFrame->look_at[2], 0.0f));
+        }
+        else if (g_TuningSession.IsRecording())
+        {
+            CameraPathFrame frame;
+            XMVECTOR eyePt = g_Camera.GetEyePt();
+            XMVECTOR lookAtPt = g_Camera.GetLookAtPt();
+            memcpy(frame.eye, eyePt.m128_f32, sizeof(frame.eye));
+            memcpy(frame.look_at, lookAtPt.m128_f32, sizeof(frame.look_at));
+            g_TuningSession.RecordCameraPathFrame(frame);
+        }
+
         XMVECTOR lightDir = g_LightCamera.GetLookAtPt() - g_LightCamera.GetEyePt();
         g_pSceneRenderer->SetLightDirection(VXGI::float3(lightDir.m128_f32));
     }
@@ -378,6 +1467,20 @@ class MainVisualController : public IVisualController
         g_pRendererInterface->setNonManagedTextureResourceState(mainRenderTarget, D3D12_RESOURCE_STATE_RENDER_TARGET);
 #endif
 
+        TuningParameters tuningParameters;
+        bool const tuning = g_TuningSession.BeginFrame(GetTuningParameters(), tuningParameters);
+        if (tuning)
+        {
+            SetTuningParameters(tuningParameters);
+        }
+
+        // the governor only measures the frames in which "MyConeTracingCS" computes the channel, and keeps its level in the other frames
+        g_TracingGovernor.BeginFrame(g_bDynamicResolution && (!tuning), (RenderingMode::NORMAL == g_RenderingMode) && g_bEnableGI && ((g_fDiffuseScale > 0) || (g_fSpecularScale > 0)), ReadGovernorQuery);
+        if (g_TracingGovernor.IsMeasuring())
+        {
+            SetGovernorLevel(g_TracingGovernor.GetLevel());
+        }
+
         XMVECTOR eyePt = g_Camera.GetEyePt();
         XMVECTOR viewForward = g_Camera.GetWorldAhead();
         XMMATRIX viewMatrix = g_Camera.GetViewMatrix();
@@ -398,9 +1501,35 @@ class MainVisualController : public IVisualController
             g_pRendererInterface->debugEndEvent();
         }
 
+        if (tuning)
+        {
+            g_pRendererInterface->beginPerformanceQuery(g_TuningPassQueries[TUNING_PASS_VOXELIZATION]);
+        }
+
         {
             SetVoxelizationParameters();
 
+            g_pSceneRenderer->ResetVoxelizationStatistics();
+
+            g_VoxelsInvalidated = 0U;
+            g_StackLevelsVoxelized = 0U;
+
+            g_pSceneRenderer->SetVoxelStatisticsEnabled(g_VoxelStatisticsRecorder.IsEnabled());
+
+            // the static layer is voxelized again when the derivation is toggled
+            if (g_bDeriveCoarseStackLevels != g_StaticLayerDerived)
+            {
+                g_StaticLayerValid = false;
+                g_StaticLayerBuildActive = false;
+                g_StaticLayerDerived = g_bDeriveCoarseStackLevels;
+            }
+            g_pSceneRenderer->SetDeriveCoarseStackLevels(g_StaticLayerDerived);
+            g_VoxelStatisticsRecorder.BeginFrame();
+            if (g_VoxelStatisticsRecorder.IsEnabled())
+            {
+                g_pSceneRenderer->ClearVoxelStatistics();
+            }
+
             if (g_bEnableGI || g_RenderingMode != RenderingMode::NORMAL)
             {
                 DirectX::XMFLOAT3 clipmap_anchor;
@@ -409,15 +1538,72 @@ class MainVisualController : public IVisualController
                     DirectX::XMStoreFloat3(&clipmap_anchor, centerPt);
                 }
 
+                if (g_bClipmapAnchorHysteresis)
+                {
+                    VXGI::float3 const velocity(g_Camera.GetWorldVelocity().m128_f32);
+                    VXGI::float3 const filtered_anchor = g_ClipmapAnchorController.Update(VXGI::float3(clipmap_anchor.x, clipmap_anchor.y, clipmap_anchor.z), velocity);
+                    clipmap_anchor = DirectX::XMFLOAT3(filtered_anchor.x, filtered_anchor.y, filtered_anchor.z);
+                }
+                else
+                {
+                    g_ClipmapAnchorController.Reset();
+                }
+
+                // the build is committed before the clipmap anchor is used, so that the voxelization and the tracing agree on the clipmap center
+                if (g_StaticLayerBuildActive && (0U == g_StaticLayerBuildPendingMask))
+                {
+                    if (g_StaticLayerDerived)
+                    {
+                        g_pSceneRenderer->DeriveCoarseStackLevels(g_clipmap_build_opacity_texture, g_clipmap_build_illumination_texture);
+                    }
+
+                    std::swap(g_clipmap_static_opacity_texture, g_clipmap_build_opacity_texture);
+                    std::swap(g_clipmap_static_illumination_texture, g_clipmap_build_illumination_texture);
+                    std::swap(g_clipmap_static_surface_texture, g_clipmap_build_surface_texture);
+                    g_StaticLayerSurfaceValid = g_StaticLayerBuildSurfaceValid;
+                    g_StaticLayerClipmapAnchor = g_StaticLayerBuildClipmapAnchor;
+                    g_StaticLayerClipmapCenter = g_StaticLayerBuildClipmapCenter;
+                    g_StaticLayerLightDirection = g_StaticLayerBuildLightDirection;
+                    g_StaticLayerFromSnapshot = g_StaticLayerBuildFromSnapshot;
+                    g_StaticLayerBuildActive = false;
+                    g_StaticLayerChanged = true;
+                }
+
+                // while the static layer is built for the target anchor, the clipmap stays at the anchor of the current static layer
+                DirectX::XMFLOAT3 const target_clipmap_anchor = clipmap_anchor;
+                if (g_bTimeSlicedVoxelization && g_StaticLayerValid)
+                {
+                    clipmap_anchor = g_StaticLayerClipmapAnchor;
+                }
+
                 VXGI::UpdateVoxelizationParameters params;
                 params.clipmapAnchor.x = clipmap_anchor.x;
                 params.clipmapAnchor.y = clipmap_anchor.y;
                 params.clipmapAnchor.z = clipmap_anchor.z;
+                g_TracingClipmapCenter = brx_voxel_cone_tracing_voxelization_compute_clipmap_center(clipmap_anchor);
                 params.finestVoxelSize = g_fVoxelSize;
                 params.indirectIrradianceMapTracingParameters.irradianceScale = g_fMultiBounceScale;
                 params.indirectIrradianceMapTracingParameters.useAutoNormalization = true;
                 params.indirectIrradianceMapTracingParameters.lightLeakingAmount = VXGI::LightLeakingAmount::MODERATE;
 
+                if (g_bTrackSceneChanges)
+                {
+                    g_SceneChangeTracker.SetPageSize(g_fVoxelSize * float(g_InvalidationPageVoxels));
+                    g_SceneChangeTracker.BeginFrame();
+                    g_pSceneRenderer->TrackSceneChanges(g_SceneChangeTracker, g_bDrawTransparent);
+                    g_SceneChangeTracker.EndFrame();
+
+                    params.invalidatedRegions = g_SceneChangeTracker.GetInvalidatedRegions();
+                    params.invalidatedRegionCount = g_SceneChangeTracker.GetInvalidatedRegionCount();
+                    params.invalidatedLightFrusta = g_SceneChangeTracker.GetInvalidatedLightFrusta();
+                    params.invalidatedFrustumCount = g_SceneChangeTracker.GetInvalidatedLightFrustumCount();
+                }
+                else
+                {
+                    // every object and the light are invalidated when the tracking is enabled again
+                    g_SceneChangeTracker.Reset();
+                }
+
                 bool performOpacityVoxelization = false;
                 bool performEmittanceVoxelization = false;
                 {
@@ -433,7 +1619,27 @@ class MainVisualController : public IVisualController
 
                 FLUSH_COMMAND_LIST;
 
-                if (performOpacityVoxelization || performEmittanceVoxelization)
+                DirectX::XMFLOAT3 const clipmap_center = brx_voxel_cone_tracing_voxelization_compute_clipmap_center(target_clipmap_anchor);
+                VXGI::float3 const light_direction = g_pSceneRenderer->GetLightDirection();
+
+                // The static layer is only invalidated when the clipmap moves or the light changes (the illumination contains the direct lighting)
+                bool const clipmap_moved =
+                    (!g_StaticLayerValid) ||
+                    (clipmap_center.x != g_StaticLayerClipmapCenter.x) || (clipmap_center.y != g_StaticLayerClipmapCenter.y) || (clipmap_center.z != g_StaticLayerClipmapCenter.z);
+
+                bool const light_changed =
+                    (light_direction.x != g_StaticLayerLightDirection.x) || (light_direction.y != g_StaticLayerLightDirection.y) || (light_direction.z != g_StaticLayerLightDirection.z);
+
+                bool const static_layer_invalidated = clipmap_moved || light_changed;
+
+                // the multi-bounce updates a slice of the voxels every frame, and the irradiance applied before is removed once the multi-bounce is disabled
+                bool const multi_bounce_due = (g_bEnableMultiBounce && g_StaticLayerSurfaceValid) || g_IndirectIrradianceApplied;
+
+                // With the persistent voxel data, VXGI skips the frames without the invalidated regions (which include the regions of the moved dynamic meshes)
+                // The custom clipmap is only updated in the other frames when the static layer is invalidated, the time-sliced build is active or a multi-bounce step is due
+                bool const custom_clipmap_due = static_layer_invalidated || g_StaticLayerBuildActive || g_StaticLayerChanged || multi_bounce_due;
+
+                if (performOpacityVoxelization || performEmittanceVoxelization || custom_clipmap_due)
                 {
                     VXGI::VoxelizationViewParameters viewParams;
                     g_pGI->getVoxelizationViewParameters(viewParams);
@@ -447,20 +1653,325 @@ class MainVisualController : public IVisualController
                     {
                         g_pRendererInterface->debugBeginEvent("VXGI Light Injection (Voxelization Opacity Geometry)");
 
+                        bool const dynamic_layer = g_pSceneRenderer->HasDynamicMeshes();
+
+                        bool const light_only_injection = light_changed && (!clipmap_moved) && g_bLightOnlyInjection && g_StaticLayerSurfaceValid;
+
+                        if (light_changed && (!clipmap_moved))
+                        {
+                            g_LastLightChange = (!light_only_injection) ? "re-voxelized" : ((LightInjectionMode::SHADOW_MAP == g_LightInjectionMode) ? "injected from the shadow map" : "injected from the voxel surface");
+                        }
+
+                        if (light_only_injection)
                         {
+                            // the opacity is still valid, only the illumination is injected again from the voxel surface
+                            g_StaticLayerBuildActive = false;
+
                             float const zero_float = 0.0F;
-                            uint32_t const zero_uint = (*reinterpret_cast<uint32_t const *>(&zero_float));
-                            g_pRendererInterface->clearTextureUInt(g_clipmap_opacity_texture, zero_uint);
-                            g_pRendererInterface->clearTextureUInt(g_clipmap_illumination_texture, zero_uint);
+                            g_pRendererInterface->clearTextureUInt(g_clipmap_static_illumination_texture, (*reinterpret_cast<uint32_t const *>(&zero_float)));
+
+                            // the working opacity is used as the scratch, since it is restored from the static layer below
+                            if (LightInjectionMode::SHADOW_MAP == g_LightInjectionMode)
+                            {
+                                g_pSceneRenderer->InjectShadowMapLight(clipmap_anchor, g_clipmap_static_surface_texture, g_clipmap_opacity_texture, g_clipmap_static_illumination_texture);
+                            }
+                            else
+                            {
+                                g_pSceneRenderer->InjectVoxelLight(clipmap_anchor, g_clipmap_static_surface_texture, g_clipmap_opacity_texture, g_clipmap_static_illumination_texture);
+                            }
+
+                            // the voxel surface of the derived voxels is not written, thus their illumination is derived again
+                            if (g_StaticLayerDerived)
+                            {
+                                g_pSceneRenderer->DeriveCoarseStackLevels(g_clipmap_static_opacity_texture, g_clipmap_static_illumination_texture);
+                            }
+
+                            g_StaticLayerLightDirection = light_direction;
+                            g_StaticLayerChanged = true;
+                        }
+                        else if (static_layer_invalidated && ((!g_bTimeSlicedVoxelization) || (!g_StaticLayerValid)))
+                        {
+                            // the first static layer (or every static layer without time slicing) is voxelized at once
+                            g_StaticLayerBuildActive = false;
+
+                            uint32_t const overlap_mask = GetClipmapOverlapStackLevelMask(clipmap_center, light_direction);
+
+                            uint64_t scrolled_voxel_counts[BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT];
+                            uint64_t revoxelized_voxel_counts[BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT];
+                            UpdateClipmapMoveStatistics(clipmap_center, overlap_mask, scrolled_voxel_counts, revoxelized_voxel_counts);
+
+                            // the voxel surface of the copied voxels is only valid when the voxel surface of the current static layer is
+                            bool const surface_valid = (0U == overlap_mask) || g_StaticLayerSurfaceValid;
+
+                            bool snapshot_surface_valid = false;
+                            g_StaticLayerFromSnapshot = g_bUseClipmapSnapshots && UploadClipmapSnapshot(GetClipmapSnapshotKey(clipmap_center), clipmap_anchor, light_direction, g_clipmap_static_opacity_texture, g_clipmap_static_illumination_texture, g_clipmap_static_surface_texture, snapshot_surface_valid);
+
+                            if (!g_StaticLayerFromSnapshot)
+                            {
+                                g_VoxelsInvalidated += g_ClipmapRevoxelizedVoxels;
+                                g_StackLevelsVoxelized = BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT;
+                                AddVoxelFrameStatisticsInvalidatedStackLevels(CLIPMAP_ALL_STACK_LEVELS_MASK, g_VoxelStatisticsRecorder.GetCurrentFrame());
+
+                                // the static layer around the new clipmap center is built in the build textures, which then replace the current static layer
+                                ClearClipmapTextures(g_clipmap_build_opacity_texture, g_clipmap_build_illumination_texture);
+                                g_pRendererInterface->clearTextureUInt(g_clipmap_build_surface_texture, 0U);
+
+                                VXGI::Box3f clipping_boxes[3U * BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT];
+                                uint32_t const clipping_box_count = GetClipmapMoveClippingBoxes(g_StaticLayerClipmapCenter, clipmap_center, overlap_mask, CLIPMAP_ALL_STACK_LEVELS_MASK, clipping_boxes);
+
+                                if (0U != clipping_box_count)
+                                {
+                                    BeginClipmapMovePass(CLIPMAP_MOVE_PASS_VOXELIZATION);
+                                    NVRHI::DrawCallState emptyState;
+                                    g_pSceneRenderer->RenderForVoxelization(emptyState, g_pGI, clipping_boxes, clipping_box_count, clipmap_anchor, voxelizationMatrix, NULL, VoxelizationLayer::STATIC, g_clipmap_build_opacity_texture, g_clipmap_build_illumination_texture, g_clipmap_build_surface_texture, CLIPMAP_ALL_STACK_LEVELS_MASK);
+                                    EndClipmapMovePass(CLIPMAP_MOVE_PASS_VOXELIZATION);
+                                }
+
+                                if (0U != overlap_mask)
+                                {
+                                    CopyClipmapOverlapTextures(g_StaticLayerClipmapCenter, clipmap_center, overlap_mask);
+                                }
+
+                                std::swap(g_clipmap_static_opacity_texture, g_clipmap_build_opacity_texture);
+                                std::swap(g_clipmap_static_illumination_texture, g_clipmap_build_illumination_texture);
+                                std::swap(g_clipmap_static_surface_texture, g_clipmap_build_surface_texture);
+                            }
+
+                            if (g_StaticLayerDerived)
+                            {
+                                g_pSceneRenderer->DeriveCoarseStackLevels(g_clipmap_static_opacity_texture, g_clipmap_static_illumination_texture);
+                            }
+
+                            g_StaticLayerSurfaceValid = g_StaticLayerFromSnapshot ? snapshot_surface_valid : surface_valid;
+                            g_StaticLayerValid = true;
+                            g_StaticLayerClipmapAnchor = clipmap_anchor;
+                            g_StaticLayerClipmapCenter = clipmap_center;
+                            g_StaticLayerLightDirection = light_direction;
+                            g_StaticLayerChanged = true;
+                        }
+                        else if (static_layer_invalidated)
+                        {
+                            // a new build is started whenever the target moves again
+                            if ((!g_StaticLayerBuildActive) ||
+                                (clipmap_center.x != g_StaticLayerBuildClipmapCenter.x) || (clipmap_center.y != g_StaticLayerBuildClipmapCenter.y) || (clipmap_center.z != g_StaticLayerBuildClipmapCenter.z) ||
+                                (light_direction.x != g_StaticLayerBuildLightDirection.x) || (light_direction.y != g_StaticLayerBuildLightDirection.y) || (light_direction.z != g_StaticLayerBuildLightDirection.z))
+                            {
+                                g_StaticLayerBuildOverlapMask = GetClipmapOverlapStackLevelMask(clipmap_center, light_direction);
+                                g_StaticLayerBuildPreviousClipmapCenter = g_StaticLayerClipmapCenter;
+                                UpdateClipmapMoveStatistics(clipmap_center, g_StaticLayerBuildOverlapMask, g_StaticLayerBuildScrolledVoxels, g_StaticLayerBuildRevoxelizedVoxels);
+
+                                bool snapshot_surface_valid = false;
+                                g_StaticLayerBuildFromSnapshot = g_bUseClipmapSnapshots && UploadClipmapSnapshot(GetClipmapSnapshotKey(clipmap_center), target_clipmap_anchor, light_direction, g_clipmap_build_opacity_texture, g_clipmap_build_illumination_texture, g_clipmap_build_surface_texture, snapshot_surface_valid);
+
+                                if (!g_StaticLayerBuildFromSnapshot)
+                                {
+                                    ClearClipmapTextures(g_clipmap_build_opacity_texture, g_clipmap_build_illumination_texture);
+                                    g_pRendererInterface->clearTextureUInt(g_clipmap_build_surface_texture, 0U);
+                                }
+
+                                g_StaticLayerBuildSurfaceValid = g_StaticLayerBuildFromSnapshot ? snapshot_surface_valid : ((0U == g_StaticLayerBuildOverlapMask) || g_StaticLayerSurfaceValid);
+
+                                g_StaticLayerBuildActive = true;
+                                g_StaticLayerBuildPendingMask = g_StaticLayerBuildFromSnapshot ? 0U : CLIPMAP_ALL_STACK_LEVELS_MASK;
+                                g_StaticLayerBuildClipmapAnchor = target_clipmap_anchor;
+                                g_StaticLayerBuildClipmapCenter = clipmap_center;
+                                g_StaticLayerBuildLightDirection = light_direction;
+                            }
+
+                            if (0U != g_StaticLayerBuildPendingMask)
+                            {
+                                uint32_t triangle_counts[BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT];
+                                g_pSceneRenderer->GetVoxelizationTriangleCounts(target_clipmap_anchor, VoxelizationLayer::STATIC, triangle_counts);
+
+                                uint32_t const stack_level_mask = g_ClipmapStackLevelScheduler.Schedule(g_StaticLayerBuildPendingMask, g_StaticLayerBuildScrolledVoxels, triangle_counts);
+
+                                // the invalidated regions of VXGI belong to the current clipmap anchor, thus the build is clipped by the scrolled slabs instead
+                                VXGI::Box3f clipping_boxes[3U * BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT];
+                                uint32_t const clipping_box_count = GetClipmapMoveClippingBoxes(g_StaticLayerBuildPreviousClipmapCenter, g_StaticLayerBuildClipmapCenter, g_StaticLayerBuildOverlapMask, stack_level_mask, clipping_boxes);
+
+                                if (0U != clipping_box_count)
+                                {
+                                    BeginClipmapMovePass(CLIPMAP_MOVE_PASS_VOXELIZATION);
+                                    NVRHI::DrawCallState emptyState;
+                                    g_pSceneRenderer->RenderForVoxelization(emptyState, g_pGI, clipping_boxes, clipping_box_count, target_clipmap_anchor, voxelizationMatrix, NULL, VoxelizationLayer::STATIC, g_clipmap_build_opacity_texture, g_clipmap_build_illumination_texture, g_clipmap_build_surface_texture, stack_level_mask);
+                                    EndClipmapMovePass(CLIPMAP_MOVE_PASS_VOXELIZATION);
+                                }
+
+                                // the current static layer is not modified while the build is active
+                                uint32_t const copy_mask = stack_level_mask & g_StaticLayerBuildOverlapMask;
+                                if (0U != copy_mask)
+                                {
+                                    CopyClipmapOverlapTextures(g_StaticLayerBuildPreviousClipmapCenter, g_StaticLayerBuildClipmapCenter, copy_mask);
+                                }
+
+                                g_StaticLayerBuildPendingMask &= (~stack_level_mask);
+                                AddVoxelFrameStatisticsInvalidatedStackLevels(stack_level_mask, g_VoxelStatisticsRecorder.GetCurrentFrame());
+
+                                for (uint32_t stack_level = 0U; stack_level < BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT; ++stack_level)
+                                {
+                                    if (0U != (stack_level_mask & (1U << stack_level)))
+                                    {
+                                        ++g_StackLevelsVoxelized;
+                                        g_VoxelsInvalidated += g_StaticLayerBuildRevoxelizedVoxels[stack_level];
+                                    }
+                                }
+                            }
+                        }
+                        else
+                        {
+                            // the target moved back to the current static layer before the build completed
+                            g_StaticLayerBuildActive = false;
+                        }
+
+                        // the indirect irradiance is gathered for the voxel surface, and the indirect irradiance added before is removed by restoring the static layer
+                        bool const multi_bounce = g_bEnableMultiBounce && g_StaticLayerSurfaceValid;
+                        if ((multi_bounce != g_IndirectIrradianceApplied) || (multi_bounce && (g_fMultiBounceScale != g_IndirectIrradianceScale)))
+                        {
+                            g_StaticLayerChanged = true;
+                        }
+
+                        // While the static layer is unchanged, the dynamic meshes of the previous frame persist outside of the invalidated regions, and only the invalidated regions are restored from the static layer (with the stored irradiance applied again)
+                        bool const persistent_dynamic_layer = g_bTrackSceneChanges && dynamic_layer && g_DynamicLayerPrev && (!g_StaticLayerChanged) &&
+                                                              IsClipmapVoxelTextureLayout(g_clipmap_opacity_texture) && IsClipmapVoxelTextureLayout(g_clipmap_illumination_texture);
+
+                        DirectX::XMFLOAT3 const dynamic_clipmap_center = brx_voxel_cone_tracing_voxelization_compute_clipmap_center(clipmap_anchor);
+                        g_DynamicLayerRestoredVoxels = 0U;
+
+                        if (persistent_dynamic_layer)
+                        {
+                            GetClipmapRegionVoxelBoxes(VXGI::float3(dynamic_clipmap_center.x, dynamic_clipmap_center.y, dynamic_clipmap_center.z), regions, numRegions, g_DynamicLayerVoxelBoxes);
+
+                            RestoreClipmapVoxelBoxes(g_clipmap_opacity_texture, g_clipmap_static_opacity_texture, g_DynamicLayerVoxelBoxes);
+                            RestoreClipmapVoxelBoxes(g_clipmap_illumination_texture, g_clipmap_static_illumination_texture, g_DynamicLayerVoxelBoxes);
+
+                            for (ClipmapVoxelBox const &voxel_box : g_DynamicLayerVoxelBoxes)
+                            {
+                                g_DynamicLayerRestoredVoxels += uint64_t(voxel_box.upper[0] - voxel_box.lower[0]) * uint64_t(voxel_box.upper[1] - voxel_box.lower[1]) * uint64_t(voxel_box.upper[2] - voxel_box.lower[2]);
+
+                                // the boxes do not overlap, thus the irradiance is applied once per voxel
+                                // the regions invalidated by the scene changes are marked as invalidated, thus the voxels around the dynamic meshes are updated with the priority of the recently invalidated voxels
+                                if (g_IndirectIrradianceApplied && g_IndirectIrradianceValid)
+                                {
+                                    g_pSceneRenderer->UpdateIndirectIrradiance(clipmap_anchor, IndirectIrradiancePass::APPLY_AND_INVALIDATE, g_clipmap_static_surface_texture, g_clipmap_opacity_texture, g_clipmap_illumination_texture, g_clipmap_indirect_irradiance_texture, 0U, 1U, 0.0f, g_IndirectIrradianceScale, &voxel_box);
+                                }
+                            }
+                        }
+                        // The dynamic meshes of the previous frame are removed by restoring the static layer
+                        else if (g_StaticLayerChanged || dynamic_layer || g_DynamicLayerPrev)
+                        {
+                            g_DynamicLayerRestoredVoxels = uint64_t(BRX_VCT_CLIPMAP_MAP_SIZE) * BRX_VCT_CLIPMAP_MAP_SIZE * BRX_VCT_CLIPMAP_MAP_SIZE * BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT;
+
+                            CopyClipmapTexture(g_clipmap_opacity_texture, g_clipmap_static_opacity_texture);
+                            CopyClipmapTexture(g_clipmap_illumination_texture, g_clipmap_static_illumination_texture);
+                            g_StaticLayerChanged = false;
+
+                            if (multi_bounce)
+                            {
+                                g_IndirectIrradianceScale = g_fMultiBounceScale;
+
+                                if ((!g_IndirectIrradianceValid) ||
+                                    (g_StaticLayerClipmapCenter.x != g_IndirectIrradianceClipmapCenter.x) || (g_StaticLayerClipmapCenter.y != g_IndirectIrradianceClipmapCenter.y) || (g_StaticLayerClipmapCenter.z != g_IndirectIrradianceClipmapCenter.z))
+                                {
+                                    // the voxels of the stored irradiance belong to another clipmap center
+                                    g_pRendererInterface->clearTextureUInt(g_clipmap_indirect_irradiance_texture, 0U);
+                                    g_IndirectIrradianceValid = true;
+                                    g_IndirectIrradianceClipmapCenter = g_StaticLayerClipmapCenter;
+                                    g_IndirectIrradianceLightDirection = g_StaticLayerLightDirection;
+                                }
+                                else
+                                {
+                                    // the stored irradiance is kept after the light changes, but the voxels are updated first and replace the stored irradiance
+                                    bool const light_changed_since_update =
+                                        (g_StaticLayerLightDirection.x != g_IndirectIrradianceLightDirection.x) || (g_StaticLayerLightDirection.y != g_IndirectIrradianceLightDirection.y) || (g_StaticLayerLightDirection.z != g_IndirectIrradianceLightDirection.z);
+                                    g_IndirectIrradianceLightDirection = g_StaticLayerLightDirection;
+
+                                    g_pSceneRenderer->UpdateIndirectIrradiance(clipmap_anchor, light_changed_since_update ? IndirectIrradiancePass::APPLY_AND_INVALIDATE : IndirectIrradiancePass::APPLY, g_clipmap_static_surface_texture, g_clipmap_opacity_texture, g_clipmap_illumination_texture, g_clipmap_indirect_irradiance_texture, 0U, 1U, 0.0f, g_IndirectIrradianceScale);
+                                }
+                            }
+                            else
+                            {
+                                g_IndirectIrradianceValid = false;
+                            }
+
+                            g_IndirectIrradianceApplied = multi_bounce;
+                        }
+
+                        // the dynamic layer is voxelized around the current clipmap anchor rather than the target of the build
+                        if (dynamic_layer && persistent_dynamic_layer)
+                        {
+                            // the unchanged regions are skipped, and no draw call is made when nothing changed
+                            if (0U != numRegions)
+                            {
+                                AddVoxelFrameStatisticsInvalidatedRegions(VXGI::float3(dynamic_clipmap_center.x, dynamic_clipmap_center.y, dynamic_clipmap_center.z), regions, numRegions, g_VoxelStatisticsRecorder.GetCurrentFrame());
+
+                                NVRHI::DrawCallState emptyState;
+                                g_pSceneRenderer->RenderForVoxelization(emptyState, g_pGI, regions, numRegions, clipmap_anchor, voxelizationMatrix, NULL, VoxelizationLayer::DYNAMIC, g_clipmap_opacity_texture, g_clipmap_illumination_texture, NULL, CLIPMAP_ALL_STACK_LEVELS_MASK);
+                            }
+                        }
+                        else if (dynamic_layer)
+                        {
+                            // the whole dynamic layer was removed by restoring the static layer, thus the voxelization is not clipped to the invalidated regions
+                            AddVoxelFrameStatisticsInvalidatedStackLevels(CLIPMAP_ALL_STACK_LEVELS_MASK, g_VoxelStatisticsRecorder.GetCurrentFrame());
+
+                            NVRHI::DrawCallState emptyState;
+                            g_pSceneRenderer->RenderForVoxelization(emptyState, g_pGI, NULL, 0U, clipmap_anchor, voxelizationMatrix, NULL, VoxelizationLayer::DYNAMIC, g_clipmap_opacity_texture, g_clipmap_illumination_texture, NULL, CLIPMAP_ALL_STACK_LEVELS_MASK);
                         }
 
-                        NVRHI::DrawCallState emptyState;
-                        g_pSceneRenderer->RenderForVoxelization(emptyState, g_pGI, regions, numRegions, clipmap_anchor, voxelizationMatrix, NULL);
+                        g_DynamicLayerPrev = dynamic_layer;
+
+                        // a fixed slice of the voxels per frame: the period is the inverse of the update fraction (at most the 64 voxels of the 4 x 4 x 4 block)
+                        if (multi_bounce)
+                        {
+                            float const update_fraction = (g_fMultiBounceUpdateFraction > (1.0f / 64.0f)) ? g_fMultiBounceUpdateFraction : (1.0f / 64.0f);
+                            uint32_t const period = std::max(1U, std::min(uint32_t(1.0f / update_fraction + 0.5f), 64U));
+
+                            // the cones trace the working clipmap after the dynamic layer is voxelized
+                            if (g_bCompactVoxels)
+                            {
+                                g_pSceneRenderer->ResolveCompactVoxels(g_clipmap_opacity_texture, g_clipmap_illumination_texture, g_CompactVoxelRadianceEncoding, g_clipmap_compact_opacity_texture, g_clipmap_compact_radiance_texture);
+                                g_pSceneRenderer->SetIndirectIrradianceCompactVoxels(g_clipmap_compact_opacity_texture, g_clipmap_compact_radiance_texture, g_CompactVoxelRadianceEncoding);
+                            }
+                            else
+                            {
+                                g_pSceneRenderer->SetIndirectIrradianceCompactVoxels(NULL, NULL, g_CompactVoxelRadianceEncoding);
+                            }
+
+                            g_pSceneRenderer->UpdateIndirectIrradiance(clipmap_anchor, IndirectIrradiancePass::UPDATE, g_clipmap_static_surface_texture, g_clipmap_opacity_texture, g_clipmap_illumination_texture, g_clipmap_indirect_irradiance_texture, g_IndirectIrradianceFrame, period, g_fMultiBounceBlend, g_IndirectIrradianceScale);
+                            ++g_IndirectIrradianceFrame;
+                        }
 
                         g_pRendererInterface->debugEndEvent();
                     }
                 }
 
+                g_VoxelsInvalidatedAverage = g_VoxelsInvalidatedAverage * 0.95 + double(g_VoxelsInvalidated) * 0.05;
+
+                if (g_VoxelStatisticsRecorder.IsEnabled())
+                {
+                    g_pSceneRenderer->CountOccupiedVoxels(g_clipmap_opacity_texture);
+                    g_pSceneRenderer->ReadVoxelStatistics(g_VoxelStatisticsRecorder.GetCurrentFrame());
+                }
+                g_VoxelStatisticsRecorder.EndFrame();
+
+                if (g_VoxelStatisticsRecorder.IsExportPending())
+                {
+                    bool const exported = g_VoxelStatisticsRecorder.Export("VoxelStatistics.csv", "VoxelStatistics.json", g_fVoxelSize);
+                    LogFormat("Voxel statistics of %u frames %s", g_VoxelStatisticsRecorder.GetFrameCount(), exported ? "exported" : "failed");
+                }
+
+                // the snapshot is baked from the current static layer, walk to other positions and bake again to cover a set of anchors
+                if (g_bBakeClipmapSnapshot && g_StaticLayerValid)
+                {
+                    BakeClipmapSnapshot(GetClipmapSnapshotKey(g_StaticLayerClipmapCenter), g_StaticLayerLightDirection);
+                    g_bBakeClipmapSnapshot = false;
+                }
+
+                if (g_bValidateVoxelization && g_StaticLayerValid)
+                {
+                    ValidateVoxelizationCpu(g_StaticLayerClipmapCenter, viewProjMatrix, cameraPos);
+                    g_bValidateVoxelization = false;
+                }
+
                 FLUSH_COMMAND_LIST;
 
                 g_pRendererInterface->debugBeginEvent("VXGI Filtering");
@@ -471,6 +1982,11 @@ class MainVisualController : public IVisualController
             }
         }
 
+        if (tuning)
+        {
+            g_pRendererInterface->endPerformanceQuery(g_TuningPassQueries[TUNING_PASS_VOXELIZATION]);
+        }
+
         {
             g_pRendererInterface->debugBeginEvent("Base Pass");
 
@@ -511,6 +2027,12 @@ class MainVisualController : public IVisualController
         views[0].extents.minY = static_cast<int>(inputBuffers.gbufferViewport.minY);
         views[0].extents.maxY = static_cast<int>(inputBuffers.gbufferViewport.maxY);
 
+        // the tracing pass of the tuner includes the deferred shading (or the voxel visualization)
+        if (tuning)
+        {
+            g_pRendererInterface->beginPerformanceQuery(g_TuningPassQueries[TUNING_PASS_TRACING]);
+        }
+
         if (g_RenderingMode == RenderingMode::OPACITY_VOXELS ||
             g_RenderingMode == RenderingMode::EMITTANCE_VOXELS ||
             g_RenderingMode == RenderingMode::IRRADIANCE_VOXELS)
@@ -564,6 +2086,7 @@ class MainVisualController : public IVisualController
                         diffuseParams.enableTemporalJitter = g_bTemporalFiltering;
                         diffuseParams.quality = g_fQuality;
                         diffuseParams.directionalSamplingRate = g_fSamplingRate;
+                        diffuseParams.tracingResolution = g_TracingResolution;
                         diffuseParams.irradianceScale = g_fDiffuseScale;
 
                         g_pGITracer->computeDiffuseChannel(diffuseParams, gbufferBindings, gbufferSize, views, 1U, indirectDiffuse, indirectConfidence);
@@ -575,15 +2098,25 @@ class MainVisualController : public IVisualController
                     if (g_fDiffuseScale > 0 || g_fSpecularScale > 0)
                     {
                         g_pRendererInterface->debugBeginEvent("VXGI Specular Cone Tracing");
+                        BeginGovernorPass(TRACING_GOVERNOR_PASS_CONE_TRACING);
 
                         VXGI::BasicSpecularTracingParameters specularParams;
                         specularParams.irradianceScale = g_fSpecularScale;
                         specularParams.filter = g_bTemporalFiltering ? VXGI::SpecularTracingParameters::FILTER_TEMPORAL : VXGI::SpecularTracingParameters::FILTER_SIMPLE;
                         specularParams.enableTemporalJitter = g_bTemporalFiltering;
                         specularParams.enableConeJitter = true;
+                        specularParams.tracingStep = g_fTracingStep;
+
+                        bool const coneTracingReduced = (1U != g_ConeTracingResolution) || g_bConeTracingHistory || g_bValidateConeTracing;
+                        if (coneTracingReduced)
+                        {
+                            SetConeTracingConstants(viewProjMatrix, cameraPos, builtinGBufferParameters, gbufferSize);
+                        }
 
                         g_MyWidth = gbufferSize.x;
                         g_MyHeight = gbufferSize.y;
+                        g_MyTracingResolution = g_ConeTracingResolution;
+                        g_MyTracingHistory = g_bConeTracingHistory || g_bValidateConeTracing;
 
                         NVRHI::BindTexture(gbufferBindings, 0, g_pSceneRenderer->GetAlbedoBufferHandle(), false, NVRHI::Format::UNKNOWN, 0U);
                         NVRHI::BindTexture(gbufferBindings, 1, g_pSceneRenderer->GetNormalBufferHandle(), false, NVRHI::Format::UNKNOWN, 0U);
@@ -593,7 +2126,23 @@ class MainVisualController : public IVisualController
 
                         g_MyWidth = 0U;
                         g_MyHeight = 0U;
+                        g_MyTracingResolution = 1U;
+                        g_MyTracingHistory = false;
+
+                        if (g_bValidateConeTracing)
+                        {
+                            ValidateConeTracingGpu(viewProjMatrix, cameraPos);
+                            g_bValidateConeTracing = false;
+                        }
 
+                        if (coneTracingReduced)
+                        {
+                            g_ConeTracingHistoryWritten = true;
+                            g_ConeTracingHistoryFrameIndex = g_ConeTracingFrameIndex;
+                            g_ConeTracingHistoryIndex = 1U - g_ConeTracingHistoryIndex;
+                        }
+
+                        EndGovernorPass(TRACING_GOVERNOR_PASS_CONE_TRACING);
                         g_pRendererInterface->debugEndEvent();
                     }
                 }
@@ -630,6 +2179,7 @@ class MainVisualController : public IVisualController
                     diffuseParams.enableTemporalJitter = g_bTemporalFiltering;
                     diffuseParams.quality = g_fQuality;
                     diffuseParams.directionalSamplingRate = g_fSamplingRate;
+                    diffuseParams.tracingResolution = g_TracingResolution;
                     diffuseParams.irradianceScale = 1.0f;
 
                     g_pGITracer->computeDiffuseChannel(diffuseParams, gbufferBindings, gbufferSize, views, 1U, indirectDiffuse, indirectConfidence);
@@ -650,6 +2200,7 @@ class MainVisualController : public IVisualController
                     specularParams.filter = g_bTemporalFiltering ? VXGI::SpecularTracingParameters::FILTER_TEMPORAL : VXGI::SpecularTracingParameters::FILTER_SIMPLE;
                     specularParams.enableTemporalJitter = g_bTemporalFiltering;
                     specularParams.enableConeJitter = true;
+                    specularParams.tracingStep = g_fTracingStep;
 
                     g_pGITracer->computeSpecularChannel(specularParams, gbufferBindings, gbufferSize, views, 1U, indirectSpecular);
                 }
@@ -660,6 +2211,34 @@ class MainVisualController : public IVisualController
             }
         }
 
+        if (tuning)
+        {
+            g_pRendererInterface->endPerformanceQuery(g_TuningPassQueries[TUNING_PASS_TRACING]);
+
+            // the queries and the image are read back at once, which stalls the GPU, but the tuner is offline
+            double pass_times_ms[TUNING_PASS_COUNT];
+            for (uint32_t pass = 0U; pass < TUNING_PASS_COUNT; ++pass)
+            {
+                pass_times_ms[pass] = g_pRendererInterface->getPerformanceQueryTimeMS(g_TuningPassQueries[pass]);
+            }
+
+            NVRHI::TextureDesc const &mainRenderTargetDesc = g_pRendererInterface->describeTexture(mainRenderTarget);
+            g_TuningImage.resize(4U * size_t(mainRenderTargetDesc.width) * mainRenderTargetDesc.height);
+            bool const image_valid = g_pRendererInterface->readTexture(mainRenderTarget, g_TuningImage.data(), 4U * mainRenderTargetDesc.width);
+
+            TuningParameters parameters;
+            if (g_TuningSession.EndFrame(pass_times_ms, image_valid ? g_TuningImage.data() : NULL, mainRenderTargetDesc.width, mainRenderTargetDesc.height, 4U * mainRenderTargetDesc.width, parameters))
+            {
+                SetTuningParameters(parameters);
+            }
+        }
+
+        g_TracingGovernor.EndFrame();
+
+        ReadClipmapMoveQueries();
+
+        ++g_ConeTracingFrameIndex;
+
         g_InputBuffersPrev = inputBuffers;
         g_InputBuffersPrevValid = true;
 
@@ -690,7 +2269,7 @@ class MainVisualController : public IVisualController
         if (FAILED(DXUTFindDXSDKMediaFileCch(strFileName, 512, "thirdparty\\sponza\\sponza.gltf")))
             return E_FAIL;
 
-        if (FAILED(g_pSceneRenderer->LoadMesh(strFileName)))
+        if (FAILED(g_pSceneRenderer->LoadMesh(strFileName, g_bCpuVoxelizationGeometry ? Scene::LOAD_CPU_GEOMETRY : 0U)))
             return E_FAIL;
 
 #if 0
@@ -719,6 +2298,8 @@ class MainVisualController : public IVisualController
             d.isUAV = true;
 
             g_clipmap_opacity_texture = g_pRendererInterface->createTexture(d, NULL);
+            g_clipmap_static_opacity_texture = g_pRendererInterface->createTexture(d, NULL);
+            g_clipmap_build_opacity_texture = g_pRendererInterface->createTexture(d, NULL);
         }
 
         {
@@ -732,13 +2313,57 @@ class MainVisualController : public IVisualController
             d.isUAV = true;
 
             g_clipmap_illumination_texture = g_pRendererInterface->createTexture(d, NULL);
+            g_clipmap_static_illumination_texture = g_pRendererInterface->createTexture(d, NULL);
+            g_clipmap_build_illumination_texture = g_pRendererInterface->createTexture(d, NULL);
         }
 
+        g_clipmap_static_surface_texture = g_pRendererInterface->createTexture(SceneRenderer::GetVoxelSurfaceTextureDesc(), NULL);
+        g_clipmap_build_surface_texture = g_pRendererInterface->createTexture(SceneRenderer::GetVoxelSurfaceTextureDesc(), NULL);
+        g_clipmap_indirect_irradiance_texture = g_pRendererInterface->createTexture(SceneRenderer::GetIndirectIrradianceTextureDesc(), NULL);
+        g_clipmap_compact_opacity_texture = g_pRendererInterface->createTexture(SceneRenderer::GetCompactVoxelOpacityTextureDesc(), NULL);
+        g_clipmap_compact_radiance_texture = g_pRendererInterface->createTexture(SceneRenderer::GetCompactVoxelRadianceTextureDesc(), NULL);
+
         // g_pMyConeTracingCS = g_pRendererInterface->createShader(NVRHI::ShaderDesc(NVRHI::ShaderType::SHADER_COMPUTE), &g_MyConeTracingCS, sizeof(g_MyConeTracingCS));
 
         if (FAILED(g_pRendererInterface->GetDevice()->CreateComputeShader(g_MyConeTracingCS, sizeof(g_MyConeTracingCS), NULL, &g_pMyConeTracingCS)))
             return E_FAIL;
 
+        if (FAILED(g_pRendererInterface->GetDevice()->CreateComputeShader(g_MyConeTracingDownsampleCS, sizeof(g_MyConeTracingDownsampleCS), NULL, &g_pMyConeTracingDownsampleCS)))
+            return E_FAIL;
+
+        if (FAILED(g_pRendererInterface->GetDevice()->CreateComputeShader(g_MyConeTracingUpsampleCS, sizeof(g_MyConeTracingUpsampleCS), NULL, &g_pMyConeTracingUpsampleCS)))
+            return E_FAIL;
+
+        g_pConeTracingConstants = g_pRendererInterface->createConstantBuffer(NVRHI::ConstantBufferDesc(sizeof(ConeTracingConstants), nullptr), nullptr);
+        g_pConeTracingGBufferParameters = g_pRendererInterface->createConstantBuffer(NVRHI::ConstantBufferDesc(sizeof(BuiltinGBufferParameters), nullptr), nullptr);
+
+        g_StaticLayerValid = false;
+        g_DynamicLayerPrev = false;
+        g_StaticLayerFromSnapshot = false;
+        g_StaticLayerChanged = false;
+        g_StaticLayerBuildActive = false;
+        g_StaticLayerSurfaceValid = false;
+        g_IndirectIrradianceValid = false;
+        g_IndirectIrradianceApplied = false;
+        g_ClipmapAnchorController.Reset();
+        g_ClipmapStackLevelScheduler.Reset();
+
+        g_TuningPassQueries[TUNING_PASS_VOXELIZATION] = g_pRendererInterface->createPerformanceQuery("Tuning Voxelization");
+        g_TuningPassQueries[TUNING_PASS_TRACING] = g_pRendererInterface->createPerformanceQuery("Tuning Tracing");
+
+        g_ClipmapMovePassQueries[CLIPMAP_MOVE_PASS_VOXELIZATION] = g_pRendererInterface->createPerformanceQuery("Clipmap Move Voxelization");
+        g_ClipmapMovePassQueries[CLIPMAP_MOVE_PASS_OVERLAP_COPY] = g_pRendererInterface->createPerformanceQuery("Clipmap Move Overlap Copy");
+        for (uint32_t pass = 0U; pass < CLIPMAP_MOVE_PASS_COUNT; ++pass)
+        {
+            g_ClipmapMovePassQueriesIssued[pass] = false;
+        }
+
+        for (uint32_t slot = 0U; slot < TRACING_GOVERNOR_QUERY_LATENCY; ++slot)
+        {
+            g_GovernorPassQueries[slot][TRACING_GOVERNOR_PASS_CONE_TRACING] = g_pRendererInterface->createPerformanceQuery("Governor Cone Tracing");
+        }
+        g_TracingGovernor.ResetQueries();
+
         g_bInitialized = true;
 
         return S_OK;
@@ -746,6 +2371,55 @@ class MainVisualController : public IVisualController
 
     virtual void DeviceDestroyed() override
     {
+        g_TuningSession.Cancel();
+        for (uint32_t pass = 0U; pass < TUNING_PASS_COUNT; ++pass)
+        {
+            if (g_TuningPassQueries[pass])
+            {
+                g_pRendererInterface->destroyPerformanceQuery(g_TuningPassQueries[pass]);
+                g_TuningPassQueries[pass] = NULL;
+            }
+        }
+
+        for (uint32_t pass = 0U; pass < CLIPMAP_MOVE_PASS_COUNT; ++pass)
+        {
+            if (g_ClipmapMovePassQueries[pass])
+            {
+                g_pRendererInterface->destroyPerformanceQuery(g_ClipmapMovePassQueries[pass]);
+                g_ClipmapMovePassQueries[pass] = NULL;
+            }
+        }
+
+        for (uint32_t slot = 0U; slot < TRACING_GOVERNOR_QUERY_LATENCY; ++slot)
+        {
+            for (uint32_t pass = 0U; pass < TRACING_GOVERNOR_PASS_COUNT; ++pass)
+            {
+                if (g_GovernorPassQueries[slot][pass])
+                {
+                    g_pRendererInterface->destroyPerformanceQuery(g_GovernorPassQueries[slot][pass]);
+                    g_GovernorPassQueries[slot][pass] = NULL;
+                }
+            }
+        }
+
+        ReleaseConeTracingTextures();
+        g_my_cone_tracing_constants = NULL;
+        g_my_cone_tracing_gbuffer_parameters = NULL;
+        g_pConeTracingConstants = nullptr;
+        g_pConeTracingGBufferParameters = nullptr;
+
+        if (g_pMyConeTracingDownsampleCS)
+        {
+            g_pMyConeTracingDownsampleCS->Release();
+            g_pMyConeTracingDownsampleCS = NULL;
+        }
+
+        if (g_pMyConeTracingUpsampleCS)
+        {
+            g_pMyConeTracingUpsampleCS->Release();
+            g_pMyConeTracingUpsampleCS = NULL;
+        }
+
         if (g_pSceneRenderer)
         {
             g_pSceneRenderer->ReleaseViewDependentResources();
@@ -785,6 +2459,9 @@ class MainVisualController : public IVisualController
 
         g_pSceneRenderer->AllocateViewDependentResources(width, height, sampleCount);
 
+        ReleaseConeTracingTextures();
+        AllocateConeTracingTextures(width, height);
+
         // Setup the camera's projection parameters
         float fAspectRatio = width / (FLOAT)height;
         g_Camera.SetProjParams(XM_PIDIV4, fAspectRatio, g_fCameraClipNear, g_fCameraClipFar);
@@ -802,6 +2479,30 @@ class MainVisualController : public IVisualController
 //--------------------------------------------------------------------------------------
 int WINAPI wWinMain(HINSTANCE, HINSTANCE, LPWSTR, int)
 {
+    // see "BakeClipmapSnapshotsCpu", "g_bCpuVoxelizationGeometry" and "RunTracingGovernorTraces"
+    for (int arg_index = 1; arg_index < __argc; ++arg_index)
+    {
+        if (0 == wcscmp(__wargv[arg_index], L"-test-governor"))
+        {
+            // headless, the device is not created
+            return RunTracingGovernorTraces() ? 0 : 1;
+        }
+        else if (0 == wcscmp(__wargv[arg_index], L"-validate-voxelization"))
+        {
+            g_bCpuVoxelizationGeometry = true;
+        }
+        else if ((0 == wcscmp(__wargv[arg_index], L"-bake")) && ((arg_index + 1) < __argc))
+        {
+            // headless, the device is not created
+            char anchors_path[MAX_PATH];
+            char strFileName[512];
+            if ((0 == WideCharToMultiByte(CP_ACP, 0, __wargv[arg_index + 1], -1, anchors_path, MAX_PATH, NULL, NULL)) || FAILED(DXUTFindDXSDKMediaFileCch(strFileName, 512, "thirdparty\\sponza\\sponza.gltf")))
+                return 1;
+
+            return BakeClipmapSnapshotsCpu(strFileName, anchors_path, g_ClipmapSnapshotDirectory, uint32_t(g_nMapSize), g_fVoxelSize) ? 0 : 1;
+        }
+    }
+
     g_DeviceManager = new DeviceManager();
 
     MainVisualController sceneController;
@@ -842,6 +2543,18 @@ int WINAPI wWinMain(HINSTANCE, HINSTANCE, LPWSTR, int)
     g_LightCamera.SetViewParams(eyePt, lookAtPt);
     g_LightCamera.SetScalers(0.00025F, 100.0F);
 
+    // the parameters tuned on this machine (see "TuningSession")
+    {
+        TuningParameters parameters = GetTuningParameters();
+        if (g_TuningSession.LoadParameters(parameters))
+        {
+            SetTuningParameters(parameters);
+        }
+    }
+
+    // the recorded voxel statistics keep the last frames
+    g_VoxelStatisticsRecorder.SetMaxFrameCount(1024U);
+
     if (g_bInitialized)
         g_DeviceManager->MessageLoop();
 
@@ -0,0 +1,250 @@
+#include "MeshBoundsIndex.h"
+#include <cassert>
+#include <cfloat>
+#include <algorithm>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE__)
+#include <xmmintrin.h>
+#define MESH_BOUNDS_INDEX_SSE 1
+#else
+#define MESH_BOUNDS_INDEX_SSE 0
+#endif
+
+// the bit "i" is set when the box overlaps the child "i"
+static inline uint32_t OverlapChildren(float const node_lower_x[4], float const node_lower_y[4], float const node_lower_z[4], float const node_upper_x[4], float const node_upper_y[4], float const node_upper_z[4], VXGI::Box3f const &box)
+{
+#if MESH_BOUNDS_INDEX_SSE
+    __m128 overlap = _mm_and_ps(_mm_cmple_ps(_mm_loadu_ps(node_lower_x), _mm_set1_ps(box.upper.x)), _mm_cmpge_ps(_mm_loadu_ps(node_upper_x), _mm_set1_ps(box.lower.x)));
+    overlap = _mm_and_ps(overlap, _mm_and_ps(_mm_cmple_ps(_mm_loadu_ps(node_lower_y), _mm_set1_ps(box.upper.y)), _mm_cmpge_ps(_mm_loadu_ps(node_upper_y), _mm_set1_ps(box.lower.y))));
+    overlap = _mm_and_ps(overlap, _mm_and_ps(_mm_cmple_ps(_mm_loadu_ps(node_lower_z), _mm_set1_ps(box.upper.z)), _mm_cmpge_ps(_mm_loadu_ps(node_upper_z), _mm_set1_ps(box.lower.z))));
+    return static_cast<uint32_t>(_mm_movemask_ps(overlap));
+#else
+    uint32_t overlap = 0U;
+    for (uint32_t child = 0U; child < 4U; ++child)
+    {
+        if ((node_lower_x[child] <= box.upper.x) && (node_upper_x[child] >= box.lower.x) &&
+            (node_lower_y[child] <= box.upper.y) && (node_upper_y[child] >= box.lower.y) &&
+            (node_lower_z[child] <= box.upper.z) && (node_upper_z[child] >= box.lower.z))
+        {
+            overlap |= (1U << child);
+        }
+    }
+    return overlap;
+#endif
+}
+
+static VXGI::Box3f UnionBounds(VXGI::Box3f const *mesh_bounds, uint32_t const *meshes, uint32_t mesh_count)
+{
+    VXGI::Box3f result(VXGI::float3(FLT_MAX), VXGI::float3(-FLT_MAX));
+
+    for (uint32_t i = 0U; i < mesh_count; ++i)
+    {
+        VXGI::Box3f const &bounds = mesh_bounds[meshes[i]];
+        result.lower = VXGI::float3(std::min(result.lower.x, bounds.lower.x), std::min(result.lower.y, bounds.lower.y), std::min(result.lower.z, bounds.lower.z));
+        result.upper = VXGI::float3(std::max(result.upper.x, bounds.upper.x), std::max(result.upper.y, bounds.upper.y), std::max(result.upper.z, bounds.upper.z));
+    }
+
+    return result;
+}
+
+MeshBoundsIndex::MeshBoundsIndex() : m_MeshCount(0U), m_RegionMaskWordCount(0U)
+{
+}
+
+int32_t MeshBoundsIndex::BuildNode(VXGI::Box3f const *mesh_bounds, uint32_t *meshes, uint32_t mesh_count)
+{
+    // the meshes are split into (at most) 4 groups by the median of the centers along the longest axis, and then again along the longest axis of each half
+    uint32_t group_begins[4] = {0U, 0U, 0U, 0U};
+    uint32_t group_counts[4] = {0U, 0U, 0U, 0U};
+
+    if (mesh_count <= 4U)
+    {
+        for (uint32_t i = 0U; i < mesh_count; ++i)
+        {
+            group_begins[i] = i;
+            group_counts[i] = 1U;
+        }
+    }
+    else
+    {
+        auto split = [mesh_bounds](uint32_t *begin, uint32_t count) -> uint32_t {
+            VXGI::Box3f center_bounds(VXGI::float3(FLT_MAX), VXGI::float3(-FLT_MAX));
+            for (uint32_t i = 0U; i < count; ++i)
+            {
+                VXGI::float3 const center = (mesh_bounds[begin[i]].lower + mesh_bounds[begin[i]].upper) * 0.5F;
+                center_bounds.lower = VXGI::float3(std::min(center_bounds.lower.x, center.x), std::min(center_bounds.lower.y, center.y), std::min(center_bounds.lower.z, center.z));
+                center_bounds.upper = VXGI::float3(std::max(center_bounds.upper.x, center.x), std::max(center_bounds.upper.y, center.y), std::max(center_bounds.upper.z, center.z));
+            }
+
+            VXGI::float3 const extent = center_bounds.upper - center_bounds.lower;
+            int const axis = ((extent.x >= extent.y) && (extent.x >= extent.z)) ? 0 : ((extent.y >= extent.z) ? 1 : 2);
+
+            uint32_t const half = count / 2U;
+            std::nth_element(begin, begin + half, begin + count, [mesh_bounds, axis](uint32_t a, uint32_t b) {
+                return ((&mesh_bounds[a].lower.x)[axis] + (&mesh_bounds[a].upper.x)[axis]) < ((&mesh_bounds[b].lower.x)[axis] + (&mesh_bounds[b].upper.x)[axis]);
+            });
+            return half;
+        };
+
+        uint32_t const half = split(meshes, mesh_count);
+        uint32_t const quarter_0 = split(meshes, half);
+        uint32_t const quarter_1 = split(meshes + half, mesh_count - half);
+
+        group_begins[0] = 0U;
+        group_counts[0] = quarter_0;
+        group_begins[1] = quarter_0;
+        group_counts[1] = half - quarter_0;
+        group_begins[2] = half;
+        group_counts[2] = quarter_1;
+        group_begins[3] = half + quarter_1;
+        group_counts[3] = mesh_count - half - quarter_1;
+    }
+
+    int32_t const node_index = static_cast<int32_t>(m_Nodes.size());
+    m_Nodes.emplace_back();
+
+    for (uint32_t child = 0U; child < 4U; ++child)
+    {
+        VXGI::Box3f bounds(VXGI::float3(FLT_MAX), VXGI::float3(-FLT_MAX));
+        int32_t child_index = EMPTY_CHILD;
+
+        if (1U == group_counts[child])
+        {
+            bounds = mesh_bounds[meshes[group_begins[child]]];
+            child_index = ~static_cast<int32_t>(meshes[group_begins[child]]);
+        }
+        else if (group_counts[child] > 1U)
+        {
+            bounds = UnionBounds(mesh_bounds, meshes + group_begins[child], group_counts[child]);
+            child_index = BuildNode(mesh_bounds, meshes + group_begins[child], group_counts[child]);
+        }
+
+        // the node is referenced by the index since the vector may grow by the recursion
+        Node &node = m_Nodes[node_index];
+        node.lower_x[child] = bounds.lower.x;
+        node.lower_y[child] = bounds.lower.y;
+        node.lower_z[child] = bounds.lower.z;
+        node.upper_x[child] = bounds.upper.x;
+        node.upper_y[child] = bounds.upper.y;
+        node.upper_z[child] = bounds.upper.z;
+        node.children[child] = child_index;
+    }
+
+    return node_index;
+}
+
+void MeshBoundsIndex::Build(VXGI::Box3f const *mesh_bounds, uint32_t mesh_count)
+{
+    m_Nodes.clear();
+    m_MeshCount = mesh_count;
+    m_RegionMaskWordCount = 0U;
+    m_RegionMasks.clear();
+    m_QueriedMeshes.clear();
+
+    if (0U == mesh_count)
+    {
+        return;
+    }
+
+    std::vector<uint32_t> meshes(mesh_count);
+    for (uint32_t i = 0U; i < mesh_count; ++i)
+    {
+        meshes[i] = i;
+    }
+
+    m_Nodes.reserve(mesh_count);
+    BuildNode(mesh_bounds, &meshes[0], mesh_count);
+}
+
+uint32_t MeshBoundsIndex::GetMeshCount() const
+{
+    return m_MeshCount;
+}
+
+void MeshBoundsIndex::Query(VXGI::Box3f const *boxes, uint32_t box_count, std::vector<uint32_t> &meshes)
+{
+    meshes.clear();
+
+    // only the masks of the meshes returned by the previous query are cleared, so that the cost does not depend on the mesh count
+    for (uint32_t const mesh : m_QueriedMeshes)
+    {
+        std::fill(m_RegionMasks.begin() + static_cast<size_t>(m_RegionMaskWordCount) * mesh, m_RegionMasks.begin() + static_cast<size_t>(m_RegionMaskWordCount) * (mesh + 1U), 0ULL);
+    }
+    m_QueriedMeshes.clear();
+
+    uint32_t const region_mask_word_count = std::max(1U, (box_count + 63U) / 64U);
+    if (region_mask_word_count != m_RegionMaskWordCount)
+    {
+        m_RegionMaskWordCount = region_mask_word_count;
+        m_RegionMasks.assign(static_cast<size_t>(m_RegionMaskWordCount) * m_MeshCount, 0ULL);
+    }
+
+    if (m_Nodes.empty())
+    {
+        return;
+    }
+
+    for (uint32_t box_index = 0U; box_index < box_count; ++box_index)
+    {
+        VXGI::Box3f const &box = boxes[box_index];
+
+        m_Stack.clear();
+        m_Stack.push_back(0);
+
+        while (!m_Stack.empty())
+        {
+            Node const &node = m_Nodes[m_Stack.back()];
+            m_Stack.pop_back();
+
+            uint32_t overlap = OverlapChildren(node.lower_x, node.lower_y, node.lower_z, node.upper_x, node.upper_y, node.upper_z, box);
+
+            while (0U != overlap)
+            {
+                uint32_t child = 0U;
+                while (0U == (overlap & (1U << child)))
+                {
+                    ++child;
+                }
+                overlap &= ~(1U << child);
+
+                int32_t const child_index = node.children[child];
+                if (child_index >= 0)
+                {
+                    m_Stack.push_back(child_index);
+                }
+                else if (EMPTY_CHILD != child_index)
+                {
+                    uint32_t const mesh = static_cast<uint32_t>(~child_index);
+                    uint64_t *region_mask = &m_RegionMasks[static_cast<size_t>(m_RegionMaskWordCount) * mesh];
+
+                    bool first_hit = true;
+                    for (uint32_t word = 0U; word < m_RegionMaskWordCount; ++word)
+                    {
+                        first_hit = first_hit && (0ULL == region_mask[word]);
+                    }
+
+                    if (first_hit)
+                    {
+                        m_QueriedMeshes.push_back(mesh);
+                    }
+
+                    region_mask[box_index >> 6] |= (1ULL << (box_index & 63U));
+                }
+            }
+        }
+    }
+
+    std::sort(m_QueriedMeshes.begin(), m_QueriedMeshes.end());
+    meshes = m_QueriedMeshes;
+}
+
+uint32_t MeshBoundsIndex::GetRegionMaskWordCount() const
+{
+    return m_RegionMaskWordCount;
+}
+
+uint64_t const *MeshBoundsIndex::GetRegionMask(uint32_t mesh) const
+{
+    assert(mesh < m_MeshCount);
+    return &m_RegionMasks[static_cast<size_t>(m_RegionMaskWordCount) * mesh];
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include "GFSDK_VXGI_MathTypes.h"
+
+// A 4-wide bounding volume hierarchy over the bounds of the meshes, which answers "all meshes overlapping any of these boxes" without testing each mesh against each box.
+// The 4 child bounds of each node are stored as SoA, so that a box is tested against all of them by a few SSE instructions (a scalar fallback is used without SSE).
+// The same inclusive overlap test as "VXGI::Box3f::intersectsWith" is used.
+class MeshBoundsIndex
+{
+    struct Node
+    {
+        float lower_x[4];
+        float lower_y[4];
+        float lower_z[4];
+        float upper_x[4];
+        float upper_y[4];
+        float upper_z[4];
+
+        // >= 0: the index of the child node
+        // < 0: "~mesh" of the leaf (or EMPTY_CHILD)
+        int32_t children[4];
+    };
+
+    static int32_t const EMPTY_CHILD = INT32_MIN;
+
+    std::vector<Node> m_Nodes;
+    uint32_t m_MeshCount;
+
+    // the bit "i" of the region mask of a mesh is set when the mesh overlaps the box "i" of the last query
+    uint32_t m_RegionMaskWordCount;
+    std::vector<uint64_t> m_RegionMasks;
+    std::vector<uint32_t> m_QueriedMeshes;
+
+    std::vector<int32_t> m_Stack;
+
+    int32_t BuildNode(VXGI::Box3f const *mesh_bounds, uint32_t *meshes, uint32_t mesh_count);
+
+public:
+    MeshBoundsIndex();
+
+    void Build(VXGI::Box3f const *mesh_bounds, uint32_t mesh_count);
+
+    uint32_t GetMeshCount() const;
+
+    // the meshes which overlap at least one box are returned in ascending order
+    void Query(VXGI::Box3f const *boxes, uint32_t box_count, std::vector<uint32_t> &meshes);
+
+    // valid for the meshes returned by the last query
+    uint32_t GetRegionMaskWordCount() const;
+    uint64_t const *GetRegionMask(uint32_t mesh) const;
+
+    static bool IsRegionInMask(uint64_t const *region_mask, uint32_t region)
+    {
+        return (0U != (region_mask[region >> 6] & (1ULL << (region & 63U))));
+    }
+};
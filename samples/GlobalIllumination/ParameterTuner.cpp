@@ -0,0 +1,723 @@
+#include "ParameterTuner.h"
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <functional>
+
+bool SaveCameraPath(char const *path, std::vector<CameraPathFrame> const &frames)
+{
+    FILE *file = fopen(path, "w");
+    if (NULL == file)
+    {
+        return false;
+    }
+
+    bool result = true;
+    for (CameraPathFrame const &frame : frames)
+    {
+        result = result && (0 <= fprintf(file, "%.9g %.9g %.9g %.9g %.9g %.9g\n", frame.eye[0], frame.eye[1], frame.eye[2], frame.look_at[0], frame.look_at[1], frame.look_at[2]));
+    }
+
+    result = (0 == fclose(file)) && result;
+
+    if (!result)
+    {
+        remove(path);
+    }
+
+    return result;
+}
+
+bool LoadCameraPath(char const *path, std::vector<CameraPathFrame> &frames)
+{
+    frames.clear();
+
+    FILE *file = fopen(path, "r");
+    if (NULL == file)
+    {
+        return false;
+    }
+
+    CameraPathFrame frame;
+    while (6 == fscanf(file, "%f %f %f %f %f %f", &frame.eye[0], &frame.eye[1], &frame.eye[2], &frame.look_at[0], &frame.look_at[1], &frame.look_at[2]))
+    {
+        frames.push_back(frame);
+    }
+
+    bool const result = (0 != feof(file));
+
+    fclose(file);
+
+    return result && (!frames.empty());
+}
+
+template <typename T>
+static void SortTuningCandidates(std::vector<T> &values, bool higher_is_better)
+{
+    if (higher_is_better)
+    {
+        std::sort(values.begin(), values.end());
+    }
+    else
+    {
+        std::sort(values.begin(), values.end(), std::greater<T>());
+    }
+
+    values.erase(std::unique(values.begin(), values.end()), values.end());
+}
+
+// box filters the RGB channels by the smallest integer factor which fits "TUNING_IMAGE_MAX_WIDTH"
+static void DownsampleTuningImage(uint8_t const *image_rgba8, uint32_t width, uint32_t height, uint32_t row_pitch, std::vector<uint8_t> &image_rgb8, uint32_t &out_width, uint32_t &out_height)
+{
+    uint32_t const factor = std::max(1U, (width + TUNING_IMAGE_MAX_WIDTH - 1U) / TUNING_IMAGE_MAX_WIDTH);
+
+    out_width = width / factor;
+    out_height = height / factor;
+    image_rgb8.resize(3U * static_cast<size_t>(out_width) * out_height);
+
+    for (uint32_t y = 0U; y < out_height; ++y)
+    {
+        for (uint32_t x = 0U; x < out_width; ++x)
+        {
+            uint32_t sums[3] = {0U, 0U, 0U};
+            for (uint32_t block_y = 0U; block_y < factor; ++block_y)
+            {
+                uint8_t const *const row = image_rgba8 + static_cast<size_t>(row_pitch) * (factor * y + block_y);
+                for (uint32_t block_x = 0U; block_x < factor; ++block_x)
+                {
+                    uint8_t const *const pixel = row + 4U * (factor * x + block_x);
+                    sums[0] += pixel[0];
+                    sums[1] += pixel[1];
+                    sums[2] += pixel[2];
+                }
+            }
+
+            uint8_t *const out_pixel = image_rgb8.data() + 3U * (static_cast<size_t>(out_width) * y + x);
+            for (uint32_t channel = 0U; channel < 3U; ++channel)
+            {
+                out_pixel[channel] = static_cast<uint8_t>((sums[channel] + (factor * factor) / 2U) / (factor * factor));
+            }
+        }
+    }
+}
+
+static double GetTuningImageError(std::vector<uint8_t> const &image, std::vector<uint8_t> const &reference_image)
+{
+    // the window is resized during the run
+    if (image.empty() || (image.size() != reference_image.size()))
+    {
+        return 1.0;
+    }
+
+    double squared_error = 0.0;
+    for (size_t index = 0U; index < image.size(); ++index)
+    {
+        double const error = (static_cast<double>(image[index]) - static_cast<double>(reference_image[index])) / 255.0;
+        squared_error += error * error;
+    }
+
+    return std::sqrt(squared_error / static_cast<double>(image.size()));
+}
+
+ParameterTuner::ParameterTuner() : m_FrameBudgetMs(4.0F), m_TargetError(0.02F), m_WarmUpFrameCount(16U), m_PathFrameCount(0U), m_Running(false), m_ReferenceRun(false), m_Run(0U), m_Frame(0U), m_ImageWidth(0U), m_ImageHeight(0U)
+{
+    m_Candidates.qualities = {0.1F, 0.25F, 0.5F, 0.75F};
+    m_Candidates.directional_sampling_rates = {0.25F, 0.5F, 1.0F};
+    m_Candidates.tracing_resolutions = {4U, 2U, 1U};
+    m_Candidates.tracing_steps = {1.0F, 0.75F, 0.5F};
+
+    m_ReferenceParameters.quality = 1.0F;
+    m_ReferenceParameters.directional_sampling_rate = 1.0F;
+    m_ReferenceParameters.tracing_resolution = 1U;
+    m_ReferenceParameters.tracing_step = 0.5F;
+
+    memset(&m_ReferenceResult, 0, sizeof(m_ReferenceResult));
+    memset(m_PassTimeSums, 0, sizeof(m_PassTimeSums));
+}
+
+void ParameterTuner::SetCandidates(TuningCandidates const &candidates)
+{
+    assert(!m_Running);
+    m_Candidates = candidates;
+}
+
+void ParameterTuner::SetReferenceParameters(TuningParameters const &parameters)
+{
+    assert(!m_Running);
+    m_ReferenceParameters = parameters;
+}
+
+void ParameterTuner::SetFrameBudget(float frame_budget_ms)
+{
+    m_FrameBudgetMs = std::max(0.0F, frame_budget_ms);
+}
+
+float *ParameterTuner::GetFrameBudgetPointer()
+{
+    return &m_FrameBudgetMs;
+}
+
+void ParameterTuner::SetTargetError(float target_error)
+{
+    m_TargetError = std::max(0.0F, target_error);
+}
+
+float *ParameterTuner::GetTargetErrorPointer()
+{
+    return &m_TargetError;
+}
+
+void ParameterTuner::SetWarmUpFrameCount(uint32_t warm_up_frame_count)
+{
+    m_WarmUpFrameCount = warm_up_frame_count;
+}
+
+void ParameterTuner::Begin(uint32_t path_frame_count)
+{
+    SortTuningCandidates(m_Candidates.qualities, true);
+    SortTuningCandidates(m_Candidates.directional_sampling_rates, true);
+    SortTuningCandidates(m_Candidates.tracing_resolutions, false);
+    SortTuningCandidates(m_Candidates.tracing_steps, false);
+
+    uint32_t const counts[TUNING_PARAMETER_COUNT] = {
+        static_cast<uint32_t>(m_Candidates.qualities.size()),
+        static_cast<uint32_t>(m_Candidates.directional_sampling_rates.size()),
+        static_cast<uint32_t>(m_Candidates.tracing_resolutions.size()),
+        static_cast<uint32_t>(m_Candidates.tracing_steps.size())};
+
+    uint32_t run_count = 1U;
+    for (uint32_t parameter = 0U; parameter < TUNING_PARAMETER_COUNT; ++parameter)
+    {
+        run_count *= counts[parameter];
+    }
+
+    // the cheapest sets come first (by the sum of the indices), so that the dominance skips the most runs
+    std::vector<uint32_t> coordinates(TUNING_PARAMETER_COUNT * static_cast<size_t>(run_count));
+    std::vector<uint32_t> order(run_count);
+    for (uint32_t run = 0U; run < run_count; ++run)
+    {
+        uint32_t remainder = run;
+        for (uint32_t parameter = TUNING_PARAMETER_COUNT; parameter > 0U; --parameter)
+        {
+            coordinates[TUNING_PARAMETER_COUNT * run + (parameter - 1U)] = remainder % counts[parameter - 1U];
+            remainder /= counts[parameter - 1U];
+        }
+        order[run] = run;
+    }
+
+    std::stable_sort(order.begin(), order.end(), [&coordinates](uint32_t a, uint32_t b) {
+        uint32_t sum_a = 0U;
+        uint32_t sum_b = 0U;
+        for (uint32_t parameter = 0U; parameter < TUNING_PARAMETER_COUNT; ++parameter)
+        {
+            sum_a += coordinates[TUNING_PARAMETER_COUNT * a + parameter];
+            sum_b += coordinates[TUNING_PARAMETER_COUNT * b + parameter];
+        }
+        return sum_a < sum_b;
+    });
+
+    m_RunCoordinates.resize(coordinates.size());
+    for (uint32_t run = 0U; run < run_count; ++run)
+    {
+        std::copy(coordinates.begin() + TUNING_PARAMETER_COUNT * order[run], coordinates.begin() + TUNING_PARAMETER_COUNT * (order[run] + 1U), m_RunCoordinates.begin() + TUNING_PARAMETER_COUNT * run);
+    }
+
+    m_Results.resize(run_count);
+    for (uint32_t run = 0U; run < run_count; ++run)
+    {
+        memset(&m_Results[run], 0, sizeof(m_Results[run]));
+        m_Results[run].parameters = GetRunParameters(run);
+    }
+
+    memset(&m_ReferenceResult, 0, sizeof(m_ReferenceResult));
+    m_ReferenceResult.parameters = m_ReferenceParameters;
+
+    m_PathFrameCount = path_frame_count;
+    m_ReferenceImages.clear();
+    m_ReferenceImages.resize(path_frame_count);
+    m_ImageWidth = 0U;
+    m_ImageHeight = 0U;
+
+    m_FrameTimes.clear();
+    m_Errors.clear();
+    memset(m_PassTimeSums, 0, sizeof(m_PassTimeSums));
+
+    m_Running = (0U != path_frame_count) && (0U != run_count);
+    m_ReferenceRun = true;
+    m_Run = 0U;
+    m_Frame = 0U;
+}
+
+void ParameterTuner::Cancel()
+{
+    m_Running = false;
+    m_ReferenceImages.clear();
+}
+
+bool ParameterTuner::IsRunning() const
+{
+    return m_Running;
+}
+
+bool ParameterTuner::IsReferenceRun() const
+{
+    return m_Running && m_ReferenceRun;
+}
+
+TuningParameters ParameterTuner::GetRunParameters(uint32_t run) const
+{
+    uint32_t const *const coordinates = &m_RunCoordinates[TUNING_PARAMETER_COUNT * run];
+
+    TuningParameters parameters;
+    parameters.quality = m_Candidates.qualities[coordinates[TUNING_PARAMETER_QUALITY]];
+    parameters.directional_sampling_rate = m_Candidates.directional_sampling_rates[coordinates[TUNING_PARAMETER_DIRECTIONAL_SAMPLING_RATE]];
+    parameters.tracing_resolution = m_Candidates.tracing_resolutions[coordinates[TUNING_PARAMETER_TRACING_RESOLUTION]];
+    parameters.tracing_step = m_Candidates.tracing_steps[coordinates[TUNING_PARAMETER_TRACING_STEP]];
+    return parameters;
+}
+
+TuningParameters ParameterTuner::GetParameters() const
+{
+    assert(m_Running);
+    return m_ReferenceRun ? m_ReferenceParameters : m_Results[m_Run].parameters;
+}
+
+uint32_t ParameterTuner::GetPathFrame() const
+{
+    return (m_Frame < m_WarmUpFrameCount) ? 0U : (m_Frame - m_WarmUpFrameCount);
+}
+
+bool ParameterTuner::IsRunSkipped(uint32_t run) const
+{
+    uint32_t const *const coordinates = &m_RunCoordinates[TUNING_PARAMETER_COUNT * run];
+
+    for (uint32_t measured_run = 0U; measured_run < run; ++measured_run)
+    {
+        TuningRunResult const &measured_result = m_Results[measured_run];
+        if (!measured_result.measured)
+        {
+            continue;
+        }
+
+        uint32_t const *const measured_coordinates = &m_RunCoordinates[TUNING_PARAMETER_COUNT * measured_run];
+
+        bool higher_quality = true;
+        bool lower_quality = true;
+        for (uint32_t parameter = 0U; parameter < TUNING_PARAMETER_COUNT; ++parameter)
+        {
+            higher_quality = higher_quality && (coordinates[parameter] >= measured_coordinates[parameter]);
+            lower_quality = lower_quality && (coordinates[parameter] <= measured_coordinates[parameter]);
+        }
+
+        // at least as expensive as a set which already meets the error (or which is already over the budget)
+        if (higher_quality && (measured_result.meets_error || (!measured_result.meets_budget)))
+        {
+            return true;
+        }
+
+        // at least as wrong as a set which does not meet the error
+        if (lower_quality && (!measured_result.meets_error))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void ParameterTuner::AddFrame(double const pass_times_ms[TUNING_PASS_COUNT], uint8_t const *image_rgba8, uint32_t width, uint32_t height, uint32_t row_pitch)
+{
+    assert(m_Running);
+
+    if (m_Frame >= m_WarmUpFrameCount)
+    {
+        uint32_t const path_frame = m_Frame - m_WarmUpFrameCount;
+
+        uint32_t image_width = 0U;
+        uint32_t image_height = 0U;
+        if (NULL != image_rgba8)
+        {
+            DownsampleTuningImage(image_rgba8, width, height, row_pitch, m_Image, image_width, image_height);
+        }
+        else
+        {
+            m_Image.clear();
+        }
+
+        if (m_ReferenceRun)
+        {
+            m_ReferenceImages[path_frame] = m_Image;
+            m_ImageWidth = image_width;
+            m_ImageHeight = image_height;
+        }
+        else
+        {
+            m_Errors.push_back(((image_width == m_ImageWidth) && (image_height == m_ImageHeight)) ? GetTuningImageError(m_Image, m_ReferenceImages[path_frame]) : 1.0);
+        }
+
+        double frame_time_ms = 0.0;
+        for (uint32_t pass = 0U; pass < TUNING_PASS_COUNT; ++pass)
+        {
+            m_PassTimeSums[pass] += pass_times_ms[pass];
+            frame_time_ms += pass_times_ms[pass];
+        }
+        m_FrameTimes.push_back(frame_time_ms);
+    }
+
+    ++m_Frame;
+
+    if (m_Frame >= (m_WarmUpFrameCount + m_PathFrameCount))
+    {
+        FinishRun();
+        AdvanceRun();
+    }
+}
+
+void ParameterTuner::FinishRun()
+{
+    TuningRunResult &result = m_ReferenceRun ? m_ReferenceResult : m_Results[m_Run];
+    result.measured = true;
+
+    double const frame_count = static_cast<double>(std::max(size_t(1U), m_FrameTimes.size()));
+
+    result.mean_frame_time_ms = 0.0;
+    for (uint32_t pass = 0U; pass < TUNING_PASS_COUNT; ++pass)
+    {
+        result.mean_pass_times_ms[pass] = m_PassTimeSums[pass] / frame_count;
+        result.mean_frame_time_ms += result.mean_pass_times_ms[pass];
+    }
+
+    std::sort(m_FrameTimes.begin(), m_FrameTimes.end());
+    result.percentile_frame_time_ms = m_FrameTimes.empty() ? 0.0 : m_FrameTimes[std::min(m_FrameTimes.size() - 1U, static_cast<size_t>(std::ceil(0.95 * static_cast<double>(m_FrameTimes.size()))) - 1U)];
+
+    result.mean_error = 0.0;
+    result.max_error = 0.0;
+    for (double const error : m_Errors)
+    {
+        result.mean_error += error;
+        result.max_error = std::max(result.max_error, error);
+    }
+    result.mean_error /= static_cast<double>(std::max(size_t(1U), m_Errors.size()));
+
+    result.meets_budget = (result.percentile_frame_time_ms <= static_cast<double>(m_FrameBudgetMs));
+    result.meets_error = (result.mean_error <= static_cast<double>(m_TargetError));
+
+    m_FrameTimes.clear();
+    m_Errors.clear();
+    memset(m_PassTimeSums, 0, sizeof(m_PassTimeSums));
+}
+
+void ParameterTuner::AdvanceRun()
+{
+    if (m_ReferenceRun)
+    {
+        m_ReferenceRun = false;
+        m_Run = 0U;
+    }
+    else
+    {
+        ++m_Run;
+    }
+
+    while ((m_Run < m_Results.size()) && IsRunSkipped(m_Run))
+    {
+        ++m_Run;
+    }
+
+    m_Frame = 0U;
+
+    if (m_Run >= m_Results.size())
+    {
+        m_Running = false;
+        m_ReferenceImages.clear();
+    }
+}
+
+uint32_t ParameterTuner::GetRunIndex() const
+{
+    return m_ReferenceRun ? 0U : (m_Run + 1U);
+}
+
+uint32_t ParameterTuner::GetRunCount() const
+{
+    return static_cast<uint32_t>(m_Results.size()) + 1U;
+}
+
+bool ParameterTuner::GetBestParameters(TuningParameters &parameters) const
+{
+    TuningRunResult const *best_result = NULL;
+    for (TuningRunResult const &result : m_Results)
+    {
+        if (result.measured && result.meets_budget && result.meets_error && ((NULL == best_result) || (result.mean_frame_time_ms < best_result->mean_frame_time_ms)))
+        {
+            best_result = &result;
+        }
+    }
+
+    if (NULL == best_result)
+    {
+        return false;
+    }
+
+    parameters = best_result->parameters;
+    return true;
+}
+
+TuningRunResult const &ParameterTuner::GetReferenceResult() const
+{
+    return m_ReferenceResult;
+}
+
+std::vector<TuningRunResult> const &ParameterTuner::GetResults() const
+{
+    return m_Results;
+}
+
+bool ParameterTuner::WriteResultsCsv(char const *path) const
+{
+    FILE *file = fopen(path, "w");
+    if (NULL == file)
+    {
+        return false;
+    }
+
+    bool result = (0 <= fprintf(file, "run,measured,quality,directional_sampling_rate,tracing_resolution,tracing_step,voxelization_ms,tracing_ms,mean_frame_ms,p95_frame_ms,mean_error,max_error,meets_budget,meets_error\n"));
+
+    for (size_t run = 0U; run <= m_Results.size(); ++run)
+    {
+        TuningRunResult const &run_result = (0U == run) ? m_ReferenceResult : m_Results[run - 1U];
+
+        char run_name[32];
+        snprintf(run_name, sizeof(run_name), (0U == run) ? "reference" : "%u", static_cast<unsigned int>(run - 1U));
+
+        result = result && (0 <= fprintf(
+                                     file,
+                                     "%s,%d,%g,%g,%u,%g,%.4f,%.4f,%.4f,%.4f,%.6f,%.6f,%d,%d\n",
+                                     run_name,
+                                     run_result.measured ? 1 : 0,
+                                     run_result.parameters.quality,
+                                     run_result.parameters.directional_sampling_rate,
+                                     run_result.parameters.tracing_resolution,
+                                     run_result.parameters.tracing_step,
+                                     run_result.mean_pass_times_ms[TUNING_PASS_VOXELIZATION],
+                                     run_result.mean_pass_times_ms[TUNING_PASS_TRACING],
+                                     run_result.mean_frame_time_ms,
+                                     run_result.percentile_frame_time_ms,
+                                     run_result.mean_error,
+                                     run_result.max_error,
+                                     run_result.meets_budget ? 1 : 0,
+                                     run_result.meets_error ? 1 : 0));
+    }
+
+    result = (0 == fclose(file)) && result;
+
+    if (!result)
+    {
+        remove(path);
+    }
+
+    return result;
+}
+
+bool SaveTuningParameters(char const *path, TuningParameters const &parameters)
+{
+    FILE *file = fopen(path, "w");
+    if (NULL == file)
+    {
+        return false;
+    }
+
+    bool result = (0 <= fprintf(file, "quality = %.9g\ndirectional_sampling_rate = %.9g\ntracing_resolution = %u\ntracing_step = %.9g\n", parameters.quality, parameters.directional_sampling_rate, parameters.tracing_resolution, parameters.tracing_step));
+
+    result = (0 == fclose(file)) && result;
+
+    if (!result)
+    {
+        remove(path);
+    }
+
+    return result;
+}
+
+bool LoadTuningParameters(char const *path, TuningParameters &parameters)
+{
+    FILE *file = fopen(path, "r");
+    if (NULL == file)
+    {
+        return false;
+    }
+
+    // the keys which are missing keep their values
+    TuningParameters loaded_parameters = parameters;
+
+    char line[256];
+    while (NULL != fgets(line, sizeof(line), file))
+    {
+        char key[64];
+        float value;
+        if (2 != sscanf(line, " %63[^= \t] = %f", key, &value))
+        {
+            continue;
+        }
+
+        if (0 == strcmp(key, "quality"))
+        {
+            loaded_parameters.quality = value;
+        }
+        else if (0 == strcmp(key, "directional_sampling_rate"))
+        {
+            loaded_parameters.directional_sampling_rate = value;
+        }
+        else if (0 == strcmp(key, "tracing_resolution"))
+        {
+            loaded_parameters.tracing_resolution = static_cast<uint32_t>(std::lround(value));
+        }
+        else if (0 == strcmp(key, "tracing_step"))
+        {
+            loaded_parameters.tracing_step = value;
+        }
+    }
+
+    fclose(file);
+
+    parameters = loaded_parameters;
+    return true;
+}
+
+TuningSession::TuningSession(char const *camera_path_file, char const *parameters_file, char const *results_file, TuningLog log) : m_CameraPathFile(camera_path_file), m_ParametersFile(parameters_file), m_ResultsFile(results_file), m_Log(log), m_Recording(false), m_StartPending(false), m_SavedParameters()
+{
+}
+
+ParameterTuner &TuningSession::GetTuner()
+{
+    return m_Tuner;
+}
+
+bool TuningSession::LoadParameters(TuningParameters &parameters) const
+{
+    return LoadTuningParameters(m_ParametersFile, parameters);
+}
+
+void TuningSession::ToggleRecording()
+{
+    if (m_Tuner.IsRunning())
+    {
+        return;
+    }
+
+    if (!m_Recording)
+    {
+        m_CameraPath.clear();
+        m_Recording = true;
+        return;
+    }
+
+    m_Recording = false;
+
+    bool const path_saved = SaveCameraPath(m_CameraPathFile, m_CameraPath);
+
+    char message[256];
+    snprintf(message, sizeof(message), "Camera path of %u frames %s %s", static_cast<uint32_t>(m_CameraPath.size()), path_saved ? "saved to" : "failed", m_CameraPathFile);
+    m_Log(message);
+}
+
+bool TuningSession::IsRecording() const
+{
+    return m_Recording;
+}
+
+uint32_t TuningSession::GetCameraPathFrameCount() const
+{
+    return static_cast<uint32_t>(m_CameraPath.size());
+}
+
+void TuningSession::RecordCameraPathFrame(CameraPathFrame const &frame)
+{
+    if (m_Recording && (!m_Tuner.IsRunning()))
+    {
+        m_CameraPath.push_back(frame);
+    }
+}
+
+CameraPathFrame const *TuningSession::GetCameraPathFrame() const
+{
+    return m_Tuner.IsRunning() ? &m_CameraPath[m_Tuner.GetPathFrame()] : NULL;
+}
+
+void TuningSession::RequestStart()
+{
+    m_StartPending = true;
+}
+
+bool TuningSession::IsRunning() const
+{
+    return m_Tuner.IsRunning();
+}
+
+bool TuningSession::BeginFrame(TuningParameters const &current_parameters, TuningParameters &parameters)
+{
+    if (m_StartPending && (!m_Tuner.IsRunning()))
+    {
+        if (m_CameraPath.empty() && (!LoadCameraPath(m_CameraPathFile, m_CameraPath)))
+        {
+            m_Log("Tuning: no camera path, press R to record one");
+        }
+        else
+        {
+            m_Recording = false;
+            m_SavedParameters = current_parameters;
+            m_Tuner.Begin(static_cast<uint32_t>(m_CameraPath.size()));
+        }
+    }
+    m_StartPending = false;
+
+    if (!m_Tuner.IsRunning())
+    {
+        return false;
+    }
+
+    parameters = m_Tuner.GetParameters();
+    return true;
+}
+
+bool TuningSession::EndFrame(double const pass_times_ms[TUNING_PASS_COUNT], uint8_t const *image_rgba8, uint32_t width, uint32_t height, uint32_t row_pitch, TuningParameters &parameters)
+{
+    m_Tuner.AddFrame(pass_times_ms, image_rgba8, width, height, row_pitch);
+
+    if (m_Tuner.IsRunning())
+    {
+        return false;
+    }
+
+    Finish(parameters);
+    return true;
+}
+
+void TuningSession::Finish(TuningParameters &parameters)
+{
+    char message[256];
+
+    bool const results_written = m_Tuner.WriteResultsCsv(m_ResultsFile);
+    snprintf(message, sizeof(message), "Tuning: results %s %s", results_written ? "written to" : "failed", m_ResultsFile);
+    m_Log(message);
+
+    if (m_Tuner.GetBestParameters(parameters))
+    {
+        bool const parameters_saved = SaveTuningParameters(m_ParametersFile, parameters);
+        snprintf(message, sizeof(message), "Tuning: quality %g, sampling rate %g, tracing resolution %u, tracing step %g %s %s", parameters.quality, parameters.directional_sampling_rate, parameters.tracing_resolution, parameters.tracing_step, parameters_saved ? "saved to" : "failed", m_ParametersFile);
+        m_Log(message);
+    }
+    else
+    {
+        m_Log("Tuning: no candidate meets the target error within the frame budget");
+        parameters = m_SavedParameters;
+    }
+}
+
+void TuningSession::Cancel()
+{
+    m_StartPending = false;
+    m_Tuner.Cancel();
+}
@@ -0,0 +1,224 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+// Searches the tracing parameters for the cheapest set which meets a target image error within a frame time budget, so that a set can be tuned per hardware tier by replaying a recorded camera path.
+// Each candidate set is run over the path: the GPU time of each pass is measured, and the final image is compared with the image of the reference (high quality) set at the same frame of the path.
+// The search assumes that moving any parameter towards the higher quality never lowers the time nor raises the error, thus the sets which can not be better than a measured set are skipped instead of run.
+// The map size, the stack levels and the finest voxel size are compile time constants of the voxel cone tracing library in this sample, thus they are not candidates.
+
+struct CameraPathFrame
+{
+    float eye[3];
+    float look_at[3];
+};
+
+// one frame per line: "eye.x eye.y eye.z look_at.x look_at.y look_at.z"
+bool SaveCameraPath(char const *path, std::vector<CameraPathFrame> const &frames);
+bool LoadCameraPath(char const *path, std::vector<CameraPathFrame> &frames);
+
+enum TUNING_PASS
+{
+    TUNING_PASS_VOXELIZATION = 0,
+    TUNING_PASS_TRACING = 1,
+    TUNING_PASS_COUNT = 2
+};
+
+enum TUNING_PARAMETER
+{
+    TUNING_PARAMETER_QUALITY = 0,
+    TUNING_PARAMETER_DIRECTIONAL_SAMPLING_RATE = 1,
+    TUNING_PARAMETER_TRACING_RESOLUTION = 2,
+    TUNING_PARAMETER_TRACING_STEP = 3,
+    TUNING_PARAMETER_COUNT = 4
+};
+
+struct TuningParameters
+{
+    // "DiffuseTracingParameters::quality", higher is better
+    float quality;
+
+    // "DiffuseTracingParameters::directionalSamplingRate", higher is better
+    float directional_sampling_rate;
+
+    // "VXGI::TracingResolution::Enum" of "DiffuseTracingParameters::tracingResolution", lower is better
+    uint32_t tracing_resolution;
+
+    // "BasicSpecularTracingParameters::tracingStep", lower is better
+    float tracing_step;
+};
+
+struct TuningCandidates
+{
+    std::vector<float> qualities;
+    std::vector<float> directional_sampling_rates;
+    std::vector<uint32_t> tracing_resolutions;
+    std::vector<float> tracing_steps;
+};
+
+struct TuningRunResult
+{
+    TuningParameters parameters;
+
+    // "false" when the run is skipped, since a measured set is known to be at least as good
+    bool measured;
+
+    double mean_pass_times_ms[TUNING_PASS_COUNT];
+    double mean_frame_time_ms;
+
+    // the budget is compared with the 95th percentile, so that a few hitches along the path do not reject the set
+    double percentile_frame_time_ms;
+
+    // the RMSE of the final image against the reference image, in [0, 1]
+    double mean_error;
+    double max_error;
+
+    bool meets_budget;
+    bool meets_error;
+};
+
+// The final images are box filtered down to this width before they are stored and compared, which bounds the memory of the reference images of a long path.
+static uint32_t const TUNING_IMAGE_MAX_WIDTH = 320U;
+
+class ParameterTuner
+{
+    TuningCandidates m_Candidates;
+    TuningParameters m_ReferenceParameters;
+
+    float m_FrameBudgetMs;
+    float m_TargetError;
+    uint32_t m_WarmUpFrameCount;
+
+    uint32_t m_PathFrameCount;
+
+    bool m_Running;
+
+    // the reference run comes before the first candidate run
+    bool m_ReferenceRun;
+    TuningRunResult m_ReferenceResult;
+
+    // the indices of each candidate run into the candidates, which are sorted from the lowest to the highest quality
+    std::vector<uint32_t> m_RunCoordinates;
+    std::vector<TuningRunResult> m_Results;
+    uint32_t m_Run;
+
+    // the frame of the current run, including the warm up frames
+    uint32_t m_Frame;
+
+    std::vector<double> m_FrameTimes;
+    double m_PassTimeSums[TUNING_PASS_COUNT];
+    std::vector<double> m_Errors;
+
+    uint32_t m_ImageWidth;
+    uint32_t m_ImageHeight;
+    std::vector<std::vector<uint8_t>> m_ReferenceImages;
+    std::vector<uint8_t> m_Image;
+
+    TuningParameters GetRunParameters(uint32_t run) const;
+    bool IsRunSkipped(uint32_t run) const;
+    void FinishRun();
+    void AdvanceRun();
+
+public:
+    ParameterTuner();
+
+    void SetCandidates(TuningCandidates const &candidates);
+    void SetReferenceParameters(TuningParameters const &parameters);
+
+    // in milliseconds, the sum of the passes
+    void SetFrameBudget(float frame_budget_ms);
+    float *GetFrameBudgetPointer();
+
+    void SetTargetError(float target_error);
+    float *GetTargetErrorPointer();
+
+    // the frames at the beginning of each run are rendered at the first frame of the path and not measured, so that the temporal filters and the voxelization settle
+    void SetWarmUpFrameCount(uint32_t warm_up_frame_count);
+
+    void Begin(uint32_t path_frame_count);
+    void Cancel();
+
+    bool IsRunning() const;
+    bool IsReferenceRun() const;
+
+    // the parameters and the frame of the path to render next
+    TuningParameters GetParameters() const;
+    uint32_t GetPathFrame() const;
+
+    // the image is RGBA8 (in any color space, as long as the reference is the same)
+    void AddFrame(double const pass_times_ms[TUNING_PASS_COUNT], uint8_t const *image_rgba8, uint32_t width, uint32_t height, uint32_t row_pitch);
+
+    // the progress, the skipped runs are counted as complete
+    uint32_t GetRunIndex() const;
+    uint32_t GetRunCount() const;
+
+    // the set with the lowest mean frame time among the sets which meet both the budget and the target error
+    bool GetBestParameters(TuningParameters &parameters) const;
+
+    TuningRunResult const &GetReferenceResult() const;
+    std::vector<TuningRunResult> const &GetResults() const;
+
+    // one row per run, the reference first
+    bool WriteResultsCsv(char const *path) const;
+};
+
+// "key = value" per line, so that a file per hardware tier can be edited by hand
+bool SaveTuningParameters(char const *path, TuningParameters const &parameters);
+bool LoadTuningParameters(char const *path, TuningParameters &parameters);
+
+// the messages of "TuningSession", one line without the newline
+typedef void (*TuningLog)(char const *message);
+
+// Drives the tuner from the sample: the camera path is recorded and replayed, the best set is saved for the next startup, and the parameters in use before the tuning are restored when no set qualifies.
+// The renderer applies the parameters and measures the frames, thus the session does not depend on the device.
+class TuningSession
+{
+    char const *m_CameraPathFile;
+    char const *m_ParametersFile;
+    char const *m_ResultsFile;
+    TuningLog m_Log;
+
+    ParameterTuner m_Tuner;
+
+    std::vector<CameraPathFrame> m_CameraPath;
+    bool m_Recording;
+
+    bool m_StartPending;
+    TuningParameters m_SavedParameters;
+
+    void Finish(TuningParameters &parameters);
+
+public:
+    TuningSession(char const *camera_path_file, char const *parameters_file, char const *results_file, TuningLog log);
+
+    // the budget, the target error and the progress
+    ParameterTuner &GetTuner();
+
+    // the parameters saved by the last tuning
+    bool LoadParameters(TuningParameters &parameters) const;
+
+    // starts the recording of the camera path, or stops it and saves the path, ignored while tuning
+    void ToggleRecording();
+    bool IsRecording() const;
+    uint32_t GetCameraPathFrameCount() const;
+
+    // the camera of the frame, recorded while recording
+    void RecordCameraPathFrame(CameraPathFrame const &frame);
+
+    // the camera of the frame while tuning, NULL otherwise
+    CameraPathFrame const *GetCameraPathFrame() const;
+
+    // the tuning starts at the next frame, with the path recorded or saved before
+    void RequestStart();
+    bool IsRunning() const;
+
+    // Returns whether the frame is tuned, and the parameters to render it with: "current_parameters" are restored after the tuning when no set qualifies.
+    bool BeginFrame(TuningParameters const &current_parameters, TuningParameters &parameters);
+
+    // The measurements of the tuned frame (see "ParameterTuner::AddFrame").
+    // Returns whether the tuning finished, and the parameters to render with from now on.
+    bool EndFrame(double const pass_times_ms[TUNING_PASS_COUNT], uint8_t const *image_rgba8, uint32_t width, uint32_t height, uint32_t row_pitch, TuningParameters &parameters);
+
+    void Cancel();
+};
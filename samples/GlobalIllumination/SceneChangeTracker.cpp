@@ -0,0 +1,226 @@
+#include "SceneChangeTracker.h"
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <cfloat>
+#include <algorithm>
+
+static VXGI::Box3f TransformBounds(VXGI::Box3f const &bounds, VXGI::float4x4 const &m)
+{
+    VXGI::Box3f result(VXGI::float3(FLT_MAX), VXGI::float3(-FLT_MAX));
+
+    for (uint32_t corner = 0U; corner < 8U; ++corner)
+    {
+        float const x = (0U != (corner & 1U)) ? bounds.upper.x : bounds.lower.x;
+        float const y = (0U != (corner & 2U)) ? bounds.upper.y : bounds.lower.y;
+        float const z = (0U != (corner & 4U)) ? bounds.upper.z : bounds.lower.z;
+
+        // row vector
+        VXGI::float3 const position(
+            x * m.m[0] + y * m.m[4] + z * m.m[8] + m.m[12],
+            x * m.m[1] + y * m.m[5] + z * m.m[9] + m.m[13],
+            x * m.m[2] + y * m.m[6] + z * m.m[10] + m.m[14]);
+
+        result.lower = VXGI::float3(std::min(result.lower.x, position.x), std::min(result.lower.y, position.y), std::min(result.lower.z, position.z));
+        result.upper = VXGI::float3(std::max(result.upper.x, position.x), std::max(result.upper.y, position.y), std::max(result.upper.z, position.z));
+    }
+
+    return result;
+}
+
+static VXGI::Box3f UnionBounds(VXGI::Box3f const &a, VXGI::Box3f const &b)
+{
+    return VXGI::Box3f(
+        VXGI::float3(std::min(a.lower.x, b.lower.x), std::min(a.lower.y, b.lower.y), std::min(a.lower.z, b.lower.z)),
+        VXGI::float3(std::max(a.upper.x, b.upper.x), std::max(a.upper.y, b.upper.y), std::max(a.upper.z, b.upper.z)));
+}
+
+// the boxes which share a face (or more) are merged as well
+static bool BoundsTouch(VXGI::Box3f const &a, VXGI::Box3f const &b)
+{
+    return (a.lower.x <= b.upper.x) && (b.lower.x <= a.upper.x) &&
+           (a.lower.y <= b.upper.y) && (b.lower.y <= a.upper.y) &&
+           (a.lower.z <= b.upper.z) && (b.lower.z <= a.upper.z);
+}
+
+static float BoundsVolume(VXGI::Box3f const &bounds)
+{
+    VXGI::float3 const extent = bounds.upper - bounds.lower;
+    return extent.x * extent.y * extent.z;
+}
+
+SceneChangeTracker::SceneChangeTracker() : m_PageSize(0.0F), m_MaxRegionCount(128U), m_LightValid(false)
+{
+}
+
+void SceneChangeTracker::SetPageSize(float page_size)
+{
+    m_PageSize = std::max(0.0F, page_size);
+}
+
+void SceneChangeTracker::SetMaxRegionCount(uint32_t max_region_count)
+{
+    m_MaxRegionCount = std::max(1U, max_region_count);
+}
+
+void SceneChangeTracker::Reset()
+{
+    m_Objects.clear();
+    m_LightValid = false;
+}
+
+void SceneChangeTracker::BeginFrame()
+{
+    for (ObjectState &object : m_Objects)
+    {
+        object.touched = false;
+    }
+
+    m_ChangedBounds.clear();
+    m_InvalidatedRegions.clear();
+    m_InvalidatedLightFrusta.clear();
+}
+
+void SceneChangeTracker::SetObject(uint32_t object_id, VXGI::float4x4 const &world_matrix, VXGI::Box3f const &local_bounds, bool visible)
+{
+    if (object_id >= m_Objects.size())
+    {
+        ObjectState new_object = {};
+        new_object.valid = false;
+        m_Objects.resize(object_id + 1U, new_object);
+    }
+
+    ObjectState &object = m_Objects[object_id];
+    assert(!object.touched);
+
+    bool const changed =
+        (!object.valid) ||
+        (object.visible != visible) ||
+        (0 != std::memcmp(&object.world_matrix, &world_matrix, sizeof(world_matrix))) ||
+        (0 != std::memcmp(&object.local_bounds, &local_bounds, sizeof(local_bounds)));
+
+    // a hidden object which stays hidden does not change the voxels
+    if (changed && (object.visible || visible))
+    {
+        if (object.valid && object.visible)
+        {
+            m_ChangedBounds.push_back(TransformBounds(object.local_bounds, object.world_matrix));
+        }
+
+        if (visible)
+        {
+            m_ChangedBounds.push_back(TransformBounds(local_bounds, world_matrix));
+        }
+    }
+
+    object.world_matrix = world_matrix;
+    object.local_bounds = local_bounds;
+    object.visible = visible;
+    object.valid = true;
+    object.touched = true;
+}
+
+void SceneChangeTracker::SetLight(VXGI::float4x4 const &light_view_proj_matrix, VXGI::Frustum const &light_frustum)
+{
+    if ((!m_LightValid) || (0 != std::memcmp(&m_LightViewProjMatrix, &light_view_proj_matrix, sizeof(light_view_proj_matrix))))
+    {
+        m_InvalidatedLightFrusta.push_back(light_frustum);
+    }
+
+    m_LightViewProjMatrix = light_view_proj_matrix;
+    m_LightValid = true;
+}
+
+void SceneChangeTracker::EndFrame()
+{
+    for (ObjectState &object : m_Objects)
+    {
+        if (object.valid && (!object.touched))
+        {
+            if (object.visible)
+            {
+                m_ChangedBounds.push_back(TransformBounds(object.local_bounds, object.world_matrix));
+            }
+
+            object.valid = false;
+        }
+    }
+
+    for (VXGI::Box3f const &bounds : m_ChangedBounds)
+    {
+        VXGI::Box3f region = bounds;
+
+        if (m_PageSize > 0.0F)
+        {
+            region.lower = VXGI::float3(std::floor(region.lower.x / m_PageSize), std::floor(region.lower.y / m_PageSize), std::floor(region.lower.z / m_PageSize)) * m_PageSize;
+            region.upper = VXGI::float3(std::ceil(region.upper.x / m_PageSize), std::ceil(region.upper.y / m_PageSize), std::ceil(region.upper.z / m_PageSize)) * m_PageSize;
+        }
+
+        // merge with the existing regions until the region does not touch any of them
+        bool merged;
+        do
+        {
+            merged = false;
+
+            for (size_t region_index = 0U; region_index < m_InvalidatedRegions.size(); ++region_index)
+            {
+                if (BoundsTouch(m_InvalidatedRegions[region_index], region))
+                {
+                    region = UnionBounds(m_InvalidatedRegions[region_index], region);
+                    m_InvalidatedRegions[region_index] = m_InvalidatedRegions.back();
+                    m_InvalidatedRegions.pop_back();
+                    merged = true;
+                    break;
+                }
+            }
+        } while (merged);
+
+        m_InvalidatedRegions.push_back(region);
+    }
+
+    // the unions of the regions on the page grid are still on the page grid
+    while (m_InvalidatedRegions.size() > m_MaxRegionCount)
+    {
+        size_t best_a = 0U;
+        size_t best_b = 1U;
+        float best_cost = FLT_MAX;
+
+        for (size_t a = 0U; a < m_InvalidatedRegions.size(); ++a)
+        {
+            for (size_t b = a + 1U; b < m_InvalidatedRegions.size(); ++b)
+            {
+                float const cost = BoundsVolume(UnionBounds(m_InvalidatedRegions[a], m_InvalidatedRegions[b])) - BoundsVolume(m_InvalidatedRegions[a]) - BoundsVolume(m_InvalidatedRegions[b]);
+                if (cost < best_cost)
+                {
+                    best_a = a;
+                    best_b = b;
+                    best_cost = cost;
+                }
+            }
+        }
+
+        m_InvalidatedRegions[best_a] = UnionBounds(m_InvalidatedRegions[best_a], m_InvalidatedRegions[best_b]);
+        m_InvalidatedRegions[best_b] = m_InvalidatedRegions.back();
+        m_InvalidatedRegions.pop_back();
+    }
+}
+
+VXGI::Box3f const *SceneChangeTracker::GetInvalidatedRegions() const
+{
+    return m_InvalidatedRegions.empty() ? NULL : &m_InvalidatedRegions[0];
+}
+
+uint32_t SceneChangeTracker::GetInvalidatedRegionCount() const
+{
+    return static_cast<uint32_t>(m_InvalidatedRegions.size());
+}
+
+VXGI::Frustum const *SceneChangeTracker::GetInvalidatedLightFrusta() const
+{
+    return m_InvalidatedLightFrusta.empty() ? NULL : &m_InvalidatedLightFrusta[0];
+}
+
+uint32_t SceneChangeTracker::GetInvalidatedLightFrustumCount() const
+{
+    return static_cast<uint32_t>(m_InvalidatedLightFrusta.size());
+}
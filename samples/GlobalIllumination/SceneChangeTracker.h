@@ -0,0 +1,65 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include "GFSDK_VXGI_MathTypes.h"
+
+// Diffs the world transform, the bounds and the visibility of each object between frames, and produces the "invalidatedRegions" and "invalidatedLightFrusta" of "VXGI::UpdateVoxelizationParameters".
+// The region of a changed object is the union of its old and new world bounds, rounded (outwards) to the page grid. Overlapping and adjacent regions are merged.
+// The frustum of the light is invalidated whenever the view projection matrix of the light changes.
+class SceneChangeTracker
+{
+    struct ObjectState
+    {
+        VXGI::float4x4 world_matrix;
+        VXGI::Box3f local_bounds;
+        bool visible;
+
+        // the object was set in a previous frame
+        bool valid;
+
+        // the object was set in the current frame
+        bool touched;
+    };
+
+    float m_PageSize;
+    uint32_t m_MaxRegionCount;
+
+    std::vector<ObjectState> m_Objects;
+
+    bool m_LightValid;
+    VXGI::float4x4 m_LightViewProjMatrix;
+
+    std::vector<VXGI::Box3f> m_ChangedBounds;
+
+    std::vector<VXGI::Box3f> m_InvalidatedRegions;
+    std::vector<VXGI::Frustum> m_InvalidatedLightFrusta;
+
+public:
+    SceneChangeTracker();
+
+    // in world units, 0 means that the regions are not rounded
+    void SetPageSize(float page_size);
+
+    // the regions which are merged the cheapest (the least added volume) are merged until the count fits
+    void SetMaxRegionCount(uint32_t max_region_count);
+
+    // the next frame will invalidate every object and the light
+    void Reset();
+
+    void BeginFrame();
+
+    // the world bounds are the local bounds transformed by the world matrix (the same as "mul(float4(position, 1.0), g_WorldMatrix).xyz" of the shaders)
+    void SetObject(uint32_t object_id, VXGI::float4x4 const &world_matrix, VXGI::Box3f const &local_bounds, bool visible);
+
+    void SetLight(VXGI::float4x4 const &light_view_proj_matrix, VXGI::Frustum const &light_frustum);
+
+    // the objects which are not set in the current frame are treated as removed
+    void EndFrame();
+
+    VXGI::Box3f const *GetInvalidatedRegions() const;
+    uint32_t GetInvalidatedRegionCount() const;
+
+    VXGI::Frustum const *GetInvalidatedLightFrusta() const;
+    uint32_t GetInvalidatedLightFrustumCount() const;
+};
@@ -17,7 +17,9 @@
 
 #include <DirectXMath.h>
 #include <string>
+#include <cassert>
 #include "SceneRenderer.h"
+#include "Clipmap.h"
 #include "BindingHelpers.h"
 
 #ifndef NDEBUG
@@ -29,6 +31,12 @@
 #include "shaders\D3D\Debug\CompositingPS.inl"
 #include "shaders\D3D\Debug\MyVoxelizationVS.inl"
 #include "shaders\D3D\Debug\MyVoxelizationPS.inl"
+#include "shaders\D3D\Debug\MyLightInjectionCS.inl"
+#include "shaders\D3D\Debug\MyShadowMapLightInjectionCS.inl"
+#include "shaders\D3D\Debug\MyVoxelStatisticsCS.inl"
+#include "shaders\D3D\Debug\MyIndirectIrradianceCS.inl"
+#include "shaders\D3D\Debug\MyClipmapDownsampleCS.inl"
+#include "shaders\D3D\Debug\MyVoxelResolveCS.inl"
 #else
 #include "shaders\D3D\Release\DefaultVS.inl"
 #include "shaders\D3D\Release\AttributesPS.inl"
@@ -38,6 +46,12 @@
 #include "shaders\D3D\Release\CompositingPS.inl"
 #include "shaders\D3D\Release\MyVoxelizationVS.inl"
 #include "shaders\D3D\Release\MyVoxelizationPS.inl"
+#include "shaders\D3D\Release\MyLightInjectionCS.inl"
+#include "shaders\D3D\Release\MyShadowMapLightInjectionCS.inl"
+#include "shaders\D3D\Release\MyVoxelStatisticsCS.inl"
+#include "shaders\D3D\Release\MyIndirectIrradianceCS.inl"
+#include "shaders\D3D\Release\MyClipmapDownsampleCS.inl"
+#include "shaders\D3D\Release\MyVoxelResolveCS.inl"
 #endif
 #include "shaders\TransparentGeometryPS.hlsli"
 #include "shaders\VoxelizationPS.hlsli"
@@ -59,18 +73,40 @@ static const UINT SRV_SLOT_COUNT = 7;
 
 static const UINT UAV_SLOT_OPACITY = 2;
 static const UINT UAV_SLOT_ILLUMINATION = 3;
+static const UINT UAV_SLOT_VOXEL_SURFACE = 4;
+static const UINT UAV_SLOT_VOXEL_STATISTICS = 5;
+
+static const UINT SRV_SLOT_VOXEL_SURFACE = 0;
+
+static const UINT SRV_SLOT_VOXEL_STATISTICS_OPACITY = 0;
+static const UINT UAV_SLOT_VOXEL_STATISTICS_COUNTERS = 0;
+
+static const UINT SRV_SLOT_INDIRECT_IRRADIANCE_SURFACE = 0;
+static const UINT SRV_SLOT_INDIRECT_IRRADIANCE_OPACITY = 1;
+static const UINT UAV_SLOT_INDIRECT_IRRADIANCE = 0;
+static const UINT UAV_SLOT_INDIRECT_IRRADIANCE_EMITTANCE = 1;
+static const UINT SRV_SLOT_INDIRECT_IRRADIANCE_COMPACT_OPACITY = 2;
+static const UINT SRV_SLOT_INDIRECT_IRRADIANCE_COMPACT_RADIANCE = 3;
+
+static const UINT UAV_SLOT_CLIPMAP_DOWNSAMPLE_OPACITY = 0;
+static const UINT UAV_SLOT_CLIPMAP_DOWNSAMPLE_ILLUMINATION = 1;
+
+static const UINT SRV_SLOT_ACCUMULATED_OPACITY = 0;
+static const UINT SRV_SLOT_ACCUMULATED_EMITTANCE = 1;
+static const UINT UAV_SLOT_COMPACT_OPACITY = 0;
+static const UINT UAV_SLOT_COMPACT_RADIANCE = 1;
 
 using namespace DirectX;
 
 SceneRenderer::SceneRenderer(NVRHI::IRendererInterface *pRenderer)
-    : m_RendererInterface(pRenderer), m_pScene(NULL), m_pTransparentScene(NULL), m_Width(0), m_Height(0), m_SampleCount(1), m_pVoxelizationGS(NULL), m_pVoxelizationPS(NULL), m_pTransparentGeometryPS(NULL)
+    : m_RendererInterface(pRenderer), m_pScene(NULL), m_pTransparentScene(NULL), m_Width(0), m_Height(0), m_SampleCount(1), m_pVoxelizationGS(NULL), m_pVoxelizationPS(NULL), m_pTransparentGeometryPS(NULL), m_VoxelizationLayer(VoxelizationLayer::STATIC), m_VoxelizationStackLevelMask(CLIPMAP_ALL_STACK_LEVELS_MASK), m_VoxelizationOpacityTexture(NULL), m_VoxelizationIlluminationTexture(NULL), m_VoxelizationSurfaceTexture(NULL), m_VoxelizationTrianglesSubmitted(0U), m_VoxelizationTrianglesSkipped(0U), m_VoxelStatisticsEnabled(false), m_DeriveCoarseStackLevels(false), m_CompactVoxelOpacityTexture(NULL), m_CompactVoxelRadianceTexture(NULL), m_CompactVoxelRadianceEncoding(VoxelRadianceEncoding::RGB9E5)
 {
 }
 
-HRESULT SceneRenderer::LoadMesh(const char *strFileName)
+HRESULT SceneRenderer::LoadMesh(const char *strFileName, uint32_t loadFlags)
 {
     m_pScene = new Scene();
-    HRESULT result = m_pScene->Load(strFileName, 0);
+    HRESULT result = m_pScene->Load(strFileName, Scene::LOAD_DOMINANT_AXIS_BINNING | loadFlags);
 
     if (FAILED(result))
     {
@@ -84,7 +120,7 @@ HRESULT SceneRenderer::LoadMesh(const char *strFileName)
 HRESULT SceneRenderer::LoadTransparentMesh(const char *strFileName)
 {
     m_pTransparentScene = new Scene();
-    HRESULT result = m_pTransparentScene->Load(strFileName, 0);
+    HRESULT result = m_pTransparentScene->Load(strFileName, Scene::LOAD_DOMINANT_AXIS_BINNING);
 
     if (FAILED(result))
     {
@@ -113,9 +149,54 @@ HRESULT SceneRenderer::AllocateResources(VXGI::IGlobalIllumination *pGI, VXGI::I
     CREATE_SHADER(PIXEL, g_BlitLdrPS, &m_pBlitLdrPS);
     CREATE_SHADER(PIXEL, g_CompositingPS, &m_pCompositingPS);
     CREATE_SHADER(PIXEL, g_MyVoxelizationPS, &m_pMyVoxelizationPS);
+    CREATE_SHADER(COMPUTE, g_MyLightInjectionCS, &m_pMyLightInjectionCS);
+    CREATE_SHADER(COMPUTE, g_MyShadowMapLightInjectionCS, &m_pMyShadowMapLightInjectionCS);
+    CREATE_SHADER(COMPUTE, g_MyVoxelStatisticsCS, &m_pMyVoxelStatisticsCS);
+    CREATE_SHADER(COMPUTE, g_MyIndirectIrradianceCS, &m_pMyIndirectIrradianceCS);
+    CREATE_SHADER(COMPUTE, g_MyClipmapDownsampleCS, &m_pMyClipmapDownsampleCS);
+    CREATE_SHADER(COMPUTE, g_MyVoxelResolveCS, &m_pMyVoxelResolveCS);
+
+    // The (viewport depth direction, stack level) pair of each instance is fetched from this buffer, since the SV_InstanceID does NOT include the StartInstanceLocation
+    // Instance "BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT * viewport_depth_direction_index + stack_level"
+    {
+        static_assert(Scene::DOMINANT_AXIS_COUNT == BRX_VCT_VIEWPORT_DEPTH_DIRECTION_COUNT, "the dominant axis of the face normal is used as the viewport depth direction");
+
+        uint32_t clipmap_instances[BRX_VCT_VIEWPORT_DEPTH_DIRECTION_COUNT * BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT][2];
+        for (uint32_t viewport_depth_direction_index = 0U; viewport_depth_direction_index < BRX_VCT_VIEWPORT_DEPTH_DIRECTION_COUNT; ++viewport_depth_direction_index)
+        {
+            for (uint32_t stack_level = 0U; stack_level < BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT; ++stack_level)
+            {
+                clipmap_instances[BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT * viewport_depth_direction_index + stack_level][0] = viewport_depth_direction_index;
+                clipmap_instances[BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT * viewport_depth_direction_index + stack_level][1] = stack_level;
+            }
+        }
+
+        NVRHI::BufferDesc clipmapInstanceBufferDesc;
+        clipmapInstanceBufferDesc.isVertexBuffer = true;
+        clipmapInstanceBufferDesc.byteSize = sizeof(clipmap_instances);
+        clipmapInstanceBufferDesc.debugName = "ClipmapInstanceBuffer";
+        m_RendererInterface->createBuffer(clipmapInstanceBufferDesc, clipmap_instances, &m_pClipmapInstanceBuffer);
+
+        NVRHI::VertexAttributeDesc clipmapInstanceAttributeDesc = {};
+        strcpy_s(clipmapInstanceAttributeDesc.name, "CLIPMAP_INSTANCE");
+        clipmapInstanceAttributeDesc.semanticIndex = 0U;
+        clipmapInstanceAttributeDesc.format = NVRHI::Format::RG32_UINT;
+        clipmapInstanceAttributeDesc.bufferIndex = 0U;
+        clipmapInstanceAttributeDesc.offset = 0U;
+        clipmapInstanceAttributeDesc.isInstanced = true;
+        m_RendererInterface->createInputLayout(&clipmapInstanceAttributeDesc, 1U, g_MyVoxelizationVS, sizeof(g_MyVoxelizationVS), &m_pMyVoxelizationInputLayout);
+    }
 
     m_RendererInterface->createConstantBuffer(NVRHI::ConstantBufferDesc(sizeof(GlobalConstants), nullptr), nullptr, &m_pGlobalCBuffer);
 
+    {
+        NVRHI::BufferDesc voxelStatisticsBufferDesc;
+        voxelStatisticsBufferDesc.byteSize = sizeof(uint32_t) * BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT * VOXEL_STATISTICS_COUNTER_COUNT;
+        voxelStatisticsBufferDesc.canHaveUAVs = true;
+        voxelStatisticsBufferDesc.debugName = "VoxelStatisticsBuffer";
+        m_RendererInterface->createBuffer(voxelStatisticsBufferDesc, NULL, &m_pVoxelStatisticsBuffer);
+    }
+
     NVRHI::SamplerDesc samplerDesc;
     samplerDesc.wrapMode[0] = NVRHI::SamplerDesc::WRAP_MODE_WRAP;
     samplerDesc.wrapMode[1] = NVRHI::SamplerDesc::WRAP_MODE_WRAP;
@@ -155,6 +236,15 @@ HRESULT SceneRenderer::AllocateResources(VXGI::IGlobalIllumination *pGI, VXGI::I
     if (FAILED(m_pScene->InitResources(m_RendererInterface)))
         return E_FAIL;
 
+    {
+        std::vector<VXGI::Box3f> meshBounds(m_pScene->GetMeshesNum());
+        for (UINT i = 0; i < m_pScene->GetMeshesNum(); ++i)
+        {
+            meshBounds[i] = m_pScene->GetMeshBounds(i);
+        }
+        m_MeshBoundsIndex.Build(meshBounds.empty() ? NULL : &meshBounds[0], uint32_t(meshBounds.size()));
+    }
+
 #if 0
     if (FAILED(m_pTransparentScene->InitResources(m_RendererInterface)))
         return E_FAIL;
@@ -313,6 +403,11 @@ void SceneRenderer::SetLightDirection(VXGI::float3 direction)
     m_LightDirection = direction.normalize();
 }
 
+VXGI::float3 SceneRenderer::GetLightDirection() const
+{
+    return m_LightDirection;
+}
+
 XMVECTOR XMVectorSet(VXGI::float3 v)
 {
     return XMVectorSet(v.x, v.y, v.z, 0.f);
@@ -443,6 +538,20 @@ void SceneRenderer::RenderSceneCommon(
 
     state.vertexBufferCount = 0;
 
+#if PATCH
+    if (voxelization)
+    {
+        state.inputLayout = m_pMyVoxelizationInputLayout;
+        state.vertexBufferCount = 1;
+        state.vertexBuffers[0].buffer = m_pClipmapInstanceBuffer;
+        state.vertexBuffers[0].slot = 0;
+        state.vertexBuffers[0].offset = 0;
+        state.vertexBuffers[0].stride = sizeof(uint32_t) * 2U;
+    }
+
+    VXGI::float3 const clipmap_center(constants.clipmap_center.x, constants.clipmap_center.y, constants.clipmap_center.z);
+#endif
+
     state.VS.shader = m_pDefaultVS;
     NVRHI::BindConstantBuffer(state.VS, 0, m_pGlobalCBuffer);
 
@@ -460,11 +569,31 @@ void SceneRenderer::RenderSceneCommon(
 
     std::vector<NVRHI::DrawArguments> drawCalls;
 
-    for (UINT i = 0; i < numMeshes; ++i)
+    bool const useMeshBoundsIndex = clippingBoxes && numBoxes && (pScene == m_pScene) && (m_MeshBoundsIndex.GetMeshCount() == numMeshes);
+    if (useMeshBoundsIndex)
+    {
+        m_MeshBoundsIndex.Query(clippingBoxes, numBoxes, m_ClippedMeshes);
+    }
+
+    // the queried meshes are in ascending order, thus the meshes are drawn in the same order either way
+    UINT const numCandidates = useMeshBoundsIndex ? UINT(m_ClippedMeshes.size()) : numMeshes;
+
+    for (UINT candidate = 0; candidate < numCandidates; ++candidate)
     {
+        UINT const i = useMeshBoundsIndex ? m_ClippedMeshes[candidate] : candidate;
+
+        // the boxes which overlap the mesh
+        uint64_t const *regionMask = useMeshBoundsIndex ? m_MeshBoundsIndex.GetRegionMask(i) : NULL;
+
         VXGI::Box3f meshBounds = pScene->GetMeshBounds(i);
 
-        if (clippingBoxes && numBoxes)
+#if PATCH
+        // only the meshes of the layer being voxelized
+        if (voxelization && (pScene->IsMeshDynamic(i) != (VoxelizationLayer::DYNAMIC == m_VoxelizationLayer)))
+            continue;
+#endif
+
+        if (clippingBoxes && numBoxes && (!useMeshBoundsIndex))
         {
             bool contained = false;
             for (UINT clipbox = 0; clipbox < numBoxes; ++clipbox)
@@ -480,6 +609,75 @@ void SceneRenderer::RenderSceneCommon(
                 continue;
         }
 
+#if PATCH
+        // one draw call per dominant axis range and per contiguous run of the scheduled stack levels
+        NVRHI::DrawArguments voxelization_draw_calls[Scene::DOMINANT_AXIS_COUNT * BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT];
+        uint32_t voxelization_draw_call_count = 0U;
+
+        if (voxelization)
+        {
+            for (uint32_t axis = 0U; axis < Scene::DOMINANT_AXIS_COUNT; ++axis)
+            {
+                NVRHI::DrawArguments draw_call = pScene->GetMeshDominantAxisDrawArguments(i, axis);
+                if (0U == draw_call.vertexCount)
+                    continue;
+
+                VXGI::Box3f const axis_bounds = pScene->GetMeshDominantAxisBounds(i, axis);
+
+                bool contained = !(clippingBoxes && numBoxes);
+                for (UINT clipbox = 0; (!contained) && (clipbox < numBoxes); ++clipbox)
+                {
+                    // the dominant axis range is inside the mesh, thus only the boxes overlapping the mesh can overlap it
+                    if (regionMask && (!MeshBoundsIndex::IsRegionInMask(regionMask, clipbox)))
+                        continue;
+
+                    contained = clippingBoxes[clipbox].intersectsWith(axis_bounds);
+                }
+
+                // only the stack levels whose region overlaps the triangles
+                uint32_t first_stack_level;
+                uint32_t stack_level_count;
+                if ((!contained) || (!GetClipmapStackLevelRange(axis_bounds, clipmap_center, first_stack_level, stack_level_count)))
+                {
+                    m_VoxelizationTrianglesSkipped += draw_call.vertexCount / 3U;
+                    continue;
+                }
+
+                uint32_t const stack_level_mask = m_VoxelizationStackLevelMask & (((1U << stack_level_count) - 1U) << first_stack_level);
+                if (0U == stack_level_mask)
+                {
+                    m_VoxelizationTrianglesSkipped += draw_call.vertexCount / 3U;
+                    continue;
+                }
+
+                m_VoxelizationTrianglesSubmitted += draw_call.vertexCount / 3U;
+
+                uint32_t stack_level = first_stack_level;
+                while (stack_level < (first_stack_level + stack_level_count))
+                {
+                    if (0U == (stack_level_mask & (1U << stack_level)))
+                    {
+                        ++stack_level;
+                        continue;
+                    }
+
+                    uint32_t const run_first_stack_level = stack_level;
+                    while ((stack_level < (first_stack_level + stack_level_count)) && (0U != (stack_level_mask & (1U << stack_level))))
+                    {
+                        ++stack_level;
+                    }
+
+                    draw_call.startInstanceLocation = BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT * axis + run_first_stack_level;
+                    draw_call.instanceCount = stack_level - run_first_stack_level;
+                    voxelization_draw_calls[voxelization_draw_call_count++] = draw_call;
+                }
+            }
+
+            if (0U == voxelization_draw_call_count)
+                continue;
+        }
+#endif
+
         int material = pScene->GetMaterialIndex(i);
 
         if (material != lastMaterial)
@@ -536,8 +734,16 @@ void SceneRenderer::RenderSceneCommon(
                 NVRHI::BindTexture(state.PS, SRV_SLOT_BASE_COLOR_TEXTURE, materialInfo.base_color_texture ? materialInfo.base_color_texture : m_NullTexture, false, NVRHI::Format::UNKNOWN, ~0u);
                 NVRHI::BindTexture(state.PS, SRV_SLOT_ROUGHNESS_METALLIC_TEXTURE, materialInfo.roughness_metallic_texture ? materialInfo.roughness_metallic_texture : m_NullTexture, false, NVRHI::Format::UNKNOWN, ~0u);
 
-                NVRHI::BindTexture(state.PS, UAV_SLOT_OPACITY, g_clipmap_opacity_texture, true, NVRHI::Format::R32_UINT, 0U);
-                NVRHI::BindTexture(state.PS, UAV_SLOT_ILLUMINATION, g_clipmap_illumination_texture, true, NVRHI::Format::R32_UINT, 0U);
+                NVRHI::BindTexture(state.PS, UAV_SLOT_OPACITY, m_VoxelizationOpacityTexture, true, NVRHI::Format::R32_UINT, 0U);
+                NVRHI::BindTexture(state.PS, UAV_SLOT_ILLUMINATION, m_VoxelizationIlluminationTexture, true, NVRHI::Format::R32_UINT, 0U);
+                if (m_VoxelizationSurfaceTexture)
+                {
+                    NVRHI::BindTexture(state.PS, UAV_SLOT_VOXEL_SURFACE, m_VoxelizationSurfaceTexture, true, NVRHI::Format::RG32_UINT, 0U);
+                }
+                if (m_VoxelStatisticsEnabled)
+                {
+                    NVRHI::BindBuffer(state.PS, UAV_SLOT_VOXEL_STATISTICS, m_pVoxelStatisticsBuffer, true, NVRHI::Format::R32_UINT);
+                }
             }
 
             NVRHI::BindBuffer(state.VS, SRV_SLOT_VERTEX_POSITION_BUFFER, m_pScene->GetVertexPositionBuffer(i), false, NVRHI::Format::BC7);
@@ -553,14 +759,14 @@ void SceneRenderer::RenderSceneCommon(
             lastMaterialInfo = materialInfo;
         }
 
-        NVRHI::DrawArguments draw_call = m_pScene->GetMeshDrawArguments(i);
 #if PATCH
         if (voxelization)
         {
-            draw_call.instanceCount = BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT;
+            drawCalls.insert(drawCalls.end(), voxelization_draw_calls, voxelization_draw_calls + voxelization_draw_call_count);
+            continue;
         }
 #endif
-        drawCalls.push_back(draw_call);
+        drawCalls.push_back(m_pScene->GetMeshDrawArguments(i));
     }
 
     if (!drawCalls.empty())
@@ -576,10 +782,13 @@ void SceneRenderer::RenderSceneCommon(
     m_RendererInterface->endRenderingPass();
 }
 
-void SceneRenderer::RenderForVoxelization(NVRHI::DrawCallState &state, VXGI::IGlobalIllumination *pGI, const VXGI::Box3f *clippingBoxes, uint32_t numBoxes, DirectX::XMFLOAT3 const &clipmap_anchor, const VXGI::float4x4 &viewProjMatrix, MaterialCallback *onChangeMaterial)
+void SceneRenderer::RenderForVoxelization(NVRHI::DrawCallState &state, VXGI::IGlobalIllumination *pGI, const VXGI::Box3f *clippingBoxes, uint32_t numBoxes, DirectX::XMFLOAT3 const &clipmap_anchor, const VXGI::float4x4 &viewProjMatrix, MaterialCallback *onChangeMaterial, VoxelizationLayer layer, NVRHI::TextureHandle opacityTexture, NVRHI::TextureHandle illuminationTexture, NVRHI::TextureHandle surfaceTexture, uint32_t stackLevelMask)
 {
     GlobalConstants constants = {};
     constants.viewProjMatrix = viewProjMatrix;
+    constants.writeVoxelSurface = (surfaceTexture != NULL) ? 1U : 0U;
+    constants.voxelStatisticsEnable = m_VoxelStatisticsEnabled ? 1U : 0U;
+    constants.deriveCoarseStackLevels = (m_DeriveCoarseStackLevels && (VoxelizationLayer::STATIC == layer)) ? 1U : 0U;
 
     DirectX::XMFLOAT3 clipmap_center = brx_voxel_cone_tracing_voxelization_compute_clipmap_center(clipmap_anchor);
     constants.clipmap_center.x = clipmap_center.x;
@@ -596,9 +805,355 @@ void SceneRenderer::RenderForVoxelization(NVRHI::DrawCallState &state, VXGI::IGl
         constants.clipmap_stack_level_projection_matrices[stack_level] = brx_voxel_cone_tracing_voxelization_compute_clipmap_stack_level_projection_matrix(stack_level);
     }
 
+    m_VoxelizationLayer = layer;
+    m_VoxelizationOpacityTexture = opacityTexture;
+    m_VoxelizationIlluminationTexture = illuminationTexture;
+    m_VoxelizationSurfaceTexture = surfaceTexture;
+    m_VoxelizationStackLevelMask = stackLevelMask;
+
     RenderSceneCommon(m_pScene, state, pGI, clippingBoxes, numBoxes, constants, onChangeMaterial, true);
 }
 
+NVRHI::TextureDesc SceneRenderer::GetVoxelSurfaceTextureDesc()
+{
+    NVRHI::TextureDesc d;
+    d.width = BRX_VCT_CLIPMAP_MAP_SIZE;
+    d.height = BRX_VCT_CLIPMAP_MAP_SIZE;
+    d.depthOrArraySize = BRX_VCT_CLIPMAP_MAP_SIZE * BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT;
+    d.format = NVRHI::Format::RG32_UINT;
+    d.isUAV = true;
+    d.debugName = "VoxelSurface";
+    return d;
+}
+
+void SceneRenderer::BindLightInjection(NVRHI::DispatchState &state, DirectX::XMFLOAT3 const &clipmap_anchor, NVRHI::TextureHandle surfaceTexture, NVRHI::TextureHandle scratchOpacityTexture, NVRHI::TextureHandle illuminationTexture)
+{
+    GlobalConstants constants = {};
+
+    DirectX::XMFLOAT3 clipmap_center = brx_voxel_cone_tracing_voxelization_compute_clipmap_center(clipmap_anchor);
+    constants.clipmap_center.x = clipmap_center.x;
+    constants.clipmap_center.y = clipmap_center.y;
+    constants.clipmap_center.z = clipmap_center.z;
+
+    for (uint32_t viewport_depth_direction_index = 0; viewport_depth_direction_index < BRX_VCT_VIEWPORT_DEPTH_DIRECTION_COUNT; ++viewport_depth_direction_index)
+    {
+        constants.viewport_depth_direction_view_matrices[viewport_depth_direction_index] = brx_voxel_cone_tracing_voxelization_compute_viewport_depth_direction_view_matrix(clipmap_center, viewport_depth_direction_index);
+    }
+
+    for (uint32_t stack_level = 0; stack_level < BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT; ++stack_level)
+    {
+        constants.clipmap_stack_level_projection_matrices[stack_level] = brx_voxel_cone_tracing_voxelization_compute_clipmap_stack_level_projection_matrix(stack_level);
+    }
+
+    constants.lightMatrix = (VXGI::float4x4 &)m_LightViewProjMatrix;
+    constants.viewProjMatrixInv = m_LightViewProjMatrix.invert();
+    constants.lightDirection = (VXGI::float3 &)m_LightDirection;
+    constants.lightColor = VXGI::float4(1.f);
+    constants.rShadowMapSize = 1.0f / s_ShadowMapSize;
+    m_RendererInterface->writeConstantBuffer(m_pGlobalCBuffer, &constants, sizeof(constants));
+
+    NVRHI::BindConstantBuffer(state, 0, m_pGlobalCBuffer);
+    NVRHI::BindTexture(state, SRV_SLOT_VOXEL_SURFACE, surfaceTexture, false, NVRHI::Format::RG32_UINT, 0U);
+    NVRHI::BindTexture(state, SRV_SLOT_SHADOW_MAP, m_ShadowMap);
+    NVRHI::BindSampler(state, 1, m_pComparisonSamplerState);
+    NVRHI::BindTexture(state, UAV_SLOT_OPACITY, scratchOpacityTexture, true, NVRHI::Format::R32_UINT, 0U);
+    NVRHI::BindTexture(state, UAV_SLOT_ILLUMINATION, illuminationTexture, true, NVRHI::Format::R32_UINT, 0U);
+}
+
+void SceneRenderer::InjectVoxelLight(DirectX::XMFLOAT3 const &clipmap_anchor, NVRHI::TextureHandle surfaceTexture, NVRHI::TextureHandle scratchOpacityTexture, NVRHI::TextureHandle illuminationTexture)
+{
+    NVRHI::DispatchState state;
+    state.shader = m_pMyLightInjectionCS;
+    BindLightInjection(state, clipmap_anchor, surfaceTexture, scratchOpacityTexture, illuminationTexture);
+
+    // [numthreads(4, 4, 4)]
+    m_RendererInterface->dispatch(state, BRX_VCT_CLIPMAP_MAP_SIZE / 4U, BRX_VCT_CLIPMAP_MAP_SIZE / 4U, (BRX_VCT_CLIPMAP_MAP_SIZE * BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT) / 4U);
+}
+
+void SceneRenderer::InjectShadowMapLight(DirectX::XMFLOAT3 const &clipmap_anchor, NVRHI::TextureHandle surfaceTexture, NVRHI::TextureHandle scratchOpacityTexture, NVRHI::TextureHandle illuminationTexture)
+{
+    NVRHI::DispatchState state;
+    state.shader = m_pMyShadowMapLightInjectionCS;
+    BindLightInjection(state, clipmap_anchor, surfaceTexture, scratchOpacityTexture, illuminationTexture);
+
+    // [numthreads(8, 8, 1)]
+    m_RendererInterface->dispatch(state, s_ShadowMapSize / 8U, s_ShadowMapSize / 8U, 1U);
+}
+
+NVRHI::TextureDesc SceneRenderer::GetIndirectIrradianceTextureDesc()
+{
+    NVRHI::TextureDesc d = GetVoxelSurfaceTextureDesc();
+    d.debugName = "IndirectIrradiance";
+    return d;
+}
+
+void SceneRenderer::UpdateIndirectIrradiance(DirectX::XMFLOAT3 const &clipmap_anchor, IndirectIrradiancePass pass, NVRHI::TextureHandle surfaceTexture, NVRHI::TextureHandle opacityTexture, NVRHI::TextureHandle illuminationTexture, NVRHI::TextureHandle indirectIrradianceTexture, uint32_t frame, uint32_t period, float blend, float scale, ClipmapVoxelBox const *voxelBox)
+{
+    GlobalConstants constants = {};
+
+    DirectX::XMFLOAT3 clipmap_center = brx_voxel_cone_tracing_voxelization_compute_clipmap_center(clipmap_anchor);
+    constants.clipmap_center.x = clipmap_center.x;
+    constants.clipmap_center.y = clipmap_center.y;
+    constants.clipmap_center.z = clipmap_center.z;
+
+    constants.indirectIrradiancePass = static_cast<uint32_t>(pass);
+    constants.indirectIrradianceFrame = frame;
+    constants.indirectIrradiancePeriod = (period > 0U) ? period : 1U;
+    constants.indirectIrradianceBlend = blend;
+    constants.indirectIrradianceScale = scale;
+    constants.indirectIrradianceCompactVoxels = (NULL != m_CompactVoxelOpacityTexture) ? 1U : 0U;
+    constants.voxelRadianceEncoding = static_cast<uint32_t>(m_CompactVoxelRadianceEncoding);
+
+    // the voxel surface texture of the stack level "L" is the Z range [L x BRX_VCT_CLIPMAP_MAP_SIZE, (L + 1) x BRX_VCT_CLIPMAP_MAP_SIZE)
+    if (NULL != voxelBox)
+    {
+        uint32_t const stack_level_z = voxelBox->stack_level * BRX_VCT_CLIPMAP_MAP_SIZE;
+        constants.indirectIrradianceVoxelLowerX = static_cast<uint32_t>(voxelBox->lower[0]);
+        constants.indirectIrradianceVoxelLowerY = static_cast<uint32_t>(voxelBox->lower[1]);
+        constants.indirectIrradianceVoxelLowerZ = stack_level_z + static_cast<uint32_t>(voxelBox->lower[2]);
+        constants.indirectIrradianceVoxelUpperX = static_cast<uint32_t>(voxelBox->upper[0]);
+        constants.indirectIrradianceVoxelUpperY = static_cast<uint32_t>(voxelBox->upper[1]);
+        constants.indirectIrradianceVoxelUpperZ = stack_level_z + static_cast<uint32_t>(voxelBox->upper[2]);
+    }
+    else
+    {
+        constants.indirectIrradianceVoxelLowerX = 0U;
+        constants.indirectIrradianceVoxelLowerY = 0U;
+        constants.indirectIrradianceVoxelLowerZ = 0U;
+        constants.indirectIrradianceVoxelUpperX = BRX_VCT_CLIPMAP_MAP_SIZE;
+        constants.indirectIrradianceVoxelUpperY = BRX_VCT_CLIPMAP_MAP_SIZE;
+        constants.indirectIrradianceVoxelUpperZ = BRX_VCT_CLIPMAP_MAP_SIZE * BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT;
+    }
+
+    m_RendererInterface->writeConstantBuffer(m_pGlobalCBuffer, &constants, sizeof(constants));
+
+    NVRHI::DispatchState state;
+    state.shader = m_pMyIndirectIrradianceCS;
+    NVRHI::BindConstantBuffer(state, 0, m_pGlobalCBuffer);
+    NVRHI::BindTexture(state, SRV_SLOT_INDIRECT_IRRADIANCE_SURFACE, surfaceTexture, false, NVRHI::Format::RG32_UINT, 0U);
+    NVRHI::BindTexture(state, SRV_SLOT_INDIRECT_IRRADIANCE_OPACITY, opacityTexture, false, NVRHI::Format::R32_UINT, 0U);
+    NVRHI::BindTexture(state, UAV_SLOT_INDIRECT_IRRADIANCE, indirectIrradianceTexture, true, NVRHI::Format::RG32_UINT, 0U);
+    NVRHI::BindTexture(state, UAV_SLOT_INDIRECT_IRRADIANCE_EMITTANCE, illuminationTexture, true, NVRHI::Format::R32_UINT, 0U);
+    if (NULL != m_CompactVoxelOpacityTexture)
+    {
+        NVRHI::BindTexture(state, SRV_SLOT_INDIRECT_IRRADIANCE_COMPACT_OPACITY, m_CompactVoxelOpacityTexture, false, NVRHI::Format::R8_UNORM, 0U);
+        NVRHI::BindTexture(state, SRV_SLOT_INDIRECT_IRRADIANCE_COMPACT_RADIANCE, m_CompactVoxelRadianceTexture, false, NVRHI::Format::R32_UINT, 0U);
+    }
+
+    // [numthreads(4, 4, 4)]
+    m_RendererInterface->dispatch(state, (constants.indirectIrradianceVoxelUpperX - constants.indirectIrradianceVoxelLowerX + 3U) / 4U, (constants.indirectIrradianceVoxelUpperY - constants.indirectIrradianceVoxelLowerY + 3U) / 4U, (constants.indirectIrradianceVoxelUpperZ - constants.indirectIrradianceVoxelLowerZ + 3U) / 4U);
+}
+
+NVRHI::TextureDesc SceneRenderer::GetCompactVoxelOpacityTextureDesc()
+{
+    NVRHI::TextureDesc d;
+    d.width = BRX_VCT_CLIPMAP_MAP_SIZE;
+    d.height = BRX_VCT_CLIPMAP_MAP_SIZE;
+    d.depthOrArraySize = BRX_VCT_CLIPMAP_MAP_SIZE * BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT;
+    d.format = NVRHI::Format::R8_UNORM;
+    d.isUAV = true;
+    d.debugName = "CompactVoxelOpacity";
+    return d;
+}
+
+NVRHI::TextureDesc SceneRenderer::GetCompactVoxelRadianceTextureDesc()
+{
+    NVRHI::TextureDesc d;
+    d.width = BRX_VCT_CLIPMAP_MAP_SIZE;
+    d.height = BRX_VCT_CLIPMAP_MAP_SIZE;
+    d.depthOrArraySize = BRX_VCT_CLIPMAP_MAP_SIZE * BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT;
+    d.format = NVRHI::Format::R32_UINT;
+    d.isUAV = true;
+    d.debugName = "CompactVoxelRadiance";
+    return d;
+}
+
+void SceneRenderer::ResolveCompactVoxels(NVRHI::TextureHandle accumulatedOpacityTexture, NVRHI::TextureHandle accumulatedEmittanceTexture, VoxelRadianceEncoding radianceEncoding, NVRHI::TextureHandle opacityTexture, NVRHI::TextureHandle radianceTexture)
+{
+    // the fixed point radiance is the accumulation itself
+    assert(VoxelRadianceEncoding::FIXED_POINT_R32G32B32 != radianceEncoding);
+
+    GlobalConstants constants = {};
+    constants.voxelRadianceEncoding = static_cast<uint32_t>(radianceEncoding);
+    m_RendererInterface->writeConstantBuffer(m_pGlobalCBuffer, &constants, sizeof(constants));
+
+    NVRHI::DispatchState state;
+    state.shader = m_pMyVoxelResolveCS;
+    NVRHI::BindConstantBuffer(state, 0, m_pGlobalCBuffer);
+    NVRHI::BindTexture(state, SRV_SLOT_ACCUMULATED_OPACITY, accumulatedOpacityTexture, false, NVRHI::Format::R32_UINT, 0U);
+    NVRHI::BindTexture(state, SRV_SLOT_ACCUMULATED_EMITTANCE, accumulatedEmittanceTexture, false, NVRHI::Format::R32_UINT, 0U);
+    NVRHI::BindTexture(state, UAV_SLOT_COMPACT_OPACITY, opacityTexture, true, NVRHI::Format::R8_UNORM, 0U);
+    NVRHI::BindTexture(state, UAV_SLOT_COMPACT_RADIANCE, radianceTexture, true, NVRHI::Format::R32_UINT, 0U);
+
+    // [numthreads(4, 4, 4)]
+    m_RendererInterface->dispatch(state, BRX_VCT_CLIPMAP_MAP_SIZE / 4U, BRX_VCT_CLIPMAP_MAP_SIZE / 4U, (BRX_VCT_CLIPMAP_MAP_SIZE * BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT) / 4U);
+}
+
+void SceneRenderer::SetIndirectIrradianceCompactVoxels(NVRHI::TextureHandle opacityTexture, NVRHI::TextureHandle radianceTexture, VoxelRadianceEncoding radianceEncoding)
+{
+    m_CompactVoxelOpacityTexture = opacityTexture;
+    m_CompactVoxelRadianceTexture = radianceTexture;
+    m_CompactVoxelRadianceEncoding = radianceEncoding;
+}
+
+void SceneRenderer::SetDeriveCoarseStackLevels(bool enabled)
+{
+    m_DeriveCoarseStackLevels = enabled;
+}
+
+void SceneRenderer::DeriveCoarseStackLevels(NVRHI::TextureHandle opacityTexture, NVRHI::TextureHandle illuminationTexture)
+{
+    // each stack level is filtered from the derived finer stack level, thus the stack levels are dispatched in order
+    for (uint32_t stack_level = 1; stack_level < BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT; ++stack_level)
+    {
+        GlobalConstants constants = {};
+        constants.deriveStackLevel = stack_level;
+        m_RendererInterface->writeConstantBuffer(m_pGlobalCBuffer, &constants, sizeof(constants));
+
+        NVRHI::DispatchState state;
+        state.shader = m_pMyClipmapDownsampleCS;
+        NVRHI::BindConstantBuffer(state, 0, m_pGlobalCBuffer);
+        NVRHI::BindTexture(state, UAV_SLOT_CLIPMAP_DOWNSAMPLE_OPACITY, opacityTexture, true, NVRHI::Format::R32_UINT, 0U);
+        NVRHI::BindTexture(state, UAV_SLOT_CLIPMAP_DOWNSAMPLE_ILLUMINATION, illuminationTexture, true, NVRHI::Format::R32_UINT, 0U);
+
+        // [numthreads(4, 4, 4)] over the inner half
+        m_RendererInterface->dispatch(state, BRX_VCT_CLIPMAP_MAP_SIZE / 8U, BRX_VCT_CLIPMAP_MAP_SIZE / 8U, BRX_VCT_CLIPMAP_MAP_SIZE / 8U);
+    }
+}
+
+void SceneRenderer::SetVoxelStatisticsEnabled(bool enabled)
+{
+    m_VoxelStatisticsEnabled = enabled;
+}
+
+bool SceneRenderer::IsVoxelStatisticsEnabled() const
+{
+    return m_VoxelStatisticsEnabled;
+}
+
+void SceneRenderer::ClearVoxelStatistics()
+{
+    m_RendererInterface->clearBufferUInt(m_pVoxelStatisticsBuffer, 0U);
+}
+
+void SceneRenderer::CountOccupiedVoxels(NVRHI::TextureHandle opacityTexture)
+{
+    NVRHI::DispatchState state;
+    state.shader = m_pMyVoxelStatisticsCS;
+    NVRHI::BindTexture(state, SRV_SLOT_VOXEL_STATISTICS_OPACITY, opacityTexture, false, NVRHI::Format::R32_UINT, 0U);
+    NVRHI::BindBuffer(state, UAV_SLOT_VOXEL_STATISTICS_COUNTERS, m_pVoxelStatisticsBuffer, true, NVRHI::Format::R32_UINT);
+
+    // [numthreads(4, 4, 4)]
+    m_RendererInterface->dispatch(state, BRX_VCT_CLIPMAP_MAP_SIZE / 4U, BRX_VCT_CLIPMAP_MAP_SIZE / 4U, (BRX_VCT_CLIPMAP_MAP_SIZE * BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT) / 4U);
+}
+
+void SceneRenderer::ReadVoxelStatistics(VoxelFrameStatistics &statistics)
+{
+    uint32_t counters[BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT * VOXEL_STATISTICS_COUNTER_COUNT] = {};
+    size_t counters_size = sizeof(counters);
+    m_RendererInterface->readBuffer(m_pVoxelStatisticsBuffer, counters, &counters_size);
+
+    SetVoxelFrameStatisticsCounters(counters, statistics);
+}
+
+void SceneRenderer::GetCpuVoxelizerMeshes(VoxelizationLayer layer, std::vector<CpuVoxelizerMesh> &meshes) const
+{
+    GetCpuVoxelizerMeshes(m_pScene, layer, meshes);
+}
+
+void SceneRenderer::GetCpuVoxelizerMeshes(Scene const *pScene, VoxelizationLayer layer, std::vector<CpuVoxelizerMesh> &meshes)
+{
+    meshes.clear();
+
+    // the voxelization reads the vertex position buffer without the world matrix, the same as the CPU geometry
+    UINT const numMeshes = pScene->GetMeshesNum();
+    for (UINT i = 0; i < numMeshes; ++i)
+    {
+        if (pScene->IsMeshDynamic(i) != (VoxelizationLayer::DYNAMIC == layer))
+            continue;
+
+        Scene::CpuMeshGeometry geometry;
+        if (!pScene->GetMeshCpuGeometry(i, geometry))
+            continue;
+
+        CpuVoxelizerMesh mesh;
+        mesh.positions = geometry.positions;
+        mesh.vertex_count = geometry.vertex_count;
+        mesh.texcoords = geometry.texcoords;
+        mesh.indices = geometry.indices;
+        mesh.index_count = geometry.index_count;
+        mesh.base_color_texels = geometry.base_color_texels;
+        mesh.base_color_width = geometry.base_color_width;
+        mesh.base_color_height = geometry.base_color_height;
+        mesh.emittance = pScene->GetColor(aiTextureType_EMISSIVE, i);
+        // "Scene::m_SpecularColors": (0, roughness, metallic)
+        VXGI::float3 const roughness_metallic = pScene->GetColor(aiTextureType_SPECULAR, i);
+        mesh.metallic = roughness_metallic.z;
+        mesh.roughness = roughness_metallic.y;
+        meshes.push_back(mesh);
+    }
+}
+
+void SceneRenderer::GetVoxelizationTriangleCounts(DirectX::XMFLOAT3 const &clipmap_anchor, VoxelizationLayer layer, uint32_t triangle_counts[BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT]) const
+{
+    DirectX::XMFLOAT3 const clipmap_center_xm = brx_voxel_cone_tracing_voxelization_compute_clipmap_center(clipmap_anchor);
+    VXGI::float3 const clipmap_center(clipmap_center_xm.x, clipmap_center_xm.y, clipmap_center_xm.z);
+
+    for (uint32_t stack_level = 0U; stack_level < BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT; ++stack_level)
+    {
+        triangle_counts[stack_level] = 0U;
+    }
+
+    UINT const numMeshes = m_pScene->GetMeshesNum();
+    for (UINT i = 0; i < numMeshes; ++i)
+    {
+        if (m_pScene->IsMeshDynamic(i) != (VoxelizationLayer::DYNAMIC == layer))
+            continue;
+
+        for (uint32_t axis = 0U; axis < Scene::DOMINANT_AXIS_COUNT; ++axis)
+        {
+            uint32_t const triangle_count = m_pScene->GetMeshDominantAxisDrawArguments(i, axis).vertexCount / 3U;
+
+            uint32_t first_stack_level;
+            uint32_t stack_level_count;
+            if ((0U == triangle_count) || (!GetClipmapStackLevelRange(m_pScene->GetMeshDominantAxisBounds(i, axis), clipmap_center, first_stack_level, stack_level_count)))
+                continue;
+
+            for (uint32_t stack_level = first_stack_level; stack_level < (first_stack_level + stack_level_count); ++stack_level)
+            {
+                triangle_counts[stack_level] += triangle_count;
+            }
+        }
+    }
+}
+
+void SceneRenderer::SetMeshDynamic(UINT meshID, bool dynamic)
+{
+    m_pScene->SetMeshDynamic(meshID, dynamic);
+}
+
+bool SceneRenderer::HasDynamicMeshes() const
+{
+    return m_pScene->HasDynamicMeshes();
+}
+
+uint64_t SceneRenderer::GetSceneContentHash() const
+{
+    return m_pScene->GetContentHash();
+}
+
+void SceneRenderer::ResetVoxelizationStatistics()
+{
+    m_VoxelizationTrianglesSubmitted = 0U;
+    m_VoxelizationTrianglesSkipped = 0U;
+}
+
+void SceneRenderer::GetVoxelizationStatistics(uint32_t &triangles_submitted, uint32_t &triangles_skipped) const
+{
+    triangles_submitted = m_VoxelizationTrianglesSubmitted;
+    triangles_skipped = m_VoxelizationTrianglesSkipped;
+}
+
 void SceneRenderer::GetMaterialInfo(Scene *pScene, UINT meshID, OUT MeshMaterialInfo &materialInfo)
 {
     materialInfo.normal_texture = pScene->GetTextureSRV(aiTextureType_NORMALS, meshID);
@@ -702,3 +1257,19 @@ VXGI::Frustum SceneRenderer::GetLightFrustum()
 {
     return VXGI::Frustum(m_LightViewProjMatrix);
 }
+
+void SceneRenderer::TrackSceneChanges(SceneChangeTracker &tracker, bool drawTransparent)
+{
+    UINT const numMeshes = m_pScene->GetMeshesNum();
+    for (UINT i = 0; i < numMeshes; ++i)
+    {
+        tracker.SetObject(i, m_pScene->m_WorldMatrix, m_pScene->GetMeshBounds(i), true);
+    }
+
+    if (m_pTransparentScene)
+    {
+        tracker.SetObject(numMeshes, m_pTransparentScene->m_WorldMatrix, m_pTransparentScene->GetSceneBounds(), drawTransparent);
+    }
+
+    tracker.SetLight(m_LightViewProjMatrix, GetLightFrustum());
+}
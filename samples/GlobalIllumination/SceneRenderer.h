@@ -25,6 +25,12 @@
 #pragma warning(disable : 4324)
 
 #include "GlobalConstants.h"
+#include "SceneChangeTracker.h"
+#include "MeshBoundsIndex.h"
+#include "VoxelStatistics.h"
+#include "Clipmap.h"
+#include "CpuVoxelizer.h"
+#include "VoxelEncoding.h"
 
 struct MeshMaterialInfo : public VXGI::MaterialInfo
 {
@@ -41,6 +47,22 @@ struct MeshMaterialInfo : public VXGI::MaterialInfo
 
 typedef std::function<void(const MeshMaterialInfo &)> MaterialCallback;
 
+// The static meshes are voxelized into a persistent layer which is only updated on invalidation.
+// The dynamic meshes are voxelized every frame on top of a copy of the persistent layer.
+enum class VoxelizationLayer
+{
+    STATIC,
+    DYNAMIC
+};
+
+// the passes of UpdateIndirectIrradiance (the same values as "MyIndirectIrradianceCS")
+enum class IndirectIrradiancePass
+{
+    UPDATE,
+    APPLY,
+    APPLY_AND_INVALIDATE
+};
+
 class SceneRenderer
 {
 private:
@@ -58,8 +80,28 @@ private:
     NVRHI::ShaderRef m_pCompositingPS;
     NVRHI::ShaderRef m_pMyVoxelizationPS;
 
+    NVRHI::ShaderRef m_pMyLightInjectionCS;
+    NVRHI::ShaderRef m_pMyShadowMapLightInjectionCS;
+    NVRHI::ShaderRef m_pMyVoxelStatisticsCS;
+    NVRHI::ShaderRef m_pMyIndirectIrradianceCS;
+    NVRHI::ShaderRef m_pMyClipmapDownsampleCS;
+    NVRHI::ShaderRef m_pMyVoxelResolveCS;
+
+    NVRHI::InputLayoutRef m_pMyVoxelizationInputLayout;
+    NVRHI::BufferRef m_pClipmapInstanceBuffer;
+
     NVRHI::ConstantBufferRef m_pGlobalCBuffer;
 
+    // the counters of "VoxelStatistics.h"
+    NVRHI::BufferRef m_pVoxelStatisticsBuffer;
+    bool m_VoxelStatisticsEnabled;
+
+    bool m_DeriveCoarseStackLevels;
+
+    NVRHI::TextureHandle m_CompactVoxelOpacityTexture;
+    NVRHI::TextureHandle m_CompactVoxelRadianceTexture;
+    VoxelRadianceEncoding m_CompactVoxelRadianceEncoding;
+
     NVRHI::SamplerRef m_pDefaultSamplerState;
     NVRHI::SamplerRef m_pComparisonSamplerState;
 
@@ -82,6 +124,19 @@ private:
 
     NVRHI::TextureRef m_NullTexture;
 
+    VoxelizationLayer m_VoxelizationLayer;
+    uint32_t m_VoxelizationStackLevelMask;
+    NVRHI::TextureHandle m_VoxelizationOpacityTexture;
+    NVRHI::TextureHandle m_VoxelizationIlluminationTexture;
+    NVRHI::TextureHandle m_VoxelizationSurfaceTexture;
+
+    uint32_t m_VoxelizationTrianglesSubmitted;
+    uint32_t m_VoxelizationTrianglesSkipped;
+
+    // the meshes of m_pScene overlapping the clipping boxes are queried from the index instead of testing each mesh against each box
+    MeshBoundsIndex m_MeshBoundsIndex;
+    std::vector<uint32_t> m_ClippedMeshes;
+
     VXGI::IUserDefinedShaderSet *m_pVoxelizationGS;
     VXGI::IUserDefinedShaderSet *m_pVoxelizationPS;
     VXGI::IUserDefinedShaderSet *m_pTransparentGeometryPS;
@@ -96,10 +151,13 @@ private:
         MaterialCallback *onChangeMaterial,
         bool voxelization);
 
+    void BindLightInjection(NVRHI::DispatchState &state, DirectX::XMFLOAT3 const &clipmap_anchor, NVRHI::TextureHandle surfaceTexture, NVRHI::TextureHandle scratchOpacityTexture, NVRHI::TextureHandle illuminationTexture);
+
 public:
     SceneRenderer(NVRHI::IRendererInterface *pRenderer);
 
-    HRESULT LoadMesh(const char *strFileName);
+    // the flags are added to "Scene::LOAD_DOMINANT_AXIS_BINNING"
+    HRESULT LoadMesh(const char *strFileName, uint32_t loadFlags = 0U);
     HRESULT LoadTransparentMesh(const char *strFileName);
 
     HRESULT AllocateResources(VXGI::IGlobalIllumination *pGI, VXGI::IShaderCompiler *pCompiler);
@@ -116,6 +174,7 @@ public:
     void RenderTransparentScene(VXGI::IGlobalIllumination *pGI, NVRHI::TextureHandle pDest, const VXGI::float4x4 &viewProjMatrix, VXGI::float3 cameraPos, float transparentRoughness, float transparentReflectance);
 
     void SetLightDirection(VXGI::float3 direction);
+    VXGI::float3 GetLightDirection() const;
     void RenderShadowMap(const VXGI::float3 cameraPosition, float lightSize, bool drawTransparent);
 
     void GetMaterialInfo(Scene *pScene, UINT meshID, OUT MeshMaterialInfo &materialInfo);
@@ -141,7 +200,71 @@ public:
         uint32_t numBoxes,
         DirectX::XMFLOAT3 const &clipmap_anchor,
         const VXGI::float4x4 &viewProjMatrix,
-        MaterialCallback *onChangeMaterial);
+        MaterialCallback *onChangeMaterial,
+        VoxelizationLayer layer,
+        NVRHI::TextureHandle opacityTexture,
+        NVRHI::TextureHandle illuminationTexture,
+        NVRHI::TextureHandle surfaceTexture,
+        uint32_t stackLevelMask);
+
+    // The voxel surface texture (written by RenderForVoxelization when not NULL) keeps the material of each voxel.
+    // The direct lighting is injected into the (cleared) illumination texture from the voxel surface by a compute pass, when only the light changes.
+    // The opacity is written by the same store as the illumination, thus a scratch texture should be passed as the opacity texture.
+    static NVRHI::TextureDesc GetVoxelSurfaceTextureDesc();
+    void InjectVoxelLight(DirectX::XMFLOAT3 const &clipmap_anchor, NVRHI::TextureHandle surfaceTexture, NVRHI::TextureHandle scratchOpacityTexture, NVRHI::TextureHandle illuminationTexture);
+
+    // The same as InjectVoxelLight, but walks the texels of the shadow map (rendered by RenderShadowMap) instead of the voxels.
+    // Only the voxels containing a surface visible from the light are injected, thus the cost scales with the shadow map rather than the clipmap.
+    void InjectShadowMapLight(DirectX::XMFLOAT3 const &clipmap_anchor, NVRHI::TextureHandle surfaceTexture, NVRHI::TextureHandle scratchOpacityTexture, NVRHI::TextureHandle illuminationTexture);
+
+    // The multi-bounce of the clipmap: the indirect irradiance of the voxel surface is gathered by cones through the working clipmap, and kept in the indirect irradiance texture (in the layout of the voxel surface).
+    // UPDATE gathers the irradiance of the voxels of the slice selected by frame (one voxel per period in each 4 x 4 x 4 block, see "MyIndirectIrradianceCS"), and adds the difference to the stored irradiance into the illumination texture.
+    // APPLY adds the stored irradiance into the illumination texture, and should be called whenever the illumination texture is restored from the static layer.
+    // The pass is restricted to the voxels of the box when it is not NULL (e.g. the regions restored from the static layer), otherwise the whole clipmap is dispatched.
+    static NVRHI::TextureDesc GetIndirectIrradianceTextureDesc();
+    void UpdateIndirectIrradiance(DirectX::XMFLOAT3 const &clipmap_anchor, IndirectIrradiancePass pass, NVRHI::TextureHandle surfaceTexture, NVRHI::TextureHandle opacityTexture, NVRHI::TextureHandle illuminationTexture, NVRHI::TextureHandle indirectIrradianceTexture, uint32_t frame, uint32_t period, float blend, float scale, ClipmapVoxelBox const *voxelBox = NULL);
+
+    // Resolves the accumulated voxels (in the layout of "CpuVoxelClipmap") into the compact encodings (see "VoxelEncoding.h"): one texel per voxel, the opacity as UNORM8 and the radiance as RGB9E5 or R11G11B10.
+    // The cones of UpdateIndirectIrradiance trace the compact textures set by SetIndirectIrradianceCompactVoxels instead of the accumulation (NULL traces the accumulation).
+    // The cone tracing of the brx library samples the accumulation in its own layout, thus the accumulation is still kept for it.
+    static NVRHI::TextureDesc GetCompactVoxelOpacityTextureDesc();
+    static NVRHI::TextureDesc GetCompactVoxelRadianceTextureDesc();
+    void ResolveCompactVoxels(NVRHI::TextureHandle accumulatedOpacityTexture, NVRHI::TextureHandle accumulatedEmittanceTexture, VoxelRadianceEncoding radianceEncoding, NVRHI::TextureHandle opacityTexture, NVRHI::TextureHandle radianceTexture);
+    void SetIndirectIrradianceCompactVoxels(NVRHI::TextureHandle opacityTexture, NVRHI::TextureHandle radianceTexture, VoxelRadianceEncoding radianceEncoding);
+
+    // The inner half of each coarser stack level is the region of the finer stack level, which is derived by filtering the finer stack level (see "DeriveCoarseStackLevelsCpu") instead of voxelizing the same triangles again.
+    // While enabled, RenderForVoxelization culls the triangles and discards the fragments of the static layer inside the inner half of the coarser stack levels, and DeriveCoarseStackLevels should be called on the textures once all stack levels are voxelized or injected.
+    // The dynamic layer is still voxelized into all stack levels, since it is written over the restored static layer.
+    void SetDeriveCoarseStackLevels(bool enabled);
+    void DeriveCoarseStackLevels(NVRHI::TextureHandle opacityTexture, NVRHI::TextureHandle illuminationTexture);
+
+    // The per stack level counters of "VoxelStatistics.h": the fragments written and discarded by MyVoxelizationPS are counted while enabled, and the occupied voxels of an opacity texture (in the layout of "CpuVoxelClipmap") are counted by CountOccupiedVoxels.
+    // ReadVoxelStatistics waits for the GPU, thus the statistics are only enabled while recording.
+    void SetVoxelStatisticsEnabled(bool enabled);
+    bool IsVoxelStatisticsEnabled() const;
+    void ClearVoxelStatistics();
+    void CountOccupiedVoxels(NVRHI::TextureHandle opacityTexture);
+    void ReadVoxelStatistics(VoxelFrameStatistics &statistics);
+
+    // The meshes of the layer for "VoxelizeClipmapCpu", empty unless the scene is loaded with "Scene::LOAD_CPU_GEOMETRY".
+    // The emittance is the emissive color of the material, and the meshes point into the scene.
+    void GetCpuVoxelizerMeshes(VoxelizationLayer layer, std::vector<CpuVoxelizerMesh> &meshes) const;
+    // the same for a scene loaded without the renderer (see "Scene::InitResources")
+    static void GetCpuVoxelizerMeshes(Scene const *pScene, VoxelizationLayer layer, std::vector<CpuVoxelizerMesh> &meshes);
+
+    // the triangles of the layer which RenderForVoxelization would draw for each stack level (without clipping boxes)
+    void GetVoxelizationTriangleCounts(DirectX::XMFLOAT3 const &clipmap_anchor, VoxelizationLayer layer, uint32_t triangle_counts[BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT]) const;
+
+    void SetMeshDynamic(UINT meshID, bool dynamic);
+    bool HasDynamicMeshes() const;
+    uint64_t GetSceneContentHash() const;
+
+    // triangles drawn / skipped by the dominant axis ranges since the last reset (once per frame)
+    void ResetVoxelizationStatistics();
+    void GetVoxelizationStatistics(uint32_t &triangles_submitted, uint32_t &triangles_skipped) const;
 
     VXGI::Frustum GetLightFrustum();
+
+    // Sets each mesh of the scene and the transparent scene (visible when drawTransparent) as an object of the tracker, and the light of the last RenderShadowMap.
+    void TrackSceneChanges(SceneChangeTracker &tracker, bool drawTransparent);
 };
\ No newline at end of file
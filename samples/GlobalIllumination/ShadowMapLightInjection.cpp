@@ -0,0 +1,156 @@
+#include "ShadowMapLightInjection.h"
+#include "Clipmap.h"
+#include <cassert>
+#include <algorithm>
+#include <unordered_map>
+
+// the same unpacking as "UnpackVoxelSurface" of "shaders/VoxelLighting.hlsli"
+static void UnpackVoxelSurface(uint32_t const packed_surface[2], VXGI::float3 &diffuse_color, VXGI::float3 &normal)
+{
+    VXGI::float3 const base_color(
+        static_cast<float>(packed_surface[0] & 0xFFU) / 255.0F,
+        static_cast<float>((packed_surface[0] >> 8) & 0xFFU) / 255.0F,
+        static_cast<float>((packed_surface[0] >> 16) & 0xFFU) / 255.0F);
+    float const metallic = static_cast<float>((packed_surface[0] >> 24) & 0x7FU) / 127.0F;
+
+    // the same as "GetDiffuseAndSpecularColor"
+    diffuse_color = VXGI::float3(
+        std::min(std::max(base_color.x - base_color.x * metallic, 0.0F), 1.0F),
+        std::min(std::max(base_color.y - base_color.y * metallic, 0.0F), 1.0F),
+        std::min(std::max(base_color.z - base_color.z * metallic, 0.0F), 1.0F));
+
+    // the same as "OctahedralDecode"
+    float const p_x = static_cast<float>(packed_surface[1] & 0xFFFU) / 4095.0F * 2.0F - 1.0F;
+    float const p_y = static_cast<float>((packed_surface[1] >> 12) & 0xFFFU) / 4095.0F * 2.0F - 1.0F;
+
+    VXGI::float3 n(p_x, p_y, 1.0F - std::abs(p_x) - std::abs(p_y));
+    float const t = std::min(std::max(-n.z, 0.0F), 1.0F);
+    n.x += (n.x >= 0.0F) ? -t : t;
+    n.y += (n.y >= 0.0F) ? -t : t;
+
+    normal = n / std::sqrt(n.x * n.x + n.y * n.y + n.z * n.z);
+}
+
+void InjectShadowMapLightReference(ShadowMapLightInjectionInput const &input, std::vector<ShadowMapLightInjectionVoxel> &voxels)
+{
+    assert(NULL != input.shadow_map_depth);
+
+    voxels.clear();
+
+    VXGI::float4x4 const &m = input.light_view_projection_matrix_inverse;
+
+    float const light_direction_length = std::sqrt(input.light_direction.x * input.light_direction.x + input.light_direction.y * input.light_direction.y + input.light_direction.z * input.light_direction.z);
+    VXGI::float3 const light_direction = input.light_direction / light_direction_length;
+
+    uint64_t const map_size = BRX_VCT_CLIPMAP_MAP_SIZE;
+
+    std::unordered_map<uint64_t, size_t> voxel_indices;
+
+    for (uint32_t texel_y = 0U; texel_y < input.shadow_map_height; ++texel_y)
+    {
+        for (uint32_t texel_x = 0U; texel_x < input.shadow_map_width; ++texel_x)
+        {
+            float const depth = input.shadow_map_depth[static_cast<size_t>(input.shadow_map_width) * texel_y + texel_x];
+
+            if (depth >= 1.0F)
+            {
+                continue;
+            }
+
+            // the center of the texel in NDC
+            float const ndc_x = (static_cast<float>(texel_x) + 0.5F) / static_cast<float>(input.shadow_map_width) * 2.0F - 1.0F;
+            float const ndc_y = 1.0F - (static_cast<float>(texel_y) + 0.5F) / static_cast<float>(input.shadow_map_height) * 2.0F;
+
+            // row vector (the same as "mul(float4, float4x4)" with "row_major")
+            float position[4];
+            for (int column = 0; column < 4; ++column)
+            {
+                position[column] = ndc_x * m.m[column] + ndc_y * m.m[4 + column] + depth * m.m[8 + column] + m.m[12 + column];
+            }
+
+            VXGI::float3 const surface_position(position[0] / position[3], position[1] / position[3], position[2] / position[3]);
+
+            for (uint32_t stack_level = 0U; stack_level < BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT; ++stack_level)
+            {
+                // move half a voxel into the surface, so that the position does not fall into the empty voxel in front of the surface
+                VXGI::float3 const splat_position = surface_position + light_direction * (0.5F * GetClipmapStackLevelVoxelSize(stack_level));
+
+                uint32_t coordinates[3];
+                if (!GetClipmapVoxelSurfaceCoordinates(splat_position, input.clipmap_center, stack_level, coordinates))
+                {
+                    continue;
+                }
+
+                uint64_t const voxel_index = (static_cast<uint64_t>(coordinates[2]) * map_size + coordinates[1]) * map_size + coordinates[0];
+
+                VXGI::float3 diffuse_color;
+                VXGI::float3 normal;
+                if (NULL != input.voxel_surface)
+                {
+                    uint32_t const *packed_surface = input.voxel_surface + 2U * voxel_index;
+
+                    // the voxel surface is not valid when the voxel was not voxelized
+                    if (0U == (packed_surface[0] & (1U << 31)))
+                    {
+                        continue;
+                    }
+
+                    UnpackVoxelSurface(packed_surface, diffuse_color, normal);
+                }
+                else
+                {
+                    diffuse_color = VXGI::float3(1.0F);
+                    normal = light_direction * -1.0F;
+                }
+
+                float const n_dot_l = -(normal.x * light_direction.x + normal.y * light_direction.y + normal.z * light_direction.z);
+
+                if (n_dot_l <= 0.0F)
+                {
+                    continue;
+                }
+
+                auto const found = voxel_indices.find(voxel_index);
+
+                size_t index;
+                if (voxel_indices.end() != found)
+                {
+                    index = found->second;
+                }
+                else
+                {
+                    index = voxels.size();
+                    voxel_indices.emplace(voxel_index, index);
+
+                    ShadowMapLightInjectionVoxel voxel;
+                    voxel.coordinates[0] = coordinates[0];
+                    voxel.coordinates[1] = coordinates[1];
+                    voxel.coordinates[2] = coordinates[2];
+                    voxel.radiance = VXGI::float3(0.0F);
+                    voxel.splat_count = 0U;
+                    voxels.push_back(voxel);
+                }
+
+                voxels[index].radiance = voxels[index].radiance + diffuse_color * input.light_color * n_dot_l;
+                ++voxels[index].splat_count;
+            }
+        }
+    }
+
+    for (ShadowMapLightInjectionVoxel &voxel : voxels)
+    {
+        voxel.radiance = voxel.radiance / static_cast<float>(voxel.splat_count);
+    }
+
+    std::sort(voxels.begin(), voxels.end(), [](ShadowMapLightInjectionVoxel const &a, ShadowMapLightInjectionVoxel const &b) {
+        if (a.coordinates[2] != b.coordinates[2])
+        {
+            return a.coordinates[2] < b.coordinates[2];
+        }
+        if (a.coordinates[1] != b.coordinates[1])
+        {
+            return a.coordinates[1] < b.coordinates[1];
+        }
+        return a.coordinates[0] < b.coordinates[0];
+    });
+}
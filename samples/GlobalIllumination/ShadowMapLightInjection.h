@@ -0,0 +1,42 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include "GFSDK_VXGI_MathTypes.h"
+
+// The CPU reference of "shaders/MyShadowMapLightInjectionCS.hlsl".
+// Each texel of the shadow map is a surface lit by the directional light, so the direct lighting can be injected into the illumination by walking the texels instead of rasterizing the geometry again.
+// The world position of each texel is reconstructed by the inverse of the view projection matrix of the light, and splatted into the voxel of each stack level which contains it.
+
+struct ShadowMapLightInjectionInput
+{
+    // the depth of the shadow map ("width" x "height", row by row)
+    // the texels whose depth is 1 (the clear value) are skipped
+    float const *shadow_map_depth;
+    uint32_t shadow_map_width;
+    uint32_t shadow_map_height;
+
+    VXGI::float4x4 light_view_projection_matrix_inverse;
+    VXGI::float3 light_direction;
+    VXGI::float3 light_color;
+
+    VXGI::float3 clipmap_center;
+
+    // the voxel surface (see "shaders/VoxelLighting.hlsli"), 2 x "uint32_t" per voxel
+    // when NULL, each voxel is treated as a white diffuse surface facing the light
+    uint32_t const *voxel_surface;
+};
+
+struct ShadowMapLightInjectionVoxel
+{
+    // in the layout of the voxel surface texture
+    uint32_t coordinates[3];
+
+    // the average of the reflected diffuse radiance of the texels splatted into the voxel
+    VXGI::float3 radiance;
+
+    uint32_t splat_count;
+};
+
+// the voxels are sorted by the coordinates (Z, Y, X) and only the voxels with at least one splat are returned
+void InjectShadowMapLightReference(ShadowMapLightInjectionInput const &input, std::vector<ShadowMapLightInjectionVoxel> &voxels);
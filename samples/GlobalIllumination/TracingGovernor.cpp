@@ -0,0 +1,337 @@
+#include "TracingGovernor.h"
+#include <cassert>
+#include <algorithm>
+
+// the cost ratio learned from one change is limited, so that a single hitch across a change does not lock out the higher level for good
+static float const TRACING_GOVERNOR_MIN_COST_RATIO = 1.0F;
+static float const TRACING_GOVERNOR_MAX_COST_RATIO = 8.0F;
+
+void GetDefaultTracingGovernorLevels(std::vector<TracingGovernorLevel> &levels)
+{
+    // cone tracing resolution
+    static TracingGovernorLevel const default_levels[] = {
+        {4U},
+        {2U},
+        {1U}};
+
+    levels.assign(default_levels, default_levels + (sizeof(default_levels) / sizeof(default_levels[0])));
+}
+
+TracingGovernor::TracingGovernor() : m_BudgetMs(4.0F), m_UpThreshold(0.75F), m_PanicThreshold(1.5F), m_Smoothing(0.1F), m_DownFrameCount(4U), m_UpFrameCount(30U), m_SettleFrameCount(6U), m_InitialCostRatio(3.0F)
+{
+    std::vector<TracingGovernorLevel> levels;
+    GetDefaultTracingGovernorLevels(levels);
+    SetLevels(levels);
+
+    ResetQueries();
+}
+
+void TracingGovernor::SetLevels(std::vector<TracingGovernorLevel> const &levels)
+{
+    assert(!levels.empty());
+    m_Levels = levels;
+    Reset();
+}
+
+uint32_t TracingGovernor::GetLevelCount() const
+{
+    return static_cast<uint32_t>(m_Levels.size());
+}
+
+void TracingGovernor::SetBudget(float budget_ms)
+{
+    m_BudgetMs = std::max(0.0F, budget_ms);
+}
+
+float *TracingGovernor::GetBudgetPointer()
+{
+    return &m_BudgetMs;
+}
+
+void TracingGovernor::SetUpThreshold(float up_threshold)
+{
+    m_UpThreshold = std::max(0.0F, std::min(1.0F, up_threshold));
+}
+
+float *TracingGovernor::GetUpThresholdPointer()
+{
+    return &m_UpThreshold;
+}
+
+void TracingGovernor::SetPanicThreshold(float panic_threshold)
+{
+    m_PanicThreshold = std::max(1.0F, panic_threshold);
+}
+
+void TracingGovernor::SetSmoothing(float smoothing)
+{
+    m_Smoothing = std::max(0.001F, std::min(1.0F, smoothing));
+}
+
+void TracingGovernor::SetDownFrameCount(uint32_t down_frame_count)
+{
+    m_DownFrameCount = std::max(1U, down_frame_count);
+}
+
+void TracingGovernor::SetUpFrameCount(uint32_t up_frame_count)
+{
+    m_UpFrameCount = std::max(1U, up_frame_count);
+}
+
+uint32_t *TracingGovernor::GetUpFrameCountPointer()
+{
+    return &m_UpFrameCount;
+}
+
+void TracingGovernor::SetSettleFrameCount(uint32_t settle_frame_count)
+{
+    m_SettleFrameCount = settle_frame_count;
+}
+
+void TracingGovernor::SetInitialCostRatio(float initial_cost_ratio)
+{
+    m_InitialCostRatio = std::max(TRACING_GOVERNOR_MIN_COST_RATIO, std::min(TRACING_GOVERNOR_MAX_COST_RATIO, initial_cost_ratio));
+}
+
+void TracingGovernor::Reset()
+{
+    m_Level = static_cast<uint32_t>(m_Levels.size()) - 1U;
+
+    m_CostRatios.assign(m_Levels.size(), m_InitialCostRatio);
+
+    m_SmoothedValid = false;
+    m_SampleCount = 0U;
+    m_SmoothedTimeMs = 0.0;
+    for (uint32_t pass = 0U; pass < TRACING_GOVERNOR_PASS_COUNT; ++pass)
+    {
+        m_SmoothedPassTimesMs[pass] = 0.0;
+    }
+
+    m_OverFrameCount = 0U;
+    m_UnderFrameCount = 0U;
+
+    // the queries of the first frames are not available yet
+    m_SettleFramesLeft = m_SettleFrameCount;
+
+    m_ChangePending = false;
+    m_ChangeFromLevel = m_Level;
+    m_ChangeFromTimeMs = 0.0;
+
+    m_ChangeCount = 0U;
+}
+
+void TracingGovernor::ChangeLevel(uint32_t level)
+{
+    assert(level < m_Levels.size());
+    assert(level != m_Level);
+
+    m_ChangePending = true;
+    m_ChangeFromLevel = m_Level;
+    m_ChangeFromTimeMs = m_SmoothedTimeMs;
+
+    m_Level = level;
+
+    // the average restarts at the new level
+    m_SmoothedValid = false;
+    m_SampleCount = 0U;
+    m_OverFrameCount = 0U;
+    m_UnderFrameCount = 0U;
+    m_SettleFramesLeft = m_SettleFrameCount;
+
+    ++m_ChangeCount;
+}
+
+void TracingGovernor::AddFrame(double const pass_times_ms[TRACING_GOVERNOR_PASS_COUNT])
+{
+    if (m_SettleFramesLeft > 0U)
+    {
+        --m_SettleFramesLeft;
+        return;
+    }
+
+    double time_ms = 0.0;
+    for (uint32_t pass = 0U; pass < TRACING_GOVERNOR_PASS_COUNT; ++pass)
+    {
+        time_ms += pass_times_ms[pass];
+    }
+
+    ++m_SampleCount;
+
+    if (m_SmoothedValid)
+    {
+        m_SmoothedTimeMs += (time_ms - m_SmoothedTimeMs) * m_Smoothing;
+        for (uint32_t pass = 0U; pass < TRACING_GOVERNOR_PASS_COUNT; ++pass)
+        {
+            m_SmoothedPassTimesMs[pass] += (pass_times_ms[pass] - m_SmoothedPassTimesMs[pass]) * m_Smoothing;
+        }
+    }
+    else
+    {
+        m_SmoothedTimeMs = time_ms;
+        for (uint32_t pass = 0U; pass < TRACING_GOVERNOR_PASS_COUNT; ++pass)
+        {
+            m_SmoothedPassTimesMs[pass] = pass_times_ms[pass];
+        }
+        m_SmoothedValid = true;
+    }
+
+    double const budget_ms = static_cast<double>(m_BudgetMs);
+
+    bool const over = (m_SmoothedTimeMs > budget_ms);
+    bool const panic = (time_ms > (budget_ms * m_PanicThreshold)) && (m_SmoothedTimeMs > budget_ms);
+
+    m_OverFrameCount = over ? (m_OverFrameCount + 1U) : 0U;
+
+    double const predicted_up_time_ms = GetPredictedUpTimeMs();
+    bool const under = (predicted_up_time_ms >= 0.0) && (predicted_up_time_ms < (budget_ms * m_UpThreshold));
+
+    m_UnderFrameCount = under ? (m_UnderFrameCount + 1U) : 0U;
+
+    bool const step_down = (m_Level > 0U) && (panic || (m_OverFrameCount >= m_DownFrameCount));
+    bool const step_up = (!step_down) && under && (m_UnderFrameCount >= m_UpFrameCount);
+
+    // the ratio is learned once the average at the new level is stable, or before the next change
+    if (m_ChangePending && (step_down || (m_SampleCount >= m_DownFrameCount)))
+    {
+        m_ChangePending = false;
+
+        uint32_t const lower_level = std::min(m_Level, m_ChangeFromLevel);
+        double const lower_time_ms = (m_Level < m_ChangeFromLevel) ? m_SmoothedTimeMs : m_ChangeFromTimeMs;
+        double const higher_time_ms = (m_Level < m_ChangeFromLevel) ? m_ChangeFromTimeMs : m_SmoothedTimeMs;
+
+        if ((lower_time_ms > 0.0) && (1U == std::max(m_Level, m_ChangeFromLevel) - lower_level))
+        {
+            float const measured_ratio = static_cast<float>(higher_time_ms / lower_time_ms);
+            float const ratio = 0.5F * (m_CostRatios[lower_level] + measured_ratio);
+            m_CostRatios[lower_level] = std::max(TRACING_GOVERNOR_MIN_COST_RATIO, std::min(TRACING_GOVERNOR_MAX_COST_RATIO, ratio));
+        }
+    }
+
+    if (step_down)
+    {
+        ChangeLevel(m_Level - 1U);
+    }
+    else if (step_up)
+    {
+        ChangeLevel(m_Level + 1U);
+    }
+}
+
+uint32_t TracingGovernor::GetLevelIndex() const
+{
+    return m_Level;
+}
+
+TracingGovernorLevel const &TracingGovernor::GetLevel() const
+{
+    return m_Levels[m_Level];
+}
+
+double TracingGovernor::GetSmoothedTimeMs() const
+{
+    return m_SmoothedTimeMs;
+}
+
+double TracingGovernor::GetSmoothedPassTimeMs(uint32_t pass) const
+{
+    assert(pass < TRACING_GOVERNOR_PASS_COUNT);
+    return m_SmoothedPassTimesMs[pass];
+}
+
+double TracingGovernor::GetPredictedUpTimeMs() const
+{
+    if ((m_Level + 1U) >= m_Levels.size())
+    {
+        return -1.0;
+    }
+
+    return m_SmoothedTimeMs * static_cast<double>(m_CostRatios[m_Level]);
+}
+
+uint32_t TracingGovernor::GetChangeCount() const
+{
+    return m_ChangeCount;
+}
+
+void TracingGovernor::BeginFrame(bool enabled, bool measurable, TracingGovernorQueryReader read_query)
+{
+    if (enabled && (!m_Enabled))
+    {
+        Reset();
+    }
+    m_Enabled = enabled;
+    m_Measuring = enabled && measurable;
+
+    if (!m_Measuring)
+    {
+        for (uint32_t slot = 0U; slot < TRACING_GOVERNOR_QUERY_LATENCY; ++slot)
+        {
+            m_QueryFramesIssued[slot] = false;
+        }
+        return;
+    }
+
+    uint32_t const slot = GetQuerySlot();
+
+    if (m_QueryFramesIssued[slot])
+    {
+        // the pass costs nothing in the frames in which nothing is traced
+        double pass_times_ms[TRACING_GOVERNOR_PASS_COUNT];
+        for (uint32_t pass = 0U; pass < TRACING_GOVERNOR_PASS_COUNT; ++pass)
+        {
+            pass_times_ms[pass] = m_QueriesIssued[slot][pass] ? read_query(slot, pass) : 0.0;
+        }
+
+        AddFrame(pass_times_ms);
+    }
+
+    for (uint32_t pass = 0U; pass < TRACING_GOVERNOR_PASS_COUNT; ++pass)
+    {
+        m_QueriesIssued[slot][pass] = false;
+    }
+    m_QueryFramesIssued[slot] = true;
+}
+
+void TracingGovernor::EndFrame()
+{
+    if (m_Measuring)
+    {
+        ++m_QueryFrame;
+    }
+}
+
+bool TracingGovernor::IsMeasuring() const
+{
+    return m_Measuring;
+}
+
+uint32_t TracingGovernor::GetQuerySlot() const
+{
+    return m_QueryFrame % TRACING_GOVERNOR_QUERY_LATENCY;
+}
+
+bool TracingGovernor::BeginPass(uint32_t pass)
+{
+    assert(pass < TRACING_GOVERNOR_PASS_COUNT);
+
+    if (m_Measuring)
+    {
+        m_QueriesIssued[GetQuerySlot()][pass] = true;
+    }
+    return m_Measuring;
+}
+
+void TracingGovernor::ResetQueries()
+{
+    m_Enabled = false;
+    m_Measuring = false;
+    m_QueryFrame = 0U;
+    for (uint32_t slot = 0U; slot < TRACING_GOVERNOR_QUERY_LATENCY; ++slot)
+    {
+        m_QueryFramesIssued[slot] = false;
+        for (uint32_t pass = 0U; pass < TRACING_GOVERNOR_PASS_COUNT; ++pass)
+        {
+            m_QueriesIssued[slot][pass] = false;
+        }
+    }
+}
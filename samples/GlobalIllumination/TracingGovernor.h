@@ -0,0 +1,148 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+// Adjusts the tracing parameters every frame to keep the GPU time of the tracing passes within a budget, since the cost of the cone tracing swings with the content of the view.
+// The parameters are moved along a ladder of levels, from the cheapest to the highest quality, and the level is changed by one step at a time:
+// - down, after the smoothed time is over the budget for several frames (at once, when it is far over the budget);
+// - up, after the predicted time of the next level is under a fraction of the budget for more frames.
+// The measurements right after a change are ignored, since the queries lag behind and the temporal filters settle, and the cost ratio between the neighboring levels is learned from each change, so that a level which was over the budget is not tried again until the content becomes cheaper.
+// The control logic only consumes the pass times, thus it can be driven by synthetic timing traces without a device.
+
+// Only the pass which the level controls is measured: the channel computed by "MyConeTracingCS" (see "g_MyWidth"), whose dispatch is divided by the level.
+// The channels which VXGI traces itself (the diffuse and specular visualization modes) do not depend on the level, thus the governor does not measure them.
+enum TRACING_GOVERNOR_PASS
+{
+    TRACING_GOVERNOR_PASS_CONE_TRACING = 0,
+    TRACING_GOVERNOR_PASS_COUNT = 1
+};
+
+// The times of the passes are read back from the timer queries "TRACING_GOVERNOR_QUERY_LATENCY" frames later, so that the readback does not wait for the GPU.
+// The renderer owns one query per slot and pass, and the governor tracks which of them hold the times of a measured frame (see "BeginFrame").
+static uint32_t const TRACING_GOVERNOR_QUERY_LATENCY = 3U;
+
+// the time of the query of the pass in the slot, in milliseconds
+typedef double (*TracingGovernorQueryReader)(uint32_t slot, uint32_t pass);
+
+// Only the controls which the tracing of the sample honors are in the level: the diffuse parameters of VXGI ("quality", "directionalSamplingRate" and "tracingResolution") are not read by "MyConeTracingCS", which replaces the tracing.
+struct TracingGovernorLevel
+{
+    // the divisor of the width and the height of the "MyConeTracingCS" dispatch (1, 2 or 4), see "g_MyTracingResolution"
+    uint32_t cone_tracing_resolution;
+};
+
+// From the cheapest to the highest quality, each level is not cheaper than the previous one.
+void GetDefaultTracingGovernorLevels(std::vector<TracingGovernorLevel> &levels);
+
+class TracingGovernor
+{
+    std::vector<TracingGovernorLevel> m_Levels;
+
+    float m_BudgetMs;
+    float m_UpThreshold;
+    float m_PanicThreshold;
+    float m_Smoothing;
+    uint32_t m_DownFrameCount;
+    uint32_t m_UpFrameCount;
+    uint32_t m_SettleFrameCount;
+    float m_InitialCostRatio;
+
+    uint32_t m_Level;
+
+    // the cost of the level "i + 1" relative to the level "i"
+    std::vector<float> m_CostRatios;
+
+    bool m_SmoothedValid;
+    uint32_t m_SampleCount;
+    double m_SmoothedTimeMs;
+    double m_SmoothedPassTimesMs[TRACING_GOVERNOR_PASS_COUNT];
+
+    uint32_t m_OverFrameCount;
+    uint32_t m_UnderFrameCount;
+
+    // the frames ignored after a change of the level
+    uint32_t m_SettleFramesLeft;
+
+    // the level and the smoothed time before the last change, to learn the cost ratio once the new level settles
+    bool m_ChangePending;
+    uint32_t m_ChangeFromLevel;
+    double m_ChangeFromTimeMs;
+
+    uint32_t m_ChangeCount;
+
+    // the governor restarts when it is enabled again, and only the frames which are measured change the level
+    bool m_Enabled;
+    bool m_Measuring;
+    uint32_t m_QueryFrame;
+    bool m_QueryFramesIssued[TRACING_GOVERNOR_QUERY_LATENCY];
+    bool m_QueriesIssued[TRACING_GOVERNOR_QUERY_LATENCY][TRACING_GOVERNOR_PASS_COUNT];
+
+    void ChangeLevel(uint32_t level);
+
+public:
+    TracingGovernor();
+
+    // the levels are expected from the cheapest to the highest quality, the governor restarts at the highest level
+    void SetLevels(std::vector<TracingGovernorLevel> const &levels);
+    uint32_t GetLevelCount() const;
+
+    // in milliseconds, the sum of the passes
+    void SetBudget(float budget_ms);
+    float *GetBudgetPointer();
+
+    // a step up is taken only when the predicted time of the next level is under "up_threshold * budget"
+    void SetUpThreshold(float up_threshold);
+    float *GetUpThresholdPointer();
+
+    // a step down is taken at once when the time is over "panic_threshold * budget"
+    void SetPanicThreshold(float panic_threshold);
+
+    // the weight of the new frame in the exponential moving average, in (0, 1]
+    void SetSmoothing(float smoothing);
+
+    // the consecutive frames over (under) the threshold before a step down (up)
+    void SetDownFrameCount(uint32_t down_frame_count);
+    void SetUpFrameCount(uint32_t up_frame_count);
+    uint32_t *GetUpFrameCountPointer();
+
+    // at least the latency of the queries
+    void SetSettleFrameCount(uint32_t settle_frame_count);
+
+    // the cost ratio assumed between the neighboring levels until it is measured, the default levels trace 4 times the pixels of the previous level less the fixed cost of the upsampling
+    void SetInitialCostRatio(float initial_cost_ratio);
+
+    // to the highest level, and forgets the measurements
+    void Reset();
+
+    // the times of the passes of one frame, in milliseconds, and the level is updated for the next frame
+    void AddFrame(double const pass_times_ms[TRACING_GOVERNOR_PASS_COUNT]);
+
+    uint32_t GetLevelIndex() const;
+    TracingGovernorLevel const &GetLevel() const;
+
+    double GetSmoothedTimeMs() const;
+    double GetSmoothedPassTimeMs(uint32_t pass) const;
+
+    // the predicted time of the next higher level, or a negative value at the highest level
+    double GetPredictedUpTimeMs() const;
+
+    uint32_t GetChangeCount() const;
+
+    // Begins a frame, which is measured when the governor is enabled and the passes which it controls are traced in the frame.
+    // While measured, the queries of the frame "TRACING_GOVERNOR_QUERY_LATENCY" frames ago are passed to "AddFrame" before their slot is reused by this frame.
+    // Otherwise the queries issued before are dropped, thus the frames after a pause are not mixed with the frames before it.
+    void BeginFrame(bool enabled, bool measurable, TracingGovernorQueryReader read_query);
+    void EndFrame();
+
+    bool IsMeasuring() const;
+
+    // the slot of the queries of the current frame
+    uint32_t GetQuerySlot() const;
+
+    // whether the query of the pass is to be issued in the slot of the current frame, i.e. whether the frame is measured
+    bool BeginPass(uint32_t pass);
+
+    // drops the queries, e.g. when they are created again with the device
+    void ResetQueries();
+};
@@ -0,0 +1,62 @@
+#include "TracingGovernorTraces.h"
+#include "TracingGovernor.h"
+#include <stdio.h>
+#include <cmath>
+
+bool RunTracingGovernorTraces()
+{
+    // the cost of each default level relative to the full resolution: a quarter of the pixels per step, plus the fixed cost of the upsampling
+    static double const level_costs[] = {0.25, 0.45, 1.0};
+
+    // with the default budget of 4 ms and the up threshold of 0.75
+    static TracingGovernorTracePhase const phases[] = {
+        {"heavy", 1000U, 12.0, 0.0, 0.0, 0.0, 0U, 0U, 3U},
+        {"light", 1000U, 2.5, 0.0, 0.0, 0.0, 0U, 2U, 3U},
+        {"oscillating", 1000U, 6.0, 1.0, 0.05, 0.0, 0U, 1U, 3U},
+        {"spiky", 1000U, 6.0, 0.0, 0.0, 18.0, 97U, 1U, 3U}};
+
+    TracingGovernor governor;
+
+    std::vector<TracingGovernorLevel> levels;
+    GetDefaultTracingGovernorLevels(levels);
+    if (levels.size() != (sizeof(level_costs) / sizeof(level_costs[0])))
+    {
+        printf("Governor traces: the costs do not match the %u default levels\n", static_cast<uint32_t>(levels.size()));
+        return false;
+    }
+
+    // a linear congruential generator, thus the traces are the same on every platform
+    uint32_t random_state = 1U;
+
+    bool passed = true;
+    uint32_t frame = 0U;
+    for (TracingGovernorTracePhase const &phase : phases)
+    {
+        uint32_t const change_count_begin = governor.GetChangeCount();
+
+        for (uint32_t phase_frame = 0U; phase_frame < phase.frame_count; ++phase_frame, ++frame)
+        {
+            double content_ms = phase.base_ms + phase.amplitude_ms * std::sin(static_cast<double>(frame) * phase.frequency);
+            if ((0U != phase.spike_period) && (0U == (frame % phase.spike_period)))
+            {
+                content_ms += phase.spike_ms;
+            }
+
+            // +-5% of noise
+            random_state = random_state * 1664525U + 1013904223U;
+            double const noise = (static_cast<double>(random_state >> 8) / static_cast<double>(1U << 24)) * 0.1 - 0.05;
+
+            double const time_ms = content_ms * level_costs[governor.GetLevelIndex()] * (1.0 + noise);
+            double const pass_times_ms[TRACING_GOVERNOR_PASS_COUNT] = {time_ms};
+            governor.AddFrame(pass_times_ms);
+        }
+
+        uint32_t const change_count = governor.GetChangeCount() - change_count_begin;
+        bool const phase_passed = (governor.GetLevelIndex() == phase.expected_level) && (change_count <= phase.max_change_count);
+        passed = passed && phase_passed;
+
+        printf("Governor traces: %s %s, level %u (expected %u), %u changes (at most %u), smoothed %.2f ms\n", phase.name, phase_passed ? "passed" : "FAILED", governor.GetLevelIndex(), phase.expected_level, change_count, phase.max_change_count, governor.GetSmoothedTimeMs());
+    }
+
+    return passed;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <stdint.h>
+
+// The headless test of "TracingGovernor": the governor is driven by synthetic timing traces, in which the time of the frame is the cost of the content times the relative cost of the level, with a deterministic noise.
+// The phases are heavy content, light content, content oscillating around the budget and spiky content, and each phase checks the level the governor settles on and the count of the changes (no oscillation).
+// Run by "-test-governor", which prints the result of each phase and exits before the device is created.
+
+struct TracingGovernorTracePhase
+{
+    char const *name;
+    uint32_t frame_count;
+
+    // the time of the level "cone tracing resolution 1" (in milliseconds) is "base + amplitude * sin(frame * frequency)", and "spike" is added every "spike_period" frames (0 means never)
+    double base_ms;
+    double amplitude_ms;
+    double frequency;
+    double spike_ms;
+    uint32_t spike_period;
+
+    // the level at the end of the phase
+    uint32_t expected_level;
+
+    uint32_t max_change_count;
+};
+
+// false is returned when any phase fails
+bool RunTracingGovernorTraces();
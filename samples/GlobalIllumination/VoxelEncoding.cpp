@@ -0,0 +1,297 @@
+#include "VoxelEncoding.h"
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+static uint32_t AsUint(float f)
+{
+    uint32_t u;
+    std::memcpy(&u, &f, sizeof(u));
+    return u;
+}
+
+// the floor of log2 of a positive normal float
+static int32_t GetFloatExponent(float f)
+{
+    return static_cast<int32_t>((AsUint(f) >> 23U) & 0xFFU) - 127;
+}
+
+uint32_t GetVoxelOpacityEncodingBytes(VoxelOpacityEncoding encoding)
+{
+    return (VoxelOpacityEncoding::UNORM8 == encoding) ? 1U : 4U;
+}
+
+uint32_t GetVoxelRadianceEncodingBytes(VoxelRadianceEncoding encoding)
+{
+    return (VoxelRadianceEncoding::FIXED_POINT_R32G32B32 == encoding) ? 12U : 4U;
+}
+
+uint32_t PackVoxelOpacityUnorm8(float opacity)
+{
+    return static_cast<uint32_t>(std::floor(std::min(std::max(opacity, 0.0F), 1.0F) * 255.0F + 0.5F));
+}
+
+float UnpackVoxelOpacityUnorm8(uint32_t packed_opacity)
+{
+    return static_cast<float>(packed_opacity & 0xFFU) / 255.0F;
+}
+
+// EXT_texture_shared_exponent
+uint32_t PackVoxelRadianceRGB9E5(VXGI::float3 const &radiance)
+{
+    int32_t const mantissa_bits = 9;
+    int32_t const exponent_bias = 15;
+    float const max_value = (511.0F / 512.0F) * 65536.0F;
+
+    float const rgb[3] = {
+        std::min(std::max(radiance.x, 0.0F), max_value),
+        std::min(std::max(radiance.y, 0.0F), max_value),
+        std::min(std::max(radiance.z, 0.0F), max_value)};
+
+    float const max_channel = std::max(std::max(rgb[0], rgb[1]), rgb[2]);
+    if (!(max_channel > 0.0F))
+    {
+        return 0U;
+    }
+
+    int32_t shared_exponent = std::max(-exponent_bias - 1, GetFloatExponent(max_channel)) + 1 + exponent_bias;
+    if (std::floor(max_channel / std::ldexp(1.0F, shared_exponent - exponent_bias - mantissa_bits) + 0.5F) >= 512.0F)
+    {
+        ++shared_exponent;
+    }
+
+    float const scale = std::ldexp(1.0F, shared_exponent - exponent_bias - mantissa_bits);
+
+    uint32_t packed_radiance = static_cast<uint32_t>(shared_exponent) << 27U;
+    for (uint32_t channel = 0U; channel < 3U; ++channel)
+    {
+        packed_radiance |= std::min(static_cast<uint32_t>(std::floor(rgb[channel] / scale + 0.5F)), 511U) << (9U * channel);
+    }
+    return packed_radiance;
+}
+
+VXGI::float3 UnpackVoxelRadianceRGB9E5(uint32_t packed_radiance)
+{
+    float const scale = std::ldexp(1.0F, static_cast<int32_t>(packed_radiance >> 27U) - 15 - 9);
+
+    return VXGI::float3(
+        static_cast<float>(packed_radiance & 0x1FFU) * scale,
+        static_cast<float>((packed_radiance >> 9U) & 0x1FFU) * scale,
+        static_cast<float>((packed_radiance >> 18U) & 0x1FFU) * scale);
+}
+
+// the unsigned float of "R11G11B10_FLOAT": 5 bits of exponent (bias 15) and "mantissa_bits" of mantissa, rounded to the nearest
+static uint32_t PackUnsignedSmallFloat(float value, uint32_t mantissa_bits)
+{
+    if (!(value > 0.0F))
+    {
+        return 0U;
+    }
+
+    uint32_t const max_packed = (30U << mantissa_bits) | ((1U << mantissa_bits) - 1U);
+
+    int32_t const exponent = GetFloatExponent(value) + 15;
+    if (exponent <= 0)
+    {
+        // denormal
+        return std::min(static_cast<uint32_t>(std::floor(std::ldexp(value, 14 + static_cast<int32_t>(mantissa_bits)) + 0.5F)), max_packed);
+    }
+
+    uint32_t const mantissa = AsUint(value) & 0x7FFFFFU;
+    uint32_t const shift = 23U - mantissa_bits;
+
+    // the carry of the rounding increments the exponent
+    uint32_t const packed = (static_cast<uint32_t>(exponent) << mantissa_bits) + ((mantissa + (1U << (shift - 1U))) >> shift);
+    return std::min(packed, max_packed);
+}
+
+static float UnpackUnsignedSmallFloat(uint32_t packed, uint32_t mantissa_bits)
+{
+    uint32_t const exponent = packed >> mantissa_bits;
+    uint32_t const mantissa = packed & ((1U << mantissa_bits) - 1U);
+
+    if (0U == exponent)
+    {
+        return std::ldexp(static_cast<float>(mantissa), -14 - static_cast<int32_t>(mantissa_bits));
+    }
+
+    return std::ldexp(1.0F + static_cast<float>(mantissa) / static_cast<float>(1U << mantissa_bits), static_cast<int32_t>(exponent) - 15);
+}
+
+uint32_t PackVoxelRadianceR11G11B10(VXGI::float3 const &radiance)
+{
+    return PackUnsignedSmallFloat(radiance.x, 6U) | (PackUnsignedSmallFloat(radiance.y, 6U) << 11U) | (PackUnsignedSmallFloat(radiance.z, 5U) << 22U);
+}
+
+VXGI::float3 UnpackVoxelRadianceR11G11B10(uint32_t packed_radiance)
+{
+    return VXGI::float3(
+        UnpackUnsignedSmallFloat(packed_radiance & 0x7FFU, 6U),
+        UnpackUnsignedSmallFloat((packed_radiance >> 11U) & 0x7FFU, 6U),
+        UnpackUnsignedSmallFloat((packed_radiance >> 22U) & 0x3FFU, 5U));
+}
+
+uint64_t CompactVoxelClipmap::GetBytes() const
+{
+    return static_cast<uint64_t>(opacity.size()) + static_cast<uint64_t>(radiance.size()) * sizeof(uint32_t);
+}
+
+void CompactVoxelClipmap::ReadVoxel(size_t voxel_index, float &voxel_opacity, VXGI::float3 &voxel_radiance) const
+{
+    if (VoxelOpacityEncoding::UNORM8 == opacity_encoding)
+    {
+        voxel_opacity = UnpackVoxelOpacityUnorm8(opacity[voxel_index]);
+    }
+    else
+    {
+        uint32_t packed_opacity;
+        std::memcpy(&packed_opacity, &opacity[4U * voxel_index], sizeof(packed_opacity));
+        voxel_opacity = static_cast<float>(packed_opacity & 0x3FFU) / 1023.0F;
+    }
+
+    switch (radiance_encoding)
+    {
+    case VoxelRadianceEncoding::RGB9E5:
+        voxel_radiance = UnpackVoxelRadianceRGB9E5(radiance[voxel_index]);
+        break;
+    case VoxelRadianceEncoding::R11G11B10:
+        voxel_radiance = UnpackVoxelRadianceR11G11B10(radiance[voxel_index]);
+        break;
+    default:
+    {
+        float const emittance_scale = 1.0F / static_cast<float>(1U << 20);
+        voxel_radiance = VXGI::float3(
+            static_cast<float>(radiance[3U * voxel_index + 0U]) * emittance_scale,
+            static_cast<float>(radiance[3U * voxel_index + 1U]) * emittance_scale,
+            static_cast<float>(radiance[3U * voxel_index + 2U]) * emittance_scale);
+    }
+    }
+}
+
+void ResolveCompactVoxelClipmapCpu(CpuVoxelClipmap const &clipmap, VoxelOpacityEncoding opacity_encoding, VoxelRadianceEncoding radiance_encoding, uint32_t thread_count, CompactVoxelClipmap &compact_clipmap)
+{
+    compact_clipmap.opacity_encoding = opacity_encoding;
+    compact_clipmap.radiance_encoding = radiance_encoding;
+    std::copy(clipmap.extent, clipmap.extent + 3, compact_clipmap.extent);
+
+    size_t const slice_voxel_count = static_cast<size_t>(clipmap.extent[0]) * clipmap.extent[1];
+    size_t const voxel_count = slice_voxel_count * clipmap.extent[2];
+
+    uint32_t const opacity_bytes = GetVoxelOpacityEncodingBytes(opacity_encoding);
+    uint32_t const radiance_words = GetVoxelRadianceEncodingBytes(radiance_encoding) / 4U;
+
+    compact_clipmap.opacity.assign(voxel_count * opacity_bytes, 0U);
+    compact_clipmap.radiance.assign(voxel_count * radiance_words, 0U);
+
+    if (0U == thread_count)
+    {
+        thread_count = std::max(1U, static_cast<uint32_t>(std::thread::hardware_concurrency()));
+    }
+
+    std::atomic<uint32_t> next_z(0U);
+
+    auto worker = [&]() {
+        float const emittance_scale = 1.0F / static_cast<float>(1U << 20);
+
+        uint32_t z;
+        while ((z = next_z.fetch_add(1U)) < clipmap.extent[2])
+        {
+            for (size_t voxel_index = z * slice_voxel_count; voxel_index < ((z + 1U) * slice_voxel_count); ++voxel_index)
+            {
+                uint32_t const packed_opacity = GetCpuVoxelOpacity(clipmap, voxel_index);
+                if (VoxelOpacityEncoding::UNORM8 == opacity_encoding)
+                {
+                    compact_clipmap.opacity[voxel_index] = static_cast<uint8_t>(PackVoxelOpacityUnorm8(static_cast<float>(packed_opacity & 0x3FFU) / 1023.0F));
+                }
+                else
+                {
+                    std::memcpy(&compact_clipmap.opacity[4U * voxel_index], &packed_opacity, sizeof(uint32_t));
+                }
+
+                uint32_t packed_emittance[3];
+                GetCpuVoxelEmittance(clipmap, voxel_index, packed_emittance);
+                VXGI::float3 const radiance(static_cast<float>(packed_emittance[0]) * emittance_scale, static_cast<float>(packed_emittance[1]) * emittance_scale, static_cast<float>(packed_emittance[2]) * emittance_scale);
+
+                switch (radiance_encoding)
+                {
+                case VoxelRadianceEncoding::RGB9E5:
+                    compact_clipmap.radiance[voxel_index] = PackVoxelRadianceRGB9E5(radiance);
+                    break;
+                case VoxelRadianceEncoding::R11G11B10:
+                    compact_clipmap.radiance[voxel_index] = PackVoxelRadianceR11G11B10(radiance);
+                    break;
+                default:
+                    std::copy(packed_emittance, packed_emittance + 3, &compact_clipmap.radiance[3U * voxel_index]);
+                }
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (uint32_t thread_index = 1U; thread_index < thread_count; ++thread_index)
+    {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+}
+
+void MeasureVoxelEncodingError(CpuVoxelClipmap const &clipmap, CompactVoxelClipmap const &compact_clipmap, VoxelEncodingErrorStatistics &statistics)
+{
+    statistics.occupied_voxel_count = 0U;
+    statistics.max_opacity_error = 0.0F;
+    statistics.max_radiance_relative_error = 0.0F;
+
+    double opacity_error_sum = 0.0;
+    double radiance_error_sum = 0.0;
+
+    float const emittance_scale = 1.0F / static_cast<float>(1U << 20);
+
+    size_t const voxel_count = GetCpuVoxelCount(clipmap);
+    for (size_t voxel_index = 0U; voxel_index < voxel_count; ++voxel_index)
+    {
+        uint32_t const packed_opacity = GetCpuVoxelOpacity(clipmap, voxel_index);
+        uint32_t packed_emittance[3];
+        GetCpuVoxelEmittance(clipmap, voxel_index, packed_emittance);
+        if ((0U == packed_opacity) && (0U == packed_emittance[0]) && (0U == packed_emittance[1]) && (0U == packed_emittance[2]))
+        {
+            continue;
+        }
+
+        ++statistics.occupied_voxel_count;
+
+        float opacity;
+        VXGI::float3 radiance;
+        compact_clipmap.ReadVoxel(voxel_index, opacity, radiance);
+
+        float const opacity_error = std::abs(opacity - static_cast<float>(packed_opacity & 0x3FFU) / 1023.0F);
+        statistics.max_opacity_error = std::max(statistics.max_opacity_error, opacity_error);
+        opacity_error_sum += static_cast<double>(opacity_error) * opacity_error;
+
+        float const reference[3] = {static_cast<float>(packed_emittance[0]) * emittance_scale, static_cast<float>(packed_emittance[1]) * emittance_scale, static_cast<float>(packed_emittance[2]) * emittance_scale};
+        float const encoded[3] = {radiance.x, radiance.y, radiance.z};
+
+        float const max_channel = std::max(std::max(reference[0], reference[1]), reference[2]);
+        if (max_channel > 0.0F)
+        {
+            for (uint32_t channel = 0U; channel < 3U; ++channel)
+            {
+                float const radiance_error = std::abs(encoded[channel] - reference[channel]) / max_channel;
+                statistics.max_radiance_relative_error = std::max(statistics.max_radiance_relative_error, radiance_error);
+                radiance_error_sum += static_cast<double>(radiance_error) * radiance_error;
+            }
+        }
+    }
+
+    statistics.opacity_rmse = (statistics.occupied_voxel_count > 0U) ? std::sqrt(opacity_error_sum / static_cast<double>(statistics.occupied_voxel_count)) : 0.0;
+    statistics.radiance_relative_rmse = (statistics.occupied_voxel_count > 0U) ? std::sqrt(radiance_error_sum / (3.0 * static_cast<double>(statistics.occupied_voxel_count))) : 0.0;
+
+    statistics.accumulation_bytes = static_cast<uint64_t>(clipmap.opacity.size() + clipmap.emittance.size()) * sizeof(uint32_t);
+    statistics.compact_bytes = compact_clipmap.GetBytes();
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include "CpuVoxelizer.h"
+
+// The compact encodings of the voxels, which are selected per clipmap.
+// The voxelization still accumulates into the 32-bit words of "CpuVoxelClipmap" (the atomic max of the opacity and the atomic add of the fixed point emittance), since the compact encodings can not be accumulated by atomics.
+// The accumulated voxels are then resolved into the compact clipmap ("ResolveCompactVoxelClipmapCpu" or "MyVoxelResolveCS"), which is traced by the multi-bounce (see "SceneRenderer::ResolveCompactVoxels").
+// The packing is exactly the same as "shaders/VoxelEncoding.hlsli", and the error of the encodings is measured by "MeasureVoxelEncodingError" on both resolves.
+// The clipmap textures of the GPU still keep the accumulation, since the cone tracing of the brx library samples them in its own layout.
+
+enum class VoxelOpacityEncoding
+{
+    // 4 bytes, the same as the accumulation
+    UNORM10_R32,
+    // 1 byte
+    UNORM8
+};
+
+enum class VoxelRadianceEncoding
+{
+    // 12 bytes, the same as the accumulation
+    FIXED_POINT_R32G32B32,
+    // 4 bytes, 9 bits of mantissa per channel and the shared exponent
+    RGB9E5,
+    // 4 bytes, 6 / 6 / 5 bits of mantissa and 5 bits of exponent per channel
+    R11G11B10
+};
+
+uint32_t GetVoxelOpacityEncodingBytes(VoxelOpacityEncoding encoding);
+uint32_t GetVoxelRadianceEncodingBytes(VoxelRadianceEncoding encoding);
+
+uint32_t PackVoxelOpacityUnorm8(float opacity);
+float UnpackVoxelOpacityUnorm8(uint32_t packed_opacity);
+
+uint32_t PackVoxelRadianceRGB9E5(VXGI::float3 const &radiance);
+VXGI::float3 UnpackVoxelRadianceRGB9E5(uint32_t packed_radiance);
+
+uint32_t PackVoxelRadianceR11G11B10(VXGI::float3 const &radiance);
+VXGI::float3 UnpackVoxelRadianceR11G11B10(uint32_t packed_radiance);
+
+struct CompactVoxelClipmap
+{
+    VoxelOpacityEncoding opacity_encoding;
+    VoxelRadianceEncoding radiance_encoding;
+
+    uint32_t extent[3];
+
+    // "GetVoxelOpacityEncodingBytes" per voxel
+    std::vector<uint8_t> opacity;
+
+    // "GetVoxelRadianceEncodingBytes / 4" x "uint32_t" per voxel
+    std::vector<uint32_t> radiance;
+
+    uint64_t GetBytes() const;
+
+    // the opacity in [0, 1] and the radiance (the unpacked emittance)
+    void ReadVoxel(size_t voxel_index, float &opacity, VXGI::float3 &radiance) const;
+};
+
+struct VoxelEncodingErrorStatistics
+{
+    // the voxels whose opacity or emittance is not zero
+    uint64_t occupied_voxel_count;
+
+    float max_opacity_error;
+    double opacity_rmse;
+
+    // relative to the max channel of the radiance of the voxel
+    float max_radiance_relative_error;
+    double radiance_relative_rmse;
+
+    uint64_t accumulation_bytes;
+    uint64_t compact_bytes;
+};
+
+// the resolve of the accumulated voxels, multithreaded over the Z slices (0 means one thread per hardware thread)
+void ResolveCompactVoxelClipmapCpu(CpuVoxelClipmap const &clipmap, VoxelOpacityEncoding opacity_encoding, VoxelRadianceEncoding radiance_encoding, uint32_t thread_count, CompactVoxelClipmap &compact_clipmap);
+
+// the error of the compact clipmap against the accumulation it is resolved from
+void MeasureVoxelEncodingError(CpuVoxelClipmap const &clipmap, CompactVoxelClipmap const &compact_clipmap, VoxelEncodingErrorStatistics &statistics);
@@ -0,0 +1,293 @@
+#include "VoxelStatistics.h"
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <algorithm>
+
+void ResetVoxelFrameStatistics(uint64_t frame_index, VoxelFrameStatistics &statistics)
+{
+    statistics.frame_index = frame_index;
+
+    for (uint32_t stack_level = 0U; stack_level < BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT; ++stack_level)
+    {
+        VoxelStackLevelStatistics &stack_level_statistics = statistics.stack_levels[stack_level];
+        stack_level_statistics.occupied_voxel_count = 0U;
+        stack_level_statistics.written_voxel_count = 0U;
+        stack_level_statistics.discarded_fragment_count = 0U;
+        stack_level_statistics.invalidated_volume = 0.0;
+        stack_level_statistics.invalidated_voxel_count = 0U;
+        stack_level_statistics.touched_bytes = 0U;
+    }
+}
+
+void SetVoxelFrameStatisticsCounters(uint32_t const counters[BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT * VOXEL_STATISTICS_COUNTER_COUNT], VoxelFrameStatistics &statistics)
+{
+    for (uint32_t stack_level = 0U; stack_level < BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT; ++stack_level)
+    {
+        uint32_t const *const stack_level_counters = counters + VOXEL_STATISTICS_COUNTER_COUNT * stack_level;
+
+        VoxelStackLevelStatistics &stack_level_statistics = statistics.stack_levels[stack_level];
+        stack_level_statistics.written_voxel_count = stack_level_counters[VOXEL_STATISTICS_COUNTER_WRITTEN_FRAGMENTS];
+        stack_level_statistics.discarded_fragment_count = stack_level_counters[VOXEL_STATISTICS_COUNTER_DISCARDED_FRAGMENTS];
+        stack_level_statistics.occupied_voxel_count = stack_level_counters[VOXEL_STATISTICS_COUNTER_OCCUPIED_VOXELS];
+    }
+}
+
+void SetVoxelFrameStatisticsCpu(CpuVoxelizerStatistics const &voxelizer_statistics, VoxelFrameStatistics &statistics)
+{
+    for (uint32_t stack_level = 0U; stack_level < BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT; ++stack_level)
+    {
+        VoxelStackLevelStatistics &stack_level_statistics = statistics.stack_levels[stack_level];
+        stack_level_statistics.written_voxel_count = voxelizer_statistics.stack_level_voxel_write_counts[stack_level];
+        stack_level_statistics.discarded_fragment_count = voxelizer_statistics.stack_level_discarded_fragment_counts[stack_level];
+        stack_level_statistics.occupied_voxel_count = voxelizer_statistics.stack_level_occupied_voxel_counts[stack_level];
+    }
+}
+
+void AddVoxelFrameStatisticsInvalidatedRegions(VXGI::float3 const &clipmap_center, VXGI::Box3f const *regions, uint32_t region_count, VoxelFrameStatistics &statistics)
+{
+    for (uint32_t stack_level = 0U; stack_level < BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT; ++stack_level)
+    {
+        VXGI::Box3f const bounds = GetClipmapStackLevelBounds(clipmap_center, stack_level);
+        float const voxel_size = GetClipmapStackLevelVoxelSize(stack_level);
+
+        VoxelStackLevelStatistics &stack_level_statistics = statistics.stack_levels[stack_level];
+
+        for (uint32_t region_index = 0U; region_index < region_count; ++region_index)
+        {
+            VXGI::Box3f const &region = regions[region_index];
+
+            double volume = 1.0;
+            uint64_t voxel_count = 1U;
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                float const lower = std::max((&region.lower.x)[axis], (&bounds.lower.x)[axis]);
+                float const upper = std::min((&region.upper.x)[axis], (&bounds.upper.x)[axis]);
+
+                if (upper <= lower)
+                {
+                    volume = 0.0;
+                    voxel_count = 0U;
+                    break;
+                }
+
+                volume *= static_cast<double>(upper - lower);
+
+                // the voxels partially inside the region are invalidated as well
+                float const voxel_lower = std::floor((lower - (&bounds.lower.x)[axis]) / voxel_size);
+                float const voxel_upper = std::ceil((upper - (&bounds.lower.x)[axis]) / voxel_size);
+                voxel_count *= static_cast<uint64_t>(std::max(0.0F, voxel_upper - voxel_lower));
+            }
+
+            stack_level_statistics.invalidated_volume += volume;
+            stack_level_statistics.invalidated_voxel_count += voxel_count;
+        }
+    }
+}
+
+void AddVoxelFrameStatisticsInvalidatedStackLevels(uint32_t stack_level_mask, VoxelFrameStatistics &statistics)
+{
+    for (uint32_t stack_level = 0U; stack_level < BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT; ++stack_level)
+    {
+        if (0U == (stack_level_mask & (1U << stack_level)))
+        {
+            continue;
+        }
+
+        double const extent = static_cast<double>(BRX_VCT_CLIPMAP_MAP_SIZE) * static_cast<double>(GetClipmapStackLevelVoxelSize(stack_level));
+
+        VoxelStackLevelStatistics &stack_level_statistics = statistics.stack_levels[stack_level];
+        stack_level_statistics.invalidated_volume += extent * extent * extent;
+        stack_level_statistics.invalidated_voxel_count += static_cast<uint64_t>(BRX_VCT_CLIPMAP_MAP_SIZE) * BRX_VCT_CLIPMAP_MAP_SIZE * BRX_VCT_CLIPMAP_MAP_SIZE;
+    }
+}
+
+void UpdateVoxelFrameStatisticsTouchedBytes(VoxelFrameStatistics &statistics)
+{
+    for (uint32_t stack_level = 0U; stack_level < BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT; ++stack_level)
+    {
+        VoxelStackLevelStatistics &stack_level_statistics = statistics.stack_levels[stack_level];
+        stack_level_statistics.touched_bytes = (stack_level_statistics.written_voxel_count + stack_level_statistics.invalidated_voxel_count) * VOXEL_STATISTICS_BYTES_PER_VOXEL;
+    }
+}
+
+VoxelStatisticsRecorder::VoxelStatisticsRecorder() : m_MaxFrameCount(0U), m_Enabled(false), m_ExportPending(false), m_FrameIndex(0U)
+{
+    ResetVoxelFrameStatistics(m_FrameIndex, m_CurrentFrame);
+}
+
+void VoxelStatisticsRecorder::SetMaxFrameCount(uint32_t max_frame_count)
+{
+    m_MaxFrameCount = max_frame_count;
+
+    while ((0U != m_MaxFrameCount) && (m_Frames.size() > m_MaxFrameCount))
+    {
+        m_Frames.pop_front();
+    }
+}
+
+uint32_t *VoxelStatisticsRecorder::GetMaxFrameCountPointer()
+{
+    return &m_MaxFrameCount;
+}
+
+bool VoxelStatisticsRecorder::IsEnabled() const
+{
+    return m_Enabled;
+}
+
+bool *VoxelStatisticsRecorder::GetEnabledPointer()
+{
+    return &m_Enabled;
+}
+
+void VoxelStatisticsRecorder::Reset()
+{
+    m_Frames.clear();
+}
+
+void VoxelStatisticsRecorder::AddFrame(VoxelFrameStatistics const &statistics)
+{
+    m_Frames.push_back(statistics);
+
+    // the count may be lowered through "GetMaxFrameCountPointer"
+    while ((0U != m_MaxFrameCount) && (m_Frames.size() > m_MaxFrameCount))
+    {
+        m_Frames.pop_front();
+    }
+}
+
+void VoxelStatisticsRecorder::BeginFrame()
+{
+    ResetVoxelFrameStatistics(m_FrameIndex++, m_CurrentFrame);
+}
+
+VoxelFrameStatistics &VoxelStatisticsRecorder::GetCurrentFrame()
+{
+    return m_CurrentFrame;
+}
+
+void VoxelStatisticsRecorder::EndFrame()
+{
+    if (m_Enabled)
+    {
+        UpdateVoxelFrameStatisticsTouchedBytes(m_CurrentFrame);
+        AddFrame(m_CurrentFrame);
+    }
+}
+
+void VoxelStatisticsRecorder::RequestExport()
+{
+    m_ExportPending = true;
+}
+
+bool VoxelStatisticsRecorder::IsExportPending() const
+{
+    return m_ExportPending;
+}
+
+bool VoxelStatisticsRecorder::Export(char const *csv_path, char const *json_path, float finest_voxel_size)
+{
+    m_ExportPending = false;
+
+    bool const csv_result = WriteCsv(csv_path, finest_voxel_size);
+    bool const json_result = WriteJson(json_path, finest_voxel_size);
+    return csv_result && json_result;
+}
+
+uint32_t VoxelStatisticsRecorder::GetFrameCount() const
+{
+    return static_cast<uint32_t>(m_Frames.size());
+}
+
+VoxelFrameStatistics const &VoxelStatisticsRecorder::GetFrame(uint32_t frame) const
+{
+    assert(frame < m_Frames.size());
+    return m_Frames[frame];
+}
+
+bool VoxelStatisticsRecorder::WriteCsv(char const *path, float finest_voxel_size) const
+{
+    FILE *file = fopen(path, "w");
+    if (NULL == file)
+    {
+        return false;
+    }
+
+    bool result = (0 <= fprintf(file, "frame,stack_level,voxel_size,occupied_voxels,written_voxels,discarded_fragments,invalidated_volume,invalidated_voxels,touched_bytes\n"));
+
+    for (VoxelFrameStatistics const &frame : m_Frames)
+    {
+        for (uint32_t stack_level = 0U; stack_level < BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT; ++stack_level)
+        {
+            VoxelStackLevelStatistics const &stack_level_statistics = frame.stack_levels[stack_level];
+
+            result = result && (0 <= fprintf(
+                                         file,
+                                         "%llu,%u,%g,%llu,%llu,%llu,%.17g,%llu,%llu\n",
+                                         static_cast<unsigned long long>(frame.frame_index),
+                                         stack_level,
+                                         finest_voxel_size * static_cast<float>(1U << stack_level),
+                                         static_cast<unsigned long long>(stack_level_statistics.occupied_voxel_count),
+                                         static_cast<unsigned long long>(stack_level_statistics.written_voxel_count),
+                                         static_cast<unsigned long long>(stack_level_statistics.discarded_fragment_count),
+                                         stack_level_statistics.invalidated_volume,
+                                         static_cast<unsigned long long>(stack_level_statistics.invalidated_voxel_count),
+                                         static_cast<unsigned long long>(stack_level_statistics.touched_bytes)));
+        }
+    }
+
+    result = (0 == fclose(file)) && result;
+
+    if (!result)
+    {
+        remove(path);
+    }
+
+    return result;
+}
+
+bool VoxelStatisticsRecorder::WriteJson(char const *path, float finest_voxel_size) const
+{
+    FILE *file = fopen(path, "w");
+    if (NULL == file)
+    {
+        return false;
+    }
+
+    bool result = (0 <= fprintf(file, "{\n  \"mapSize\": %u,\n  \"stackLevelCount\": %u,\n  \"finestVoxelSize\": %g,\n  \"frames\": [", BRX_VCT_CLIPMAP_MAP_SIZE, BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT, finest_voxel_size));
+
+    for (size_t frame = 0U; frame < m_Frames.size(); ++frame)
+    {
+        result = result && (0 <= fprintf(file, "%s\n    { \"frame\": %llu, \"stackLevels\": [", (0U != frame) ? "," : "", static_cast<unsigned long long>(m_Frames[frame].frame_index)));
+
+        for (uint32_t stack_level = 0U; stack_level < BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT; ++stack_level)
+        {
+            VoxelStackLevelStatistics const &stack_level_statistics = m_Frames[frame].stack_levels[stack_level];
+
+            result = result && (0 <= fprintf(
+                                         file,
+                                         "%s\n      { \"occupiedVoxels\": %llu, \"writtenVoxels\": %llu, \"discardedFragments\": %llu, \"invalidatedVolume\": %.17g, \"invalidatedVoxels\": %llu, \"touchedBytes\": %llu }",
+                                         (0U != stack_level) ? "," : "",
+                                         static_cast<unsigned long long>(stack_level_statistics.occupied_voxel_count),
+                                         static_cast<unsigned long long>(stack_level_statistics.written_voxel_count),
+                                         static_cast<unsigned long long>(stack_level_statistics.discarded_fragment_count),
+                                         stack_level_statistics.invalidated_volume,
+                                         static_cast<unsigned long long>(stack_level_statistics.invalidated_voxel_count),
+                                         static_cast<unsigned long long>(stack_level_statistics.touched_bytes)));
+        }
+
+        result = result && (0 <= fprintf(file, " ] }"));
+    }
+
+    result = result && (0 <= fprintf(file, "\n  ]\n}\n"));
+
+    result = (0 == fclose(file)) && result;
+
+    if (!result)
+    {
+        remove(path);
+    }
+
+    return result;
+}
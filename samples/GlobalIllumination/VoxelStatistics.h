@@ -0,0 +1,108 @@
+#pragma once
+
+#include <stdint.h>
+#include <deque>
+#include "Clipmap.h"
+#include "CpuVoxelizer.h"
+
+// The occupancy and the update cost of the clipmap, per stack level and per frame.
+// The counts are read back from the counters of "MyVoxelizationPS" and "MyVoxelStatisticsCS" (see "SceneRenderer::ReadVoxelStatistics"), or taken from "CpuVoxelizerStatistics" of the CPU reference voxelizer.
+// The frames are recorded by "VoxelStatisticsRecorder" and exported as CSV or JSON to compare the voxelization strategies offline.
+
+// The layout of the counters buffer: "VOXEL_STATISTICS_COUNTER_COUNT" x "uint32_t" per stack level.
+static uint32_t const VOXEL_STATISTICS_COUNTER_WRITTEN_FRAGMENTS = 0U;
+static uint32_t const VOXEL_STATISTICS_COUNTER_DISCARDED_FRAGMENTS = 1U;
+static uint32_t const VOXEL_STATISTICS_COUNTER_OCCUPIED_VOXELS = 2U;
+static uint32_t const VOXEL_STATISTICS_COUNTER_COUNT = 3U;
+
+// The opacity (4 bytes) and the emittance (3 x 4 bytes) of "CpuVoxelClipmap", which are read-modify-written by the atomics of each write and written by the clear of each invalidated voxel.
+static uint32_t const VOXEL_STATISTICS_BYTES_PER_VOXEL = 16U;
+
+struct VoxelStackLevelStatistics
+{
+    // the voxels of which the opacity is not zero after the frame
+    uint64_t occupied_voxel_count;
+
+    // the fragments stored by the voxelization (the (triangle, voxel) pairs of "VoxelizeClipmapCpu")
+    uint64_t written_voxel_count;
+
+    // the fragments discarded by "opacity < 0.5"
+    uint64_t discarded_fragment_count;
+
+    // the invalidated regions clipped to the stack level, in world units cubed
+    double invalidated_volume;
+
+    // the voxels of the stack level which overlap the invalidated regions
+    uint64_t invalidated_voxel_count;
+
+    // the estimated bytes of the clipmap memory touched by the writes and the clears
+    uint64_t touched_bytes;
+};
+
+struct VoxelFrameStatistics
+{
+    uint64_t frame_index;
+    VoxelStackLevelStatistics stack_levels[BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT];
+};
+
+void ResetVoxelFrameStatistics(uint64_t frame_index, VoxelFrameStatistics &statistics);
+
+// the counters of the GPU in the layout above
+void SetVoxelFrameStatisticsCounters(uint32_t const counters[BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT * VOXEL_STATISTICS_COUNTER_COUNT], VoxelFrameStatistics &statistics);
+
+void SetVoxelFrameStatisticsCpu(CpuVoxelizerStatistics const &voxelizer_statistics, VoxelFrameStatistics &statistics);
+
+// the regions are expected not to overlap (see "SceneChangeTracker")
+void AddVoxelFrameStatisticsInvalidatedRegions(VXGI::float3 const &clipmap_center, VXGI::Box3f const *regions, uint32_t region_count, VoxelFrameStatistics &statistics);
+
+// the whole stack levels of the mask are cleared and voxelized again (the clipmap moved or the light changed)
+void AddVoxelFrameStatisticsInvalidatedStackLevels(uint32_t stack_level_mask, VoxelFrameStatistics &statistics);
+
+// the touched bytes are derived from the written and the invalidated voxels, after both are set
+void UpdateVoxelFrameStatisticsTouchedBytes(VoxelFrameStatistics &statistics);
+
+class VoxelStatisticsRecorder
+{
+    uint32_t m_MaxFrameCount;
+
+    std::deque<VoxelFrameStatistics> m_Frames;
+
+    // the frames are only recorded while enabled, since the readback of the counters waits for the GPU
+    bool m_Enabled;
+    bool m_ExportPending;
+    uint64_t m_FrameIndex;
+    VoxelFrameStatistics m_CurrentFrame;
+
+public:
+    VoxelStatisticsRecorder();
+
+    // the oldest frames are dropped when the count is exceeded, 0 means unlimited
+    void SetMaxFrameCount(uint32_t max_frame_count);
+    uint32_t *GetMaxFrameCountPointer();
+
+    bool IsEnabled() const;
+    bool *GetEnabledPointer();
+
+    // the statistics of the current frame are reset by "BeginFrame", and added by "EndFrame" while enabled
+    void BeginFrame();
+    VoxelFrameStatistics &GetCurrentFrame();
+    void EndFrame();
+
+    // the frames are exported at the end of the next frame
+    void RequestExport();
+    bool IsExportPending() const;
+    bool Export(char const *csv_path, char const *json_path, float finest_voxel_size);
+
+    void Reset();
+
+    void AddFrame(VoxelFrameStatistics const &statistics);
+
+    uint32_t GetFrameCount() const;
+    VoxelFrameStatistics const &GetFrame(uint32_t frame) const;
+
+    // one row per frame and stack level
+    bool WriteCsv(char const *path, float finest_voxel_size) const;
+
+    // the frames with the clipmap parameters ("mapSize", "stackLevelCount" and "finestVoxelSize")
+    bool WriteJson(char const *path, float finest_voxel_size) const;
+};
@@ -0,0 +1,106 @@
+#include "../../../thirdparty/Brioche-Shader-Language/shaders/brx_shader_language.bsli"
+#include "../../../thirdparty/Voxel-Cone-Tracing/include/brx_voxel_cone_tracing.h"
+
+#pragma pack_matrix(row_major)
+
+#include "../GlobalConstants.h"
+
+// the opacity and the illumination textures of the clipmap (see "CpuVoxelClipmap"): the stack levels are stacked along the Z axis and each voxel covers "width / BRX_VCT_CLIPMAP_MAP_SIZE" texels along the X axis
+RWTexture3D<uint> u_opacity : register(u0);
+RWTexture3D<uint> u_illumination : register(u1);
+
+#define DIRECTION_COUNT 6
+
+// the directions stored in the opacity texel of a voxel (the order of "ANISOTROPIC_CLIPMAP_DIRECTION"): the directions share the texels when there are less than 6 texels per voxel, and the texels share the direction otherwise
+void GetOpacityTexelDirections(uint texel, uint voxel_texel_count, out uint direction_begin, out uint direction_end)
+{
+    direction_begin = (DIRECTION_COUNT * texel + voxel_texel_count - 1u) / voxel_texel_count;
+    direction_end = (DIRECTION_COUNT * (texel + 1u) + voxel_texel_count - 1u) / voxel_texel_count;
+    if (direction_begin == direction_end)
+    {
+        direction_begin = (DIRECTION_COUNT * texel) / voxel_texel_count;
+        direction_end = direction_begin + 1u;
+    }
+}
+
+// Derives the inner half of the stack level "g_DeriveStackLevel" from the stack level "g_DeriveStackLevel - 1", the same as "DeriveCoarseStackLevelsCpu".
+// Since all stack levels share the clipmap center, the region of the finer stack level is exactly the inner half of the coarser stack level, and each voxel there covers 2 x 2 x 2 voxels of the finer stack level.
+// The opacity along each direction is the average over the 2 x 2 columns of the front-to-back composition of the 2 children along the direction, and the illumination is the average of the children.
+[numthreads(4, 4, 4)]
+void main(uint3 dispatch_thread_id : SV_DispatchThreadID)
+{
+    uint opacity_width;
+    uint illumination_width;
+    uint height;
+    uint depth;
+    u_opacity.GetDimensions(opacity_width, height, depth);
+    u_illumination.GetDimensions(illumination_width, height, depth);
+    uint voxel_texel_count = opacity_width / BRX_VCT_CLIPMAP_MAP_SIZE;
+    uint voxel_illumination_texel_count = illumination_width / BRX_VCT_CLIPMAP_MAP_SIZE;
+
+    uint3 voxel = dispatch_thread_id + uint3(BRX_VCT_CLIPMAP_MAP_SIZE / 4u, BRX_VCT_CLIPMAP_MAP_SIZE / 4u, BRX_VCT_CLIPMAP_MAP_SIZE / 4u);
+    voxel.z += g_DeriveStackLevel * BRX_VCT_CLIPMAP_MAP_SIZE;
+
+    uint3 finer_voxel = 2u * dispatch_thread_id;
+    finer_voxel.z += (g_DeriveStackLevel - 1u) * BRX_VCT_CLIPMAP_MAP_SIZE;
+
+    // [direction][child]
+    float child_opacity[DIRECTION_COUNT][8];
+    for (uint child = 0u; child < 8u; ++child)
+    {
+        uint3 child_voxel = finer_voxel + uint3(child & 1u, (child >> 1u) & 1u, (child >> 2u) & 1u);
+        for (uint direction = 0u; direction < DIRECTION_COUNT; ++direction)
+        {
+            child_opacity[direction][child] = float(u_opacity[uint3(voxel_texel_count * child_voxel.x + (direction * voxel_texel_count) / DIRECTION_COUNT, child_voxel.y, child_voxel.z)] & 0x3FFu) / 1023.0;
+        }
+    }
+
+    float opacity[DIRECTION_COUNT];
+    for (uint direction = 0u; direction < DIRECTION_COUNT; ++direction)
+    {
+        uint axis_bit = 1u << (direction >> 1u);
+        bool positive = (0u == (direction & 1u));
+
+        opacity[direction] = 0.0;
+        for (uint child = 0u; child < 8u; ++child)
+        {
+            // each column is visited from its front child
+            if ((0u != (child & axis_bit)) == positive)
+            {
+                continue;
+            }
+
+            float front = child_opacity[direction][child];
+            float back = child_opacity[direction][child ^ axis_bit];
+            opacity[direction] += 0.25 * (front + (1.0 - front) * back);
+        }
+    }
+
+    for (uint texel = 0u; texel < voxel_texel_count; ++texel)
+    {
+        uint direction_begin;
+        uint direction_end;
+        GetOpacityTexelDirections(texel, voxel_texel_count, direction_begin, direction_end);
+
+        float texel_opacity = 0.0;
+        for (uint direction = direction_begin; direction < direction_end; ++direction)
+        {
+            texel_opacity += opacity[direction];
+        }
+
+        u_opacity[uint3(voxel_texel_count * voxel.x + texel, voxel.y, voxel.z)] = uint(1023.0 * (texel_opacity / float(direction_end - direction_begin)));
+    }
+
+    // the illumination is fixed point (see "VxgiPackEmittanceForAtomic"), which is averaged as float since the sum of the children may overflow
+    for (uint texel = 0u; texel < voxel_illumination_texel_count; ++texel)
+    {
+        float illumination = 0.0;
+        for (uint child = 0u; child < 8u; ++child)
+        {
+            uint3 child_voxel = finer_voxel + uint3(child & 1u, (child >> 1u) & 1u, (child >> 2u) & 1u);
+            illumination += float(u_illumination[uint3(voxel_illumination_texel_count * child_voxel.x + texel, child_voxel.y, child_voxel.z)]);
+        }
+
+        u_illumination[uint3(voxel_illumination_texel_count * voxel.x + texel, voxel.y, voxel.z)] = uint(0.125 * illumination);
+    }
+}
@@ -0,0 +1,30 @@
+#pragma pack_matrix(row_major)
+
+#include "../ConeTracingConstants.h"
+
+// the full resolution G-buffer, in the slots of "MyConeTracingCS"
+Texture2D g_gbuffer_base_color_and_metallic : register(t0);
+Texture2D g_gbuffer_normal_and_roughness : register(t1);
+Texture2D g_gbuffer_depth : register(t2);
+
+// the G-buffer at the sample positions, which replaces the full resolution G-buffer of "MyConeTracingCS"
+RWTexture2D<float4> u_base_color_and_metallic : register(u0);
+RWTexture2D<float4> u_normal_and_roughness : register(u1);
+RWTexture2D<float> u_depth : register(u2);
+
+// The samples are point sampled rather than filtered, so that the traced surface is a surface of the G-buffer, and the upsampling can compare the depth and the normal of each sample with the pixels around.
+[numthreads(8, 8, 1)]
+void main(uint3 dispatch_thread_id : SV_DispatchThreadID)
+{
+    [branch]
+    if (any(dispatch_thread_id.xy >= uint2(g_TracingWidth, g_TracingHeight)))
+    {
+        return;
+    }
+
+    uint2 pixel = min(dispatch_thread_id.xy * g_TracingResolution + uint2(g_SampleOffsetX, g_SampleOffsetY), uint2(g_FullWidth - 1, g_FullHeight - 1));
+
+    u_base_color_and_metallic[dispatch_thread_id.xy] = g_gbuffer_base_color_and_metallic[pixel];
+    u_normal_and_roughness[dispatch_thread_id.xy] = g_gbuffer_normal_and_roughness[pixel];
+    u_depth[dispatch_thread_id.xy] = g_gbuffer_depth[pixel].r;
+}
@@ -0,0 +1,152 @@
+#pragma pack_matrix(row_major)
+
+#include "../ConeTracingConstants.h"
+
+// the output of "MyConeTracingCS" at the sample positions, and the G-buffer at the sample positions (see "MyConeTracingDownsampleCS")
+Texture2D<float4> g_traced_radiance_and_ambient : register(t0);
+Texture2D<float> g_traced_depth : register(t1);
+Texture2D<float4> g_traced_normal_and_roughness : register(t2);
+
+// the full resolution G-buffer of the current and the previous frame
+Texture2D g_gbuffer_depth : register(t3);
+Texture2D g_gbuffer_normal_and_roughness : register(t4);
+Texture2D g_gbuffer_depth_prev : register(t5);
+Texture2D g_gbuffer_normal_and_roughness_prev : register(t6);
+
+// the result of the previous frame
+Texture2D<float4> g_history : register(t7);
+
+// the output of "MyConeTracingCS" expected by VXGI
+RWTexture2D<float4> u_radiance_and_ambient : register(u0);
+RWTexture2D<float4> u_history : register(u1);
+
+float3 ReconstructWorldPosition(float2 pixel_center, float depth, float4x4 view_proj_matrix_inv)
+{
+    float2 uv = pixel_center / float2(g_FullWidth, g_FullHeight);
+    float4 position = mul(float4(uv.x * 2.0 - 1.0, 1.0 - uv.y * 2.0, depth, 1.0), view_proj_matrix_inv);
+    return position.xyz / position.w;
+}
+
+// the distance to the tangent plane of the pixel relative to the tolerance, and the agreement of the normals
+float GetGeometricWeight(float3 position, float3 normal, float plane_tolerance, float3 sample_position, float3 sample_normal)
+{
+    return exp(-abs(dot(normal, sample_position - position)) / plane_tolerance) * pow(saturate(dot(normal, sample_normal)), g_NormalExponent);
+}
+
+// Reconstructs the full resolution output from the reduced resolution samples:
+// - the 2x2 samples around the pixel are weighted by the bilinear weight and the geometric weight, so that the samples across the depth and the normal discontinuities do not leak;
+// - the history is reprojected by the previous G-buffer, rejected when the surface does not match, and clamped to the samples of the same surface;
+// - the pixel traced in the current frame is blended with a higher weight than the pixels which are only upsampled.
+[numthreads(8, 8, 1)]
+void main(uint3 dispatch_thread_id : SV_DispatchThreadID)
+{
+    uint2 pixel = dispatch_thread_id.xy;
+
+    [branch]
+    if (any(pixel >= uint2(g_FullWidth, g_FullHeight)))
+    {
+        return;
+    }
+
+    float depth = g_gbuffer_depth[pixel].r;
+
+    [branch]
+    if (depth >= 1.0)
+    {
+        u_radiance_and_ambient[pixel] = float4(0.0, 0.0, 0.0, 0.0);
+        u_history[pixel] = float4(0.0, 0.0, 0.0, 0.0);
+        return;
+    }
+
+    float3 normal = normalize(g_gbuffer_normal_and_roughness[pixel].xyz);
+    float3 position = ReconstructWorldPosition(float2(pixel) + 0.5, depth, g_ViewProjMatrixInv);
+    float plane_tolerance = max(g_DepthTolerance * distance(position, g_CameraPos.xyz), 1e-4);
+
+    float2 sample_coordinates = (float2(pixel) - float2(g_SampleOffsetX, g_SampleOffsetY)) / float(g_TracingResolution);
+    int2 base_sample = int2(floor(sample_coordinates));
+    float2 fraction = sample_coordinates - float2(base_sample);
+
+    float4 current = float4(0.0, 0.0, 0.0, 0.0);
+    float current_weight = 0.0;
+    float4 fallback = float4(0.0, 0.0, 0.0, 0.0);
+    float fallback_weight = 0.0;
+    float4 neighborhood_min = float4(65504.0, 65504.0, 65504.0, 65504.0);
+    float4 neighborhood_max = float4(-65504.0, -65504.0, -65504.0, -65504.0);
+    bool traced = false;
+
+    [unroll]
+    for (int sample_index = 0; sample_index < 4; ++sample_index)
+    {
+        int2 offset = int2(sample_index & 1, sample_index >> 1);
+        int2 sample_coordinate = clamp(base_sample + offset, int2(0, 0), int2(g_TracingWidth - 1, g_TracingHeight - 1));
+        uint2 sample_pixel = min(uint2(sample_coordinate) * g_TracingResolution + uint2(g_SampleOffsetX, g_SampleOffsetY), uint2(g_FullWidth - 1, g_FullHeight - 1));
+
+        float sample_depth = g_traced_depth[sample_coordinate];
+        float4 sample_value = g_traced_radiance_and_ambient[sample_coordinate];
+
+        float spatial_weight = max((0 != offset.x) ? fraction.x : (1.0 - fraction.x), 1e-3) * max((0 != offset.y) ? fraction.y : (1.0 - fraction.y), 1e-3);
+
+        [branch]
+        if (sample_depth < 1.0)
+        {
+            float3 sample_position = ReconstructWorldPosition(float2(sample_pixel) + 0.5, sample_depth, g_ViewProjMatrixInv);
+            float3 sample_normal = normalize(g_traced_normal_and_roughness[sample_coordinate].xyz);
+            float geometric_weight = GetGeometricWeight(position, normal, plane_tolerance, sample_position, sample_normal);
+
+            current += sample_value * (spatial_weight * geometric_weight);
+            current_weight += spatial_weight * geometric_weight;
+
+            fallback += sample_value * spatial_weight;
+            fallback_weight += spatial_weight;
+
+            if (geometric_weight > 0.5)
+            {
+                neighborhood_min = min(neighborhood_min, sample_value);
+                neighborhood_max = max(neighborhood_max, sample_value);
+            }
+
+            traced = traced || all(sample_pixel == pixel);
+        }
+    }
+
+    bool current_valid = (current_weight > 1e-4);
+    current = current_valid ? (current / current_weight) : ((fallback_weight > 0.0) ? (fallback / fallback_weight) : float4(0.0, 0.0, 0.0, 0.0));
+
+    float4 result = current;
+
+    [branch]
+    if (0 != g_HistoryValid)
+    {
+        float4 previous_clip = mul(float4(position, 1.0), g_PreviousViewProjMatrix);
+        float2 previous_uv = float2(previous_clip.x / previous_clip.w * 0.5 + 0.5, 0.5 - previous_clip.y / previous_clip.w * 0.5);
+
+        [branch]
+        if ((previous_clip.w > 0.0) && all(previous_uv >= float2(0.0, 0.0)) && all(previous_uv < float2(1.0, 1.0)))
+        {
+            uint2 previous_pixel = min(uint2(previous_uv * float2(g_FullWidth, g_FullHeight)), uint2(g_FullWidth - 1, g_FullHeight - 1));
+
+            float previous_depth = g_gbuffer_depth_prev[previous_pixel].r;
+            float3 previous_position = ReconstructWorldPosition(float2(previous_pixel) + 0.5, previous_depth, g_PreviousViewProjMatrixInv);
+            float3 previous_normal = normalize(g_gbuffer_normal_and_roughness_prev[previous_pixel].xyz);
+
+            // the history is rejected when the surface was occluded or is another surface (the disocclusion)
+            [branch]
+            if ((previous_depth < 1.0) && (GetGeometricWeight(position, normal, plane_tolerance, previous_position, previous_normal) > 0.5))
+            {
+                float4 history = g_history[previous_pixel];
+
+                // the history is clamped to the samples of the same surface (slightly extended to keep the accumulation of the noise), to limit the ghosting of the moving lighting
+                if (neighborhood_min.x <= neighborhood_max.x)
+                {
+                    float4 neighborhood_extent = (neighborhood_max - neighborhood_min) * 0.25;
+                    history = clamp(history, neighborhood_min - neighborhood_extent, neighborhood_max + neighborhood_extent);
+                }
+
+                result = current_valid ? lerp(history, current, traced ? g_TracedWeight : g_UpsampledWeight) : history;
+            }
+        }
+    }
+
+    u_radiance_and_ambient[pixel] = result;
+    u_history[pixel] = result;
+}
@@ -0,0 +1,248 @@
+#include "../../../thirdparty/Brioche-Shader-Language/shaders/brx_shader_language.bsli"
+#include "../../../thirdparty/Voxel-Cone-Tracing/include/brx_voxel_cone_tracing.h"
+
+#pragma pack_matrix(row_major)
+
+#include "../GlobalConstants.h"
+#include "VoxelEncoding.hlsli"
+
+// the voxel surface of the static layer (see "VoxelLighting.hlsli") and the opacity of the working clipmap (in the layout of "CpuVoxelClipmap")
+Texture3D<uint2> g_voxel_surface : register(t0);
+Texture3D<uint> g_opacity : register(t1);
+
+// the working clipmap resolved into the compact encodings (see "SceneRenderer::ResolveCompactVoxels"), which the cones trace instead of the accumulation when "g_IndirectIrradianceCompactVoxels" is set
+Texture3D<float> g_compact_opacity : register(t2);
+Texture3D<uint> g_compact_radiance : register(t3);
+
+// The indirect irradiance of each voxel, in the layout of the voxel surface:
+// x: R and G (2 x half)
+// y: B (half) and the count of the updates since the voxel was invalidated (16 bits)
+RWTexture3D<uint2> u_indirect_irradiance : register(u0);
+
+// the emittance of the working clipmap, RGB interleaved along the X axis (the fixed point sums of "brx_voxel_cone_tracing_voxelization_store_data")
+RWTexture3D<uint> u_emittance : register(u1);
+
+// not used by this pass, but declared for "VoxelLighting.hlsli"
+Texture2D g_shadow_map : register(t6);
+SamplerComparisonState g_shadow_sampler : register(s1);
+
+#include "VoxelLighting.hlsli"
+
+#define INDIRECT_IRRADIANCE_PASS_UPDATE 0
+#define INDIRECT_IRRADIANCE_PASS_APPLY 1
+#define INDIRECT_IRRADIANCE_PASS_APPLY_AND_INVALIDATE 2
+
+#define INDIRECT_IRRADIANCE_MAX_PERIOD 64
+#define INDIRECT_IRRADIANCE_CONE_COUNT 6
+#define INDIRECT_IRRADIANCE_CONE_STEP_COUNT 16
+
+// tan(30 degrees)
+#define INDIRECT_IRRADIANCE_CONE_APERTURE 0.577
+
+void UnpackIndirectIrradiance(uint2 packed_irradiance, out float3 irradiance, out uint update_count)
+{
+    irradiance = float3(f16tof32(packed_irradiance.x), f16tof32(packed_irradiance.x >> 16), f16tof32(packed_irradiance.y));
+    update_count = (packed_irradiance.y >> 16);
+}
+
+uint2 PackIndirectIrradiance(float3 irradiance, uint update_count)
+{
+    uint3 packed_irradiance = f32tof16(irradiance);
+    return uint2(packed_irradiance.x | (packed_irradiance.y << 16), packed_irradiance.z | (min(update_count, 0xFFFFu) << 16));
+}
+
+// The fixed point emittance added to the working clipmap. Both the update and the apply pass compute the emittance from the packed irradiance by this function, thus the emittance removed by an update is exactly the emittance added before.
+int3 GetIndirectEmittance(float3 diffuse_color, uint2 packed_irradiance)
+{
+    float3 irradiance;
+    uint update_count;
+    UnpackIndirectIrradiance(packed_irradiance, irradiance, update_count);
+
+    return int3(round(diffuse_color * irradiance * g_IndirectIrradianceScale * float(1u << 20)));
+}
+
+void AddEmittance(uint3 coordinates, int3 emittance)
+{
+    [branch] if (any(0 != emittance))
+    {
+        InterlockedAdd(u_emittance[uint3(3 * coordinates.x + 0, coordinates.yz)], uint(emittance.x));
+        InterlockedAdd(u_emittance[uint3(3 * coordinates.x + 1, coordinates.yz)], uint(emittance.y));
+        InterlockedAdd(u_emittance[uint3(3 * coordinates.x + 2, coordinates.yz)], uint(emittance.z));
+    }
+}
+
+// the rank of the voxel inside the 4 x 4 x 4 block, the bit reversed morton code, thus the voxels of the consecutive ranks are spread over the block
+uint GetVoxelRank(uint3 coordinates)
+{
+    uint3 block = coordinates & 3u;
+    uint morton = (block.x & 1u) | ((block.y & 1u) << 1) | ((block.z & 1u) << 2) | ((block.x & 2u) << 2) | ((block.y & 2u) << 3) | ((block.z & 2u) << 4);
+    return reversebits(morton) >> 26;
+}
+
+float ReadVoxelOpacity(uint3 coordinates)
+{
+    [branch] if (0u != g_IndirectIrradianceCompactVoxels)
+    {
+        return g_compact_opacity[coordinates];
+    }
+
+    return float(g_opacity[coordinates] & 0x3FFu) / 1023.0;
+}
+
+float3 ReadVoxelEmittance(uint3 coordinates)
+{
+    [branch] if (0u != g_IndirectIrradianceCompactVoxels)
+    {
+        uint packed_radiance = g_compact_radiance[coordinates];
+        return (VOXEL_RADIANCE_ENCODING_R11G11B10 == g_VoxelRadianceEncoding) ? UnpackVoxelRadianceR11G11B10(packed_radiance) : UnpackVoxelRadianceRGB9E5(packed_radiance);
+    }
+
+    return float3(
+        u_emittance[uint3(3 * coordinates.x + 0, coordinates.yz)],
+        u_emittance[uint3(3 * coordinates.x + 1, coordinates.yz)],
+        u_emittance[uint3(3 * coordinates.x + 2, coordinates.yz)]) / float(1u << 20);
+}
+
+// Marches the cone front to back through the stack levels of which the voxel size matches the diameter of the cone.
+float3 TraceCone(float3 origin, float3 direction, int start_stack_level_index)
+{
+    float3 radiance = float3(0.0, 0.0, 0.0);
+    float occlusion = 0.0;
+
+    float cone_distance = GetStackLevelVoxelSize(start_stack_level_index);
+
+    [loop] for (int step_index = 0; (step_index < INDIRECT_IRRADIANCE_CONE_STEP_COUNT) && (occlusion < 0.99); ++step_index)
+    {
+        float diameter = max(2.0 * INDIRECT_IRRADIANCE_CONE_APERTURE * cone_distance, GetStackLevelVoxelSize(start_stack_level_index));
+        float3 position = origin + direction * cone_distance;
+
+        int clipmap_stack_level_index = clamp(int(ceil(log2(diameter / BRX_VCT_CLIPMAP_FINEST_VOXEL_SIZE))), start_stack_level_index, BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT - 1);
+
+        uint3 coordinates;
+        bool inside = GetVoxelSurfaceCoordinates(position, clipmap_stack_level_index, coordinates);
+
+        // the finer stack level does not cover the position, thus the coarser stack levels are used
+        [loop] while ((!inside) && (clipmap_stack_level_index < (BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT - 1)))
+        {
+            ++clipmap_stack_level_index;
+            inside = GetVoxelSurfaceCoordinates(position, clipmap_stack_level_index, coordinates);
+        }
+
+        [branch] if (!inside)
+        {
+            break;
+        }
+
+        float opacity = ReadVoxelOpacity(coordinates);
+
+        [branch] if (opacity > 0.0)
+        {
+            float3 emittance = ReadVoxelEmittance(coordinates);
+
+            radiance += (1.0 - occlusion) * emittance;
+            occlusion += (1.0 - occlusion) * opacity;
+        }
+
+        cone_distance += 0.5 * max(diameter, GetStackLevelVoxelSize(clipmap_stack_level_index));
+    }
+
+    return radiance;
+}
+
+// The cosine weighted average of the incident radiance over the hemisphere: one cone along the normal and five cones tilted by 60 degrees.
+float3 GatherIrradiance(float3 position, float3 normal, int clipmap_stack_level_index)
+{
+    float3 tangent = normalize(cross((abs(normal.y) < 0.99) ? float3(0.0, 1.0, 0.0) : float3(1.0, 0.0, 0.0), normal));
+    float3 bitangent = cross(normal, tangent);
+
+    // the cone starts outside of the voxel itself
+    float3 origin = position + normal * GetStackLevelVoxelSize(clipmap_stack_level_index);
+
+    float3 irradiance = 0.25 * TraceCone(origin, normal, clipmap_stack_level_index);
+
+    [unroll] for (int cone_index = 1; cone_index < INDIRECT_IRRADIANCE_CONE_COUNT; ++cone_index)
+    {
+        float phi = 2.0 * 3.14159265 * float(cone_index - 1) / float(INDIRECT_IRRADIANCE_CONE_COUNT - 1);
+        float3 direction = 0.5 * normal + 0.866025 * (cos(phi) * tangent + sin(phi) * bitangent);
+
+        irradiance += 0.15 * TraceCone(origin, direction, clipmap_stack_level_index);
+    }
+
+    return irradiance;
+}
+
+// Keeps the indirect irradiance of the voxel surface in the emittance of the working clipmap (the multi-bounce of the custom cone tracing).
+// UPDATE: a stratified slice of the voxels gathers the irradiance again and the difference to the stored irradiance is added to the emittance.
+//   The voxel is updated every "period" frames, and the period is doubled per stack level (the voxels near the clipmap anchor are updated more often) and divided by 4 for the voxels invalidated recently.
+// APPLY: the stored irradiance is added to the emittance after the working clipmap is restored from the static layer.
+// APPLY_AND_INVALIDATE: the same as APPLY, and the voxels are marked as invalidated (the stored irradiance is kept until the voxel is updated).
+// Only the voxels of the box [g_IndirectIrradianceVoxelLower, g_IndirectIrradianceVoxelUpper) are dispatched, thus a region restored from the static layer can be applied alone.
+[numthreads(4, 4, 4)]
+void main(uint3 dispatch_thread_id : SV_DispatchThreadID)
+{
+    // the box of the voxels dispatched, in the layout of the voxel surface
+    uint3 voxel_coordinates = dispatch_thread_id + uint3(g_IndirectIrradianceVoxelLowerX, g_IndirectIrradianceVoxelLowerY, g_IndirectIrradianceVoxelLowerZ);
+
+    [branch] if (any(voxel_coordinates >= uint3(g_IndirectIrradianceVoxelUpperX, g_IndirectIrradianceVoxelUpperY, g_IndirectIrradianceVoxelUpperZ)))
+    {
+        return;
+    }
+
+    uint2 packed_surface = g_voxel_surface[voxel_coordinates];
+
+    [branch] if (!IsVoxelSurfaceValid(packed_surface))
+    {
+        return;
+    }
+
+    float3 base_color;
+    float metallic;
+    float3 shading_normal_world_space;
+    float roughness;
+    UnpackVoxelSurface(packed_surface, base_color, metallic, shading_normal_world_space, roughness);
+
+    float3 diffuse_color;
+    float3 specular_color;
+    GetDiffuseAndSpecularColor(base_color, metallic, diffuse_color, specular_color);
+
+    uint2 packed_irradiance = u_indirect_irradiance[voxel_coordinates];
+
+    [branch] if (INDIRECT_IRRADIANCE_PASS_UPDATE != g_IndirectIrradiancePass)
+    {
+        AddEmittance(voxel_coordinates, GetIndirectEmittance(diffuse_color, packed_irradiance));
+
+        if (INDIRECT_IRRADIANCE_PASS_APPLY_AND_INVALIDATE == g_IndirectIrradiancePass)
+        {
+            u_indirect_irradiance[voxel_coordinates] = uint2(packed_irradiance.x, packed_irradiance.y & 0xFFFFu);
+        }
+        return;
+    }
+
+    float3 irradiance;
+    uint update_count;
+    UnpackIndirectIrradiance(packed_irradiance, irradiance, update_count);
+
+    int clipmap_stack_level_index;
+    float3 surface_position_world_space = GetVoxelSurfacePosition(voxel_coordinates, clipmap_stack_level_index);
+
+    uint period = min(g_IndirectIrradiancePeriod << clipmap_stack_level_index, uint(INDIRECT_IRRADIANCE_MAX_PERIOD));
+    if (0u == update_count)
+    {
+        period = max(period >> 2, 1u);
+    }
+
+    [branch] if (0u != ((GetVoxelRank(voxel_coordinates) + g_IndirectIrradianceFrame) % period))
+    {
+        return;
+    }
+
+    float3 gathered_irradiance = GatherIrradiance(surface_position_world_space, shading_normal_world_space, clipmap_stack_level_index);
+
+    // the first updates after the invalidation replace the stored irradiance, rather than blending with the stale irradiance
+    float blend = max(g_IndirectIrradianceBlend, 1.0 / float(update_count + 1u));
+    uint2 new_packed_irradiance = PackIndirectIrradiance(min(lerp(irradiance, gathered_irradiance, blend), 65504.0), update_count + 1u);
+
+    AddEmittance(voxel_coordinates, GetIndirectEmittance(diffuse_color, new_packed_irradiance) - GetIndirectEmittance(diffuse_color, packed_irradiance));
+
+    u_indirect_irradiance[voxel_coordinates] = new_packed_irradiance;
+}
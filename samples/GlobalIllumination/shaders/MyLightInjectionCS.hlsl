@@ -0,0 +1,78 @@
+#include "../../../thirdparty/Brioche-Shader-Language/shaders/brx_shader_language.bsli"
+#include "../../../thirdparty/Brioche-Shader-Language/shaders/brx_brdf.bsli"
+#define BRX_VCT_CLIPMAP_OPACITY_TEXTURE u_Opacity
+#define BRX_VCT_CLIPMAP_ILLUMINATION_TEXTURE u_Emittance
+#include "../../../thirdparty/Voxel-Cone-Tracing/include/brx_voxel_cone_tracing.h"
+
+#pragma pack_matrix(row_major)
+
+// the same slots as the voxelization pixel shader
+// the opacity is written by "brx_voxel_cone_tracing_voxelization_store_data" as well, thus a scratch texture should be bound instead of the opacity of the clipmap
+RWTexture3D<uint> u_Opacity : register(u2);
+
+RWTexture3D<uint> u_Emittance : register(u3);
+
+#define BRX_VCT_VOXELIZATION_ENABLE_ILLUMINATION 1
+
+#include "../../../thirdparty/Voxel-Cone-Tracing/shaders/brx_voxel_cone_tracing_voxelization_fragment.bsli"
+
+#include "../GlobalConstants.h"
+
+Texture3D<uint2> g_voxel_surface : register(t0);
+Texture2D g_shadow_map : register(t6);
+
+SamplerComparisonState g_shadow_sampler : register(s1);
+
+#include "VoxelLighting.hlsli"
+
+// Injects the direct lighting into the illumination from the stored voxel surface, without rasterizing the geometry again.
+// The illumination should be cleared before.
+[numthreads(4, 4, 4)]
+void main(uint3 dispatch_thread_id : SV_DispatchThreadID)
+{
+    uint2 packed_surface = g_voxel_surface[dispatch_thread_id];
+
+    [branch] if (!IsVoxelSurfaceValid(packed_surface))
+    {
+        return;
+    }
+
+    float3 base_color;
+    float metallic;
+    float3 shading_normal_world_space;
+    float roughness;
+    UnpackVoxelSurface(packed_surface, base_color, metallic, shading_normal_world_space, roughness);
+
+    float3 diffuse_color;
+    float3 specular_color;
+    GetDiffuseAndSpecularColor(base_color, metallic, diffuse_color, specular_color);
+
+    int clipmap_stack_level_index;
+    float3 surface_position_world_space = GetVoxelSurfacePosition(dispatch_thread_id, clipmap_stack_level_index);
+
+    float3 incident_direction = normalize(-g_LightDirection.xyz);
+
+    float3 E_l = GetIncidentLight(surface_position_world_space, shading_normal_world_space);
+
+    // the dominant axis of the normal is used as the viewport depth direction (the same as "Scene::GetMeshDominantAxisDrawArguments")
+    float3 abs_normal = abs(shading_normal_world_space);
+    int viewport_depth_direction_index = ((abs_normal.x >= abs_normal.y) && (abs_normal.x >= abs_normal.z)) ? 0 : ((abs_normal.y >= abs_normal.z) ? 1 : 2);
+
+    // the same position as "SV_Position" of the voxelization pixel shader
+    float4 position_clip_space = mul(mul(float4(surface_position_world_space, 1.0), g_viewport_depth_direction_view_matrices[viewport_depth_direction_index]), g_clipmap_stack_level_projection_matrices[clipmap_stack_level_index]);
+    float3 position_ndc = position_clip_space.xyz / position_clip_space.w;
+    float2 position_viewport = float2(position_ndc.x * 0.5 + 0.5, 0.5 - position_ndc.y * 0.5) * float(BRX_VCT_CLIPMAP_MAP_SIZE);
+
+    brx_voxel_cone_tracing_voxelization_store_data(
+        viewport_depth_direction_index,
+        clipmap_stack_level_index,
+        brx_float3(position_viewport.x, BRX_VCT_CLIPMAP_MAP_SIZE - position_viewport.y, position_ndc.z * BRX_VCT_CLIPMAP_MAP_SIZE),
+        1u,
+        1.0,
+        shading_normal_world_space,
+        diffuse_color,
+        specular_color,
+        roughness,
+        incident_direction,
+        E_l);
+}
@@ -0,0 +1,104 @@
+#include "../../../thirdparty/Brioche-Shader-Language/shaders/brx_shader_language.bsli"
+#include "../../../thirdparty/Brioche-Shader-Language/shaders/brx_brdf.bsli"
+#define BRX_VCT_CLIPMAP_OPACITY_TEXTURE u_Opacity
+#define BRX_VCT_CLIPMAP_ILLUMINATION_TEXTURE u_Emittance
+#include "../../../thirdparty/Voxel-Cone-Tracing/include/brx_voxel_cone_tracing.h"
+
+#pragma pack_matrix(row_major)
+
+// the same slots as the voxelization pixel shader
+// the opacity is written by "brx_voxel_cone_tracing_voxelization_store_data" as well, thus a scratch texture should be bound instead of the opacity of the clipmap
+RWTexture3D<uint> u_Opacity : register(u2);
+
+RWTexture3D<uint> u_Emittance : register(u3);
+
+#define BRX_VCT_VOXELIZATION_ENABLE_ILLUMINATION 1
+
+#include "../../../thirdparty/Voxel-Cone-Tracing/shaders/brx_voxel_cone_tracing_voxelization_fragment.bsli"
+
+#include "../GlobalConstants.h"
+
+Texture3D<uint2> g_voxel_surface : register(t0);
+Texture2D g_shadow_map : register(t6);
+
+SamplerComparisonState g_shadow_sampler : register(s1);
+
+#include "VoxelLighting.hlsli"
+
+// Injects the direct lighting into the illumination by walking the texels of the shadow map (see "ShadowMapLightInjection.h" for the CPU reference).
+// Each texel is a surface visible from the light, and thus lit without any shadow test. The material is fetched from the voxel surface.
+// "g_ViewProjMatrixInv" is the inverse of the view projection matrix of the light. The illumination should be cleared before.
+[numthreads(8, 8, 1)]
+void main(uint3 dispatch_thread_id : SV_DispatchThreadID)
+{
+    float depth = g_shadow_map.Load(int3(dispatch_thread_id.xy, 0)).r;
+
+    [branch] if (depth >= 1.0)
+    {
+        return;
+    }
+
+    float2 position_ndc = float2((float(dispatch_thread_id.x) + 0.5) * g_rShadowMapSize * 2.0 - 1.0, 1.0 - (float(dispatch_thread_id.y) + 0.5) * g_rShadowMapSize * 2.0);
+    float4 position_world_space = mul(float4(position_ndc, depth, 1.0), g_ViewProjMatrixInv);
+    float3 surface_position_world_space = position_world_space.xyz / position_world_space.w;
+
+    float3 light_direction = normalize(g_LightDirection.xyz);
+    float3 incident_direction = -light_direction;
+
+    for (int clipmap_stack_level_index = 0; clipmap_stack_level_index < BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT; ++clipmap_stack_level_index)
+    {
+        // move half a voxel into the surface, so that the position does not fall into the empty voxel in front of the surface
+        float3 splat_position_world_space = surface_position_world_space + light_direction * (0.5 * GetStackLevelVoxelSize(clipmap_stack_level_index));
+
+        uint3 coordinates;
+        [branch] if (!GetVoxelSurfaceCoordinates(splat_position_world_space, clipmap_stack_level_index, coordinates))
+        {
+            continue;
+        }
+
+        uint2 packed_surface = g_voxel_surface[coordinates];
+
+        [branch] if (!IsVoxelSurfaceValid(packed_surface))
+        {
+            continue;
+        }
+
+        float3 base_color;
+        float metallic;
+        float3 shading_normal_world_space;
+        float roughness;
+        UnpackVoxelSurface(packed_surface, base_color, metallic, shading_normal_world_space, roughness);
+
+        [branch] if (dot(shading_normal_world_space, incident_direction) <= 0.0)
+        {
+            continue;
+        }
+
+        float3 diffuse_color;
+        float3 specular_color;
+        GetDiffuseAndSpecularColor(base_color, metallic, diffuse_color, specular_color);
+
+        // the dominant axis of the normal is used as the viewport depth direction (the same as "Scene::GetMeshDominantAxisDrawArguments")
+        float3 abs_normal = abs(shading_normal_world_space);
+        int viewport_depth_direction_index = ((abs_normal.x >= abs_normal.y) && (abs_normal.x >= abs_normal.z)) ? 0 : ((abs_normal.y >= abs_normal.z) ? 1 : 2);
+
+        // the same position as "SV_Position" of the voxelization pixel shader
+        float3 voxel_position_world_space = GetVoxelSurfacePosition(coordinates, clipmap_stack_level_index);
+        float4 position_clip_space = mul(mul(float4(voxel_position_world_space, 1.0), g_viewport_depth_direction_view_matrices[viewport_depth_direction_index]), g_clipmap_stack_level_projection_matrices[clipmap_stack_level_index]);
+        float3 voxel_position_ndc = position_clip_space.xyz / position_clip_space.w;
+        float2 position_viewport = float2(voxel_position_ndc.x * 0.5 + 0.5, 0.5 - voxel_position_ndc.y * 0.5) * float(BRX_VCT_CLIPMAP_MAP_SIZE);
+
+        brx_voxel_cone_tracing_voxelization_store_data(
+            viewport_depth_direction_index,
+            clipmap_stack_level_index,
+            brx_float3(position_viewport.x, BRX_VCT_CLIPMAP_MAP_SIZE - position_viewport.y, voxel_position_ndc.z * BRX_VCT_CLIPMAP_MAP_SIZE),
+            1u,
+            1.0,
+            shading_normal_world_space,
+            diffuse_color,
+            specular_color,
+            roughness,
+            incident_direction,
+            g_LightColor.rgb);
+    }
+}
@@ -0,0 +1,57 @@
+#include "../../../thirdparty/Brioche-Shader-Language/shaders/brx_shader_language.bsli"
+#include "../../../thirdparty/Voxel-Cone-Tracing/include/brx_voxel_cone_tracing.h"
+
+#pragma pack_matrix(row_major)
+
+#include "../GlobalConstants.h"
+#include "VoxelEncoding.hlsli"
+
+// the accumulation in the layout of "CpuVoxelClipmap": the stack levels are stacked along the Z axis and each voxel covers "width / BRX_VCT_CLIPMAP_MAP_SIZE" texels along the X axis, the emittance is RGB interleaved
+Texture3D<uint> g_accumulated_opacity : register(t0);
+Texture3D<uint> g_accumulated_emittance : register(t1);
+
+// R8_UNORM, one texel per voxel
+RWTexture3D<unorm float> u_compact_opacity : register(u0);
+
+// R32_UINT, one texel per voxel, packed as "g_VoxelRadianceEncoding" (RGB9E5 or R11G11B10)
+RWTexture3D<uint> u_compact_radiance : register(u1);
+
+// Resolves the voxels accumulated by the voxelization (the atomic max of the opacity and the atomic add of the fixed point emittance) into the compact encodings, the same as "ResolveCompactVoxelClipmapCpu".
+[numthreads(4, 4, 4)]
+void main(uint3 dispatch_thread_id : SV_DispatchThreadID)
+{
+    uint opacity_width;
+    uint emittance_width;
+    uint height;
+    uint depth;
+    g_accumulated_opacity.GetDimensions(opacity_width, height, depth);
+    g_accumulated_emittance.GetDimensions(emittance_width, height, depth);
+    uint voxel_texel_count = opacity_width / BRX_VCT_CLIPMAP_MAP_SIZE;
+    uint voxel_group_count = emittance_width / (3u * BRX_VCT_CLIPMAP_MAP_SIZE);
+
+    // the max over the directions, the same as "GetCpuVoxelOpacity"
+    uint packed_opacity = 0u;
+    for (uint texel = 0u; texel < voxel_texel_count; ++texel)
+    {
+        packed_opacity = max(packed_opacity, g_accumulated_opacity[uint3(voxel_texel_count * dispatch_thread_id.x + texel, dispatch_thread_id.yz)]);
+    }
+
+    // the sum over the directions, the same as "GetCpuVoxelEmittance"
+    uint3 emittance = uint3(0u, 0u, 0u);
+    for (uint group = 0u; group < voxel_group_count; ++group)
+    {
+        uint x = 3u * (voxel_group_count * dispatch_thread_id.x + group);
+        emittance += uint3(
+            g_accumulated_emittance[uint3(x + 0u, dispatch_thread_id.yz)],
+            g_accumulated_emittance[uint3(x + 1u, dispatch_thread_id.yz)],
+            g_accumulated_emittance[uint3(x + 2u, dispatch_thread_id.yz)]);
+    }
+
+    float opacity = float(packed_opacity & 0x3FFu) / 1023.0;
+    float3 radiance = float3(emittance) / float(1u << 20);
+
+    // the same rounding as "PackVoxelOpacityUnorm8"
+    u_compact_opacity[dispatch_thread_id] = floor(saturate(opacity) * 255.0 + 0.5) / 255.0;
+
+    u_compact_radiance[dispatch_thread_id] = (VOXEL_RADIANCE_ENCODING_R11G11B10 == g_VoxelRadianceEncoding) ? PackVoxelRadianceR11G11B10(radiance) : PackVoxelRadianceRGB9E5(radiance);
+}
@@ -0,0 +1,54 @@
+#include "../../../thirdparty/Brioche-Shader-Language/shaders/brx_shader_language.bsli"
+#include "../../../thirdparty/Voxel-Cone-Tracing/include/brx_voxel_cone_tracing.h"
+
+#pragma pack_matrix(row_major)
+
+#include "../GlobalConstants.h"
+
+// the opacity texture of the clipmap (see "CpuVoxelClipmap"): the stack levels are stacked along the Z axis and each voxel covers "width / BRX_VCT_CLIPMAP_MAP_SIZE" texels along the X axis
+Texture3D<uint> g_opacity : register(t0);
+
+// the counters of "VoxelStatistics.h": "VOXEL_STATISTICS_COUNTER_COUNT" x uint per stack level
+RWBuffer<uint> u_voxel_statistics : register(u0);
+
+#define VOXEL_STATISTICS_COUNTER_OCCUPIED_VOXELS 2
+#define VOXEL_STATISTICS_COUNTER_COUNT 3
+
+groupshared uint s_occupied_voxel_count;
+
+// Counts the voxels of which the opacity is not zero. The group is inside one stack level, since the map size is a multiple of 4.
+[numthreads(4, 4, 4)]
+void main(uint3 dispatch_thread_id : SV_DispatchThreadID, uint group_index : SV_GroupIndex)
+{
+    if (0 == group_index)
+    {
+        s_occupied_voxel_count = 0;
+    }
+
+    GroupMemoryBarrierWithGroupSync();
+
+    uint width;
+    uint height;
+    uint depth;
+    g_opacity.GetDimensions(width, height, depth);
+    uint voxel_texel_count = width / BRX_VCT_CLIPMAP_MAP_SIZE;
+
+    uint opacity = 0;
+    for (uint texel = 0; texel < voxel_texel_count; ++texel)
+    {
+        opacity = max(opacity, g_opacity[uint3(voxel_texel_count * dispatch_thread_id.x + texel, dispatch_thread_id.y, dispatch_thread_id.z)] & 0x3FFu);
+    }
+
+    if (0 != opacity)
+    {
+        InterlockedAdd(s_occupied_voxel_count, 1u);
+    }
+
+    GroupMemoryBarrierWithGroupSync();
+
+    if ((0 == group_index) && (0 != s_occupied_voxel_count))
+    {
+        uint stack_level = dispatch_thread_id.z / BRX_VCT_CLIPMAP_MAP_SIZE;
+        InterlockedAdd(u_voxel_statistics[VOXEL_STATISTICS_COUNTER_COUNT * stack_level + VOXEL_STATISTICS_COUNTER_OCCUPIED_VOXELS], s_occupied_voxel_count);
+    }
+}
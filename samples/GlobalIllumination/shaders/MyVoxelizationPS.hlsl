@@ -181,6 +181,15 @@ Texture2D g_base_color_texture : register(t4);
 Texture2D g_roughness_metallic_texture : register(t5);
 Texture2D g_shadow_map : register(t6);
 
+RWTexture3D<uint2> u_VoxelSurface : register(u4);
+
+// the counters of "VoxelStatistics.h", only bound when "g_VoxelStatisticsEnable" is set
+RWBuffer<uint> u_VoxelStatistics : register(u5);
+
+#define VOXEL_STATISTICS_COUNTER_WRITTEN_FRAGMENTS 0
+#define VOXEL_STATISTICS_COUNTER_DISCARDED_FRAGMENTS 1
+#define VOXEL_STATISTICS_COUNTER_COUNT 3
+
 SamplerState g_sampler : register(s0);
 SamplerComparisonState g_shadow_sampler : register(s1);
 
@@ -203,63 +212,12 @@ float GetShadowFast(float3 fragmentPos)
     return g_shadow_map.SampleCmpLevelZero(g_shadow_sampler, clipPos.xy, clipPos.z);
 }
 
-float GetShadow(float3 fragmentPos)
-{
-    static const float2 g_SamplePositions[] = {
-        // Poisson disk with 16 points
-        float2(-0.3935238f, 0.7530643f),
-        float2(-0.3022015f, 0.297664f),
-        float2(0.09813362f, 0.192451f),
-        float2(-0.7593753f, 0.518795f),
-        float2(0.2293134f, 0.7607011f),
-        float2(0.6505286f, 0.6297367f),
-        float2(0.5322764f, 0.2350069f),
-        float2(0.8581018f, -0.01624052f),
-        float2(-0.6928226f, 0.07119545f),
-        float2(-0.3114384f, -0.3017288f),
-        float2(0.2837671f, -0.179743f),
-        float2(-0.3093514f, -0.749256f),
-        float2(-0.7386893f, -0.5215692f),
-        float2(0.3988827f, -0.617012f),
-        float2(0.8114883f, -0.458026f),
-        float2(0.08265103f, -0.8939569f)};
-
-    fragmentPos -= g_LightDirection.xyz * 1.0f;
-
-    float4 clipPos = mul(float4(fragmentPos, 1.0f), g_LightViewProjMatrix);
-
-    if (abs(clipPos.x) > clipPos.w || abs(clipPos.y) > clipPos.w || clipPos.z <= 0)
-    {
-        return 0;
-    }
-
-    clipPos.xyz /= clipPos.w;
-    clipPos.x = clipPos.x * 0.5f + 0.5f;
-    clipPos.y = 0.5f - clipPos.y * 0.5f;
-
-    float shadow = 0;
-    float totalWeight = 0;
-
-    for (int nSample = 0; nSample < 16; ++nSample)
-    {
-        float2 offset = g_SamplePositions[nSample];
-        float weight = 1.0;
-        offset *= 2 * g_rShadowMapSize;
-        float sample = g_shadow_map.SampleCmpLevelZero(g_shadow_sampler, clipPos.xy + offset, clipPos.z);
-        shadow += sample * weight;
-        totalWeight += weight;
-    }
-
-    shadow /= totalWeight;
-    shadow = pow(shadow, 2.2);
-
-    return shadow;
-}
+#include "VoxelLighting.hlsli"
 
 void main(
     in uint in_sample_mask : SV_Coverage,
     in float4 in_position : SV_Position,
-    in float in_cull_distance[2] : SV_CullDistance,
+    in float in_cull_distance[3] : SV_CullDistance,
     in nointerpolation int in_viewport_depth_direction_index : LOCATION0,
     in nointerpolation int in_clipmap_stack_level_index : LOCATION1,
     in float3 in_interpolated_position_world_space : LOCATION2,
@@ -267,10 +225,21 @@ void main(
     in float4 in_interpolated_tangent : LOCATION4,
     in float2 in_interpolated_texcoord : LOCATION5)
 {
+    // the inner half of the coarser stack levels is derived from the finer stack level (MyClipmapDownsampleCS), thus the fragments of the triangles which cross the inner half are discarded there (with one voxel of margin)
+    [branch] if ((0u != g_DeriveCoarseStackLevels) && (in_clipmap_stack_level_index > 0))
+    {
+        float3 voxel = float3(in_position.x, BRX_VCT_CLIPMAP_MAP_SIZE - in_position.y, in_position.z * BRX_VCT_CLIPMAP_MAP_SIZE);
+        if (all(voxel >= float(BRX_VCT_CLIPMAP_MAP_SIZE / 4 + 1)) && all(voxel < float(3 * BRX_VCT_CLIPMAP_MAP_SIZE / 4 - 1)))
+        {
+            discard;
+            return;
+        }
+    }
+
     float opacity;
     float3 shading_normal_world_space;
-    float3 diffuse_color;
-    float3 specular_color;
+    float3 base_color;
+    float metallic;
     float roughness;
     {
         {
@@ -288,7 +257,7 @@ void main(
         {
             float4 base_color_and_opacity = g_base_color_texture.Sample(g_sampler, in_interpolated_texcoord);
 
-            float3 base_color = base_color_and_opacity.xyz;
+            base_color = base_color_and_opacity.xyz;
 
             opacity = base_color_and_opacity.w;
 
@@ -296,44 +265,45 @@ void main(
 
             roughness = roughness_metallic.x;
 
-            float metallic = roughness_metallic.y;
-
-            // UE4: https://github.com/EpicGames/UnrealEngine/blob/4.21/Engine/Shaders/Private/MobileBasePassPixelShader.usf#L376
-            const float dielectric_specular = 0.04;
-
-            specular_color = clamp((dielectric_specular - dielectric_specular * metallic) + base_color * metallic, 0.0, 1.0);
-            diffuse_color = clamp(base_color - base_color * metallic, 0.0, 1.0);
+            metallic = roughness_metallic.y;
         }
     }
 
     // [branch]
     if (opacity < 0.5)
     {
+        [branch] if (0u != g_VoxelStatisticsEnable)
+        {
+            InterlockedAdd(u_VoxelStatistics[VOXEL_STATISTICS_COUNTER_COUNT * in_clipmap_stack_level_index + VOXEL_STATISTICS_COUNTER_DISCARDED_FRAGMENTS], 1u);
+        }
+
         discard;
         return;
     }
 
-    float3 surface_position_world_space = in_interpolated_position_world_space;
+    float3 diffuse_color;
+    float3 specular_color;
+    GetDiffuseAndSpecularColor(base_color, metallic, diffuse_color, specular_color);
 
-    float3 incident_direction = normalize(-g_LightDirection.xyz);
+    float3 surface_position_world_space = in_interpolated_position_world_space;
 
-    float3 E_l;
+    // the material is kept for the light injection (MyLightInjectionCS) when only the light changes
+    [branch] if (0u != g_WriteVoxelSurface)
     {
-        float3 L = incident_direction;
-        float3 N = shading_normal_world_space;
+        uint3 voxel_surface_coordinates;
+        if (GetVoxelSurfaceCoordinates(surface_position_world_space, in_clipmap_stack_level_index, voxel_surface_coordinates))
+        {
+            u_VoxelSurface[voxel_surface_coordinates] = PackVoxelSurface(base_color, metallic, shading_normal_world_space, roughness);
+        }
+    }
 
-        float NdotL = dot(N, L);
+    float3 incident_direction = normalize(-g_LightDirection.xyz);
 
-        [branch] if (NdotL > 0.0)
-        {
-            float shadow = GetShadow(surface_position_world_space);
+    float3 E_l = GetIncidentLight(surface_position_world_space, shading_normal_world_space);
 
-            E_l = g_LightColor.rgb * shadow;
-        }
-        else
-        {
-            E_l = float3(0.0, 0.0, 0.0);
-        }
+    [branch] if (0u != g_VoxelStatisticsEnable)
+    {
+        InterlockedAdd(u_VoxelStatistics[VOXEL_STATISTICS_COUNTER_COUNT * in_clipmap_stack_level_index + VOXEL_STATISTICS_COUNTER_WRITTEN_FRAGMENTS], 1u);
     }
 
     brx_voxel_cone_tracing_voxelization_store_data(
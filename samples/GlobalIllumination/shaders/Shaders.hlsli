@@ -70,9 +70,9 @@ void DefaultVS(
 
 void MyVoxelizationVS(
     in uint in_vertex_id : SV_VertexID,
-    in uint in_instance_id : SV_InstanceID,
+    in uint2 in_clipmap_instance : CLIPMAP_INSTANCE,
     out float4 out_position : SV_Position,
-    out float out_cull_distance[2] : SV_CullDistance,
+    out float out_cull_distance[3] : SV_CullDistance,
     out nointerpolation int out_viewport_depth_direction_index : LOCATION0,
     out nointerpolation int out_clipmap_stack_level_index : LOCATION1,
     out float3 out_vertex_position_world_space : LOCATION2,
@@ -81,37 +81,11 @@ void MyVoxelizationVS(
     out float2 out_vertex_texcoord : LOCATION5)
 {
 
-    brx_uint3 triangle_vertex_indices;
-    {
-        brx_uint triangle_index = in_vertex_id / 3u;
-        brx_uint index_buffer_offset = (SURFACE_UINT32_INDEX_BUFFER_STRIDE * 3u) * triangle_index;
-        triangle_vertex_indices = brx_byte_address_buffer_load3(g_index_buffer, index_buffer_offset);
-    }
-
-    brx_float3 triangle_vertices_position_model_space[3];
-    {
-        brx_uint3 vertex_position_buffer_offset = SURFACE_VERTEX_POSITION_BUFFER_STRIDE * triangle_vertex_indices;
-
-        brx_uint3 packed_vector_vertices_position_binding[3];
-        packed_vector_vertices_position_binding[0] = brx_byte_address_buffer_load3(g_vertex_position_buffer, vertex_position_buffer_offset.x);
-        packed_vector_vertices_position_binding[1] = brx_byte_address_buffer_load3(g_vertex_position_buffer, vertex_position_buffer_offset.y);
-        packed_vector_vertices_position_binding[2] = brx_byte_address_buffer_load3(g_vertex_position_buffer, vertex_position_buffer_offset.z);
-
-        triangle_vertices_position_model_space[0] = brx_uint_as_float(packed_vector_vertices_position_binding[0]);
-        triangle_vertices_position_model_space[1] = brx_uint_as_float(packed_vector_vertices_position_binding[1]);
-        triangle_vertices_position_model_space[2] = brx_uint_as_float(packed_vector_vertices_position_binding[2]);
-    }
-
-    brx_float3 triangle_vertices_position_world_space[3];
-    {
-        triangle_vertices_position_world_space[0] = mul(float4(triangle_vertices_position_model_space[0], 1.0), g_WorldMatrix).xyz;
-        triangle_vertices_position_world_space[1] = mul(float4(triangle_vertices_position_model_space[1], 1.0), g_WorldMatrix).xyz;
-        triangle_vertices_position_world_space[2] = mul(float4(triangle_vertices_position_model_space[2], 1.0), g_WorldMatrix).xyz;
-    }
-
-    brx_int viewport_depth_direction_index = brx_voxel_cone_tracing_voxelization_compute_viewport_depth_direction_index(triangle_vertices_position_world_space[0], triangle_vertices_position_world_space[1], triangle_vertices_position_world_space[2]);
-
-    brx_int clipmap_stack_level_index = in_instance_id;
+    // the triangles are sorted by the dominant axis of the face normal at load time (Scene::GetMeshDominantAxisDrawArguments)
+    // SV_InstanceID does NOT include the StartInstanceLocation
+    // both the viewport depth direction and the stack level are fetched from the per-instance vertex buffer instead, so that the draw call can skip the stack levels which the triangles do not overlap
+    brx_int viewport_depth_direction_index = in_clipmap_instance.x;
+    brx_int clipmap_stack_level_index = in_clipmap_instance.y;
 
     brx_uint vertex_index;
     {
@@ -146,12 +120,22 @@ void MyVoxelizationVS(
 
     brx_float2 cull_distance = brx_voxel_cone_tracing_voxelization_compute_cull_distance(vertex_position_clip_space);
 
+    // the inner half of the coarser stack levels is derived from the finer stack level (MyClipmapDownsampleCS), thus the triangles inside the inner half (with one voxel of margin) are culled
+    brx_float inner_cull_distance = 1.0;
+    if ((0u != g_DeriveCoarseStackLevels) && (clipmap_stack_level_index > 0))
+    {
+        brx_float3 inner_half_extent = brx_float3(0.5 - 2.0 / brx_float(BRX_VCT_CLIPMAP_MAP_SIZE), 0.5 - 2.0 / brx_float(BRX_VCT_CLIPMAP_MAP_SIZE), 0.25 - 1.0 / brx_float(BRX_VCT_CLIPMAP_MAP_SIZE));
+        brx_float3 inner_distance = abs(vertex_position_clip_space.xyz / vertex_position_clip_space.w - brx_float3(0.0, 0.0, 0.5)) - inner_half_extent;
+        inner_cull_distance = max(inner_distance.x, max(inner_distance.y, inner_distance.z));
+    }
+
     brx_float3 vertex_normal_world_space = mul(float4(vertex_normal_model_space, 0.0), g_WorldMatrix).xyz;
     brx_float4 vertex_tangent_world_space = float4(mul(float4(vertex_tangent_model_space.xyz, 0.0), g_WorldMatrix).xyz, vertex_tangent_model_space.w);
 
     out_position = vertex_position_clip_space;
     out_cull_distance[0] = cull_distance.x;
     out_cull_distance[1] = cull_distance.y;
+    out_cull_distance[2] = inner_cull_distance;
     out_viewport_depth_direction_index = viewport_depth_direction_index;
     out_clipmap_stack_level_index = clipmap_stack_level_index;
     out_vertex_position_world_space = vertex_position_world_space;
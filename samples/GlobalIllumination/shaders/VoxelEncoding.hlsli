@@ -0,0 +1,96 @@
+#ifndef _VOXEL_ENCODING_HLSLI_
+#define _VOXEL_ENCODING_HLSLI_ 1
+
+// the compact encodings of the voxels (see "VoxelEncoding.h" for the CPU reference, which packs exactly the same)
+
+#define VOXEL_RADIANCE_ENCODING_FIXED_POINT_R32G32B32 0
+#define VOXEL_RADIANCE_ENCODING_RGB9E5 1
+#define VOXEL_RADIANCE_ENCODING_R11G11B10 2
+
+// the floor of log2 of a positive normal float
+int GetFloatExponent(float f)
+{
+    return int((asuint(f) >> 23u) & 0xFFu) - 127;
+}
+
+// EXT_texture_shared_exponent
+uint PackVoxelRadianceRGB9E5(float3 radiance)
+{
+    const float max_value = (511.0 / 512.0) * 65536.0;
+
+    float3 rgb = clamp(radiance, 0.0, max_value);
+
+    float max_channel = max(max(rgb.r, rgb.g), rgb.b);
+
+    [branch] if (!(max_channel > 0.0))
+    {
+        return 0u;
+    }
+
+    int shared_exponent = max(-15 - 1, GetFloatExponent(max_channel)) + 1 + 15;
+    [flatten] if (floor(max_channel / ldexp(1.0, shared_exponent - 15 - 9) + 0.5) >= 512.0)
+    {
+        ++shared_exponent;
+    }
+
+    float scale = ldexp(1.0, shared_exponent - 15 - 9);
+
+    uint3 mantissa = min(uint3(floor(rgb / scale + 0.5)), uint3(511u, 511u, 511u));
+
+    return mantissa.r | (mantissa.g << 9u) | (mantissa.b << 18u) | (uint(shared_exponent) << 27u);
+}
+
+float3 UnpackVoxelRadianceRGB9E5(uint packed_radiance)
+{
+    float scale = ldexp(1.0, int(packed_radiance >> 27u) - 15 - 9);
+
+    return float3(packed_radiance & 0x1FFu, (packed_radiance >> 9u) & 0x1FFu, (packed_radiance >> 18u) & 0x1FFu) * scale;
+}
+
+// the unsigned float of "R11G11B10_FLOAT": 5 bits of exponent (bias 15) and "mantissa_bits" of mantissa, rounded to the nearest
+uint PackUnsignedSmallFloat(float value, uint mantissa_bits)
+{
+    [branch] if (!(value > 0.0))
+    {
+        return 0u;
+    }
+
+    uint max_packed = (30u << mantissa_bits) | ((1u << mantissa_bits) - 1u);
+
+    int exponent = GetFloatExponent(value) + 15;
+
+    [branch] if (exponent <= 0)
+    {
+        // denormal
+        return min(uint(floor(ldexp(value, 14 + int(mantissa_bits)) + 0.5)), max_packed);
+    }
+
+    uint mantissa = asuint(value) & 0x7FFFFFu;
+    uint shift = 23u - mantissa_bits;
+
+    // the carry of the rounding increments the exponent
+    return min((uint(exponent) << mantissa_bits) + ((mantissa + (1u << (shift - 1u))) >> shift), max_packed);
+}
+
+float UnpackUnsignedSmallFloat(uint packed, uint mantissa_bits)
+{
+    uint exponent = packed >> mantissa_bits;
+    uint mantissa = packed & ((1u << mantissa_bits) - 1u);
+
+    return (0u == exponent) ? ldexp(float(mantissa), -14 - int(mantissa_bits)) : ldexp(1.0 + float(mantissa) / float(1u << mantissa_bits), int(exponent) - 15);
+}
+
+uint PackVoxelRadianceR11G11B10(float3 radiance)
+{
+    return PackUnsignedSmallFloat(radiance.r, 6u) | (PackUnsignedSmallFloat(radiance.g, 6u) << 11u) | (PackUnsignedSmallFloat(radiance.b, 5u) << 22u);
+}
+
+float3 UnpackVoxelRadianceR11G11B10(uint packed_radiance)
+{
+    return float3(
+        UnpackUnsignedSmallFloat(packed_radiance & 0x7FFu, 6u),
+        UnpackUnsignedSmallFloat((packed_radiance >> 11u) & 0x7FFu, 6u),
+        UnpackUnsignedSmallFloat((packed_radiance >> 22u) & 0x3FFu, 5u));
+}
+
+#endif
@@ -0,0 +1,164 @@
+#ifndef _VOXEL_LIGHTING_HLSLI_
+#define _VOXEL_LIGHTING_HLSLI_ 1
+
+// shared by the voxelization pixel shader and the light injection compute shader
+// the "GlobalConstants", "g_shadow_map" and "g_shadow_sampler" should be declared before this file is included
+
+float GetShadow(float3 fragmentPos)
+{
+    static const float2 g_SamplePositions[] = {
+        // Poisson disk with 16 points
+        float2(-0.3935238f, 0.7530643f),
+        float2(-0.3022015f, 0.297664f),
+        float2(0.09813362f, 0.192451f),
+        float2(-0.7593753f, 0.518795f),
+        float2(0.2293134f, 0.7607011f),
+        float2(0.6505286f, 0.6297367f),
+        float2(0.5322764f, 0.2350069f),
+        float2(0.8581018f, -0.01624052f),
+        float2(-0.6928226f, 0.07119545f),
+        float2(-0.3114384f, -0.3017288f),
+        float2(0.2837671f, -0.179743f),
+        float2(-0.3093514f, -0.749256f),
+        float2(-0.7386893f, -0.5215692f),
+        float2(0.3988827f, -0.617012f),
+        float2(0.8114883f, -0.458026f),
+        float2(0.08265103f, -0.8939569f)};
+
+    fragmentPos -= g_LightDirection.xyz * 1.0f;
+
+    float4 clipPos = mul(float4(fragmentPos, 1.0f), g_LightViewProjMatrix);
+
+    if (abs(clipPos.x) > clipPos.w || abs(clipPos.y) > clipPos.w || clipPos.z <= 0)
+    {
+        return 0;
+    }
+
+    clipPos.xyz /= clipPos.w;
+    clipPos.x = clipPos.x * 0.5f + 0.5f;
+    clipPos.y = 0.5f - clipPos.y * 0.5f;
+
+    float shadow = 0;
+    float totalWeight = 0;
+
+    for (int nSample = 0; nSample < 16; ++nSample)
+    {
+        float2 offset = g_SamplePositions[nSample];
+        float weight = 1.0;
+        offset *= 2 * g_rShadowMapSize;
+        float sample = g_shadow_map.SampleCmpLevelZero(g_shadow_sampler, clipPos.xy + offset, clipPos.z);
+        shadow += sample * weight;
+        totalWeight += weight;
+    }
+
+    shadow /= totalWeight;
+    shadow = pow(shadow, 2.2);
+
+    return shadow;
+}
+
+float3 GetIncidentLight(float3 surface_position_world_space, float3 shading_normal_world_space)
+{
+    float3 L = normalize(-g_LightDirection.xyz);
+    float3 N = shading_normal_world_space;
+
+    float NdotL = dot(N, L);
+
+    float3 E_l;
+    [branch] if (NdotL > 0.0)
+    {
+        float shadow = GetShadow(surface_position_world_space);
+
+        E_l = g_LightColor.rgb * shadow;
+    }
+    else
+    {
+        E_l = float3(0.0, 0.0, 0.0);
+    }
+
+    return E_l;
+}
+
+void GetDiffuseAndSpecularColor(float3 base_color, float metallic, out float3 diffuse_color, out float3 specular_color)
+{
+    // UE4: https://github.com/EpicGames/UnrealEngine/blob/4.21/Engine/Shaders/Private/MobileBasePassPixelShader.usf#L376
+    const float dielectric_specular = 0.04;
+
+    specular_color = clamp((dielectric_specular - dielectric_specular * metallic) + base_color * metallic, 0.0, 1.0);
+    diffuse_color = clamp(base_color - base_color * metallic, 0.0, 1.0);
+}
+
+// The voxel surface texture stores the material of the last fragment voxelized into each voxel, so that the illumination can be injected again without the geometry.
+// The texture is "BRX_VCT_CLIPMAP_MAP_SIZE" x "BRX_VCT_CLIPMAP_MAP_SIZE" x ("BRX_VCT_CLIPMAP_MAP_SIZE" * "BRX_VCT_CLIPMAP_STACK_LEVEL_COUNT") and the stack levels are stacked along the Z axis.
+// x: base color (RGB8), metallic (7 bits) and the valid bit
+// y: octahedral normal (2 x 12 bits) and roughness (8 bits)
+
+float2 OctahedralEncode(float3 n)
+{
+    n /= (abs(n.x) + abs(n.y) + abs(n.z));
+    float2 p = n.xy;
+    if (n.z < 0.0)
+    {
+        p = (float2(1.0, 1.0) - abs(p.yx)) * float2((p.x >= 0.0) ? 1.0 : -1.0, (p.y >= 0.0) ? 1.0 : -1.0);
+    }
+    return p;
+}
+
+float3 OctahedralDecode(float2 p)
+{
+    float3 n = float3(p.x, p.y, 1.0 - abs(p.x) - abs(p.y));
+    float t = saturate(-n.z);
+    n.x += (n.x >= 0.0) ? -t : t;
+    n.y += (n.y >= 0.0) ? -t : t;
+    return normalize(n);
+}
+
+uint2 PackVoxelSurface(float3 base_color, float metallic, float3 normal, float roughness)
+{
+    uint3 packed_base_color = uint3(round(saturate(base_color) * 255.0));
+    uint packed_metallic = uint(round(saturate(metallic) * 127.0));
+    uint2 packed_normal = uint2(round((OctahedralEncode(normal) * 0.5 + 0.5) * 4095.0));
+    uint packed_roughness = uint(round(saturate(roughness) * 255.0));
+
+    return uint2(
+        packed_base_color.x | (packed_base_color.y << 8) | (packed_base_color.z << 16) | (packed_metallic << 24) | (1u << 31),
+        packed_normal.x | (packed_normal.y << 12) | (packed_roughness << 24));
+}
+
+bool IsVoxelSurfaceValid(uint2 packed_surface)
+{
+    return (0u != (packed_surface.x & (1u << 31)));
+}
+
+void UnpackVoxelSurface(uint2 packed_surface, out float3 base_color, out float metallic, out float3 normal, out float roughness)
+{
+    base_color = float3(packed_surface.x & 0xFFu, (packed_surface.x >> 8) & 0xFFu, (packed_surface.x >> 16) & 0xFFu) / 255.0;
+    metallic = float((packed_surface.x >> 24) & 0x7Fu) / 127.0;
+    normal = OctahedralDecode(float2(packed_surface.y & 0xFFFu, (packed_surface.y >> 12) & 0xFFFu) / 4095.0 * 2.0 - 1.0);
+    roughness = float((packed_surface.y >> 24) & 0xFFu) / 255.0;
+}
+
+float GetStackLevelVoxelSize(int clipmap_stack_level_index)
+{
+    return BRX_VCT_CLIPMAP_FINEST_VOXEL_SIZE * float(1u << clipmap_stack_level_index);
+}
+
+bool GetVoxelSurfaceCoordinates(float3 position_world_space, int clipmap_stack_level_index, out uint3 coordinates)
+{
+    int3 voxel = int3(floor((position_world_space - g_clipmap_center.xyz) / GetStackLevelVoxelSize(clipmap_stack_level_index) + 0.5 * float(BRX_VCT_CLIPMAP_MAP_SIZE)));
+
+    coordinates = uint3(voxel.x, voxel.y, voxel.z + clipmap_stack_level_index * BRX_VCT_CLIPMAP_MAP_SIZE);
+
+    return all(voxel >= int3(0, 0, 0)) && all(voxel < int3(BRX_VCT_CLIPMAP_MAP_SIZE, BRX_VCT_CLIPMAP_MAP_SIZE, BRX_VCT_CLIPMAP_MAP_SIZE));
+}
+
+float3 GetVoxelSurfacePosition(uint3 coordinates, out int clipmap_stack_level_index)
+{
+    clipmap_stack_level_index = int(coordinates.z / BRX_VCT_CLIPMAP_MAP_SIZE);
+
+    float3 voxel = float3(coordinates.x, coordinates.y, coordinates.z - clipmap_stack_level_index * BRX_VCT_CLIPMAP_MAP_SIZE) + 0.5;
+
+    return g_clipmap_center.xyz + (voxel - 0.5 * float(BRX_VCT_CLIPMAP_MAP_SIZE)) * GetStackLevelVoxelSize(clipmap_stack_level_index);
+}
+
+#endif
@@ -1,8 +1,10 @@
 #include "Scene.h"
+#include "ContentHash.h"
 #include <stdexcept>
 #include <iostream>
 #include <cmath>
 #include <cassert>
+#include <algorithm>
 #include <DirectXPackedVector.h>
 #include "../../thirdparty/Brioche-Shader-Language/include/brx_packed_vector.h"
 #include "../../thirdparty/Environment-Lighting/include/brx_octahedral_mapping.h"
@@ -48,6 +50,7 @@ struct VertexVaryingBufferEntry
 HRESULT Scene::Load(const char *fileName, uint32_t flags)
 {
     m_ScenePath = fileName;
+    m_LoadFlags = flags;
 
     return S_OK;
 }
@@ -67,6 +70,11 @@ uint32_t Scene::GetMeshesNum() const
     return this->m_NumMeshes;
 }
 
+uint64_t Scene::GetContentHash() const
+{
+    return this->m_ContentHash;
+}
+
 VXGI::Box3f Scene::GetSceneBounds() const
 {
     assert(m_MeshBounds.empty() == false);
@@ -74,7 +82,7 @@ VXGI::Box3f Scene::GetSceneBounds() const
     return m_SceneBounds;
 }
 
-NVRHI::TextureHandle Scene::LoadTextureFromFile(const char *name, bool force_srgb)
+std::string Scene::GetTexturePath(const char *name) const
 {
     std::string str_path = GetScenePath();
     {
@@ -84,20 +92,19 @@ NVRHI::TextureHandle Scene::LoadTextureFromFile(const char *name, bool force_srg
         str_path += name;
     }
 
-    return this->LoadTextureFromFileInternal(str_path.c_str(), force_srgb);
+    return str_path;
 }
 
-NVRHI::TextureHandle Scene::LoadTextureFromFileInternal(const char *name, bool force_srgb)
+NVRHI::TextureHandle Scene::LoadTextureFromFile(const char *name, bool force_srgb, uint64_t *content_hash)
 {
-    NVRHI::TextureHandle texture = m_LoadedTextures[name];
-    if (texture)
-    {
-        return texture;
-    }
+    return this->LoadTextureFromFileInternal(GetTexturePath(name).c_str(), force_srgb, content_hash);
+}
+
+bool Scene::LoadImageFromFile(const char *name, std::vector<uint32_t> &pixel_data, uint32_t &pixel_data_width, uint32_t &pixel_data_height)
+{
+    pixel_data_width = 0U;
+    pixel_data_height = 0U;
 
-    std::vector<uint32_t> pixel_data;
-    uint32_t pixel_data_width;
-    uint32_t pixel_data_height;
     {
         std::vector<uint8_t> file_data;
         {
@@ -300,6 +307,72 @@ NVRHI::TextureHandle Scene::LoadTextureFromFileInternal(const char *name, bool f
         }
     }
 
+    return (0U != pixel_data_width);
+}
+
+NVRHI::TextureHandle Scene::LoadTextureFromFileInternal(const char *name, bool force_srgb, uint64_t *content_hash)
+{
+    NVRHI::TextureHandle texture = m_LoadedTextures[name];
+    if (texture)
+    {
+        if (NULL != content_hash)
+        {
+            std::map<std::string, uint64_t>::const_iterator const found_hash = m_LoadedTextureHashes.find(name);
+            if (found_hash != m_LoadedTextureHashes.end())
+            {
+                (*content_hash) = found_hash->second;
+            }
+            else
+            {
+                // the texture was loaded before without the hash
+                std::vector<uint32_t> pixel_data;
+                uint32_t pixel_data_width;
+                uint32_t pixel_data_height;
+                LoadImageFromFile(name, pixel_data, pixel_data_width, pixel_data_height);
+
+                (*content_hash) = HashContentData(pixel_data.data(), sizeof(uint32_t) * pixel_data.size());
+                m_LoadedTextureHashes[name] = (*content_hash);
+            }
+        }
+
+        return texture;
+    }
+
+    // without the renderer only the hash is needed, and the image is not decoded again for the meshes sharing it
+    if (NULL == m_Renderer)
+    {
+        if (NULL != content_hash)
+        {
+            std::map<std::string, uint64_t>::const_iterator const found_hash = m_LoadedTextureHashes.find(name);
+            if (found_hash != m_LoadedTextureHashes.end())
+            {
+                (*content_hash) = found_hash->second;
+                return texture;
+            }
+        }
+        else
+        {
+            return texture;
+        }
+    }
+
+    std::vector<uint32_t> pixel_data;
+    uint32_t pixel_data_width;
+    uint32_t pixel_data_height;
+    LoadImageFromFile(name, pixel_data, pixel_data_width, pixel_data_height);
+
+    // the texels are only hashed for the callers which need the hash, since the hash costs a pass over the whole image
+    if (NULL != content_hash)
+    {
+        (*content_hash) = HashContentData(pixel_data.data(), sizeof(uint32_t) * pixel_data.size());
+        m_LoadedTextureHashes[name] = (*content_hash);
+    }
+
+    if (NULL == m_Renderer)
+    {
+        return texture;
+    }
+
     NVRHI::TextureDesc textureDesc;
     textureDesc.width = pixel_data_width;
     textureDesc.height = pixel_data_height;
@@ -346,6 +419,8 @@ HRESULT Scene::InitResources(NVRHI::IRendererInterface *pRenderer)
     assert(0U == this->m_NumMeshes);
     this->m_NumMeshes = mesh->primitives_count;
 
+    this->m_ContentHash = HashContentData(this->m_ScenePath.data(), this->m_ScenePath.size());
+
     float const maxFloat = 3.402823466e+38F;
     VXGI::float3 const _minBoundary(maxFloat, maxFloat, maxFloat);
     VXGI::float3 const _maxBoundary(-maxFloat, -maxFloat, -maxFloat);
@@ -361,6 +436,37 @@ HRESULT Scene::InitResources(NVRHI::IRendererInterface *pRenderer)
     assert(this->m_VertexCounts.empty());
     this->m_VertexCounts.resize(mesh->primitives_count);
 
+    assert(this->m_MeshDynamic.empty());
+    this->m_MeshDynamic.resize(mesh->primitives_count, false);
+
+    assert(this->m_MeshAlphaTested.empty());
+    this->m_MeshAlphaTested.resize(mesh->primitives_count, false);
+
+    bool const dominant_axis_binning = (0U != (this->m_LoadFlags & LOAD_DOMINANT_AXIS_BINNING));
+    bool const cpu_geometry = (0U != (this->m_LoadFlags & LOAD_CPU_GEOMETRY));
+
+    assert(this->m_DominantAxisIndexStarts.empty());
+    assert(this->m_DominantAxisIndexCounts.empty());
+    assert(this->m_DominantAxisBounds.empty());
+    if (dominant_axis_binning)
+    {
+        this->m_DominantAxisIndexStarts.resize(mesh->primitives_count * DOMINANT_AXIS_COUNT);
+        this->m_DominantAxisIndexCounts.resize(mesh->primitives_count * DOMINANT_AXIS_COUNT);
+        this->m_DominantAxisBounds.resize(mesh->primitives_count * DOMINANT_AXIS_COUNT);
+    }
+
+    assert(this->m_CpuPositions.empty());
+    assert(this->m_CpuTexcoords.empty());
+    assert(this->m_CpuIndices.empty());
+    assert(this->m_CpuBaseColorImageNames.empty());
+    if (cpu_geometry)
+    {
+        this->m_CpuPositions.resize(mesh->primitives_count);
+        this->m_CpuTexcoords.resize(mesh->primitives_count);
+        this->m_CpuIndices.resize(mesh->primitives_count);
+        this->m_CpuBaseColorImageNames.resize(mesh->primitives_count);
+    }
+
     assert(this->m_IndexBuffers.empty());
     this->m_IndexBuffers.resize(mesh->primitives_count);
     assert(this->m_VertexPositionBuffers.empty());
@@ -690,11 +796,14 @@ HRESULT Scene::InitResources(NVRHI::IRendererInterface *pRenderer)
         float metallic_factor = 0.0F;
         float roughness_factor = 0.0F;
         std::string metallic_roughness_texture_image_uri;
+        bool alpha_tested = false;
         {
             cgltf_primitive const *const primitive = &mesh->primitives[primitive_index];
 
             cgltf_material const *const material = primitive->material;
 
+            alpha_tested = (cgltf_alpha_mode_opaque != material->alpha_mode);
+
             if (NULL != material->normal_texture.texture)
             {
                 cgltf_image const *const normal_texture_image = material->normal_texture.texture->image;
@@ -885,21 +994,109 @@ HRESULT Scene::InitResources(NVRHI::IRendererInterface *pRenderer)
         this->m_SceneBounds.upper.y = __max(this->m_SceneBounds.upper.y, this->m_MeshBounds[mesh_id].upper.y);
         this->m_SceneBounds.upper.z = __max(this->m_SceneBounds.upper.z, this->m_MeshBounds[mesh_id].upper.z);
 
-        NVRHI::BufferDesc indexBufferDesc;
-        indexBufferDesc.isIndexBuffer = true;
-        indexBufferDesc.byteSize = index_count * sizeof(uint32_t);
-        this->m_IndexBuffers[mesh_id] = this->m_Renderer->createBuffer(indexBufferDesc, indices.data());
+        // Dominant Axis Binning
+        if (dominant_axis_binning)
+        {
+            // the projection of the voxelization is selected by the dominant axis of the face normal
+            // the triangles are sorted at load time and thus the projection can be fixed per draw call instead of selected per triangle on the GPU
+            // the world matrix is assumed to not rotate the mesh, which is true for both the opaque scene and the transparent scene
+            std::vector<uint32_t> binned_indices[DOMINANT_AXIS_COUNT];
+
+            for (uint32_t axis = 0U; axis < DOMINANT_AXIS_COUNT; ++axis)
+            {
+                this->m_DominantAxisBounds[DOMINANT_AXIS_COUNT * mesh_id + axis].lower = _minBoundary;
+                this->m_DominantAxisBounds[DOMINANT_AXIS_COUNT * mesh_id + axis].upper = _maxBoundary;
+            }
+
+            for (size_t triangle_index = 0U; (triangle_index * 3U) < index_count; ++triangle_index)
+            {
+                DirectX::XMVECTOR const triangle_vertices_position[3] = {
+                    DirectX::XMLoadFloat3(reinterpret_cast<DirectX::XMFLOAT3 const *>(vertices_position[indices[triangle_index * 3U]].position)),
+                    DirectX::XMLoadFloat3(reinterpret_cast<DirectX::XMFLOAT3 const *>(vertices_position[indices[triangle_index * 3U + 1U]].position)),
+                    DirectX::XMLoadFloat3(reinterpret_cast<DirectX::XMFLOAT3 const *>(vertices_position[indices[triangle_index * 3U + 2U]].position))};
+
+                DirectX::XMFLOAT3 face_normal;
+                DirectX::XMStoreFloat3(&face_normal, DirectX::XMVectorAbs(DirectX::XMVector3Cross(DirectX::XMVectorSubtract(triangle_vertices_position[1], triangle_vertices_position[0]), DirectX::XMVectorSubtract(triangle_vertices_position[2], triangle_vertices_position[0]))));
+
+                uint32_t const axis = ((face_normal.x > face_normal.y) && (face_normal.x > face_normal.z)) ? 0U : ((face_normal.y > face_normal.z) ? 1U : 2U);
+
+                VXGI::Box3f &axis_bounds = this->m_DominantAxisBounds[DOMINANT_AXIS_COUNT * mesh_id + axis];
+
+                for (uint32_t vertex_index = 0U; vertex_index < 3U; ++vertex_index)
+                {
+                    uint32_t const index = indices[triangle_index * 3U + vertex_index];
+
+                    binned_indices[axis].push_back(index);
 
-        NVRHI::BufferDesc vertexPositionBufferDesc;
-        vertexPositionBufferDesc.isVertexBuffer = true;
-        vertexPositionBufferDesc.byteSize = vertex_count * sizeof(VertexPositionBufferEntry);
-        this->m_VertexPositionBuffers[mesh_id] = this->m_Renderer->createBuffer(vertexPositionBufferDesc, vertices_position.data());
+                    axis_bounds.lower.x = __min(axis_bounds.lower.x, vertices_position[index].position[0]);
+                    axis_bounds.lower.y = __min(axis_bounds.lower.y, vertices_position[index].position[1]);
+                    axis_bounds.lower.z = __min(axis_bounds.lower.z, vertices_position[index].position[2]);
 
-        NVRHI::BufferDesc vertexVaryingBufferDesc;
-        vertexVaryingBufferDesc.canHaveUAVs = true;
-        vertexVaryingBufferDesc.isVertexBuffer = true;
-        vertexVaryingBufferDesc.byteSize = vertex_count * sizeof(VertexVaryingBufferEntry);
-        this->m_VertexVaryingBuffers[mesh_id] = this->m_Renderer->createBuffer(vertexVaryingBufferDesc, vertices_varying.data());
+                    axis_bounds.upper.x = __max(axis_bounds.upper.x, vertices_position[index].position[0]);
+                    axis_bounds.upper.y = __max(axis_bounds.upper.y, vertices_position[index].position[1]);
+                    axis_bounds.upper.z = __max(axis_bounds.upper.z, vertices_position[index].position[2]);
+                }
+            }
+
+            uint32_t index_start = 0U;
+            for (uint32_t axis = 0U; axis < DOMINANT_AXIS_COUNT; ++axis)
+            {
+                this->m_DominantAxisIndexStarts[DOMINANT_AXIS_COUNT * mesh_id + axis] = index_start;
+                this->m_DominantAxisIndexCounts[DOMINANT_AXIS_COUNT * mesh_id + axis] = static_cast<uint32_t>(binned_indices[axis].size());
+
+                std::copy(binned_indices[axis].begin(), binned_indices[axis].end(), indices.begin() + index_start);
+                index_start += static_cast<uint32_t>(binned_indices[axis].size());
+            }
+
+            assert(index_start == index_count);
+        }
+
+        if (NULL != this->m_Renderer)
+        {
+            NVRHI::BufferDesc indexBufferDesc;
+            indexBufferDesc.isIndexBuffer = true;
+            indexBufferDesc.byteSize = index_count * sizeof(uint32_t);
+            this->m_IndexBuffers[mesh_id] = this->m_Renderer->createBuffer(indexBufferDesc, indices.data());
+
+            NVRHI::BufferDesc vertexPositionBufferDesc;
+            vertexPositionBufferDesc.isVertexBuffer = true;
+            vertexPositionBufferDesc.byteSize = vertex_count * sizeof(VertexPositionBufferEntry);
+            this->m_VertexPositionBuffers[mesh_id] = this->m_Renderer->createBuffer(vertexPositionBufferDesc, vertices_position.data());
+
+            NVRHI::BufferDesc vertexVaryingBufferDesc;
+            vertexVaryingBufferDesc.canHaveUAVs = true;
+            vertexVaryingBufferDesc.isVertexBuffer = true;
+            vertexVaryingBufferDesc.byteSize = vertex_count * sizeof(VertexVaryingBufferEntry);
+            this->m_VertexVaryingBuffers[mesh_id] = this->m_Renderer->createBuffer(vertexVaryingBufferDesc, vertices_varying.data());
+        }
+
+        if (cpu_geometry)
+        {
+            std::vector<float> &cpu_positions = this->m_CpuPositions[mesh_id];
+            std::vector<float> &cpu_texcoords = this->m_CpuTexcoords[mesh_id];
+            cpu_positions.resize(3U * vertex_count);
+            cpu_texcoords.resize(2U * vertex_count);
+            for (size_t vertex_index = 0; vertex_index < vertex_count; ++vertex_index)
+            {
+                std::copy(vertices_position[vertex_index].position, vertices_position[vertex_index].position + 3, &cpu_positions[3U * vertex_index]);
+                cpu_texcoords[2U * vertex_index + 0U] = raw_texcoords[vertex_index].x;
+                cpu_texcoords[2U * vertex_index + 1U] = raw_texcoords[vertex_index].y;
+            }
+
+            this->m_CpuIndices[mesh_id] = indices;
+        }
+
+        this->m_ContentHash = HashContentData(indices.data(), sizeof(uint32_t) * indices.size(), this->m_ContentHash);
+        this->m_ContentHash = HashContentData(vertices_position.data(), sizeof(VertexPositionBufferEntry) * vertices_position.size(), this->m_ContentHash);
+        this->m_ContentHash = HashContentData(vertices_varying.data(), sizeof(VertexVaryingBufferEntry) * vertices_varying.size(), this->m_ContentHash);
+
+        // the voxelization reads the material, the fields are hashed one by one since the padding is undefined
+        this->m_ContentHash = HashContentData(&base_color_factor, sizeof(base_color_factor), this->m_ContentHash);
+        this->m_ContentHash = HashContentData(&emissive_factor, sizeof(emissive_factor), this->m_ContentHash);
+        this->m_ContentHash = HashContentData(&metallic_factor, sizeof(metallic_factor), this->m_ContentHash);
+        this->m_ContentHash = HashContentData(&roughness_factor, sizeof(roughness_factor), this->m_ContentHash);
+        uint8_t const alpha_tested_byte = alpha_tested ? 1U : 0U;
+        this->m_ContentHash = HashContentData(&alpha_tested_byte, sizeof(alpha_tested_byte), this->m_ContentHash);
 
         assert(1.0 == normal_texture_scale);
 
@@ -917,10 +1114,26 @@ HRESULT Scene::InitResources(NVRHI::IRendererInterface *pRenderer)
 
         this->m_DiffuseColors[mesh_id] = VXGI::float3(base_color_factor.x, base_color_factor.y, base_color_factor.z);
 
+        this->m_MeshAlphaTested[mesh_id] = alpha_tested;
+
         // TODO: why not srgb
         if (!base_color_texture_image_uri.empty())
         {
-            this->m_DiffuseTextures[mesh_id] = LoadTextureFromFile(base_color_texture_image_uri.c_str(), false);
+            uint64_t base_color_texture_hash = 0U;
+            this->m_DiffuseTextures[mesh_id] = LoadTextureFromFile(base_color_texture_image_uri.c_str(), false, &base_color_texture_hash);
+            this->m_ContentHash = HashContentData(&base_color_texture_hash, sizeof(base_color_texture_hash), this->m_ContentHash);
+
+            if (cpu_geometry)
+            {
+                std::string const base_color_texture_path = GetTexturePath(base_color_texture_image_uri.c_str());
+                if (this->m_CpuImages.end() == this->m_CpuImages.find(base_color_texture_path))
+                {
+                    CpuImage &image = this->m_CpuImages[base_color_texture_path];
+                    LoadImageFromFile(base_color_texture_path.c_str(), image.texels, image.width, image.height);
+                }
+
+                this->m_CpuBaseColorImageNames[mesh_id] = base_color_texture_path;
+            }
         }
 
         this->m_SpecularColors[mesh_id] = VXGI::float3(0.0, roughness_factor, metallic_factor);
@@ -944,6 +1157,7 @@ void Scene::ReleaseResources()
     m_EmissiveTextures.clear();
 
     m_LoadedTextures.clear();
+    m_LoadedTextureHashes.clear();
 }
 
 NVRHI::BufferHandle Scene::GetIndexBuffer(uint32_t meshID) const
@@ -972,6 +1186,24 @@ NVRHI::DrawArguments Scene::GetMeshDrawArguments(uint32_t meshID) const
     return args;
 }
 
+NVRHI::DrawArguments Scene::GetMeshDominantAxisDrawArguments(uint32_t meshID, uint32_t axis) const
+{
+    assert(axis < DOMINANT_AXIS_COUNT);
+    assert((DOMINANT_AXIS_COUNT * meshID + axis) < this->m_DominantAxisIndexCounts.size());
+
+    NVRHI::DrawArguments args;
+
+    // the vertex shader fetches the indices from the index buffer by the SV_VertexID which includes the StartVertexLocation
+    if ((DOMINANT_AXIS_COUNT * meshID + axis) < this->m_DominantAxisIndexCounts.size())
+    {
+        args.vertexCount = m_DominantAxisIndexCounts[DOMINANT_AXIS_COUNT * meshID + axis];
+        args.startIndexLocation = 0U;
+        args.startVertexLocation = m_DominantAxisIndexStarts[DOMINANT_AXIS_COUNT * meshID + axis];
+    }
+
+    return args;
+}
+
 NVRHI::TextureHandle Scene::GetTextureSRV(aiTextureType type, uint32_t meshID) const
 {
     int materialIndex = GetMaterialIndex(meshID);
@@ -1067,6 +1299,78 @@ VXGI::Box3f Scene::GetMeshBounds(uint32_t meshID) const
     }
 }
 
+VXGI::Box3f Scene::GetMeshDominantAxisBounds(uint32_t meshID, uint32_t axis) const
+{
+    assert(axis < DOMINANT_AXIS_COUNT);
+    assert((DOMINANT_AXIS_COUNT * meshID + axis) < this->m_DominantAxisBounds.size());
+
+    if ((DOMINANT_AXIS_COUNT * meshID + axis) < this->m_DominantAxisBounds.size())
+    {
+        return this->m_DominantAxisBounds[DOMINANT_AXIS_COUNT * meshID + axis];
+    }
+    else
+    {
+        return VXGI::Box3f();
+    }
+}
+
+void Scene::SetMeshDynamic(uint32_t meshID, bool dynamic)
+{
+    assert(meshID < this->m_MeshDynamic.size());
+
+    if (meshID < this->m_MeshDynamic.size())
+    {
+        this->m_MeshDynamic[meshID] = dynamic;
+    }
+}
+
+bool Scene::IsMeshDynamic(uint32_t meshID) const
+{
+    assert(meshID < this->m_MeshDynamic.size());
+
+    return (meshID < this->m_MeshDynamic.size()) ? this->m_MeshDynamic[meshID] : false;
+}
+
+bool Scene::HasDynamicMeshes() const
+{
+    return std::find(this->m_MeshDynamic.begin(), this->m_MeshDynamic.end(), true) != this->m_MeshDynamic.end();
+}
+
+bool Scene::IsMeshAlphaTested(uint32_t meshID) const
+{
+    assert(meshID < this->m_MeshAlphaTested.size());
+
+    return (meshID < this->m_MeshAlphaTested.size()) ? this->m_MeshAlphaTested[meshID] : false;
+}
+
+bool Scene::GetMeshCpuGeometry(uint32_t meshID, CpuMeshGeometry &geometry) const
+{
+    if (meshID >= this->m_CpuIndices.size())
+    {
+        return false;
+    }
+
+    geometry.positions = this->m_CpuPositions[meshID].data();
+    geometry.texcoords = this->m_CpuTexcoords[meshID].data();
+    geometry.vertex_count = static_cast<uint32_t>(this->m_CpuPositions[meshID].size() / 3U);
+    geometry.indices = this->m_CpuIndices[meshID].data();
+    geometry.index_count = static_cast<uint32_t>(this->m_CpuIndices[meshID].size());
+
+    geometry.base_color_texels = NULL;
+    geometry.base_color_width = 0U;
+    geometry.base_color_height = 0U;
+
+    std::map<std::string, CpuImage>::const_iterator const found_image = this->m_CpuImages.find(this->m_CpuBaseColorImageNames[meshID]);
+    if ((found_image != this->m_CpuImages.end()) && (!found_image->second.texels.empty()))
+    {
+        geometry.base_color_texels = found_image->second.texels.data();
+        geometry.base_color_width = found_image->second.width;
+        geometry.base_color_height = found_image->second.height;
+    }
+
+    return true;
+}
+
 static cgltf_result _internal_cgltf_custom_read_file(const struct cgltf_memory_options *memory_options, const struct cgltf_file_options *file_options, const char *path, cgltf_size *size, void **data)
 {
     void *(*const memory_alloc)(void *, cgltf_size) = memory_options->alloc_func;
@@ -1187,3 +1491,4 @@ static void PNGCBAPI _internal_libpng_read_data_callback(png_structp png_ptr, pn
         }
     }
 }
+
@@ -26,14 +26,33 @@ protected:
 
     std::string m_ScenePath;
 
+    // see "LOAD_DOMINANT_AXIS_BINNING"
+    uint32_t m_LoadFlags;
+
     unsigned int m_NumMeshes;
 
+    // FNV-1a (see "HashContentData") of the scene path, the vertex and index data uploaded by InitResources and the materials including the texels of the base color textures
+    uint64_t m_ContentHash;
+
     VXGI::Box3f m_SceneBounds;
     std::vector<VXGI::Box3f> m_MeshBounds;
 
     std::vector<uint32_t> m_IndexCounts;
     std::vector<uint32_t> m_VertexCounts;
 
+    // The triangles of each mesh are sorted into contiguous index ranges by the dominant axis of the face normal (X, Y, Z).
+    // Indexed by "meshID * DOMINANT_AXIS_COUNT + axis".
+    // Empty unless the scene is loaded with "LOAD_DOMINANT_AXIS_BINNING".
+    std::vector<uint32_t> m_DominantAxisIndexStarts;
+    std::vector<uint32_t> m_DominantAxisIndexCounts;
+    std::vector<VXGI::Box3f> m_DominantAxisBounds;
+
+    // The static meshes are voxelized into the persistent layer and the dynamic meshes are voxelized into the per-frame overlay.
+    std::vector<bool> m_MeshDynamic;
+
+    // The alpha of the base color is only used by the materials of which the glTF "alphaMode" is not "OPAQUE".
+    std::vector<bool> m_MeshAlphaTested;
+
     std::vector<NVRHI::BufferRef> m_IndexBuffers;
     std::vector<NVRHI::BufferRef> m_VertexPositionBuffers;
     std::vector<NVRHI::BufferRef> m_VertexVaryingBuffers;
@@ -48,11 +67,58 @@ protected:
     std::vector<VXGI::float3> m_EmissiveColors;
 
     std::map<std::string, NVRHI::TextureHandle> m_LoadedTextures;
-    
-    NVRHI::TextureHandle LoadTextureFromFile(const char *name, bool force_srgb);
+
+    // the hash of the texels, only for the textures loaded with the content hash requested
+    std::map<std::string, uint64_t> m_LoadedTextureHashes;
+
+    struct CpuImage
+    {
+        uint32_t width;
+        uint32_t height;
+        std::vector<uint32_t> texels;
+    };
+
+    // Empty unless the scene is loaded with "LOAD_CPU_GEOMETRY".
+    // The positions are in the space of the vertex position buffer and the indices are in the order of the index buffer.
+    std::vector<std::vector<float>> m_CpuPositions;
+    std::vector<std::vector<float>> m_CpuTexcoords;
+    std::vector<std::vector<uint32_t>> m_CpuIndices;
+    // the path of the base color texture of each mesh (empty without the texture), the images are shared by the meshes
+    std::vector<std::string> m_CpuBaseColorImageNames;
+    std::map<std::string, CpuImage> m_CpuImages;
+
+    // relative to the directory of the scene
+    std::string GetTexturePath(const char *name) const;
+
+    NVRHI::TextureHandle LoadTextureFromFile(const char *name, bool force_srgb, uint64_t *content_hash = NULL);
 
 public:
-    Scene() : m_Renderer(NULL), m_NumMeshes(0U)
+    static uint32_t const DOMINANT_AXIS_COUNT = 3U;
+
+    // the flags of "Load"
+    // the triangles are binned by the dominant axis in InitResources, only the samples which voxelize the scene with the fixed projection per draw call need this
+    static uint32_t const LOAD_DOMINANT_AXIS_BINNING = 0x1U;
+    // the geometry and the base color texels are kept on the CPU in InitResources, only the CPU voxelizer needs this
+    static uint32_t const LOAD_CPU_GEOMETRY = 0x2U;
+
+    struct CpuMeshGeometry
+    {
+        // 3 x "float" per vertex, in the space of the vertex position buffer
+        float const *positions;
+        // 2 x "float" per vertex
+        float const *texcoords;
+        uint32_t vertex_count;
+
+        uint32_t const *indices;
+        uint32_t index_count;
+
+        // RGBA8, row by row without padding, NULL without the base color texture
+        uint32_t const *base_color_texels;
+        uint32_t base_color_width;
+        uint32_t base_color_height;
+    };
+
+    Scene() : m_Renderer(NULL), m_LoadFlags(0U), m_NumMeshes(0U), m_ContentHash(0U)
     {
     }
 
@@ -65,16 +131,22 @@ public:
     VXGI::float4x4 m_WorldMatrix;
 
     HRESULT Load(const char *fileName, uint32_t flags = 0);
+    // without the renderer (NULL) no buffer or texture is created, and only the bounds, the content hash and the CPU geometry (see "LOAD_CPU_GEOMETRY") are loaded
     HRESULT InitResources(NVRHI::IRendererInterface *pRenderer);
     void Release();
     void ReleaseResources();
 
-    NVRHI::TextureHandle LoadTextureFromFileInternal(const char *name, bool force_srgb);
+    NVRHI::TextureHandle LoadTextureFromFileInternal(const char *name, bool force_srgb, uint64_t *content_hash = NULL);
+
+    // decodes the PNG file into RGBA8 texels, row by row
+    static bool LoadImageFromFile(const char *name, std::vector<uint32_t> &pixel_data, uint32_t &pixel_data_width, uint32_t &pixel_data_height);
 
     const char *GetScenePath() const;
 
     uint32_t GetMeshesNum() const;
 
+    uint64_t GetContentHash() const;
+
     VXGI::Box3f GetSceneBounds() const;
 
     NVRHI::BufferHandle GetIndexBuffer(uint32_t meshID) const;
@@ -82,10 +154,23 @@ public:
     NVRHI::BufferHandle GetVertexVaryingBuffer(uint32_t meshID) const;
 
     NVRHI::DrawArguments GetMeshDrawArguments(uint32_t meshID) const;
+    // the scene must be loaded with "LOAD_DOMINANT_AXIS_BINNING", otherwise the ranges are empty
+    NVRHI::DrawArguments GetMeshDominantAxisDrawArguments(uint32_t meshID, uint32_t axis) const;
 
     NVRHI::TextureHandle GetTextureSRV(aiTextureType type, uint32_t meshID) const;
     VXGI::float3 GetColor(aiTextureType type, uint32_t meshID) const;
     int GetMaterialIndex(uint32_t meshID) const;
 
     VXGI::Box3f GetMeshBounds(uint32_t meshID) const;
+    VXGI::Box3f GetMeshDominantAxisBounds(uint32_t meshID, uint32_t axis) const;
+
+    // all meshes are static by default
+    void SetMeshDynamic(uint32_t meshID, bool dynamic);
+    bool IsMeshDynamic(uint32_t meshID) const;
+    bool HasDynamicMeshes() const;
+
+    bool IsMeshAlphaTested(uint32_t meshID) const;
+
+    // the scene must be loaded with "LOAD_CPU_GEOMETRY", otherwise false is returned
+    bool GetMeshCpuGeometry(uint32_t meshID, CpuMeshGeometry &geometry) const;
 };
\ No newline at end of file
@@ -350,6 +350,11 @@ public:
     {
         return m_mCameraWorld.r[3];
     }
+    XMVECTOR GetWorldVelocity() const
+    {
+        // the velocity is in the local space of the camera
+        return XMVector3TransformNormal(m_vVelocity, m_mCameraWorld);
+    }
 
 protected:
     XMMATRIX m_mCameraWorld; // World matrix of the camera (inverse of the view matrix)